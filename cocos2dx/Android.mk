@@ -41,6 +41,7 @@ CCDirector.cpp \
 draw_nodes/CCDrawingPrimitives.cpp \
 draw_nodes/CCDrawNode.cpp \
 effects/CCGrabber.cpp \
+effects/ccGridKernels.cpp \
 effects/CCGrid.cpp \
 kazmath/src/aabb.c \
 kazmath/src/mat3.c \
@@ -71,6 +72,7 @@ misc_nodes/CCClippingNode.cpp \
 misc_nodes/CCMotionStreak.cpp \
 misc_nodes/CCProgressTimer.cpp \
 misc_nodes/CCRenderTexture.cpp \
+misc_nodes/CCRenderCacheNode.cpp \
 particle_nodes/CCParticleExamples.cpp \
 particle_nodes/CCParticleSystem.cpp \
 particle_nodes/CCParticleBatchNode.cpp \
@@ -110,6 +112,8 @@ sprite_nodes/CCSpriteFrameCache.cpp \
 support/ccUTF8.cpp \
 support/CCNotificationCenter.cpp \
 support/CCProfiling.cpp \
+support/CCFrameTimeHistogram.cpp \
+support/CCPoolAllocator.cpp \
 support/CCPointExtension.cpp \
 support/TransformUtils.cpp \
 support/user_default/CCUserDefaultAndroid.cpp \
@@ -118,6 +122,8 @@ support/ccUtils.cpp \
 support/CCVertex.cpp \
 support/data_support/ccCArray.cpp \
 support/image_support/TGAlib.cpp \
+support/image_support/ccTextureDecoders.cpp \
+support/image_support/ccPixelConversion.cpp \
 support/tinyxml2/tinyxml2.cpp \
 support/zip_support/ZipUtils.cpp \
 support/zip_support/ioapi.cpp \
@@ -128,6 +134,8 @@ textures/CCTexture2D.cpp \
 textures/CCTextureAtlas.cpp \
 textures/CCTextureCache.cpp \
 textures/CCTexturePVR.cpp \
+textures/CCTextureKTX.cpp \
+textures/CCDynamicAtlas.cpp \
 tilemap_parallax_nodes/CCParallaxNode.cpp \
 tilemap_parallax_nodes/CCTMXLayer.cpp \
 tilemap_parallax_nodes/CCTMXObjectGroup.cpp \
@@ -38,10 +38,15 @@ CCConfiguration::CCConfiguration(void)
 : m_nMaxTextureSize(0) 
 , m_nMaxModelviewStackDepth(0)
 , m_bSupportsPVRTC(false)
+, m_bSupportsETC1(false)
+, m_bSupportsETC2(false)
+, m_bSupportsS3TC(false)
 , m_bSupportsNPOT(false)
 , m_bSupportsBGRA8888(false)
 , m_bSupportsDiscardFramebuffer(false)
 , m_bSupportsShareableVAO(false)
+, m_bSupportsProgramBinary(false)
+, m_bSupportsPixelBufferObject(false)
 , m_nMaxSamplesAllowed(0)
 , m_nMaxTextureUnits(0)
 , m_pGlExtensions(NULL)
@@ -63,19 +68,33 @@ bool CCConfiguration::init(void)
 #endif
 
     m_bSupportsPVRTC = checkForGLExtension("GL_IMG_texture_compression_pvrtc");
+    m_bSupportsETC1 = checkForGLExtension("GL_OES_compressed_ETC1_RGB8_texture");
+    const char *pszVersion = (const char *)glGetString(GL_VERSION);
+    m_bSupportsETC2 = checkForGLExtension("GL_ARB_ES3_compatibility") ||
+        (pszVersion && strncmp(pszVersion, "OpenGL ES 3", 11) == 0);
+    m_bSupportsS3TC = checkForGLExtension("GL_EXT_texture_compression_s3tc");
     m_bSupportsNPOT = true;
     m_bSupportsBGRA8888 = checkForGLExtension("GL_IMG_texture_format_BGRA888");
     m_bSupportsDiscardFramebuffer = checkForGLExtension("GL_EXT_discard_framebuffer");
 
     m_bSupportsShareableVAO = checkForGLExtension("vertex_array_object");
+    m_bSupportsProgramBinary = checkForGLExtension("GL_OES_get_program_binary") ||
+        checkForGLExtension("GL_ARB_get_program_binary");
+    m_bSupportsPixelBufferObject = checkForGLExtension("GL_ARB_pixel_buffer_object") ||
+        checkForGLExtension("GL_EXT_pixel_buffer_object");
 
     CCLOG("cocos2d: GL_MAX_TEXTURE_SIZE: %d", m_nMaxTextureSize);
     CCLOG("cocos2d: GL_MAX_TEXTURE_UNITS: %d",m_nMaxTextureUnits);
     CCLOG("cocos2d: GL supports PVRTC: %s", (m_bSupportsPVRTC ? "YES" : "NO"));
+    CCLOG("cocos2d: GL supports ETC1: %s", (m_bSupportsETC1 ? "YES" : "NO"));
+    CCLOG("cocos2d: GL supports ETC2: %s", (m_bSupportsETC2 ? "YES" : "NO"));
+    CCLOG("cocos2d: GL supports S3TC: %s", (m_bSupportsS3TC ? "YES" : "NO"));
     CCLOG("cocos2d: GL supports BGRA8888 textures: %s", (m_bSupportsBGRA8888 ? "YES" : "NO"));
     CCLOG("cocos2d: GL supports NPOT textures: %s", (m_bSupportsNPOT ? "YES" : "NO"));
     CCLOG("cocos2d: GL supports discard_framebuffer: %s", (m_bSupportsDiscardFramebuffer ? "YES" : "NO"));
     CCLOG("cocos2d: GL supports shareable VAO: %s", (m_bSupportsShareableVAO ? "YES" : "NO") );
+    CCLOG("cocos2d: GL supports program binaries: %s", (m_bSupportsProgramBinary ? "YES" : "NO"));
+    CCLOG("cocos2d: GL supports pixel buffer objects: %s", (m_bSupportsPixelBufferObject ? "YES" : "NO"));
 
     bool CC_UNUSED bEnableProfilers = false;
 
@@ -85,6 +85,30 @@ public:
         return m_bSupportsPVRTC;
     }
 
+    /** Whether or not ETC1 Texture Compressed is supported
+     @since v2.1.4
+     */
+    inline bool supportsETC1(void)
+    {
+        return m_bSupportsETC1;
+    }
+
+    /** Whether or not ETC2 / EAC Texture Compressed is supported (OpenGL ES 3.0 or GL_ARB_ES3_compatibility)
+     @since v2.1.4
+     */
+    inline bool supportsETC2(void)
+    {
+        return m_bSupportsETC2;
+    }
+
+    /** Whether or not S3TC (DXT1, DXT3 and DXT5) Texture Compressed is supported
+     @since v2.1.4
+     */
+    inline bool supportsS3TC(void)
+    {
+        return m_bSupportsS3TC;
+    }
+
     /** Whether or not BGRA8888 textures are supported.
      @since v0.99.2
      */
@@ -109,6 +133,24 @@ public:
         return m_bSupportsShareableVAO;
     }
 
+    /** Whether or not linked programs can be saved and reloaded with glGetProgramBinary / glProgramBinary
+     (GL_OES_get_program_binary or GL_ARB_get_program_binary)
+     @since v2.1.4
+     */
+    inline bool supportsProgramBinary(void)
+    {
+        return m_bSupportsProgramBinary;
+    }
+
+    /** Whether or not pixels can be read back into a buffer object without stalling the pipeline
+     (GL_ARB_pixel_buffer_object or GL_EXT_pixel_buffer_object)
+     @since v2.1.4
+     */
+    inline bool supportsPixelBufferObject(void)
+    {
+        return m_bSupportsPixelBufferObject;
+    }
+
     /** returns whether or not an OpenGL is supported */
     bool checkForGLExtension(const std::string &searchName);
 
@@ -122,10 +164,15 @@ protected:
     GLint           m_nMaxTextureSize;
     GLint           m_nMaxModelviewStackDepth;
     bool            m_bSupportsPVRTC;
+    bool            m_bSupportsETC1;
+    bool            m_bSupportsETC2;
+    bool            m_bSupportsS3TC;
     bool            m_bSupportsNPOT;
     bool            m_bSupportsBGRA8888;
     bool            m_bSupportsDiscardFramebuffer;
     bool            m_bSupportsShareableVAO;
+    bool            m_bSupportsProgramBinary;
+    bool            m_bSupportsPixelBufferObject;
     GLint           m_nMaxSamplesAllowed;
     GLint           m_nMaxTextureUnits;
     char *          m_pGlExtensions;
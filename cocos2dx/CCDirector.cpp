@@ -56,6 +56,8 @@ THE SOFTWARE.
 #include "kazmath/kazmath.h"
 #include "kazmath/GL/matrix.h"
 #include "support/CCProfiling.h"
+#include "support/CCPoolAllocator.h"
+#include "support/CCFrameTimeHistogram.h"
 #include "CCEGLView.h"
 #include <string>
 
@@ -71,6 +73,7 @@ THE SOFTWARE.
 using namespace std;
 
 unsigned int g_uNumberOfDraws = 0;
+unsigned int g_uNumberOfCulledNodes = 0;
 
 NS_CC_BEGIN
 // XXX it should be a Director ivar. Move it there once support for multiple directors is added
@@ -100,6 +103,9 @@ CCDirector::CCDirector(void)
 bool CCDirector::init(void)
 {
     CCLOG("cocos2d: %s", cocos2dVersion());
+
+    // the objects of the game loop are allocated without locking
+    CCPoolAllocator::setMainThread();
     
     // scenes
     m_pRunningScene = NULL;
@@ -125,8 +131,9 @@ bool CCDirector::init(void)
     m_pDrawsLabel = NULL;
     m_bDisplayStats = false;
     m_uTotalFrames = m_uFrames = 0;
-    m_pszFPS = new char[10];
+    m_pszFPS = new char[32];
     m_pLastUpdate = new struct cc_timeval();
+    m_pFrameTimeHistogram = new CCFrameTimeHistogram();
 
     // paused ?
     m_bPaused = false;
@@ -184,6 +191,7 @@ CCDirector::~CCDirector(void)
 
     // delete m_pLastUpdate
     CC_SAFE_DELETE(m_pLastUpdate);
+    CC_SAFE_DELETE(m_pFrameTimeHistogram);
     // delete fps string
     delete []m_pszFPS;
 
@@ -239,6 +247,9 @@ void CCDirector::drawScene(void)
     {
         m_pNotificationNode->visit();
     }
+
+    // and the primitives batched while drawing them
+    ccDrawFlush();
     
     if (m_bDisplayStats)
     {
@@ -773,7 +784,15 @@ void CCDirector::showStats(void)
                 sprintf(m_pszFPS, "%.1f", m_fFrameRate);
                 m_pFPSLabel->setString(m_pszFPS);
                 
-                sprintf(m_pszFPS, "%4lu", (unsigned long)g_uNumberOfDraws);
+                if (CCNode::isCullingEnabled())
+                {
+                    // draw calls / culled nodes
+                    sprintf(m_pszFPS, "%4lu / %lu", (unsigned long)g_uNumberOfDraws, (unsigned long)g_uNumberOfCulledNodes);
+                }
+                else
+                {
+                    sprintf(m_pszFPS, "%4lu", (unsigned long)g_uNumberOfDraws);
+                }
                 m_pDrawsLabel->setString(m_pszFPS);
             }
             
@@ -784,6 +803,7 @@ void CCDirector::showStats(void)
     }    
     
     g_uNumberOfDraws = 0;
+    g_uNumberOfCulledNodes = 0;
 }
 
 void CCDirector::calculateMPF()
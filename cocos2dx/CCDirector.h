@@ -73,6 +73,7 @@ class CCActionManager;
 class CCTouchDispatcher;
 class CCKeypadDispatcher;
 class CCAccelerometer;
+class CCFrameTimeHistogram;
 
 /**
 @brief Class that creates and handle the main Window and manages how
@@ -135,6 +136,12 @@ public:
 
     /** How many frames were called since the director started */
     inline unsigned int getTotalFrames(void) { return m_uTotalFrames; }
+
+    /** Frame times measured by the main loop, with their percentiles and missed deadlines.
+     Only filled on the platforms which pace their frames themselves, Linux for now.
+     @since v2.1.4
+     */
+    inline CCFrameTimeHistogram* getFrameTimeHistogram(void) { return m_pFrameTimeHistogram; }
     
     /** Sets an OpenGL projection
      @since v0.8.2
@@ -394,6 +401,9 @@ protected:
     /* last time the main loop was updated */
     struct cc_timeval *m_pLastUpdate;
 
+    /* frame times measured by the main loop */
+    CCFrameTimeHistogram *m_pFrameTimeHistogram;
+
     /* whether or not the next delta time will be zero */
     bool m_bNextDeltaTimeZero;
     
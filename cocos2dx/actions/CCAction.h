@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "cocoa/CCObject.h"
 #include "cocoa/CCGeometry.h"
 #include "platform/CCPlatformMacros.h"
+#include "support/CCPoolAllocator.h"
 
 NS_CC_BEGIN
 
@@ -48,6 +49,8 @@ enum {
  */
 class CC_DLL CCAction : public CCObject 
 {
+    CC_POOL_ALLOCATED()
+
 public:
     CCAction(void);
     virtual ~CCAction(void);
@@ -56,6 +56,8 @@ NS_CC_BEGIN;
  */
 class CC_DLL CCPointArray : public CCObject
 {
+    CC_POOL_ALLOCATED()
+
 public:
     
     /** creates and initializes a Points array with capacity */
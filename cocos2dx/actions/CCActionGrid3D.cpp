@@ -26,9 +26,203 @@ THE SOFTWARE.
 #include "support/CCPointExtension.h"
 #include "CCDirector.h"
 #include "cocoa/CCZone.h"
+#include "effects/CCGrid.h"
+#include "effects/ccGridKernels.h"
 #include <stdlib.h>
 
 NS_CC_BEGIN
+
+// The vertex kernels below run over whole grid columns, which are contiguous in the vertex arrays,
+// so that ccGridParallelFor can split the columns across the grid worker threads. Each column is
+// processed in chunks whose sines are evaluated together by ccSinArray.
+
+#define CC_GRID_CHUNK 128
+
+struct GridKernelContext
+{
+    const ccVertex3F*   src;            // original vertices
+    ccVertex3F*         dst;            // vertices
+    unsigned int        columnSize;     // vertices per column, gridSize.height + 1
+    float               phase;          // time * M_PI * waves * 2
+    float               amplitude;      // amplitude * amplitudeRate
+    CCPoint             center;
+    float               radius;
+    CCSize              gridSize;
+    bool                horizontal;
+    bool                vertical;
+};
+
+static void waves3DColumns(void* data, unsigned int begin, unsigned int end)
+{
+    GridKernelContext* c = (GridKernelContext*)data;
+    float sines[CC_GRID_CHUNK];
+
+    for (unsigned int first = begin * c->columnSize, last = end * c->columnSize; first < last; first += CC_GRID_CHUNK)
+    {
+        unsigned int n = MIN(CC_GRID_CHUNK, last - first);
+        const ccVertex3F* src = c->src + first;
+        ccVertex3F* dst = c->dst + first;
+
+        for (unsigned int k = 0; k < n; ++k)
+        {
+            sines[k] = c->phase + (src[k].y + src[k].x) * 0.01f;
+        }
+        ccSinArray(sines, sines, n);
+        for (unsigned int k = 0; k < n; ++k)
+        {
+            dst[k].x = src[k].x;
+            dst[k].y = src[k].y;
+            dst[k].z = src[k].z + sines[k] * c->amplitude;
+        }
+    }
+}
+
+static void ripple3DColumns(void* data, unsigned int begin, unsigned int end)
+{
+    GridKernelContext* c = (GridKernelContext*)data;
+    float sines[CC_GRID_CHUNK];
+    float weights[CC_GRID_CHUNK];
+
+    for (unsigned int first = begin * c->columnSize, last = end * c->columnSize; first < last; first += CC_GRID_CHUNK)
+    {
+        unsigned int n = MIN(CC_GRID_CHUNK, last - first);
+        const ccVertex3F* src = c->src + first;
+        ccVertex3F* dst = c->dst + first;
+
+        for (unsigned int k = 0; k < n; ++k)
+        {
+            float dx = c->center.x - src[k].x;
+            float dy = c->center.y - src[k].y;
+            float r = c->radius - sqrtf(dx * dx + dy * dy);
+            float rate = r / c->radius;
+            // vertices outside of the radius don't move
+            weights[k] = r > 0 ? rate * rate * c->amplitude : 0;
+            sines[k] = c->phase + r * 0.1f;
+        }
+        ccSinArray(sines, sines, n);
+        for (unsigned int k = 0; k < n; ++k)
+        {
+            dst[k].x = src[k].x;
+            dst[k].y = src[k].y;
+            dst[k].z = src[k].z + sines[k] * weights[k];
+        }
+    }
+}
+
+static void liquidColumns(void* data, unsigned int begin, unsigned int end)
+{
+    GridKernelContext* c = (GridKernelContext*)data;
+    float sinesX[CC_GRID_CHUNK];
+    float sinesY[CC_GRID_CHUNK];
+
+    // the border vertices don't move: columns and rows 1 to gridSize - 1 only
+    for (unsigned int i = begin + 1; i < end + 1; ++i)
+    {
+        for (unsigned int first = i * c->columnSize + 1, last = (i + 1) * c->columnSize - 1; first < last; first += CC_GRID_CHUNK)
+        {
+            unsigned int n = MIN(CC_GRID_CHUNK, last - first);
+            const ccVertex3F* src = c->src + first;
+            ccVertex3F* dst = c->dst + first;
+
+            for (unsigned int k = 0; k < n; ++k)
+            {
+                sinesX[k] = c->phase + src[k].x * .01f;
+                sinesY[k] = c->phase + src[k].y * .01f;
+            }
+            ccSinArray(sinesX, sinesX, n);
+            ccSinArray(sinesY, sinesY, n);
+            for (unsigned int k = 0; k < n; ++k)
+            {
+                dst[k].x = src[k].x + sinesX[k] * c->amplitude;
+                dst[k].y = src[k].y + sinesY[k] * c->amplitude;
+                dst[k].z = src[k].z;
+            }
+        }
+    }
+}
+
+static void wavesColumns(void* data, unsigned int begin, unsigned int end)
+{
+    GridKernelContext* c = (GridKernelContext*)data;
+    float sines[CC_GRID_CHUNK];
+
+    for (unsigned int first = begin * c->columnSize, last = end * c->columnSize; first < last; first += CC_GRID_CHUNK)
+    {
+        unsigned int n = MIN(CC_GRID_CHUNK, last - first);
+        const ccVertex3F* src = c->src + first;
+        ccVertex3F* dst = c->dst + first;
+
+        for (unsigned int k = 0; k < n; ++k)
+        {
+            dst[k] = src[k];
+        }
+
+        // x waves along y first, then y along the displaced x
+        if (c->vertical)
+        {
+            for (unsigned int k = 0; k < n; ++k)
+            {
+                sines[k] = c->phase + dst[k].y * .01f;
+            }
+            ccSinArray(sines, sines, n);
+            for (unsigned int k = 0; k < n; ++k)
+            {
+                dst[k].x += sines[k] * c->amplitude;
+            }
+        }
+
+        if (c->horizontal)
+        {
+            for (unsigned int k = 0; k < n; ++k)
+            {
+                sines[k] = c->phase + dst[k].x * .01f;
+            }
+            ccSinArray(sines, sines, n);
+            for (unsigned int k = 0; k < n; ++k)
+            {
+                dst[k].y += sines[k] * c->amplitude;
+            }
+        }
+    }
+}
+
+static void twirlColumns(void* data, unsigned int begin, unsigned int end)
+{
+    GridKernelContext* c = (GridKernelContext*)data;
+    float sines[CC_GRID_CHUNK];
+    float cosines[CC_GRID_CHUNK];
+
+    for (unsigned int i = begin; i < end; ++i)
+    {
+        float dx = i - c->gridSize.width / 2.0f;
+
+        for (unsigned int j = 0; j < c->columnSize; j += CC_GRID_CHUNK)
+        {
+            unsigned int n = MIN(CC_GRID_CHUNK, c->columnSize - j);
+            const ccVertex3F* src = c->src + i * c->columnSize + j;
+            ccVertex3F* dst = c->dst + i * c->columnSize + j;
+
+            // the angle grows with the distance, in grid units, from the center of the grid
+            for (unsigned int k = 0; k < n; ++k)
+            {
+                float dy = (j + k) - c->gridSize.height / 2.0f;
+                sines[k] = sqrtf(dx * dx + dy * dy) * c->amplitude;
+                cosines[k] = sines[k] + (float)M_PI / 2.0f;
+            }
+            ccSinArray(sines, sines, n);
+            ccSinArray(cosines, cosines, n);
+            for (unsigned int k = 0; k < n; ++k)
+            {
+                float x = src[k].x - c->center.x;
+                float y = src[k].y - c->center.y;
+                dst[k].x = c->center.x + sines[k] * y + cosines[k] * x;
+                dst[k].y = c->center.y + cosines[k] * y - sines[k] * x;
+                dst[k].z = src[k].z;
+            }
+        }
+    }
+}
+
 // implementation of CCWaves3D
 
 CCWaves3D* CCWaves3D::create(float duration, const CCSize& gridSize, unsigned int waves, float amplitude)
@@ -90,17 +284,16 @@ CCObject* CCWaves3D::copyWithZone(CCZone *pZone)
 
 void CCWaves3D::update(float time)
 {
-    int i, j;
-    for (i = 0; i < m_sGridSize.width + 1; ++i)
-    {
-        for (j = 0; j < m_sGridSize.height + 1; ++j)
-        {
-            ccVertex3F v = originalVertex(ccp(i ,j));
-            v.z += (sinf((float)M_PI * time * m_nWaves * 2 + (v.y+v.x) * 0.01f) * m_fAmplitude * m_fAmplitudeRate);
-            //CCLOG("v.z offset is %f\n", (sinf((float)M_PI * time * m_nWaves * 2 + (v.y+v.x) * .01f) * m_fAmplitude * m_fAmplitudeRate));
-            setVertex(ccp(i, j), v);
-        }
-    }
+    CCGrid3D* pGrid = (CCGrid3D*)m_pTarget->getGrid();
+
+    GridKernelContext context;
+    context.src = pGrid->getOriginalVertices();
+    context.dst = pGrid->getVertices();
+    context.columnSize = m_sGridSize.height + 1;
+    context.phase = (float)M_PI * time * m_nWaves * 2;
+    context.amplitude = m_fAmplitude * m_fAmplitudeRate;
+
+    ccGridParallelFor(m_sGridSize.width + 1, context.columnSize, waves3DColumns, &context);
 }
 
 // implementation of CCFlipX3D
@@ -413,38 +606,38 @@ void CCLens3D::update(float time)
     CC_UNUSED_PARAM(time);
     if (m_bDirty)
     {
-        int i, j;
-        
-        for (i = 0; i < m_sGridSize.width + 1; ++i)
+        CCGrid3D* pGrid = (CCGrid3D*)m_pTarget->getGrid();
+        const ccVertex3F* src = pGrid->getOriginalVertices();
+        ccVertex3F* dst = pGrid->getVertices();
+        unsigned int count = (m_sGridSize.width + 1) * (m_sGridSize.height + 1);
+
+        for (unsigned int k = 0; k < count; ++k)
         {
-            for (j = 0; j < m_sGridSize.height + 1; ++j)
+            ccVertex3F v = src[k];
+            CCPoint vect = ccpSub(m_position, ccp(v.x, v.y));
+            float r = ccpLength(vect);
+            
+            if (r < m_fRadius)
             {
-                ccVertex3F v = originalVertex(ccp(i, j));
-                CCPoint vect = ccpSub(m_position, ccp(v.x, v.y));
-                float r = ccpLength(vect);
-                
-                if (r < m_fRadius)
+                r = m_fRadius - r;
+                float pre_log = r / m_fRadius;
+                if ( pre_log == 0 ) 
                 {
-                    r = m_fRadius - r;
-                    float pre_log = r / m_fRadius;
-                    if ( pre_log == 0 ) 
-                    {
-                        pre_log = 0.001f;
-                    }
-
-                    float l = logf(pre_log) * m_fLensEffect;
-                    float new_r = expf( l ) * m_fRadius;
-                    
-                    if (ccpLength(vect) > 0)
-                    {
-                        vect = ccpNormalize(vect);
-                        CCPoint new_vect = ccpMult(vect, new_r);
-                        v.z += (m_bConcave ? -1.0f : 1.0f) * ccpLength(new_vect) * m_fLensEffect;
-                    }
+                    pre_log = 0.001f;
                 }
+
+                float l = logf(pre_log) * m_fLensEffect;
+                float new_r = expf( l ) * m_fRadius;
                 
-                setVertex(ccp(i, j), v);
+                if (ccpLength(vect) > 0)
+                {
+                    vect = ccpNormalize(vect);
+                    CCPoint new_vect = ccpMult(vect, new_r);
+                    v.z += (m_bConcave ? -1.0f : 1.0f) * ccpLength(new_vect) * m_fLensEffect;
+                }
             }
+            
+            dst[k] = v;
         }
         
         m_bDirty = false;
@@ -518,26 +711,18 @@ CCObject* CCRipple3D::copyWithZone(CCZone *pZone)
 
 void CCRipple3D::update(float time)
 {
-    int i, j;
-
-    for (i = 0; i < (m_sGridSize.width+1); ++i)
-    {
-        for (j = 0; j < (m_sGridSize.height+1); ++j)
-        {
-            ccVertex3F v = originalVertex(ccp(i, j));
-            CCPoint vect = ccpSub(m_position, ccp(v.x,v.y));
-            float r = ccpLength(vect);
-            
-            if (r < m_fRadius)
-            {
-                r = m_fRadius - r;
-                float rate = powf(r / m_fRadius, 2);
-                v.z += (sinf( time*(float)M_PI * m_nWaves * 2 + r * 0.1f) * m_fAmplitude * m_fAmplitudeRate * rate);
-            }
-            
-            setVertex(ccp(i, j), v);
-        }
-    }
+    CCGrid3D* pGrid = (CCGrid3D*)m_pTarget->getGrid();
+
+    GridKernelContext context;
+    context.src = pGrid->getOriginalVertices();
+    context.dst = pGrid->getVertices();
+    context.columnSize = m_sGridSize.height + 1;
+    context.phase = time * (float)M_PI * m_nWaves * 2;
+    context.amplitude = m_fAmplitude * m_fAmplitudeRate;
+    context.center = m_position;
+    context.radius = m_fRadius;
+
+    ccGridParallelFor(m_sGridSize.width + 1, context.columnSize, ripple3DColumns, &context);
 }
 
 // implementation of Shaky3D
@@ -600,22 +785,23 @@ CCObject* CCShaky3D::copyWithZone(CCZone *pZone)
 void CCShaky3D::update(float time)
 {
     CC_UNUSED_PARAM(time);
-    int i, j;
+    CCGrid3D* pGrid = (CCGrid3D*)m_pTarget->getGrid();
+    const ccVertex3F* src = pGrid->getOriginalVertices();
+    ccVertex3F* dst = pGrid->getVertices();
+    unsigned int count = (m_sGridSize.width + 1) * (m_sGridSize.height + 1);
 
-    for (i = 0; i < (m_sGridSize.width+1); ++i)
+    // rand() isn't thread safe, and keeps the sequence of the column by column loop this way
+    for (unsigned int k = 0; k < count; ++k)
     {
-        for (j = 0; j < (m_sGridSize.height+1); ++j)
+        ccVertex3F v = src[k];
+        v.x += (rand() % (m_nRandrange*2)) - m_nRandrange;
+        v.y += (rand() % (m_nRandrange*2)) - m_nRandrange;
+        if (m_bShakeZ)
         {
-            ccVertex3F v = originalVertex(ccp(i ,j));
-            v.x += (rand() % (m_nRandrange*2)) - m_nRandrange;
-            v.y += (rand() % (m_nRandrange*2)) - m_nRandrange;
-            if (m_bShakeZ)
-            {
-                v.z += (rand() % (m_nRandrange*2)) - m_nRandrange;
-            }
-            
-            setVertex(ccp(i, j), v);
+            v.z += (rand() % (m_nRandrange*2)) - m_nRandrange;
         }
+        
+        dst[k] = v;
     }
 }
 
@@ -679,18 +865,21 @@ CCObject* CCLiquid::copyWithZone(CCZone *pZone)
 
 void CCLiquid::update(float time)
 {
-    int i, j;
-
-    for (i = 1; i < m_sGridSize.width; ++i)
+    if (m_sGridSize.width < 2 || m_sGridSize.height < 2)
     {
-        for (j = 1; j < m_sGridSize.height; ++j)
-        {
-            ccVertex3F v = originalVertex(ccp(i, j));
-            v.x = (v.x + (sinf(time * (float)M_PI * m_nWaves * 2 + v.x * .01f) * m_fAmplitude * m_fAmplitudeRate));
-            v.y = (v.y + (sinf(time * (float)M_PI * m_nWaves * 2 + v.y * .01f) * m_fAmplitude * m_fAmplitudeRate));
-            setVertex(ccp(i, j), v);
-        }
+        return;
     }
+
+    CCGrid3D* pGrid = (CCGrid3D*)m_pTarget->getGrid();
+
+    GridKernelContext context;
+    context.src = pGrid->getOriginalVertices();
+    context.dst = pGrid->getVertices();
+    context.columnSize = m_sGridSize.height + 1;
+    context.phase = time * (float)M_PI * m_nWaves * 2;
+    context.amplitude = m_fAmplitude * m_fAmplitudeRate;
+
+    ccGridParallelFor(m_sGridSize.width - 1, context.columnSize, liquidColumns, &context);
 }
 
 // implementation of Waves
@@ -755,27 +944,18 @@ CCObject* CCWaves::copyWithZone(CCZone *pZone)
 
 void CCWaves::update(float time)
 {
-    int i, j;
-
-    for (i = 0; i < m_sGridSize.width + 1; ++i)
-    {
-        for (j = 0; j < m_sGridSize.height + 1; ++j)
-        {
-            ccVertex3F v = originalVertex(ccp(i, j));
-
-            if (m_bVertical)
-            {
-                v.x = (v.x + (sinf(time * (float)M_PI * m_nWaves * 2 + v.y * .01f) * m_fAmplitude * m_fAmplitudeRate));
-            }
-
-            if (m_bHorizontal)
-            {
-                v.y = (v.y + (sinf(time * (float)M_PI * m_nWaves * 2 + v.x * .01f) * m_fAmplitude * m_fAmplitudeRate));
-            }
-
-            setVertex(ccp(i, j), v);
-        }
-    }
+    CCGrid3D* pGrid = (CCGrid3D*)m_pTarget->getGrid();
+
+    GridKernelContext context;
+    context.src = pGrid->getOriginalVertices();
+    context.dst = pGrid->getVertices();
+    context.columnSize = m_sGridSize.height + 1;
+    context.phase = time * (float)M_PI * m_nWaves * 2;
+    context.amplitude = m_fAmplitude * m_fAmplitudeRate;
+    context.horizontal = m_bHorizontal;
+    context.vertical = m_bVertical;
+
+    ccGridParallelFor(m_sGridSize.width + 1, context.columnSize, wavesColumns, &context);
 }
 
 // implementation of Twirl
@@ -845,31 +1025,18 @@ CCObject* CCTwirl::copyWithZone(CCZone *pZone)
 
 void CCTwirl::update(float time)
 {
-    int i, j;
-    CCPoint    c = m_position;
-    
-    for (i = 0; i < (m_sGridSize.width+1); ++i)
-    {
-        for (j = 0; j < (m_sGridSize.height+1); ++j)
-        {
-            ccVertex3F v = originalVertex(ccp(i ,j));
-            
-            CCPoint    avg = ccp(i-(m_sGridSize.width/2.0f), j-(m_sGridSize.height/2.0f));
-            float r = ccpLength(avg);
-            
-            float amp = 0.1f * m_fAmplitude * m_fAmplitudeRate;
-            float a = r * cosf( (float)M_PI/2.0f + time * (float)M_PI * m_nTwirls * 2 ) * amp;
-            
-            CCPoint d = ccp(
-                sinf(a) * (v.y-c.y) + cosf(a) * (v.x-c.x),
-                cosf(a) * (v.y-c.y) - sinf(a) * (v.x-c.x));
-            
-            v.x = c.x + d.x;
-            v.y = c.y + d.y;
-
-            setVertex(ccp(i ,j), v);
-        }
-    }
+    CCGrid3D* pGrid = (CCGrid3D*)m_pTarget->getGrid();
+
+    GridKernelContext context;
+    context.src = pGrid->getOriginalVertices();
+    context.dst = pGrid->getVertices();
+    context.columnSize = m_sGridSize.height + 1;
+    // angle per grid unit of distance from the center
+    context.amplitude = cosf((float)M_PI/2.0f + time * (float)M_PI * m_nTwirls * 2) * 0.1f * m_fAmplitude * m_fAmplitudeRate;
+    context.center = m_position;
+    context.gridSize = m_sGridSize;
+
+    ccGridParallelFor(m_sGridSize.width + 1, context.columnSize, twirlColumns, &context);
 }
 
 NS_CC_END
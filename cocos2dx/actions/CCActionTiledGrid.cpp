@@ -27,11 +27,53 @@ THE SOFTWARE.
 #include "ccMacros.h"
 #include "support/CCPointExtension.h"
 #include "effects/CCGrid.h"
+#include "effects/ccGridKernels.h"
 #include "cocoa/CCZone.h"
 #include <stdlib.h>
 
 NS_CC_BEGIN
 
+// tiles processed per ccSinArray call
+#define CC_TILE_CHUNK 128
+
+struct TileKernelContext
+{
+    const ccQuad3*  src;            // original tiles
+    ccQuad3*        dst;            // tiles
+    unsigned int    columnSize;     // tiles per column, gridSize.height
+    float           phase;          // time * M_PI * waves * 2
+    float           amplitude;      // amplitude * amplitudeRate
+};
+
+static void wavesTiles3DColumns(void* data, unsigned int begin, unsigned int end)
+{
+    TileKernelContext* c = (TileKernelContext*)data;
+    float sines[CC_TILE_CHUNK];
+
+    for (unsigned int first = begin * c->columnSize, last = end * c->columnSize; first < last; first += CC_TILE_CHUNK)
+    {
+        unsigned int n = MIN(CC_TILE_CHUNK, last - first);
+        const ccQuad3* src = c->src + first;
+        ccQuad3* dst = c->dst + first;
+
+        for (unsigned int k = 0; k < n; ++k)
+        {
+            sines[k] = c->phase + (src[k].bl.y + src[k].bl.x) * .01f;
+        }
+        ccSinArray(sines, sines, n);
+        for (unsigned int k = 0; k < n; ++k)
+        {
+            // the whole tile moves along z
+            float z = sines[k] * c->amplitude;
+            dst[k] = src[k];
+            dst[k].bl.z = z;
+            dst[k].br.z = z;
+            dst[k].tl.z = z;
+            dst[k].tr.z = z;
+        }
+    }
+}
+
 struct Tile
 {
     CCPoint    position;
@@ -99,36 +141,37 @@ CCObject* CCShakyTiles3D::copyWithZone(CCZone *pZone)
 void CCShakyTiles3D::update(float time)
 {
     CC_UNUSED_PARAM(time);
-    int i, j;
+    CCTiledGrid3D* pGrid = (CCTiledGrid3D*)m_pTarget->getGrid();
+    const ccQuad3* src = pGrid->getOriginalTiles();
+    ccQuad3* dst = pGrid->getTiles();
+    unsigned int count = m_sGridSize.width * m_sGridSize.height;
 
-    for (i = 0; i < m_sGridSize.width; ++i)
+    // rand() isn't thread safe, and keeps the sequence of the column by column loop this way
+    for (unsigned int k = 0; k < count; ++k)
     {
-        for (j = 0; j < m_sGridSize.height; ++j)
-        {
-            ccQuad3 coords = originalTile(ccp(i, j));
+        ccQuad3 coords = src[k];
 
-            // X
-            coords.bl.x += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
-            coords.br.x += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
-            coords.tl.x += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
-            coords.tr.x += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
+        // X
+        coords.bl.x += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
+        coords.br.x += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
+        coords.tl.x += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
+        coords.tr.x += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
 
-            // Y
-            coords.bl.y += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
-            coords.br.y += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
-            coords.tl.y += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
-            coords.tr.y += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
+        // Y
+        coords.bl.y += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
+        coords.br.y += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
+        coords.tl.y += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
+        coords.tr.y += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
 
-            if (m_bShakeZ)
-            {
-                coords.bl.z += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
-                coords.br.z += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
-                coords.tl.z += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
-                coords.tr.z += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
-            }
-                        
-            setTile(ccp(i, j), coords);
+        if (m_bShakeZ)
+        {
+            coords.bl.z += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
+            coords.br.z += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
+            coords.tl.z += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
+            coords.tr.z += ( rand() % (m_nRandrange*2) ) - m_nRandrange;
         }
+
+        dst[k] = coords;
     }
 }
 
@@ -796,23 +839,17 @@ CCObject* CCWavesTiles3D::copyWithZone(CCZone *pZone)
 
 void CCWavesTiles3D::update(float time)
 {
-    int i, j;
+    CCTiledGrid3D* pGrid = (CCTiledGrid3D*)m_pTarget->getGrid();
 
-    for( i = 0; i < m_sGridSize.width; i++ )
-    {
-        for( j = 0; j < m_sGridSize.height; j++ )
-        {
-            ccQuad3 coords = originalTile(ccp(i, j));
+    TileKernelContext context;
+    context.src = pGrid->getOriginalTiles();
+    context.dst = pGrid->getTiles();
+    context.columnSize = m_sGridSize.height;
+    context.phase = time * (float)M_PI * m_nWaves * 2;
+    context.amplitude = m_fAmplitude * m_fAmplitudeRate;
 
-            coords.bl.z = (sinf(time * (float)M_PI  *m_nWaves * 2 + 
-                (coords.bl.y+coords.bl.x) * .01f) * m_fAmplitude * m_fAmplitudeRate );
-            coords.br.z    = coords.bl.z;
-            coords.tl.z = coords.bl.z;
-            coords.tr.z = coords.bl.z;
-
-            setTile(ccp(i, j), coords);
-        }
-    }
+    // a tile costs about 4 vertices
+    ccGridParallelFor(m_sGridSize.width, context.columnSize * 4, wavesTiles3DColumns, &context);
 }
 
 // implementation of CCJumpTiles3D
@@ -873,33 +910,27 @@ CCObject* CCJumpTiles3D::copyWithZone(CCZone *pZone)
 
 void CCJumpTiles3D::update(float time)
 {
-    int i, j;
-
     float sinz =  (sinf((float)M_PI * time * m_nJumps * 2) * m_fAmplitude * m_fAmplitudeRate );
     float sinz2 = (sinf((float)M_PI * (time * m_nJumps * 2 + 1)) * m_fAmplitude * m_fAmplitudeRate );
 
-    for( i = 0; i < m_sGridSize.width; i++ )
+    CCTiledGrid3D* pGrid = (CCTiledGrid3D*)m_pTarget->getGrid();
+    const ccQuad3* src = pGrid->getOriginalTiles();
+    ccQuad3* dst = pGrid->getTiles();
+    unsigned int width = m_sGridSize.width, height = m_sGridSize.height;
+
+    for (unsigned int i = 0; i < width; ++i)
     {
-        for( j = 0; j < m_sGridSize.height; j++ )
+        for (unsigned int j = 0; j < height; ++j)
         {
-            ccQuad3 coords = originalTile(ccp(i, j));
+            ccQuad3 coords = *src++;
+            float z = ((i+j) % 2) == 0 ? sinz : sinz2;
 
-            if ( ((i+j) % 2) == 0 )
-            {
-                coords.bl.z += sinz;
-                coords.br.z += sinz;
-                coords.tl.z += sinz;
-                coords.tr.z += sinz;
-            }
-            else
-            {
-                coords.bl.z += sinz2;
-                coords.br.z += sinz2;
-                coords.tl.z += sinz2;
-                coords.tr.z += sinz2;
-            }
+            coords.bl.z += z;
+            coords.br.z += z;
+            coords.tl.z += z;
+            coords.tr.z += z;
 
-            setTile(ccp(i, j), coords);
+            *dst++ = coords;
         }
     }
 }
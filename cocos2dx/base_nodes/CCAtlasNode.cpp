@@ -204,6 +204,7 @@ ccBlendFunc CCAtlasNode::getBlendFunc()
 void CCAtlasNode::setBlendFunc(ccBlendFunc blendFunc)
 {
     m_tBlendFunc = blendFunc;
+    invalidateRenderCache();
 }
 
 void CCAtlasNode::updateBlendFunc()
@@ -219,6 +220,7 @@ void CCAtlasNode::setTexture(CCTexture2D *texture)
     m_pTextureAtlas->setTexture(texture);
     this->updateBlendFunc();
     this->updateOpacityModifyRGB();
+    invalidateRenderCache();
 }
 
 CCTexture2D * CCAtlasNode::getTexture()
@@ -246,6 +248,7 @@ unsigned int CCAtlasNode::getQuadsToDraw()
 void CCAtlasNode::setQuadsToDraw(unsigned int uQuadsToDraw)
 {
     m_uQuadsToDraw = uQuadsToDraw;
+    invalidateRenderCache();
 }
 
 NS_CC_END
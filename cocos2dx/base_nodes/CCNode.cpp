@@ -36,6 +36,8 @@ THE SOFTWARE.
 #include "actions/CCActionManager.h"
 #include "script_support/CCScriptSupport.h"
 #include "shaders/CCGLProgram.h"
+#include "support/data_support/uthash.h"
+#include "misc_nodes/CCRenderCacheNode.h"
 // externals
 #include "kazmath/GL/matrix.h"
 
@@ -51,6 +53,23 @@ NS_CC_BEGIN
 // XXX: Yes, nodes might have a sort problem once every 15 days if the game runs at 60 FPS and each frame sprites are reordered.
 static int s_globalOrderOfArrival = 1;
 
+static bool s_bCullingEnabled = false;
+// > 0 while visiting nodes under an active grid
+static unsigned int s_uCullingSuspended = 0;
+
+// children that moved more than this since their positions were cached are looked up
+// by re-caching every position instead of scanning back from the cached one
+#define CC_CHILD_INDEX_MAX_DRIFT 32
+
+// Hash element used by the children tag index
+typedef struct _ccChildTagEntry
+{
+    int             tag;
+    CCNode          *node;      // the child with this tag if count is 1, NULL if unknown
+    unsigned int    count;      // number of children with this tag
+    UT_hash_handle  hh;
+} tChildTagEntry;
+
 CCNode::CCNode(void)
 : m_fRotationX(0.0f)
 , m_fRotationY(0.0f)
@@ -63,6 +82,7 @@ CCNode::CCNode(void)
 , m_obAnchorPointInPoints(CCPointZero)
 , m_obAnchorPoint(CCPointZero)
 , m_obContentSize(CCSizeZero)
+, m_obCullingBounds(CCRectZero)
 , m_sAdditionalTransform(CCAffineTransformMakeIdentity())
 , m_pCamera(NULL)
 // children (lazy allocs)
@@ -86,6 +106,11 @@ CCNode::CCNode(void)
 , m_bVisible(true)
 , m_bIgnoreAnchorPointForPosition(false)
 , m_bReorderChildDirty(false)
+, m_bChildTagIndexEnabled(false)
+, m_pChildTagIndex(NULL)
+, m_uIndexInParent(0)
+, m_uChildRemovalsSinceIndex(0)
+, m_pRenderCache(NULL)
 , m_nScriptHandler(0)
 , m_nUpdateScriptHandler(0)
 {
@@ -133,6 +158,7 @@ CCNode::~CCNode(void)
     }
 
     // children
+    clearTagIndex();
     CC_SAFE_RELEASE(m_pChildren);
 }
 
@@ -150,6 +176,7 @@ void CCNode::setSkewX(float newSkewX)
 {
     m_fSkewX = newSkewX;
     m_bTransformDirty = m_bInverseDirty = true;
+    invalidateRenderCache();
 }
 
 float CCNode::getSkewY()
@@ -162,6 +189,7 @@ void CCNode::setSkewY(float newSkewY)
     m_fSkewY = newSkewY;
 
     m_bTransformDirty = m_bInverseDirty = true;
+    invalidateRenderCache();
 }
 
 /// zOrder getter
@@ -197,6 +225,7 @@ float CCNode::getVertexZ()
 void CCNode::setVertexZ(float var)
 {
     m_fVertexZ = var;
+    invalidateRenderCache();
 }
 
 
@@ -212,6 +241,7 @@ void CCNode::setRotation(float newRotation)
 {
     m_fRotationX = m_fRotationY = newRotation;
     m_bTransformDirty = m_bInverseDirty = true;
+    invalidateRenderCache();
 }
 
 float CCNode::getRotationX()
@@ -223,6 +253,7 @@ void CCNode::setRotationX(float fRotationX)
 {
     m_fRotationX = fRotationX;
     m_bTransformDirty = m_bInverseDirty = true;
+    invalidateRenderCache();
 }
 
 float CCNode::getRotationY()
@@ -234,6 +265,7 @@ void CCNode::setRotationY(float fRotationY)
 {
     m_fRotationY = fRotationY;
     m_bTransformDirty = m_bInverseDirty = true;
+    invalidateRenderCache();
 }
 
 /// scale getter
@@ -248,6 +280,7 @@ void CCNode::setScale(float scale)
 {
     m_fScaleX = m_fScaleY = scale;
     m_bTransformDirty = m_bInverseDirty = true;
+    invalidateRenderCache();
 }
 
 /// scaleX getter
@@ -261,6 +294,7 @@ void CCNode::setScaleX(float newScaleX)
 {
     m_fScaleX = newScaleX;
     m_bTransformDirty = m_bInverseDirty = true;
+    invalidateRenderCache();
 }
 
 /// scaleY getter
@@ -274,6 +308,7 @@ void CCNode::setScaleY(float newScaleY)
 {
     m_fScaleY = newScaleY;
     m_bTransformDirty = m_bInverseDirty = true;
+    invalidateRenderCache();
 }
 
 /// position getter
@@ -287,6 +322,7 @@ void CCNode::setPosition(const CCPoint& newPosition)
 {
     m_obPosition = newPosition;
     m_bTransformDirty = m_bInverseDirty = true;
+    invalidateRenderCache();
 }
 
 void CCNode::getPosition(float* x, float* y)
@@ -355,6 +391,7 @@ void CCNode::setGrid(CCGridBase* pGrid)
     CC_SAFE_RETAIN(pGrid);
     CC_SAFE_RELEASE(m_pGrid);
     m_pGrid = pGrid;
+    invalidateRenderCache();
 }
 
 
@@ -367,7 +404,11 @@ bool CCNode::isVisible()
 /// isVisible setter
 void CCNode::setVisible(bool var)
 {
-    m_bVisible = var;
+    if (var != m_bVisible)
+    {
+        m_bVisible = var;
+        invalidateRenderCache();
+    }
 }
 
 const CCPoint& CCNode::getAnchorPointInPoints()
@@ -388,6 +429,7 @@ void CCNode::setAnchorPoint(const CCPoint& point)
         m_obAnchorPoint = point;
         m_obAnchorPointInPoints = ccp(m_obContentSize.width * m_obAnchorPoint.x, m_obContentSize.height * m_obAnchorPoint.y );
         m_bTransformDirty = m_bInverseDirty = true;
+        invalidateRenderCache();
     }
 }
 
@@ -405,6 +447,7 @@ void CCNode::setContentSize(const CCSize & size)
 
         m_obAnchorPointInPoints = ccp(m_obContentSize.width * m_obAnchorPoint.x, m_obContentSize.height * m_obAnchorPoint.y );
         m_bTransformDirty = m_bInverseDirty = true;
+        invalidateRenderCache();
     }
 }
 
@@ -437,6 +480,7 @@ void CCNode::ignoreAnchorPointForPosition(bool newValue)
     {
 		m_bIgnoreAnchorPointForPosition = newValue;
 		m_bTransformDirty = m_bInverseDirty = true;
+		invalidateRenderCache();
 	}
 }
 
@@ -449,7 +493,16 @@ int CCNode::getTag()
 /// tag setter
 void CCNode::setTag(int var)
 {
-    m_nTag = var;
+    if (m_pParent && m_pParent->m_bChildTagIndexEnabled && var != m_nTag)
+    {
+        m_pParent->removeFromTagIndex(this);
+        m_nTag = var;
+        m_pParent->addToTagIndex(this);
+    }
+    else
+    {
+        m_nTag = var;
+    }
 }
 
 /// userData getter
@@ -506,6 +559,7 @@ void CCNode::setShaderProgram(CCGLProgram *pShaderProgram)
     CC_SAFE_RELEASE(m_pShaderProgram);
     m_pShaderProgram = pShaderProgram;
     CC_SAFE_RETAIN(m_pShaderProgram);
+    invalidateRenderCache();
 }
 
 CCRect CCNode::boundingBox()
@@ -514,6 +568,86 @@ CCRect CCNode::boundingBox()
     return CCRectApplyAffineTransform(rect, nodeToParentTransform());
 }
 
+void CCNode::setCullingEnabled(bool bEnabled)
+{
+    s_bCullingEnabled = bEnabled;
+}
+
+bool CCNode::isCullingEnabled()
+{
+    return s_bCullingEnabled;
+}
+
+void CCNode::setCullingBounds(const CCRect& bounds)
+{
+    m_obCullingBounds = bounds;
+}
+
+const CCRect& CCNode::getCullingBounds()
+{
+    return m_obCullingBounds;
+}
+
+bool CCNode::isCullingActive()
+{
+    return s_bCullingEnabled && s_uCullingSuspended == 0;
+}
+
+void CCNode::suspendCulling(bool bSuspend)
+{
+    if (bSuspend)
+    {
+        ++s_uCullingSuspended;
+    }
+    else
+    {
+        CCAssert(s_uCullingSuspended > 0, "Unbalanced culling suspension");
+        --s_uCullingSuspended;
+    }
+}
+
+void CCNode::currentModelViewProjection(kmMat4* pOut)
+{
+    kmMat4 matrixP;
+    kmMat4 matrixMV;
+    kmGLGetMatrix(KM_GL_PROJECTION, &matrixP);
+    kmGLGetMatrix(KM_GL_MODELVIEW, &matrixMV);
+    kmMat4Multiply(pOut, &matrixP, &matrixMV);
+}
+
+// bit set for each clip plane the point is outside of
+static inline unsigned int clipOutcode(const kmScalar* m, const ccVertex3F& v)
+{
+    float x = m[0] * v.x + m[4] * v.y + m[8] * v.z + m[12];
+    float y = m[1] * v.x + m[5] * v.y + m[9] * v.z + m[13];
+    float z = m[2] * v.x + m[6] * v.y + m[10] * v.z + m[14];
+    float w = m[3] * v.x + m[7] * v.y + m[11] * v.z + m[15];
+
+    return (x < -w ? 1 : 0) | (x > w ? 2 : 0)
+         | (y < -w ? 4 : 0) | (y > w ? 8 : 0)
+         | (z < -w ? 16 : 0) | (z > w ? 32 : 0);
+}
+
+bool CCNode::isQuadOutsideViewport(const kmMat4& mvp, const ccVertex3F& a, const ccVertex3F& b, const ccVertex3F& c, const ccVertex3F& d)
+{
+    // the clip planes are linear in homogeneous coordinates: when all the corners are outside
+    // of the same plane, so is the whole quad, whatever the projection
+    return (clipOutcode(mvp.mat, a) & clipOutcode(mvp.mat, b) & clipOutcode(mvp.mat, c) & clipOutcode(mvp.mat, d)) != 0;
+}
+
+bool CCNode::isRectOutsideViewport(const kmMat4& mvp, const CCRect& rect)
+{
+    float x0 = rect.origin.x;
+    float y0 = rect.origin.y;
+    float x1 = x0 + rect.size.width;
+    float y1 = y0 + rect.size.height;
+    ccVertex3F a = { x0, y0, 0 };
+    ccVertex3F b = { x1, y0, 0 };
+    ccVertex3F c = { x0, y1, 0 };
+    ccVertex3F d = { x1, y1, 0 };
+    return isQuadOutsideViewport(mvp, a, b, c, d);
+}
+
 CCNode * CCNode::create(void)
 {
 	CCNode * pRet = new CCNode();
@@ -528,6 +662,19 @@ CCNode * CCNode::create(void)
 	return pRet;
 }
 
+void CCNode::invalidateRenderCache()
+{
+    if (m_pRenderCache)
+    {
+        m_pRenderCache->invalidateCache();
+    }
+}
+
+CCRenderCacheNode* CCNode::getRenderCacheForChildren()
+{
+    return m_pRenderCache;
+}
+
 void CCNode::cleanup()
 {
     // actions
@@ -560,6 +707,22 @@ CCNode* CCNode::getChildByTag(int aTag)
 {
     CCAssert( aTag != kCCNodeTagInvalid, "Invalid tag");
 
+    tChildTagEntry *pEntry = NULL;
+    if (m_bChildTagIndexEnabled)
+    {
+        HASH_FIND_INT(m_pChildTagIndex, &aTag, pEntry);
+        if (pEntry == NULL)
+        {
+            return NULL;
+        }
+        if (pEntry->count == 1 && pEntry->node)
+        {
+            return pEntry->node;
+        }
+        // several children share the tag: the first one in the array wins, as without the index
+    }
+
+    CCNode* pFound = NULL;
     if(m_pChildren && m_pChildren->count() > 0)
     {
         CCObject* child;
@@ -567,10 +730,141 @@ CCNode* CCNode::getChildByTag(int aTag)
         {
             CCNode* pNode = (CCNode*) child;
             if(pNode && pNode->m_nTag == aTag)
-                return pNode;
+            {
+                pFound = pNode;
+                break;
+            }
+        }
+    }
+
+    if (pEntry && pEntry->count == 1)
+    {
+        pEntry->node = pFound;
+    }
+    return pFound;
+}
+
+void CCNode::setChildTagIndexEnabled(bool bEnabled)
+{
+    if (bEnabled == m_bChildTagIndexEnabled)
+    {
+        return;
+    }
+
+    clearTagIndex();
+    m_bChildTagIndexEnabled = bEnabled;
+
+    if (bEnabled && m_pChildren)
+    {
+        CCObject* child;
+        CCARRAY_FOREACH(m_pChildren, child)
+        {
+            addToTagIndex((CCNode*) child);
         }
     }
-    return NULL;
+}
+
+bool CCNode::isChildTagIndexEnabled()
+{
+    return m_bChildTagIndexEnabled;
+}
+
+void CCNode::addToTagIndex(CCNode *child)
+{
+    int tag = child->m_nTag;
+    if (tag == kCCNodeTagInvalid)
+    {
+        return;
+    }
+
+    tChildTagEntry *pEntry = NULL;
+    HASH_FIND_INT(m_pChildTagIndex, &tag, pEntry);
+    if (pEntry == NULL)
+    {
+        pEntry = (tChildTagEntry *)calloc(sizeof(*pEntry), 1);
+        pEntry->tag = tag;
+        HASH_ADD_INT(m_pChildTagIndex, tag, pEntry);
+    }
+
+    if (pEntry->count++ == 0)
+    {
+        pEntry->node = child;
+    }
+}
+
+void CCNode::removeFromTagIndex(CCNode *child)
+{
+    int tag = child->m_nTag;
+    tChildTagEntry *pEntry = NULL;
+    HASH_FIND_INT(m_pChildTagIndex, &tag, pEntry);
+    if (pEntry == NULL)
+    {
+        return;
+    }
+
+    if (--pEntry->count == 0)
+    {
+        HASH_DEL(m_pChildTagIndex, pEntry);
+        free(pEntry);
+    }
+    else if (pEntry->node == child)
+    {
+        // found again by getChildByTag once the tag is unique
+        pEntry->node = NULL;
+    }
+}
+
+void CCNode::clearTagIndex()
+{
+    tChildTagEntry *pEntry, *pTmp;
+    HASH_ITER(hh, m_pChildTagIndex, pEntry, pTmp)
+    {
+        HASH_DEL(m_pChildTagIndex, pEntry);
+        free(pEntry);
+    }
+}
+
+unsigned int CCNode::indexOfChild(CCNode *child)
+{
+    ccArray *arr = m_pChildren->data;
+    if (arr->num == 0)
+    {
+        return CC_INVALID_INDEX;
+    }
+
+    // Between two updateChildIndexes() children are only appended or removed,
+    // so a child moved down by at most one slot per removal.
+    if (m_uChildRemovalsSinceIndex <= CC_CHILD_INDEX_MAX_DRIFT)
+    {
+        unsigned int i = MIN(child->m_uIndexInParent, arr->num - 1);
+        unsigned int low = i > m_uChildRemovalsSinceIndex ? i - m_uChildRemovalsSinceIndex : 0;
+        for (;; --i)
+        {
+            if (arr->arr[i] == child)
+            {
+                return i;
+            }
+            if (i == low)
+            {
+                break;
+            }
+        }
+    }
+
+    // the array was reordered or edited directly
+    updateChildIndexes();
+    unsigned int index = child->m_uIndexInParent;
+    return (index < arr->num && arr->arr[index] == child) ? index : CC_INVALID_INDEX;
+}
+
+void CCNode::updateChildIndexes()
+{
+    ccArray *arr = m_pChildren->data;
+    for (unsigned int i = 0; i < arr->num; i++)
+    {
+        ((CCNode*)arr->arr[i])->m_uIndexInParent = i;
+    }
+    m_uChildRemovalsSinceIndex = 0;
 }
 
 /* "add" logic MUST only be on this method
@@ -590,6 +884,10 @@ void CCNode::addChild(CCNode *child, int zOrder, int tag)
     this->insertChild(child, zOrder);
 
     child->m_nTag = tag;
+    if (m_bChildTagIndexEnabled)
+    {
+        addToTagIndex(child);
+    }
 
     child->setParent(this);
     child->setOrderOfArrival(s_globalOrderOfArrival++);
@@ -598,6 +896,7 @@ void CCNode::addChild(CCNode *child, int zOrder, int tag)
     {
         child->onEnter();
         child->onEnterTransitionDidFinish();
+        child->invalidateRenderCache();
     }
 }
 
@@ -643,9 +942,10 @@ void CCNode::removeChild(CCNode* child, bool cleanup)
         return;
     }
 
-    if ( m_pChildren->containsObject(child) )
+    unsigned int index = child ? indexOfChild(child) : CC_INVALID_INDEX;
+    if ( index != CC_INVALID_INDEX )
     {
-        this->detachChild(child,cleanup);
+        this->detachChild(child, index, cleanup);
     }
 }
 
@@ -691,6 +991,7 @@ void CCNode::removeAllChildrenWithCleanup(bool cleanup)
                 //  -2nd cleanup
                 if(m_bRunning)
                 {
+                    pNode->invalidateRenderCache();
                     pNode->onExitTransitionDidStart();
                     pNode->onExit();
                 }
@@ -705,17 +1006,21 @@ void CCNode::removeAllChildrenWithCleanup(bool cleanup)
         }
         
         m_pChildren->removeAllObjects();
+        m_uChildRemovalsSinceIndex = 0;
     }
-    
+
+    clearTagIndex();
+
 }
 
-void CCNode::detachChild(CCNode *child, bool doCleanup)
+void CCNode::detachChild(CCNode *child, unsigned int childIndex, bool doCleanup)
 {
     // IMPORTANT:
     //  -1st do onExit
     //  -2nd cleanup
     if (m_bRunning)
     {
+        child->invalidateRenderCache();
         child->onExitTransitionDidStart();
         child->onExit();
     }
@@ -727,10 +1032,24 @@ void CCNode::detachChild(CCNode *child, bool doCleanup)
         child->cleanup();
     }
 
+    if (m_bChildTagIndexEnabled)
+    {
+        removeFromTagIndex(child);
+    }
+
     // set parent nil at the end
     child->setParent(NULL);
 
-    m_pChildren->removeObject(child);
+    // onExit() or cleanup() may have changed the siblings
+    if (childIndex >= m_pChildren->count() || m_pChildren->data->arr[childIndex] != child)
+    {
+        childIndex = indexOfChild(child);
+    }
+    if (childIndex != CC_INVALID_INDEX)
+    {
+        m_pChildren->removeObjectAtIndex(childIndex);
+        m_uChildRemovalsSinceIndex++;
+    }
 }
 
 
@@ -739,6 +1058,7 @@ void CCNode::insertChild(CCNode* child, int z)
 {
     m_bReorderChildDirty = true;
     ccArrayAppendObjectWithResize(m_pChildren->data, child);
+    child->m_uIndexInParent = m_pChildren->data->num - 1;
     child->_setZOrder(z);
 }
 
@@ -748,6 +1068,7 @@ void CCNode::reorderChild(CCNode *child, int zOrder)
     m_bReorderChildDirty = true;
     child->setOrderOfArrival(s_globalOrderOfArrival++);
     child->_setZOrder(zOrder);
+    child->invalidateRenderCache();
 }
 
 void CCNode::sortAllChildren()
@@ -773,6 +1094,8 @@ void CCNode::sortAllChildren()
             x[j+1] = tempItem;
         }
 
+        updateChildIndexes();
+
         //don't need to check children recursively, that's done in visit of each child
 
         m_bReorderChildDirty = false;
@@ -797,17 +1120,44 @@ void CCNode::visit()
     }
     kmGLPushMatrix();
 
-     if (m_pGrid && m_pGrid->isActive())
+    bool bGridActive = m_pGrid && m_pGrid->isActive();
+     if (bGridActive)
      {
          m_pGrid->beforeDraw();
+         suspendCulling(true);
      }
 
     this->transform();
 
+    bool bVisitChildren = true;
+    bool bDrawSelf = true;
+    if (isCullingActive())
+    {
+        kmMat4 mvp;
+        currentModelViewProjection(&mvp);
+
+        if (m_obCullingBounds.size.width > 0 && m_obCullingBounds.size.height > 0
+            && isRectOutsideViewport(mvp, m_obCullingBounds))
+        {
+            bVisitChildren = false;
+            bDrawSelf = false;
+        }
+        else if (m_obContentSize.width > 0 && m_obContentSize.height > 0
+            && isRectOutsideViewport(mvp, CCRectMake(0, 0, m_obContentSize.width, m_obContentSize.height)))
+        {
+            bDrawSelf = false;
+        }
+
+        if (!bDrawSelf)
+        {
+            CC_INCREMENT_CULLED_NODES(1);
+        }
+    }
+
     CCNode* pNode = NULL;
     unsigned int i = 0;
 
-    if(m_pChildren && m_pChildren->count() > 0)
+    if(bVisitChildren && m_pChildren && m_pChildren->count() > 0)
     {
         sortAllChildren();
         // draw children zOrder < 0
@@ -826,7 +1176,10 @@ void CCNode::visit()
             }
         }
         // self draw
-        this->draw();
+        if (bDrawSelf)
+        {
+            this->draw();
+        }
 
         for( ; i < arrayData->num; i++ )
         {
@@ -837,7 +1190,7 @@ void CCNode::visit()
             }
         }        
     }
-    else
+    else if (bDrawSelf)
     {
         this->draw();
     }
@@ -845,8 +1198,9 @@ void CCNode::visit()
     // reset for next frame
     m_uOrderOfArrival = 0;
 
-     if (m_pGrid && m_pGrid->isActive())
+     if (bGridActive)
      {
+         suspendCulling(false);
          m_pGrid->afterDraw(this);
     }
  
@@ -895,6 +1249,9 @@ void CCNode::transform()
 
 void CCNode::onEnter()
 {
+    // before the children, which look for their cache in this node
+    m_pRenderCache = m_pParent ? m_pParent->getRenderCacheForChildren() : NULL;
+
     arrayMakeObjectsPerformSelector(m_pChildren, onEnter, CCNode*);
 
     this->resumeSchedulerAndActions();
@@ -939,6 +1296,8 @@ void CCNode::onExit()
     }
 
     arrayMakeObjectsPerformSelector(m_pChildren, onExit, CCNode*);    
+
+    m_pRenderCache = NULL;
 }
 
 void CCNode::registerScriptHandler(int nHandler)
@@ -1190,6 +1549,7 @@ void CCNode::setAdditionalTransform(const CCAffineTransform& additionalTransform
     m_sAdditionalTransform = additionalTransform;
     m_bTransformDirty = true;
     m_bAdditionalTransformDirty = true;
+    invalidateRenderCache();
 }
 
 CCAffineTransform CCNode::parentToNodeTransform(void)
@@ -1302,6 +1662,7 @@ GLubyte CCNodeRGBA::getDisplayedOpacity(void)
 void CCNodeRGBA::setOpacity(GLubyte opacity)
 {
     _displayedOpacity = _realOpacity = opacity;
+    invalidateRenderCache();
     
 	if (_cascadeOpacityEnabled)
     {
@@ -1318,6 +1679,7 @@ void CCNodeRGBA::setOpacity(GLubyte opacity)
 void CCNodeRGBA::updateDisplayedOpacity(GLubyte parentOpacity)
 {
 	_displayedOpacity = _realOpacity * parentOpacity/255.0;
+    invalidateRenderCache();
 	
     if (_cascadeOpacityEnabled)
     {
@@ -1356,6 +1718,7 @@ const ccColor3B& CCNodeRGBA::getDisplayedColor()
 void CCNodeRGBA::setColor(const ccColor3B& color)
 {
 	_displayedColor = _realColor = color;
+    invalidateRenderCache();
 	
 	if (_cascadeColorEnabled)
     {
@@ -1375,6 +1738,7 @@ void CCNodeRGBA::updateDisplayedColor(const ccColor3B& parentColor)
 	_displayedColor.r = _realColor.r * parentColor.r/255.0;
 	_displayedColor.g = _realColor.g * parentColor.g/255.0;
 	_displayedColor.b = _realColor.b * parentColor.b/255.0;
+    invalidateRenderCache();
     
     if (_cascadeColorEnabled)
     {
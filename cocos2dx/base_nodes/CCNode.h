@@ -49,6 +49,8 @@ class CCRGBAProtocol;
 class CCLabelProtocol;
 class CCScheduler;
 class CCActionManager;
+class CCRenderCacheNode;
+struct _ccChildTagEntry;
 
 /**
  * @addtogroup base_nodes
@@ -585,6 +587,24 @@ public:
      * @return a CCNode object whose tag equals to the input parameter
      */
     CCNode * getChildByTag(int tag);
+    /**
+     * Enables a hash index of the children by tag, which turns getChildByTag into a
+     * constant time lookup for nodes with many children. Disabled by default.
+     *
+     * The index is kept up to date by addChild, removeChild and setTag. Subclasses that
+     * insert into the children array directly bypass it and should leave it disabled.
+     *
+     * @param bEnabled  true to build the index from the current children, false to drop it
+     * @since v2.1.4
+     */
+    void setChildTagIndexEnabled(bool bEnabled);
+    /**
+     * Returns whether the children are indexed by tag
+     *
+     * @return true if getChildByTag uses the tag index
+     * @since v2.1.4
+     */
+    bool isChildTagIndexEnabled();
     /**
      * Return an array of children
      *
@@ -971,6 +991,53 @@ public:
      */
     CCRect boundingBox(void);
 
+    /// @{
+    /// @name Culling
+
+    /**
+     * Enables or disables viewport culling for all the nodes. Disabled by default.
+     *
+     * When enabled, visit() skips draw() for the nodes whose content box, (0, 0, contentSize) in their
+     * own coordinates, is entirely outside the viewport; their children are still visited.
+     * Nodes with an empty content size are never culled, so override draw() carefully when you draw
+     * outside of the content box of a node with a size. CCSpriteBatchNode only draws its visible sprites.
+     * The test is done in clip space with the current matrices, so it works with any projection,
+     * camera and render texture. Nodes under an active grid effect are never culled.
+     * The culled nodes of a frame are displayed next to the draw calls in the director stats.
+     *
+     * @since v2.1.4
+     */
+    static void setCullingEnabled(bool bEnabled);
+    static bool isCullingEnabled();
+
+    /**
+     * Sets a box, in the node's coordinates, containing everything drawn by the node and all its descendants.
+     * When culling is enabled and the box is outside the viewport, the whole subtree is skipped, children included.
+     * The box is not computed: it is up to you to keep it conservative. A box with an empty size, the default, disables it.
+     *
+     * @since v2.1.4
+     */
+    virtual void setCullingBounds(const CCRect& bounds);
+    virtual const CCRect& getCullingBounds();
+
+    /// @} end of Culling
+
+    /// @{
+    /// @name Render cache
+
+    /**
+     * Tells the CCRenderCacheNode containing this node, if any, that its cached rendering is stale.
+     *
+     * The setters changing how a node is drawn (transform, visibility, color, opacity, texture,
+     * children...) already call it. Call it after changing the look of a node in other ways,
+     * e.g. when editing a CCTextureAtlas or a camera directly.
+     *
+     * @since v2.1.4
+     */
+    void invalidateRenderCache();
+
+    /// @} end of Render cache
+
     /// @{
     /// @name Actions
 
@@ -1308,12 +1375,38 @@ private:
     void insertChild(CCNode* child, int z);
     
     /// Removes a child, call child->onExit(), do cleanup, remove it from children array.
-    void detachChild(CCNode *child, bool doCleanup);
+    void detachChild(CCNode *child, unsigned int childIndex, bool doCleanup);
+    
+    /// Returns the position of a child in the children array, or CC_INVALID_INDEX.
+    /// Uses the position cached in the child when it is still valid.
+    unsigned int indexOfChild(CCNode *child);
+    
+    /// Caches the position of every child in the children array
+    void updateChildIndexes();
+    
+    /// tag index helpers
+    void addToTagIndex(CCNode *child);
+    void removeFromTagIndex(CCNode *child);
+    void clearTagIndex();
     
     /// Convert cocos2d coordinates to UI windows coordinate.
     CCPoint convertToWindowSpace(const CCPoint& nodePoint);
 
 protected:
+    /// true when culling is enabled and not suspended by a grid effect
+    static bool isCullingActive();
+    /// suspends culling while visiting the children of a node with a grid effect, which moves vertices around
+    static void suspendCulling(bool bSuspend);
+    /// current projection * modelview matrix
+    static void currentModelViewProjection(kmMat4* pOut);
+    /// true when the quad a-b-c-d, transformed by mvp, is entirely outside one of the clip planes
+    static bool isQuadOutsideViewport(const kmMat4& mvp, const ccVertex3F& a, const ccVertex3F& b, const ccVertex3F& c, const ccVertex3F& d);
+    /// same for a rect in the current coordinates
+    static bool isRectOutsideViewport(const kmMat4& mvp, const CCRect& rect);
+
+    /// the CCRenderCacheNode that caches the children of this node, NULL if none
+    virtual CCRenderCacheNode* getRenderCacheForChildren();
+
     float m_fRotationX;                 ///< rotation angle on x-axis
     float m_fRotationY;                 ///< rotation angle on y-axis
     
@@ -1332,6 +1425,8 @@ protected:
     
     CCSize m_obContentSize;             ///< untransformed size of the node
     
+    CCRect m_obCullingBounds;           ///< conservative bounds of the subtree, for culling
+    
     
     CCAffineTransform m_sAdditionalTransform; ///< transform
     CCAffineTransform m_sTransform;     ///< transform
@@ -1373,6 +1468,13 @@ protected:
     
     bool m_bReorderChildDirty;          ///< children order dirty flag
     
+    bool m_bChildTagIndexEnabled;       ///< true if the children are indexed by tag
+    struct _ccChildTagEntry *m_pChildTagIndex; ///< hash of the children by tag, see setChildTagIndexEnabled
+    unsigned int m_uIndexInParent;      ///< position in the parent's children array when it was last cached; verified before use
+    unsigned int m_uChildRemovalsSinceIndex; ///< children removed since their positions were cached, i.e. how far they may have moved
+    
+    CCRenderCacheNode *m_pRenderCache;  ///< weak reference to the closest CCRenderCacheNode ancestor, set while running
+    
     int m_nScriptHandler;               ///< script handler for onEnter() & onExit(), used in Javascript binding and Lua binding.
     int m_nUpdateScriptHandler;         ///< script handler for update() callback per frame, which is invoked from lua & javascript.
     ccScriptType m_eScriptType;         ///< type of script binding, lua or javascript
@@ -23,63 +23,107 @@ THE SOFTWARE.
 ****************************************************************************/
 #include "CCAutoreleasePool.h"
 #include "ccMacros.h"
+#include <stdlib.h>
+#include <typeinfo>
+#include <vector>
+#include <algorithm>
+#ifdef __GNUC__
+#include <cxxabi.h>
+#endif
 
 NS_CC_BEGIN
 
 static CCPoolManager* s_pPoolManager = NULL;
 
 CCAutoreleasePool::CCAutoreleasePool(void)
+: m_pFirstChunk(NULL)
+, m_pCurrentChunk(NULL)
+, m_uCurrentChunkCount(0)
+, m_uObjectCount(0)
 {
-    m_pManagedObjectArray = new CCArray();
-    m_pManagedObjectArray->init();
 }
 
 CCAutoreleasePool::~CCAutoreleasePool(void)
 {
-    CC_SAFE_DELETE(m_pManagedObjectArray);
+    while (m_pFirstChunk)
+    {
+        CCAutoreleasePoolChunk* pNext = m_pFirstChunk->next;
+        free(m_pFirstChunk);
+        m_pFirstChunk = pNext;
+    }
 }
 
 void CCAutoreleasePool::addObject(CCObject* pObject)
 {
-    m_pManagedObjectArray->addObject(pObject);
+    if (m_pCurrentChunk == NULL || m_uCurrentChunkCount == kCCAutoreleasePoolChunkSize)
+    {
+        CCAutoreleasePoolChunk* pNext = m_pCurrentChunk ? m_pCurrentChunk->next : m_pFirstChunk;
+        if (pNext == NULL)
+        {
+            pNext = (CCAutoreleasePoolChunk*)malloc(sizeof(CCAutoreleasePoolChunk));
+            CCAssert(pNext, "out of memory");
+            pNext->prev = m_pCurrentChunk;
+            pNext->next = NULL;
+            if (m_pCurrentChunk)
+            {
+                m_pCurrentChunk->next = pNext;
+            }
+            else
+            {
+                m_pFirstChunk = pNext;
+            }
+        }
+        m_pCurrentChunk = pNext;
+        m_uCurrentChunkCount = 0;
+    }
 
-    CCAssert(pObject->m_uReference > 1, "reference count should be greater than 1");
+    // no retain: the pool takes over the reference the caller gives up
+    CCAssert(pObject->m_uReference > 0, "reference count should be greater than 0");
+    m_pCurrentChunk->objects[m_uCurrentChunkCount++] = pObject;
+    ++m_uObjectCount;
     ++(pObject->m_uAutoReleaseCount);
-    pObject->release(); // no ref count, in this case autorelease pool added.
 }
 
 void CCAutoreleasePool::removeObject(CCObject* pObject)
 {
-    for (unsigned int i = 0; i < pObject->m_uAutoReleaseCount; ++i)
+    // the slots are emptied, clear() skips them
+    unsigned int uRemaining = pObject->m_uAutoReleaseCount;
+    for (CCAutoreleasePoolChunk* pChunk = m_pFirstChunk; pChunk && uRemaining > 0; pChunk = pChunk->next)
     {
-        m_pManagedObjectArray->removeObject(pObject, false);
+        unsigned int uCount = (pChunk == m_pCurrentChunk) ? m_uCurrentChunkCount : kCCAutoreleasePoolChunkSize;
+        for (unsigned int i = 0; i < uCount && uRemaining > 0; ++i)
+        {
+            if (pChunk->objects[i] == pObject)
+            {
+                pChunk->objects[i] = NULL;
+                --uRemaining;
+            }
+        }
+        if (pChunk == m_pCurrentChunk)
+        {
+            break;
+        }
     }
 }
 
 void CCAutoreleasePool::clear()
 {
-    if(m_pManagedObjectArray->count() > 0)
+    // most recent first; objects autoreleased by the destructors are released too
+    while (m_uObjectCount > 0)
     {
-        //CCAutoreleasePool* pReleasePool;
-#ifdef _DEBUG
-        int nIndex = m_pManagedObjectArray->count() - 1;
-#endif
-
-        CCObject* pObj = NULL;
-        CCARRAY_FOREACH_REVERSE(m_pManagedObjectArray, pObj)
+        if (m_uCurrentChunkCount == 0)
         {
-            if(!pObj)
-                break;
+            m_pCurrentChunk = m_pCurrentChunk->prev;
+            m_uCurrentChunkCount = kCCAutoreleasePoolChunkSize;
+        }
 
+        CCObject* pObj = m_pCurrentChunk->objects[--m_uCurrentChunkCount];
+        --m_uObjectCount;
+        if (pObj)
+        {
             --(pObj->m_uAutoReleaseCount);
-            //(*it)->release();
-            //delete (*it);
-#ifdef _DEBUG
-            nIndex--;
-#endif
+            pObj->release();
         }
-
-        m_pManagedObjectArray->removeAllObjects();
     }
 }
 
@@ -109,6 +153,12 @@ CCPoolManager::CCPoolManager()
     m_pReleasePoolStack = new CCArray();    
     m_pReleasePoolStack->init();
     m_pCurReleasePool = 0;
+    m_pSparePool = 0;
+    m_uLastFrameObjectCount = 0;
+    m_bStatisticsEnabled = false;
+    m_uStatisticsFrames = 0;
+    m_uStatisticsObjects = 0;
+    m_uStatisticsPeak = 0;
 }
 
 CCPoolManager::~CCPoolManager()
@@ -121,6 +171,7 @@ CCPoolManager::~CCPoolManager()
      m_pReleasePoolStack->removeObjectAtIndex(0);
  
      CC_SAFE_DELETE(m_pReleasePoolStack);
+    CC_SAFE_RELEASE_NULL(m_pSparePool);
 }
 
 void CCPoolManager::finalize()
@@ -141,7 +192,12 @@ void CCPoolManager::finalize()
 
 void CCPoolManager::push()
 {
-    CCAutoreleasePool* pPool = new CCAutoreleasePool();       //ref = 1
+    CCAutoreleasePool* pPool = m_pSparePool;               //ref = 1
+    m_pSparePool = NULL;
+    if (! pPool)
+    {
+        pPool = new CCAutoreleasePool();                    //ref = 1
+    }
     m_pCurReleasePool = pPool;
 
     m_pReleasePoolStack->addObject(pPool);                   //ref = 2
@@ -157,11 +213,17 @@ void CCPoolManager::pop()
     }
 
      int nCount = m_pReleasePoolStack->count();
+    unsigned int uObjectCount = m_pCurReleasePool->getObjectCount();
 
     m_pCurReleasePool->clear();
  
       if(nCount > 1)
       {
+        // keep the pool and its chunks for the next push()
+        CC_SAFE_RELEASE(m_pSparePool);
+        m_pSparePool = m_pCurReleasePool;
+        m_pSparePool->retain();
+
         m_pReleasePoolStack->removeObjectAtIndex(nCount-1);
 
 //         if(nCount > 1)
@@ -171,6 +233,17 @@ void CCPoolManager::pop()
 //         }
         m_pCurReleasePool = (CCAutoreleasePool*)m_pReleasePoolStack->objectAtIndex(nCount - 2);
     }
+    else
+    {
+        // the bottom pool is popped once per frame by CCDirector
+        m_uLastFrameObjectCount = uObjectCount;
+        if (m_bStatisticsEnabled)
+        {
+            ++m_uStatisticsFrames;
+            m_uStatisticsObjects += uObjectCount;
+            m_uStatisticsPeak = MAX(m_uStatisticsPeak, uObjectCount);
+        }
+    }
 
     /*m_pCurReleasePool = NULL;*/
 }
@@ -184,9 +257,63 @@ void CCPoolManager::removeObject(CCObject* pObject)
 
 void CCPoolManager::addObject(CCObject* pObject)
 {
+    if (m_bStatisticsEnabled)
+    {
+        ++m_classCounts[typeid(*pObject).name()];
+    }
     getCurReleasePool()->addObject(pObject);
 }
 
+void CCPoolManager::setStatisticsEnabled(bool bEnabled)
+{
+    if (bEnabled && ! m_bStatisticsEnabled)
+    {
+        resetStatistics();
+    }
+    m_bStatisticsEnabled = bEnabled;
+}
+
+void CCPoolManager::resetStatistics()
+{
+    m_uStatisticsFrames = 0;
+    m_uStatisticsObjects = 0;
+    m_uStatisticsPeak = 0;
+    m_classCounts.clear();
+}
+
+static bool compareClassCounts(const std::pair<const char*, unsigned int>& a, const std::pair<const char*, unsigned int>& b)
+{
+    return a.second > b.second;
+}
+
+void CCPoolManager::dumpStatistics(unsigned int nMaxClasses)
+{
+    CCLOG("cocos2d: CCPoolManager: %u objects autoreleased in the last frame", m_uLastFrameObjectCount);
+    if (! m_bStatisticsEnabled)
+    {
+        CCLOG("cocos2d: CCPoolManager: enable the statistics for more");
+        return;
+    }
+
+    CCLOG("cocos2d: CCPoolManager: %u frames, %.1f objects per frame on average, %u at most",
+          m_uStatisticsFrames, m_uStatisticsFrames ? (float)m_uStatisticsObjects / m_uStatisticsFrames : 0.0f, m_uStatisticsPeak);
+
+    std::vector<std::pair<const char*, unsigned int> > counts(m_classCounts.begin(), m_classCounts.end());
+    std::sort(counts.begin(), counts.end(), compareClassCounts);
+    for (unsigned int i = 0; i < counts.size() && i < nMaxClasses; ++i)
+    {
+        const char* pszName = counts[i].first;
+#ifdef __GNUC__
+        int status = 0;
+        char* pszDemangled = abi::__cxa_demangle(pszName, NULL, NULL, &status);
+        CCLOG("cocos2d: %10u %s", counts[i].second, status == 0 ? pszDemangled : pszName);
+        free(pszDemangled);
+#else
+        CCLOG("cocos2d: %10u %s", counts[i].second, pszName);
+#endif
+    }
+}
+
 
 CCAutoreleasePool* CCPoolManager::getCurReleasePool()
 {
@@ -26,6 +26,7 @@ THE SOFTWARE.
 
 #include "CCObject.h"
 #include "CCArray.h"
+#include <map>
 
 NS_CC_BEGIN
 
@@ -34,9 +35,23 @@ NS_CC_BEGIN
  * @{
  */
 
+// number of objects per chunk of an autorelease pool
+#define kCCAutoreleasePoolChunkSize 1024
+
 class CC_DLL CCAutoreleasePool : public CCObject
 {
-    CCArray*    m_pManagedObjectArray;    
+    // the objects are stored in chunks kept from one clear() to the next:
+    // once a pool has grown to the number of objects of a frame, autorelease() doesn't allocate anymore
+    struct CCAutoreleasePoolChunk
+    {
+        CCObject* objects[kCCAutoreleasePoolChunkSize];
+        CCAutoreleasePoolChunk* prev;
+        CCAutoreleasePoolChunk* next;
+    };
+    CCAutoreleasePoolChunk* m_pFirstChunk;
+    CCAutoreleasePoolChunk* m_pCurrentChunk;    // chunk receiving the next object
+    unsigned int m_uCurrentChunkCount;          // objects in the current chunk
+    unsigned int m_uObjectCount;
 public:
     CCAutoreleasePool(void);
     ~CCAutoreleasePool(void);
@@ -45,12 +60,25 @@ public:
     void removeObject(CCObject *pObject);
 
     void clear();
+
+    /** number of objects waiting to be released */
+    unsigned int getObjectCount() const { return m_uObjectCount; }
 };
 
 class CC_DLL CCPoolManager
 {
     CCArray*    m_pReleasePoolStack;    
     CCAutoreleasePool*                    m_pCurReleasePool;
+    // the last pool popped, reused by the next push()
+    CCAutoreleasePool*                    m_pSparePool;
+
+    unsigned int m_uLastFrameObjectCount;
+    bool m_bStatisticsEnabled;
+    unsigned int m_uStatisticsFrames;
+    unsigned int m_uStatisticsObjects;
+    unsigned int m_uStatisticsPeak;
+    // autorelease() calls per class, keyed by type_info::name()
+    std::map<const char*, unsigned int> m_classCounts;
 
     CCAutoreleasePool* getCurReleasePool();
 public:
@@ -63,6 +91,24 @@ public:
     void removeObject(CCObject* pObject);
     void addObject(CCObject* pObject);
 
+    /** number of objects released by the last pop() of the bottom pool, done by CCDirector every frame
+     @since v2.1.4
+     */
+    unsigned int getLastFrameObjectCount() { return m_uLastFrameObjectCount; }
+
+    /** enables the collection of autorelease statistics: objects per frame and per class.
+     Counting the classes is not free, keep it disabled in release builds. Enabling it resets the statistics.
+     @since v2.1.4
+     */
+    void setStatisticsEnabled(bool bEnabled);
+    bool isStatisticsEnabled() { return m_bStatisticsEnabled; }
+    void resetStatistics();
+
+    /** Output to CCLOG the objects autoreleased per frame and the nMaxClasses classes autoreleased the most
+     @since v2.1.4
+     */
+    void dumpStatistics(unsigned int nMaxClasses = 10);
+
     static CCPoolManager* sharedPoolManager();
     static void purgePoolManager();
 
@@ -26,51 +26,64 @@
 #include "CCString.h"
 #include "CCInteger.h"
 #include "platform/CCFileUtils.h"
+#include <stdlib.h>
+#include <string.h>
 
 using namespace std;
 
 NS_CC_BEGIN
 
 // -----------------------------------------------------------------------
-// CCDictElement
+// CCDictKey
 
-CCDictElement::CCDictElement(const char* pszKey, CCObject* pObject)
+CCDictKey::CCDictKey(const char* pszKey)
+: m_pszKey(pszKey)
 {
-    CCAssert(pszKey && strlen(pszKey) > 0, "Invalid key value.");
-    m_iKey = 0;
-    const char* pStart = pszKey;
-    
-    int len = strlen(pszKey);
-    if (len > MAX_KEY_LEN )
-    {
-        char* pEnd = (char*)&pszKey[len-1];
-        pStart = pEnd - (MAX_KEY_LEN-1);
-    }
-    
-    strcpy(m_szKey, pStart);
-    
-    m_pObject = pObject;
-    memset(&hh, 0, sizeof(hh));
+    m_uHash = hashString(pszKey, &m_uLength);
 }
 
-CCDictElement::CCDictElement(intptr_t iKey, CCObject* pObject)
+CCDictKey::CCDictKey(const std::string& key)
+: m_pszKey(key.c_str())
 {
-    m_szKey[0] = '\0';
-    m_iKey = iKey;
-    m_pObject = pObject;
-    memset(&hh, 0, sizeof(hh));
+    m_uHash = hashString(m_pszKey, &m_uLength);
 }
 
-CCDictElement::~CCDictElement()
+unsigned int CCDictKey::hashString(const char* pszKey, unsigned int* pLength)
 {
+    // FNV-1a
+    unsigned int hash = 2166136261u;
+    const unsigned char* p = (const unsigned char*)pszKey;
+    for (; *p; ++p)
+    {
+        hash = (hash ^ *p) * 16777619u;
+    }
+    if (pLength)
+    {
+        *pLength = (unsigned int)(p - (const unsigned char*)pszKey);
+    }
+    return hash;
+}
 
+static inline unsigned int hashInt(intptr_t key)
+{
+    unsigned long long value = (unsigned long long)key;
+    unsigned int hash = (unsigned int)(value ^ (value >> 32)) * 2654435761u;
+    return hash ^ (hash >> 16);
 }
 
 // -----------------------------------------------------------------------
 // CCDictionary
 
+#define CC_DICT_MIN_CAPACITY    4
+
 CCDictionary::CCDictionary()
 : m_pElements(NULL)
+, m_uCapacity(0)
+, m_uElementEnd(0)
+, m_uCount(0)
+, m_iFreeElement(-1)
+, m_pBuckets(NULL)
+, m_uBucketMask(0)
 , m_eDictType(kCCDictUnknown)
 {
 
@@ -83,7 +96,7 @@ CCDictionary::~CCDictionary()
 
 unsigned int CCDictionary::count()
 {
-    return HASH_COUNT(m_pElements);
+    return m_uCount;
 }
 
 CCArray* CCDictionary::allKeys()
@@ -93,19 +106,19 @@ CCArray* CCDictionary::allKeys()
 
     CCArray* pArray = CCArray::createWithCapacity(iKeyCount);
 
-    CCDictElement *pElement, *tmp;
+    CCDictElement *pElement;
     if (m_eDictType == kCCDictStr)
     {
-        HASH_ITER(hh, m_pElements, pElement, tmp) 
+        CCDICT_FOREACH(this, pElement)
         {
-            CCString* pOneKey = new CCString(pElement->m_szKey);
+            CCString* pOneKey = new CCString(pElement->getStrKey());
             pArray->addObject(pOneKey);
             CC_SAFE_RELEASE(pOneKey);
         }
     }
     else if (m_eDictType == kCCDictInt)
     {
-        HASH_ITER(hh, m_pElements, pElement, tmp) 
+        CCDICT_FOREACH(this, pElement)
         {
             CCInteger* pOneKey = new CCInteger(pElement->m_iKey);
             pArray->addObject(pOneKey);
@@ -122,15 +135,15 @@ CCArray* CCDictionary::allKeysForObject(CCObject* object)
     if (iKeyCount <= 0) return NULL;
     CCArray* pArray = CCArray::create();
 
-    CCDictElement *pElement, *tmp;
+    CCDictElement *pElement;
 
     if (m_eDictType == kCCDictStr)
     {
-        HASH_ITER(hh, m_pElements, pElement, tmp) 
+        CCDICT_FOREACH(this, pElement)
         {
             if (object == pElement->m_pObject)
             {
-                CCString* pOneKey = new CCString(pElement->m_szKey);
+                CCString* pOneKey = new CCString(pElement->getStrKey());
                 pArray->addObject(pOneKey);
                 CC_SAFE_RELEASE(pOneKey);
             }
@@ -138,7 +151,7 @@ CCArray* CCDictionary::allKeysForObject(CCObject* object)
     }
     else if (m_eDictType == kCCDictInt)
     {
-        HASH_ITER(hh, m_pElements, pElement, tmp) 
+        CCDICT_FOREACH(this, pElement)
         {
             if (object == pElement->m_pObject)
             {
@@ -151,40 +164,66 @@ CCArray* CCDictionary::allKeysForObject(CCObject* object)
     return pArray;
 }
 
+unsigned int CCDictionary::findBucket(const CCDictKey& key)
+{
+    unsigned int bucket = key.getHash() & m_uBucketMask;
+    for (;;)
+    {
+        unsigned int index = m_pBuckets[bucket];
+        if (index == 0)
+        {
+            return bucket;
+        }
+        const CCDictElement& element = m_pElements[index - 1];
+        if (element.m_uHash == key.getHash() && strcmp(element.getStrKey(), key.getKey()) == 0)
+        {
+            return bucket;
+        }
+        bucket = (bucket + 1) & m_uBucketMask;
+    }
+}
+
+unsigned int CCDictionary::findBucket(intptr_t key, unsigned int hash)
+{
+    unsigned int bucket = hash & m_uBucketMask;
+    for (;;)
+    {
+        unsigned int index = m_pBuckets[bucket];
+        if (index == 0 || m_pElements[index - 1].m_iKey == key)
+        {
+            return bucket;
+        }
+        bucket = (bucket + 1) & m_uBucketMask;
+    }
+}
+
 CCObject* CCDictionary::objectForKey(const std::string& key)
+{
+    return objectForKey(CCDictKey(key));
+}
+
+CCObject* CCDictionary::objectForKey(const CCDictKey& key)
 {
     // if dictionary wasn't initialized, return NULL directly.
-    if (m_eDictType == kCCDictUnknown) return NULL;
+    if (m_eDictType == kCCDictUnknown || m_uCount == 0) return NULL;
     // CCDictionary only supports one kind of key, string or integer.
     // This method uses string as key, therefore we should make sure that the key type of this CCDictionary is string.
     CCAssert(m_eDictType == kCCDictStr, "this dictionary does not use string as key.");
 
-    CCObject* pRetObject = NULL;
-    CCDictElement *pElement = NULL;
-    HASH_FIND_STR(m_pElements, key.c_str(), pElement);
-    if (pElement != NULL)
-    {
-        pRetObject = pElement->m_pObject;
-    }
-    return pRetObject;
+    unsigned int index = m_pBuckets[findBucket(key)];
+    return index ? m_pElements[index - 1].m_pObject : NULL;
 }
 
 CCObject* CCDictionary::objectForKey(intptr_t key)
 {
     // if dictionary wasn't initialized, return NULL directly.
-    if (m_eDictType == kCCDictUnknown) return NULL;
+    if (m_eDictType == kCCDictUnknown || m_uCount == 0) return NULL;
     // CCDictionary only supports one kind of key, string or integer.
     // This method uses integer as key, therefore we should make sure that the key type of this CCDictionary is integer.
     CCAssert(m_eDictType == kCCDictInt, "this dictionary does not use integer as key.");
 
-    CCObject* pRetObject = NULL;
-    CCDictElement *pElement = NULL;
-    HASH_FIND_PTR(m_pElements, &key, pElement);
-    if (pElement != NULL)
-    {
-        pRetObject = pElement->m_pObject;
-    }
-    return pRetObject;
+    unsigned int index = m_pBuckets[findBucket(key, hashInt(key))];
+    return index ? m_pElements[index - 1].m_pObject : NULL;
 }
 
 const CCString* CCDictionary::valueForKey(const std::string& key)
@@ -209,7 +248,12 @@ const CCString* CCDictionary::valueForKey(intptr_t key)
 
 void CCDictionary::setObject(CCObject* pObject, const std::string& key)
 {
-    CCAssert(key.length() > 0 && pObject != NULL, "Invalid Argument!");
+    setObject(pObject, CCDictKey(key));
+}
+
+void CCDictionary::setObject(CCObject* pObject, const CCDictKey& key)
+{
+    CCAssert(key.getLength() > 0 && pObject != NULL, "Invalid Argument!");
     if (m_eDictType == kCCDictUnknown)
     {
         m_eDictType = kCCDictStr;
@@ -217,19 +261,20 @@ void CCDictionary::setObject(CCObject* pObject, const std::string& key)
 
     CCAssert(m_eDictType == kCCDictStr, "this dictionary doesn't use string as key.");
 
-    CCDictElement *pElement = NULL;
-    HASH_FIND_STR(m_pElements, key.c_str(), pElement);
-    if (pElement == NULL)
+    unsigned int bucket = m_pBuckets ? findBucket(key) : 0;
+    if (m_pBuckets == NULL || m_pBuckets[bucket] == 0)
     {
-        setObjectUnSafe(pObject, key);
+        setObjectUnSafe(pObject, key, bucket);
     }
-    else if (pElement->m_pObject != pObject)
+    else
     {
-        CCObject* pTmpObj = pElement->m_pObject;
-        pTmpObj->retain();
-        removeObjectForElememt(pElement);
-        setObjectUnSafe(pObject, key);
-        pTmpObj->release();
+        CCDictElement* pElement = &m_pElements[m_pBuckets[bucket] - 1];
+        if (pElement->m_pObject != pObject)
+        {
+            pObject->retain();
+            pElement->m_pObject->release();
+            pElement->m_pObject = pObject;
+        }
     }
 }
 
@@ -243,62 +288,168 @@ void CCDictionary::setObject(CCObject* pObject, intptr_t key)
 
     CCAssert(m_eDictType == kCCDictInt, "this dictionary doesn't use integer as key.");
 
-    CCDictElement *pElement = NULL;
-    HASH_FIND_PTR(m_pElements, &key, pElement);
-    if (pElement == NULL)
+    unsigned int hash = hashInt(key);
+    unsigned int bucket = m_pBuckets ? findBucket(key, hash) : 0;
+    if (m_pBuckets == NULL || m_pBuckets[bucket] == 0)
     {
-        setObjectUnSafe(pObject, key);
+        setObjectUnSafe(pObject, key, hash, bucket);
     }
-    else if (pElement->m_pObject != pObject)
+    else
     {
-        CCObject* pTmpObj = pElement->m_pObject;
-        pTmpObj->retain();
-        removeObjectForElememt(pElement);
-        setObjectUnSafe(pObject, key);
-        pTmpObj->release();
+        CCDictElement* pElement = &m_pElements[m_pBuckets[bucket] - 1];
+        if (pElement->m_pObject != pObject)
+        {
+            pObject->retain();
+            pElement->m_pObject->release();
+            pElement->m_pObject = pObject;
+        }
     }
-
 }
 
 void CCDictionary::removeObjectForKey(const std::string& key)
 {
-    if (m_eDictType == kCCDictUnknown)
+    if (m_eDictType == kCCDictUnknown || m_uCount == 0)
     {
         return;
     }
     
     CCAssert(m_eDictType == kCCDictStr, "this dictionary doesn't use string as its key");
     CCAssert(key.length() > 0, "Invalid Argument!");
-    CCDictElement *pElement = NULL;
-    HASH_FIND_STR(m_pElements, key.c_str(), pElement);
-    removeObjectForElememt(pElement);
+    unsigned int index = m_pBuckets[findBucket(CCDictKey(key))];
+    if (index != 0)
+    {
+        removeObjectForElememt(&m_pElements[index - 1]);
+    }
 }
 
 void CCDictionary::removeObjectForKey(intptr_t key)
 {
-    if (m_eDictType == kCCDictUnknown)
+    if (m_eDictType == kCCDictUnknown || m_uCount == 0)
     {
         return;
     }
     
     CCAssert(m_eDictType == kCCDictInt, "this dictionary doesn't use integer as its key");
-    CCDictElement *pElement = NULL;
-    HASH_FIND_PTR(m_pElements, &key, pElement);
-    removeObjectForElememt(pElement);
+    unsigned int index = m_pBuckets[findBucket(key, hashInt(key))];
+    if (index != 0)
+    {
+        removeObjectForElememt(&m_pElements[index - 1]);
+    }
+}
+
+CCDictElement* CCDictionary::allocateElement(bool* pGrown)
+{
+    *pGrown = false;
+    if (m_iFreeElement >= 0)
+    {
+        CCDictElement* pElement = &m_pElements[m_iFreeElement];
+        m_iFreeElement = pElement->m_iKey;
+        return pElement;
+    }
+
+    if (m_uElementEnd == m_uCapacity)
+    {
+        // the free list is empty: every element is used
+        m_uCapacity = m_uCapacity ? m_uCapacity * 2 : CC_DICT_MIN_CAPACITY;
+        m_pElements = (CCDictElement*)realloc(m_pElements, m_uCapacity * sizeof(CCDictElement));
+        rehash();
+        *pGrown = true;
+    }
+    return &m_pElements[m_uElementEnd++];
+}
+
+void CCDictionary::rehash()
+{
+    free(m_pBuckets);
+    unsigned int bucketCount = m_uCapacity * 2;
+    m_pBuckets = (unsigned int*)calloc(bucketCount, sizeof(unsigned int));
+    m_uBucketMask = bucketCount - 1;
+
+    for (unsigned int i = 0; i < m_uElementEnd; ++i)
+    {
+        if (m_pElements[i].m_pObject != NULL)
+        {
+            unsigned int bucket = m_pElements[i].m_uHash & m_uBucketMask;
+            while (m_pBuckets[bucket] != 0)
+            {
+                bucket = (bucket + 1) & m_uBucketMask;
+            }
+            m_pBuckets[bucket] = i + 1;
+        }
+    }
 }
 
-void CCDictionary::setObjectUnSafe(CCObject* pObject, const std::string& key)
+void CCDictionary::setObjectUnSafe(CCObject* pObject, const CCDictKey& key, unsigned int bucket)
 {
+    bool grown;
+    CCDictElement* pElement = allocateElement(&grown);
+    if (grown)
+    {
+        bucket = findBucket(key);
+    }
+
+    if (key.getLength() < CC_DICT_INLINE_KEY_LEN)
+    {
+        memcpy(pElement->m_szKey, key.getKey(), key.getLength() + 1);
+        pElement->m_pszLongKey = NULL;
+    }
+    else
+    {
+        pElement->m_szKey[0] = '\0';
+        pElement->m_pszLongKey = (char*)malloc(key.getLength() + 1);
+        memcpy(pElement->m_pszLongKey, key.getKey(), key.getLength() + 1);
+    }
+    pElement->m_iKey = 0;
+    pElement->m_uHash = key.getHash();
+    pElement->m_pObject = pObject;
     pObject->retain();
-    CCDictElement* pElement = new CCDictElement(key.c_str(), pObject);
-    HASH_ADD_STR(m_pElements, m_szKey, pElement);
+
+    m_pBuckets[bucket] = (unsigned int)(pElement - m_pElements) + 1;
+    m_uCount++;
 }
 
-void CCDictionary::setObjectUnSafe(CCObject* pObject, const intptr_t key)
+void CCDictionary::setObjectUnSafe(CCObject* pObject, const intptr_t key, unsigned int hash, unsigned int bucket)
 {
+    bool grown;
+    CCDictElement* pElement = allocateElement(&grown);
+    if (grown)
+    {
+        bucket = findBucket(key, hash);
+    }
+
+    pElement->m_szKey[0] = '\0';
+    pElement->m_pszLongKey = NULL;
+    pElement->m_iKey = key;
+    pElement->m_uHash = hash;
+    pElement->m_pObject = pObject;
     pObject->retain();
-    CCDictElement* pElement = new CCDictElement(key, pObject);
-    HASH_ADD_PTR(m_pElements, m_iKey, pElement);
+
+    m_pBuckets[bucket] = (unsigned int)(pElement - m_pElements) + 1;
+    m_uCount++;
+}
+
+void CCDictionary::removeBucket(unsigned int bucket)
+{
+    // backward shift deletion: moves back the following elements of the cluster
+    // which could not be stored before the emptied bucket, so no tombstone is needed
+    unsigned int next = bucket;
+    for (;;)
+    {
+        next = (next + 1) & m_uBucketMask;
+        unsigned int index = m_pBuckets[next];
+        if (index == 0)
+        {
+            break;
+        }
+        unsigned int home = m_pElements[index - 1].m_uHash & m_uBucketMask;
+        // distances from the home bucket, modulo the table size
+        if (((next - home) & m_uBucketMask) >= ((next - bucket) & m_uBucketMask))
+        {
+            m_pBuckets[bucket] = index;
+            bucket = next;
+        }
+    }
+    m_pBuckets[bucket] = 0;
 }
 
 void CCDictionary::removeObjectsForKeys(CCArray* pKeyArray)
@@ -313,24 +464,58 @@ void CCDictionary::removeObjectsForKeys(CCArray* pKeyArray)
 
 void CCDictionary::removeObjectForElememt(CCDictElement* pElement)
 {
-    if (pElement != NULL)
+    if (pElement != NULL && pElement->m_pObject != NULL)
     {
-        HASH_DEL(m_pElements, pElement);
-        pElement->m_pObject->release();
-        CC_SAFE_DELETE(pElement);
+        unsigned int index = (unsigned int)(pElement - m_pElements) + 1;
+        unsigned int bucket = pElement->m_uHash & m_uBucketMask;
+        while (m_pBuckets[bucket] != index)
+        {
+            bucket = (bucket + 1) & m_uBucketMask;
+        }
+        removeBucket(bucket);
+
+        CCObject* pObject = pElement->m_pObject;
+        free(pElement->m_pszLongKey);
+        pElement->m_pszLongKey = NULL;
+        pElement->m_pObject = NULL;
+        pElement->m_iKey = m_iFreeElement;
+        m_iFreeElement = index - 1;
+        m_uCount--;
+
+        if (m_uCount == 0)
+        {
+            // all the elements are free: start again from the first one
+            m_uElementEnd = 0;
+            m_iFreeElement = -1;
+        }
+        pObject->release();
     }
 }
 
 void CCDictionary::removeAllObjects()
 {
-    CCDictElement *pElement, *tmp;
-    HASH_ITER(hh, m_pElements, pElement, tmp) 
+    CCDictElement* pElements = m_pElements;
+    unsigned int uElementEnd = m_uElementEnd;
+
+    // empty the dictionary first: releasing the objects may access it
+    m_pElements = NULL;
+    m_uCapacity = 0;
+    m_uElementEnd = 0;
+    m_uCount = 0;
+    m_iFreeElement = -1;
+    free(m_pBuckets);
+    m_pBuckets = NULL;
+    m_uBucketMask = 0;
+
+    for (unsigned int i = 0; i < uElementEnd; ++i)
     {
-        HASH_DEL(m_pElements, pElement);
-        pElement->m_pObject->release();
-        CC_SAFE_DELETE(pElement);
-
+        if (pElements[i].m_pObject != NULL)
+        {
+            free(pElements[i].m_pszLongKey);
+            pElements[i].m_pObject->release();
+        }
     }
+    free(pElements);
 }
 
 CCObject* CCDictionary::copyWithZone(CCZone* pZone)
@@ -25,6 +25,7 @@ THE SOFTWARE.
 #ifndef __CCDICTIONARY_H__
 #define __CCDICTIONARY_H__
 
+// not used by CCDictionary anymore, kept for the files which get uthash through this header
 #include "support/data_support/uthash.h"
 #include "CCObject.h"
 #include "CCArray.h"
@@ -40,6 +41,39 @@ class CCDictionary;
  */
 
 
+/**
+ *  A string key of CCDictionary with its hash computed once.
+ *
+ *  Looking up a CCDictKey neither hashes nor copies the string. Keep the keys
+ *  used on hot paths, like the names of frequently used sprite frames.
+ *
+ *  @note The key doesn't copy the string: the string must live as long as the key,
+ *        a literal or a std::string kept next to it.
+ *  @code
+ *  static const CCDictKey s_runKey("run");
+ *  CCAnimation* pAnimation = (CCAnimation*)pDict->objectForKey(s_runKey);
+ *  @endcode
+ *  @since v2.1.4
+ */
+class CC_DLL CCDictKey
+{
+public:
+    explicit CCDictKey(const char* pszKey);
+    explicit CCDictKey(const std::string& key);
+
+    inline const char* getKey() const { return m_pszKey; }
+    inline unsigned int getLength() const { return m_uLength; }
+    inline unsigned int getHash() const { return m_uHash; }
+
+    /** the hash CCDictionary uses for a string key */
+    static unsigned int hashString(const char* pszKey, unsigned int* pLength = NULL);
+
+private:
+    const char*  m_pszKey;
+    unsigned int m_uLength;
+    unsigned int m_uHash;
+};
+
 /**
  *  CCDictElement is used for traversing CCDictionary.
  *
@@ -47,6 +81,8 @@ class CCDictionary;
  *  Its key has two different type (integer and string).
  *
  *  @note The key type is unique, all the elements in CCDictionary has the same key type(integer or string).
+ *  @note The elements are stored in an array of the dictionary: a CCDictElement pointer stays valid while
+ *        elements are removed, but not after an element is added.
  *  @code
  *  CCDictElement* pElement;
  *  CCDICT_FOREACH(dict, pElement)
@@ -61,29 +97,7 @@ class CCDictionary;
  */
 class CC_DLL CCDictElement
 {
-private:
-    /**
-     *  Constructor of CCDictElement. It's only for internal usage. CCDictionary is its friend class.
-     *  
-     *  @param  pszKey    The string key of this element.
-     *  @param  pObject   The object of this element.
-     */
-    CCDictElement(const char* pszKey, CCObject* pObject);
-
-    /**
-     *  Constructor of CCDictElement. It's only for internal usage. CCDictionary is its friend class.
-     *
-     *  @param  iKey    The integer key of this element.
-     *  @param  pObject   The object of this element.
-     */
-    CCDictElement(intptr_t iKey, CCObject* pObject);
-    
 public:
-    /**
-     *  The destructor of CCDictElement.
-     */
-    ~CCDictElement();
-
     // Inline functions need to be implemented in header file on Android.
     
     /**
@@ -95,8 +109,8 @@ public:
      */
     inline const char* getStrKey() const
     {
-        CCAssert(m_szKey[0] != '\0', "Should not call this function for integer dictionary");
-        return m_szKey;
+        CCAssert(m_pszLongKey != NULL || m_szKey[0] != '\0', "Should not call this function for integer dictionary");
+        return m_pszLongKey ? m_pszLongKey : m_szKey;
     }
 
     /**
@@ -108,7 +122,7 @@ public:
      */
     inline intptr_t getIntKey() const
     {
-        CCAssert(m_szKey[0] == '\0', "Should not call this function for string dictionary");
+        CCAssert(m_pszLongKey == NULL && m_szKey[0] == '\0', "Should not call this function for string dictionary");
         return m_iKey;
     }
     
@@ -120,26 +134,26 @@ public:
     inline CCObject* getObject() const { return m_pObject; }
 
 private:
-    // The max length of string key.
-    #define   MAX_KEY_LEN   256
-    // char array is needed for HASH_ADD_STR in UT_HASH.
-    // So it's a pain that all elements will allocate 256 bytes for this array.
-    char      m_szKey[MAX_KEY_LEN];     // hash key of string type
-    intptr_t  m_iKey;       // hash key of integer type
-    CCObject* m_pObject;    // hash value
-public:
-    UT_hash_handle hh;      // makes this class hashable
-    friend class CCDictionary; // declare CCDictionary as friend class
+    // Keys shorter than this are stored in the element, the longer ones are allocated.
+    #define   CC_DICT_INLINE_KEY_LEN   32
+    char      m_szKey[CC_DICT_INLINE_KEY_LEN];  // string key, empty for integer keys
+    char*     m_pszLongKey;     // string key, when it doesn't fit in m_szKey
+    intptr_t  m_iKey;           // integer key; next free element when m_pObject is NULL
+    unsigned int m_uHash;       // hash of the key
+    CCObject* m_pObject;        // value, NULL for a free element
+    friend class CCDictionary;  // declare CCDictionary as friend class
 };
 
 /** The macro for traversing dictionary
  *  
  *  @note It's faster than getting all keys and traversing keys to get objects by objectForKey.
- *        It's also safe to remove elements while traversing.
+ *        It's also safe to remove the current element while traversing, but not to add elements.
  */
 #define CCDICT_FOREACH(__dict__, __el__) \
     CCDictElement* pTmp##__dict__##__el__ = NULL; \
-    HASH_ITER(hh, (__dict__)->m_pElements, __el__, pTmp##__dict__##__el__)
+    for (__el__ = (__dict__)->firstElement(); \
+         __el__ != NULL && ((pTmp##__dict__##__el__ = (__dict__)->nextElement(__el__)), true); \
+         __el__ = pTmp##__dict__##__el__)
 
 
 
@@ -166,6 +180,7 @@ public:
  *  CCLog("{ key3: %d }", pInteger->getValue());
  *  @endcode
  *
+ *  The elements are stored in an array, indexed by an open addressing hash table.
  */
 
 class CC_DLL CCDictionary : public CCObject
@@ -231,6 +246,14 @@ public:
      *  @see objectForKey(const std::string&)
      */
     CCObject* objectForKey(intptr_t key);
+
+    /**
+     *  Get the object according to the specified pre-hashed string key.
+     *
+     *  @see objectForKey(const std::string&), CCDictKey
+     *  @since v2.1.4
+     */
+    CCObject* objectForKey(const CCDictKey& key);
     
     /** Get the value according to the specified string key.
      *
@@ -277,6 +300,13 @@ public:
      */
     void setObject(CCObject* pObject, intptr_t key);
 
+    /** Insert an object to dictionary, and match it with the specified pre-hashed string key.
+     *
+     *  @see setObject(CCObject*, const std::string&), CCDictKey
+     *  @since v2.1.4
+     */
+    void setObject(CCObject* pObject, const CCDictKey& key);
+
     /** 
      *  Remove an object by the specified string key.
      *
@@ -385,21 +415,58 @@ public:
     /* override functions */
     virtual void acceptVisitor(CCDataVisitor &visitor);
 
+    /**
+     *  The first element, NULL if the dictionary is empty. Used by CCDICT_FOREACH.
+     */
+    inline CCDictElement* firstElement() const { return elementFrom(0); }
+
+    /**
+     *  The element after pElement, NULL after the last one. Used by CCDICT_FOREACH.
+     */
+    inline CCDictElement* nextElement(CCDictElement* pElement) const { return elementFrom(pElement - m_pElements + 1); }
+
 private:
+    inline CCDictElement* elementFrom(intptr_t index) const
+    {
+        for (; index < (intptr_t)m_uElementEnd; ++index)
+        {
+            if (m_pElements[index].m_pObject != NULL)
+            {
+                return &m_pElements[index];
+            }
+        }
+        return NULL;
+    }
+
     /** 
      *  For internal usage, invoked by setObject.
      */
-    void setObjectUnSafe(CCObject* pObject, const std::string& key);
-    void setObjectUnSafe(CCObject* pObject, const intptr_t key);
-    
-public:
+    void setObjectUnSafe(CCObject* pObject, const CCDictKey& key, unsigned int bucket);
+    void setObjectUnSafe(CCObject* pObject, const intptr_t key, unsigned int hash, unsigned int bucket);
+
+    /** the bucket holding the key, or the empty one where it would be added */
+    unsigned int findBucket(const CCDictKey& key);
+    unsigned int findBucket(intptr_t key, unsigned int hash);
+    /** a free element, growing the arrays when there's none. Bucket positions change when they grow. */
+    CCDictElement* allocateElement(bool* pGrown);
+    void removeBucket(unsigned int bucket);
+    void rehash();
+
     /**
-     *  All the elements in dictionary.
-     * 
-     *  @note For internal usage, we need to declare this member variable as public since it's used in UT_HASH.
+     *  All the elements in dictionary, free ones included.
      */
     CCDictElement* m_pElements;
-private:
+    unsigned int m_uCapacity;
+    /** elements past this one were never used */
+    unsigned int m_uElementEnd;
+    unsigned int m_uCount;
+    /** free elements are linked through their m_iKey, -1 ends the list */
+    intptr_t m_iFreeElement;
+
+    /** the open addressing table: index + 1 of an element, 0 for an empty bucket. Twice the capacity, a power of 2. */
+    unsigned int* m_pBuckets;
+    unsigned int m_uBucketMask;
+
     
     /** The support type of dictionary, it's confirmed when setObject is invoked. */
     enum CCDictType
@@ -27,6 +27,7 @@ THE SOFTWARE.
 
 #include <set>
 #include "CCObject.h"
+#include "support/CCPoolAllocator.h"
 
 NS_CC_BEGIN
 
@@ -39,6 +40,8 @@ typedef std::set<CCObject *>::iterator CCSetIterator;
 
 class CC_DLL CCSet : public CCObject
 {
+    CC_POOL_ALLOCATED()
+
 public:
     CCSet(void);
     CCSet(const CCSet &rSetObject);
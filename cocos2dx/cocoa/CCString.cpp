@@ -3,10 +3,72 @@
 #include "ccMacros.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <pthread.h>
+
+// pre-C99 compilers (Visual Studio before 2013) don't have it, their va_list is a plain pointer
+#ifndef va_copy
+#define va_copy(dst, src) ((dst) = (src))
+#endif
 
 NS_CC_BEGIN
 
 #define kMaxStringLen (1024*100)
+// formatted strings shorter than this don't allocate anything besides the std::string
+#define kStackStringLen 512
+
+// the per-thread buffer used for the strings too long for the stack
+struct FormatBuffer
+{
+    char* data;
+    unsigned int size;
+};
+
+static pthread_key_t s_formatBufferKey;
+static pthread_once_t s_formatBufferOnce = PTHREAD_ONCE_INIT;
+static unsigned int s_uFormatBufferAllocations = 0;
+
+static void deleteFormatBuffer(void* pBuffer)
+{
+    FormatBuffer* buffer = (FormatBuffer*)pBuffer;
+    free(buffer->data);
+    free(buffer);
+}
+
+static void createFormatBufferKey()
+{
+    pthread_key_create(&s_formatBufferKey, deleteFormatBuffer);
+}
+
+// returns the buffer of the calling thread, grown to at least size bytes
+static char* getFormatBuffer(unsigned int size)
+{
+    pthread_once(&s_formatBufferOnce, createFormatBufferKey);
+
+    FormatBuffer* buffer = (FormatBuffer*)pthread_getspecific(s_formatBufferKey);
+    if (buffer == NULL)
+    {
+        buffer = (FormatBuffer*)calloc(1, sizeof(FormatBuffer));
+        if (buffer == NULL)
+        {
+            return NULL;
+        }
+        pthread_setspecific(s_formatBufferKey, buffer);
+    }
+
+    if (buffer->size < size)
+    {
+        char* data = (char*)realloc(buffer->data, size);
+        if (data == NULL)
+        {
+            return NULL;
+        }
+        buffer->data = data;
+        buffer->size = size;
+        // only a statistic: races between threads don't matter
+        ++s_uFormatBufferAllocations;
+    }
+    return buffer->data;
+}
 
 CCString::CCString()
     :m_sString("")
@@ -37,16 +99,51 @@ CCString& CCString::operator= (const CCString& other)
 
 bool CCString::initWithFormatAndValist(const char* format, va_list ap)
 {
-    bool bRet = false;
-    char* pBuf = (char*)malloc(kMaxStringLen);
-    if (pBuf != NULL)
+    char stackBuf[kStackStringLen];
+    va_list apCopy;
+
+    va_copy(apCopy, ap);
+    int len = vsnprintf(stackBuf, kStackStringLen, format, apCopy);
+    va_end(apCopy);
+
+    if (len >= 0 && len < kStackStringLen)
     {
-        vsnprintf(pBuf, kMaxStringLen, format, ap);
-        m_sString = pBuf;
-        free(pBuf);
-        bRet = true;
+        m_sString.assign(stackBuf, len);
+        return true;
     }
-    return bRet;
+
+    // len is the size needed, or -1 with the vsnprintf of some platforms: grow until it fits, up to kMaxStringLen
+    unsigned int size = len >= 0 ? len + 1 : kStackStringLen * 2;
+    while (true)
+    {
+        if (size > kMaxStringLen)
+        {
+            size = kMaxStringLen;
+        }
+        char* pBuf = getFormatBuffer(size);
+        if (pBuf == NULL)
+        {
+            return false;
+        }
+
+        va_copy(apCopy, ap);
+        len = vsnprintf(pBuf, size, format, apCopy);
+        va_end(apCopy);
+
+        if ((len >= 0 && (unsigned int)len < size) || size == kMaxStringLen)
+        {
+            // longer strings are truncated, as they have always been
+            pBuf[size - 1] = '\0';
+            m_sString = pBuf;
+            return true;
+        }
+        size = len >= 0 ? len + 1 : size * 2;
+    }
+}
+
+unsigned int CCString::getFormatBufferAllocations()
+{
+    return s_uFormatBufferAllocations;
 }
 
 bool CCString::initWithFormat(const char* format, ...)
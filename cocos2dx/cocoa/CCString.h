@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include <string>
 #include <functional>
 #include "CCObject.h"
+#include "support/CCPoolAllocator.h"
 
 NS_CC_BEGIN
 
@@ -42,6 +43,8 @@ NS_CC_BEGIN
 
 class CC_DLL CCString : public CCObject
 {
+    CC_POOL_ALLOCATED()
+
 public:
     CCString();
     CCString(const char* str);
@@ -90,13 +93,19 @@ public:
      */
     static CCString* create(const std::string& str);
 
-    /** create a string with format, it's similar with the c function 'sprintf', the default buffer size is (1024*100) bytes,
+    /** create a string with format, it's similar with the c function 'sprintf'. The result is limited to (1024*100) bytes,
      *  if you want to change it, you should modify the kMaxStringLen macro in CCString.cpp file.
+     *  Short strings are formatted on the stack, longer ones in a buffer of the calling thread reused by the next calls.
      *  @return A CCString pointer which is an autorelease object pointer,
      *          it means that you needn't do a release operation unless you retain it.
      */ 
     static CCString* createWithFormat(const char* format, ...) CC_FORMAT_PRINTF(1, 2);
 
+    /** returns how many times the buffers used to format the strings too long for the stack were allocated or grown, on all threads
+     *  @since v2.1.4
+     */
+    static unsigned int getFormatBufferAllocations();
+
     /** create a string with binary data 
      *  @return A CCString pointer which is an autorelease object pointer,
      *          it means that you needn't do a release operation unless you retain it.
@@ -243,6 +243,7 @@ void CCDrawNode::drawDot(const CCPoint &pos, float radius, const ccColor4F &colo
 	m_nBufferCount += vertex_count;
 	
 	m_bDirty = true;
+	invalidateRenderCache();
 }
 
 void CCDrawNode::drawSegment(const CCPoint &from, const CCPoint &to, float radius, const ccColor4F &color)
@@ -316,6 +317,7 @@ void CCDrawNode::drawSegment(const CCPoint &from, const CCPoint &to, float radiu
 	m_nBufferCount += vertex_count;
 	
 	m_bDirty = true;
+	invalidateRenderCache();
 }
 
 void CCDrawNode::drawPolygon(CCPoint *verts, unsigned int count, const ccColor4F &fillColor, float borderWidth, const ccColor4F &borderColor)
@@ -420,6 +422,7 @@ void CCDrawNode::drawPolygon(CCPoint *verts, unsigned int count, const ccColor4F
 	m_nBufferCount += vertex_count;
 	
 	m_bDirty = true;
+	invalidateRenderCache();
 
     free(extrude);
 }
@@ -428,6 +431,7 @@ void CCDrawNode::clear()
 {
     m_nBufferCount = 0;
     m_bDirty = true;
+    invalidateRenderCache();
 }
 
 ccBlendFunc CCDrawNode::getBlendFunc() const
@@ -45,8 +45,10 @@ THE SOFTWARE.
 #include "shaders/CCGLProgram.h"
 #include "actions/CCActionCatmullRom.h"
 #include "support/CCPointExtension.h"
+#include "kazmath/GL/matrix.h"
 #include <string.h>
 #include <cmath>
+#include <vector>
 
 NS_CC_BEGIN
 #ifndef M_PI
@@ -59,6 +61,8 @@ static int s_nColorLocation = -1;
 static ccColor4F s_tColor = {1.0f,1.0f,1.0f,1.0f};
 static int s_nPointSizeLocation = -1;
 static GLfloat s_fPointSize = 1.0f;
+// the last width given to ccLineWidth(), so that queuing a line doesn't query GL
+static GLfloat s_fLineWidth = 1.0f;
 
 #ifdef EMSCRIPTEN
 static GLuint s_bufferObject = 0;
@@ -87,6 +91,146 @@ static void setGLBufferData(void *buf, GLuint bufSize)
 
 #endif // EMSCRIPTEN
 
+// --------------------- batching ---------------------
+
+typedef struct _ccDrawBatchVertex
+{
+    ccVertex3F  vertices;
+    ccColor4B   colors;
+} ccDrawBatchVertex;
+
+// consecutive batched lines sharing a line width
+typedef struct _ccDrawLineRun
+{
+    GLfloat         width;
+    unsigned int    first;
+    unsigned int    count;
+} ccDrawLineRun;
+
+static bool s_bBatchingEnabled = false;
+static std::vector<ccDrawBatchVertex> s_tBatchTriangles;
+static std::vector<ccDrawBatchVertex> s_tBatchLines;
+static std::vector<ccDrawLineRun> s_tBatchLineRuns;
+static GLuint s_uBatchBuffer = 0;
+
+// Batched vertices are stored in world space: the modelview matrix is applied here
+// and the batch is drawn with an identity one.
+static inline ccDrawBatchVertex batchVertex(const kmMat4& mv, GLfloat x, GLfloat y, ccColor4B color)
+{
+    ccDrawBatchVertex v;
+    v.vertices.x = mv.mat[0] * x + mv.mat[4] * y + mv.mat[12];
+    v.vertices.y = mv.mat[1] * x + mv.mat[5] * y + mv.mat[13];
+    v.vertices.z = mv.mat[2] * x + mv.mat[6] * y + mv.mat[14];
+    v.colors = color;
+    return v;
+}
+
+static inline void batchLine(const ccDrawBatchVertex& a, const ccDrawBatchVertex& b)
+{
+    s_tBatchLines.push_back(a);
+    s_tBatchLines.push_back(b);
+}
+
+/* Adds count vertices, read every stride floats from coords, as primitives of the given mode.
+ Points become squares of the point size, strips, loops and fans become lines and triangles.
+ */
+static void batchVertices(GLenum mode, const GLfloat *coords, unsigned int stride, unsigned int count, const ccColor4F& color)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    kmMat4 mv;
+    kmGLGetMatrix(KM_GL_MODELVIEW, &mv);
+    ccColor4B c = ccc4BFromccc4F(color);
+
+    switch (mode)
+    {
+        case GL_POINTS:
+        {
+            // the point size is in pixels whatever the node scale is, so the square is built around the transformed point
+            GLfloat h = s_fPointSize / CC_CONTENT_SCALE_FACTOR() / 2;
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                ccDrawBatchVertex p = batchVertex(mv, coords[i * stride], coords[i * stride + 1], c);
+                ccDrawBatchVertex q[4] = { p, p, p, p };
+                q[0].vertices.x -= h; q[0].vertices.y -= h;
+                q[1].vertices.x += h; q[1].vertices.y -= h;
+                q[2].vertices.x += h; q[2].vertices.y += h;
+                q[3].vertices.x -= h; q[3].vertices.y += h;
+
+                s_tBatchTriangles.push_back(q[0]);
+                s_tBatchTriangles.push_back(q[1]);
+                s_tBatchTriangles.push_back(q[2]);
+                s_tBatchTriangles.push_back(q[0]);
+                s_tBatchTriangles.push_back(q[2]);
+                s_tBatchTriangles.push_back(q[3]);
+            }
+            break;
+        }
+        case GL_TRIANGLE_FAN:
+        {
+            if (count < 3)
+            {
+                break;
+            }
+            ccDrawBatchVertex center = batchVertex(mv, coords[0], coords[1], c);
+            ccDrawBatchVertex previous = batchVertex(mv, coords[stride], coords[stride + 1], c);
+            for (unsigned int i = 2; i < count; ++i)
+            {
+                ccDrawBatchVertex current = batchVertex(mv, coords[i * stride], coords[i * stride + 1], c);
+                s_tBatchTriangles.push_back(center);
+                s_tBatchTriangles.push_back(previous);
+                s_tBatchTriangles.push_back(current);
+                previous = current;
+            }
+            break;
+        }
+        case GL_LINES:
+        case GL_LINE_STRIP:
+        case GL_LINE_LOOP:
+        {
+            if (s_tBatchLineRuns.empty() || s_tBatchLineRuns.back().width != s_fLineWidth)
+            {
+                ccDrawLineRun run = { s_fLineWidth, (unsigned int)s_tBatchLines.size(), 0 };
+                s_tBatchLineRuns.push_back(run);
+            }
+            unsigned int first = s_tBatchLines.size();
+
+            if (mode == GL_LINES)
+            {
+                for (unsigned int i = 0; i + 1 < count; i += 2)
+                {
+                    batchLine(batchVertex(mv, coords[i * stride], coords[i * stride + 1], c),
+                              batchVertex(mv, coords[(i + 1) * stride], coords[(i + 1) * stride + 1], c));
+                }
+            }
+            else
+            {
+                ccDrawBatchVertex start = batchVertex(mv, coords[0], coords[1], c);
+                ccDrawBatchVertex previous = start;
+                for (unsigned int i = 1; i < count; ++i)
+                {
+                    ccDrawBatchVertex current = batchVertex(mv, coords[i * stride], coords[i * stride + 1], c);
+                    batchLine(previous, current);
+                    previous = current;
+                }
+                if (mode == GL_LINE_LOOP && count > 2)
+                {
+                    batchLine(previous, start);
+                }
+            }
+
+            s_tBatchLineRuns.back().count += s_tBatchLines.size() - first;
+            break;
+        }
+        default:
+            CCAssert(false, "unsupported primitive");
+            break;
+    }
+}
+
 static void lazy_init( void )
 {
     if( ! s_bInitialized ) {
@@ -110,16 +254,123 @@ static void lazy_init( void )
 void ccDrawInit()
 {
     lazy_init();
+    // a lost context took the batch buffer with it, and the line width is back to the GL default
+    s_uBatchBuffer = 0;
+    s_fLineWidth = 1.0f;
 }
 
 void ccDrawFree()
 {
 	CC_SAFE_RELEASE_NULL(s_pShader);
 	s_bInitialized = false;
+
+    if (s_uBatchBuffer)
+    {
+        glDeleteBuffers(1, &s_uBatchBuffer);
+        s_uBatchBuffer = 0;
+    }
+    s_tBatchTriangles.clear();
+    s_tBatchLines.clear();
+    s_tBatchLineRuns.clear();
+}
+
+void ccDrawSetBatchingEnabled( bool enabled )
+{
+    if (s_bBatchingEnabled && ! enabled)
+    {
+        ccDrawFlush();
+    }
+    s_bBatchingEnabled = enabled;
+}
+
+bool ccDrawIsBatchingEnabled()
+{
+    return s_bBatchingEnabled;
+}
+
+void ccDrawFlush()
+{
+    if (s_tBatchTriangles.empty() && s_tBatchLines.empty())
+    {
+        return;
+    }
+
+    CCGLProgram* shader = CCShaderCache::sharedShaderCache()->programForKey(kCCShader_PositionColor);
+
+    kmGLMatrixMode(KM_GL_MODELVIEW);
+    kmGLPushMatrix();
+    kmGLLoadIdentity();
+
+    shader->use();
+    shader->setUniformsForBuiltins();
+    ccGLBlendFunc(CC_BLEND_SRC, CC_BLEND_DST);
+    ccGLEnableVertexAttribs( kCCVertexAttribFlag_Position | kCCVertexAttribFlag_Color );
+
+    if (! s_uBatchBuffer)
+    {
+        glGenBuffers(1, &s_uBatchBuffer);
+    }
+
+    // one buffer per flush: triangles first, then lines
+    GLsizeiptr trianglesSize = s_tBatchTriangles.size() * sizeof(ccDrawBatchVertex);
+    GLsizeiptr linesSize = s_tBatchLines.size() * sizeof(ccDrawBatchVertex);
+    glBindBuffer(GL_ARRAY_BUFFER, s_uBatchBuffer);
+    glBufferData(GL_ARRAY_BUFFER, trianglesSize + linesSize, NULL, GL_STREAM_DRAW);
+    if (trianglesSize)
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, 0, trianglesSize, &s_tBatchTriangles[0]);
+    }
+    if (linesSize)
+    {
+        glBufferSubData(GL_ARRAY_BUFFER, trianglesSize, linesSize, &s_tBatchLines[0]);
+    }
+
+    glVertexAttribPointer(kCCVertexAttrib_Position, 3, GL_FLOAT, GL_FALSE, sizeof(ccDrawBatchVertex), (GLvoid *)offsetof(ccDrawBatchVertex, vertices));
+    glVertexAttribPointer(kCCVertexAttrib_Color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ccDrawBatchVertex), (GLvoid *)offsetof(ccDrawBatchVertex, colors));
+
+    if (! s_tBatchTriangles.empty())
+    {
+        glDrawArrays(GL_TRIANGLES, 0, (GLsizei) s_tBatchTriangles.size());
+        CC_INCREMENT_GL_DRAWS(1);
+    }
+
+    if (! s_tBatchLineRuns.empty())
+    {
+        GLint firstLine = (GLint) s_tBatchTriangles.size();
+        for (unsigned int i = 0; i < s_tBatchLineRuns.size(); ++i)
+        {
+            const ccDrawLineRun& run = s_tBatchLineRuns[i];
+            if (run.count == 0)
+            {
+                continue;
+            }
+            glLineWidth(run.width);
+            glDrawArrays(GL_LINES, firstLine + run.first, (GLsizei) run.count);
+            CC_INCREMENT_GL_DRAWS(1);
+        }
+
+        glLineWidth(s_fLineWidth);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    kmGLPopMatrix();
+
+    CHECK_GL_ERROR_DEBUG();
+
+    s_tBatchTriangles.clear();
+    s_tBatchLines.clear();
+    s_tBatchLineRuns.clear();
 }
 
 void ccDrawPoint( const CCPoint& point )
 {
+    if (s_bBatchingEnabled)
+    {
+        GLfloat coords[2] = { point.x, point.y };
+        batchVertices(GL_POINTS, coords, 2, 1, s_tColor);
+        return;
+    }
+
     lazy_init();
 
     ccVertex2F p;
@@ -147,6 +398,12 @@ void ccDrawPoint( const CCPoint& point )
 
 void ccDrawPoints( const CCPoint *points, unsigned int numberOfPoints )
 {
+    if (s_bBatchingEnabled)
+    {
+        batchVertices(GL_POINTS, &points[0].x, sizeof(CCPoint) / sizeof(GLfloat), numberOfPoints, s_tColor);
+        return;
+    }
+
     lazy_init();
 
     ccGLEnableVertexAttribs( kCCVertexAttribFlag_Position );
@@ -195,13 +452,19 @@ void ccDrawPoints( const CCPoint *points, unsigned int numberOfPoints )
 
 void ccDrawLine( const CCPoint& origin, const CCPoint& destination )
 {
-    lazy_init();
-
     ccVertex2F vertices[2] = {
         {origin.x, origin.y},
         {destination.x, destination.y}
     };
 
+    if (s_bBatchingEnabled)
+    {
+        batchVertices(GL_LINES, &vertices[0].x, 2, 2, s_tColor);
+        return;
+    }
+
+    lazy_init();
+
     s_pShader->use();
     s_pShader->setUniformsForBuiltins();
     s_pShader->setUniformLocationWith4fv(s_nColorLocation, (GLfloat*) &s_tColor.r, 1);
@@ -240,6 +503,12 @@ void ccDrawSolidRect( CCPoint origin, CCPoint destination, ccColor4F color )
 
 void ccDrawPoly( const CCPoint *poli, unsigned int numberOfPoints, bool closePolygon )
 {
+    if (s_bBatchingEnabled)
+    {
+        batchVertices(closePolygon ? GL_LINE_LOOP : GL_LINE_STRIP, &poli[0].x, sizeof(CCPoint) / sizeof(GLfloat), numberOfPoints, s_tColor);
+        return;
+    }
+
     lazy_init();
 
     s_pShader->use();
@@ -292,6 +561,12 @@ void ccDrawPoly( const CCPoint *poli, unsigned int numberOfPoints, bool closePol
 
 void ccDrawSolidPoly( const CCPoint *poli, unsigned int numberOfPoints, ccColor4F color )
 {
+    if (s_bBatchingEnabled)
+    {
+        batchVertices(GL_TRIANGLE_FAN, &poli[0].x, sizeof(CCPoint) / sizeof(GLfloat), numberOfPoints, color);
+        return;
+    }
+
     lazy_init();
 
     s_pShader->use();
@@ -359,6 +634,13 @@ void ccDrawCircle( const CCPoint& center, float radius, float angle, unsigned in
     vertices[(segments+1)*2] = center.x;
     vertices[(segments+1)*2+1] = center.y;
 
+    if (s_bBatchingEnabled)
+    {
+        batchVertices(GL_LINE_STRIP, vertices, 2, segments+additionalSegment, s_tColor);
+        free( vertices );
+        return;
+    }
+
     s_pShader->use();
     s_pShader->setUniformsForBuiltins();
     s_pShader->setUniformLocationWith4fv(s_nColorLocation, (GLfloat*) &s_tColor.r, 1);
@@ -399,6 +681,13 @@ void ccDrawQuadBezier(const CCPoint& origin, const CCPoint& control, const CCPoi
     vertices[segments].x = destination.x;
     vertices[segments].y = destination.y;
 
+    if (s_bBatchingEnabled)
+    {
+        batchVertices(GL_LINE_STRIP, &vertices[0].x, 2, segments + 1, s_tColor);
+        CC_SAFE_DELETE_ARRAY(vertices);
+        return;
+    }
+
     s_pShader->use();
     s_pShader->setUniformsForBuiltins();
     s_pShader->setUniformLocationWith4fv(s_nColorLocation, (GLfloat*) &s_tColor.r, 1);
@@ -456,6 +745,13 @@ void ccDrawCardinalSpline( CCPointArray *config, float tension,  unsigned int se
         vertices[i].y = newPos.y;
     }
 
+    if (s_bBatchingEnabled)
+    {
+        batchVertices(GL_LINE_STRIP, &vertices[0].x, 2, segments + 1, s_tColor);
+        CC_SAFE_DELETE_ARRAY(vertices);
+        return;
+    }
+
     s_pShader->use();
     s_pShader->setUniformsForBuiltins();
     s_pShader->setUniformLocationWith4fv(s_nColorLocation, (GLfloat*)&s_tColor.r, 1);
@@ -490,6 +786,13 @@ void ccDrawCubicBezier(const CCPoint& origin, const CCPoint& control1, const CCP
     vertices[segments].x = destination.x;
     vertices[segments].y = destination.y;
 
+    if (s_bBatchingEnabled)
+    {
+        batchVertices(GL_LINE_STRIP, &vertices[0].x, 2, segments + 1, s_tColor);
+        CC_SAFE_DELETE_ARRAY(vertices);
+        return;
+    }
+
     s_pShader->use();
     s_pShader->setUniformsForBuiltins();
     s_pShader->setUniformLocationWith4fv(s_nColorLocation, (GLfloat*) &s_tColor.r, 1);
@@ -524,6 +827,12 @@ void ccPointSize( GLfloat pointSize )
 
 }
 
+void ccLineWidth( GLfloat lineWidth )
+{
+    s_fLineWidth = lineWidth;
+    glLineWidth(lineWidth);
+}
+
 void ccDrawColor4B( GLubyte r, GLubyte g, GLubyte b, GLubyte a )
 {
     s_tColor.r = r/255.0f;
@@ -60,9 +60,9 @@ THE SOFTWARE.
  You can change the color, point size, width by calling:
  - ccDrawColor4B(), ccDrawColor4F()
  - ccPointSize()
- - glLineWidth()
+ - ccLineWidth()
  
- @warning These functions draws the Line, Point, Polygon, immediately. They aren't batched. If you are going to make a game that depends on these primitives, I suggest creating a batch. Instead you should use CCDrawNode
+ @warning These functions draws the Line, Point, Polygon, immediately unless ccDrawSetBatchingEnabled(true) was called. If you are going to make a game that depends on these primitives, I suggest creating a batch. Instead you should use CCDrawNode
  
  */
 
@@ -81,6 +81,27 @@ void CC_DLL ccDrawInit();
 /** Frees allocated resources by the drawing primitives */
 void CC_DLL ccDrawFree();
 
+/** Enables or disables batching. Disabled by default.
+ While it is enabled the primitives are not drawn right away: they are transformed by the current
+ modelview matrix and queued, then drawn by ccDrawFlush() in one draw call for the solid shapes and
+ points and one per line width, set with ccLineWidth(), for the lines. CCDirector flushes after drawing the scene, so the
+ batched primitives are drawn over it, and points are drawn as squares.
+ CCRenderTexture, CCGrid, CCClippingNode and CCScrollView flush before changing the render target,
+ the stencil or the scissor; call ccDrawFlush() yourself before changing such state.
+ @since v2.1.4
+ */
+void CC_DLL ccDrawSetBatchingEnabled( bool enabled );
+
+/** Returns whether the primitives are batched.
+ @since v2.1.4
+ */
+bool CC_DLL ccDrawIsBatchingEnabled();
+
+/** Draws the batched primitives, if any.
+ @since v2.1.4
+ */
+void CC_DLL ccDrawFlush();
+
 /** draws a point given x and y coordinate measured in points */
 void CC_DLL ccDrawPoint( const CCPoint& point );
 
@@ -152,6 +173,12 @@ void CC_DLL ccDrawColor4F( GLfloat r, GLfloat g, GLfloat b, GLfloat a );
  */
 void CC_DLL ccPointSize( GLfloat pointSize );
 
+/** sets the line width in pixels with glLineWidth(). Default 1.
+ The width is also kept on the CPU for the batched lines, which don't see the widths set with glLineWidth() directly.
+ @since v2.1.4
+ */
+void CC_DLL ccLineWidth( GLfloat lineWidth );
+
 // end of global group
 /// @}
 
@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "shaders/ccGLStateCache.h"
 #include "CCGL.h"
 #include "support/CCPointExtension.h"
+#include "draw_nodes/CCDrawingPrimitives.h"
 #include "support/TransformUtils.h"
 #include "kazmath/kazmath.h"
 #include "kazmath/GL/matrix.h"
@@ -199,6 +200,9 @@ void CCGridBase::set2DProjection()
 
 void CCGridBase::beforeDraw(void)
 {
+    // batched primitives drawn so far belong to the screen
+    ccDrawFlush();
+
     // save projection
     CCDirector *director = CCDirector::sharedDirector();
     m_directorProjection = director->getProjection();
@@ -211,6 +215,9 @@ void CCGridBase::beforeDraw(void)
 
 void CCGridBase::afterDraw(cocos2d::CCNode *pTarget)
 {
+    // and those drawn by the target to the grid texture
+    ccDrawFlush();
+
     m_pGrabber->afterRender(m_pTexture);
 
     // restore projection
@@ -122,6 +122,15 @@ public:
     ccVertex3F originalVertex(const CCPoint& pos);
     /** sets a new vertex at a given position */
     void setVertex(const CCPoint& pos, const ccVertex3F& vertex);
+    /** returns the (gridSize.width + 1) * (gridSize.height + 1) vertices, column by column:
+     the vertex at (x, y) has index x * (gridSize.height + 1) + y
+     @since v2.1.4
+     */
+    inline ccVertex3F* getVertices(void) { return (ccVertex3F*)m_pVertices; }
+    /** returns the original (non-transformed) vertices, laid out as getVertices()
+     @since v2.1.4
+     */
+    inline const ccVertex3F* getOriginalVertices(void) { return (const ccVertex3F*)m_pOriginalVertices; }
 
     virtual void blit(void);
     virtual void reuse(void);
@@ -159,6 +168,15 @@ public:
     ccQuad3 originalTile(const CCPoint& pos);
     /** sets a new tile */
     void setTile(const CCPoint& pos, const ccQuad3& coords);
+    /** returns the gridSize.width * gridSize.height tiles, column by column:
+     the tile at (x, y) has index x * gridSize.height + y
+     @since v2.1.4
+     */
+    inline ccQuad3* getTiles(void) { return (ccQuad3*)m_pVertices; }
+    /** returns the original (untransformed) tiles, laid out as getTiles()
+     @since v2.1.4
+     */
+    inline const ccQuad3* getOriginalTiles(void) { return (const ccQuad3*)m_pOriginalVertices; }
 
     virtual void blit(void);
     virtual void reuse(void);
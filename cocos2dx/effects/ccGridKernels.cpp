@@ -0,0 +1,264 @@
+/****************************************************************************
+Copyright (c) 2013 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#include "ccGridKernels.h"
+#include "support/image_support/ccPixelConversion.h"
+#include <math.h>
+#include <pthread.h>
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define CC_GRID_SSE2 1
+        #include <emmintrin.h>
+    #endif
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)
+    #define CC_GRID_NEON 1
+    #include <arm_neon.h>
+#endif
+
+NS_CC_BEGIN
+
+// sine: x = k * pi + r with |r| <= pi / 2, then sin(x) = (-1)^k * sin(r) and sin(r) is a degree 11
+// polynomial. pi is split in two so that k * CC_SIN_PI_HI is exact for |k| < 2^16.
+
+#define CC_SIN_INV_PI   0.318309886f
+#define CC_SIN_PI_HI    3.140625f
+#define CC_SIN_PI_LO    9.67653589793e-4f
+#define CC_SIN_C3       -1.66666667e-1f
+#define CC_SIN_C5       8.33333333e-3f
+#define CC_SIN_C7       -1.98412698e-4f
+#define CC_SIN_C9       2.75573192e-6f
+#define CC_SIN_C11      -2.50521084e-8f
+
+static inline float sinScalar(float x)
+{
+    float k = floorf(x * CC_SIN_INV_PI + 0.5f);
+    float r = (x - k * CC_SIN_PI_HI) - k * CC_SIN_PI_LO;
+    float r2 = r * r;
+    float s = r + r * r2 * (CC_SIN_C3 + r2 * (CC_SIN_C5 + r2 * (CC_SIN_C7 + r2 * (CC_SIN_C9 + r2 * CC_SIN_C11))));
+    return ((int)k & 1) ? -s : s;
+}
+
+#if defined(CC_GRID_SSE2)
+static inline __m128 sin4(__m128 x)
+{
+    // rounds to nearest, the default MXCSR mode
+    __m128i ki = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(CC_SIN_INV_PI)));
+    __m128 k = _mm_cvtepi32_ps(ki);
+    __m128 r = _mm_sub_ps(_mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(CC_SIN_PI_HI))), _mm_mul_ps(k, _mm_set1_ps(CC_SIN_PI_LO)));
+    __m128 r2 = _mm_mul_ps(r, r);
+    __m128 p = _mm_add_ps(_mm_set1_ps(CC_SIN_C9), _mm_mul_ps(r2, _mm_set1_ps(CC_SIN_C11)));
+    p = _mm_add_ps(_mm_set1_ps(CC_SIN_C7), _mm_mul_ps(r2, p));
+    p = _mm_add_ps(_mm_set1_ps(CC_SIN_C5), _mm_mul_ps(r2, p));
+    p = _mm_add_ps(_mm_set1_ps(CC_SIN_C3), _mm_mul_ps(r2, p));
+    __m128 s = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), p));
+    // odd k flips the sign bit
+    return _mm_xor_ps(s, _mm_castsi128_ps(_mm_slli_epi32(ki, 31)));
+}
+#endif
+
+#if defined(CC_GRID_NEON)
+static inline float32x4_t sin4(float32x4_t x)
+{
+    // vcvtq truncates: add +-0.5 to round to nearest
+    float32x4_t kf = vmulq_n_f32(x, CC_SIN_INV_PI);
+    uint32x4_t negative = vcltq_f32(kf, vdupq_n_f32(0.0f));
+    int32x4_t ki = vcvtq_s32_f32(vaddq_f32(kf, vbslq_f32(negative, vdupq_n_f32(-0.5f), vdupq_n_f32(0.5f))));
+    float32x4_t k = vcvtq_f32_s32(ki);
+    float32x4_t r = vmlsq_f32(vmlsq_f32(x, k, vdupq_n_f32(CC_SIN_PI_HI)), k, vdupq_n_f32(CC_SIN_PI_LO));
+    float32x4_t r2 = vmulq_f32(r, r);
+    float32x4_t p = vmlaq_f32(vdupq_n_f32(CC_SIN_C9), r2, vdupq_n_f32(CC_SIN_C11));
+    p = vmlaq_f32(vdupq_n_f32(CC_SIN_C7), r2, p);
+    p = vmlaq_f32(vdupq_n_f32(CC_SIN_C5), r2, p);
+    p = vmlaq_f32(vdupq_n_f32(CC_SIN_C3), r2, p);
+    float32x4_t s = vmlaq_f32(r, vmulq_f32(r, r2), p);
+    uint32x4_t sign = vshlq_n_u32(vreinterpretq_u32_s32(ki), 31);
+    return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(s), sign));
+}
+#endif
+
+void ccSinArray(const float *in, float *out, unsigned int count)
+{
+    unsigned int i = 0;
+#if defined(CC_GRID_SSE2)
+    if (ccGetCPUFeatures() & kCCCPUFeature_SSE2)
+    {
+        for (; i + 4 <= count; i += 4)
+        {
+            _mm_storeu_ps(out + i, sin4(_mm_loadu_ps(in + i)));
+        }
+    }
+#elif defined(CC_GRID_NEON)
+    if (ccGetCPUFeatures() & kCCCPUFeature_NEON)
+    {
+        for (; i + 4 <= count; i += 4)
+        {
+            vst1q_f32(out + i, sin4(vld1q_f32(in + i)));
+        }
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        out[i] = sinScalar(in[i]);
+    }
+}
+
+// worker threads
+
+struct GridWorker
+{
+    pthread_t       thread;
+    unsigned int    index;          // range index, 0 is the calling thread
+    unsigned int    generation;     // last job seen
+};
+
+static GridWorker *s_pWorkers = NULL;
+static unsigned int s_uWorkerCount = 0;
+static pthread_mutex_t s_workerMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_jobCondition = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t s_doneCondition = PTHREAD_COND_INITIALIZER;
+static unsigned int s_uGeneration = 0;
+static unsigned int s_uPending = 0;
+static bool s_bQuit = false;
+
+static CC_GRID_RANGE_FUNC s_pJobFunc = NULL;
+static void *s_pJobContext = NULL;
+static unsigned int s_uJobCount = 0;
+
+static void runRange(CC_GRID_RANGE_FUNC func, void *context, unsigned int count, unsigned int index, unsigned int ranges)
+{
+    unsigned int begin = (unsigned int)((unsigned long long)count * index / ranges);
+    unsigned int end = (unsigned int)((unsigned long long)count * (index + 1) / ranges);
+    if (begin < end)
+    {
+        func(context, begin, end);
+    }
+}
+
+static void* gridWorkerMain(void *data)
+{
+    GridWorker *pWorker = (GridWorker*)data;
+
+    pthread_mutex_lock(&s_workerMutex);
+    for (;;)
+    {
+        while (pWorker->generation == s_uGeneration && !s_bQuit)
+        {
+            pthread_cond_wait(&s_jobCondition, &s_workerMutex);
+        }
+        if (s_bQuit)
+        {
+            break;
+        }
+        pWorker->generation = s_uGeneration;
+
+        CC_GRID_RANGE_FUNC func = s_pJobFunc;
+        void *context = s_pJobContext;
+        unsigned int count = s_uJobCount;
+        pthread_mutex_unlock(&s_workerMutex);
+
+        runRange(func, context, count, pWorker->index, s_uWorkerCount + 1);
+
+        pthread_mutex_lock(&s_workerMutex);
+        if (--s_uPending == 0)
+        {
+            pthread_cond_signal(&s_doneCondition);
+        }
+    }
+    pthread_mutex_unlock(&s_workerMutex);
+    return NULL;
+}
+
+void ccGridSetWorkerThreadCount(unsigned int count)
+{
+    if (count == s_uWorkerCount)
+    {
+        return;
+    }
+
+    if (s_uWorkerCount > 0)
+    {
+        pthread_mutex_lock(&s_workerMutex);
+        s_bQuit = true;
+        pthread_cond_broadcast(&s_jobCondition);
+        pthread_mutex_unlock(&s_workerMutex);
+
+        for (unsigned int i = 0; i < s_uWorkerCount; ++i)
+        {
+            pthread_join(s_pWorkers[i].thread, NULL);
+        }
+        delete [] s_pWorkers;
+        s_pWorkers = NULL;
+        s_uWorkerCount = 0;
+        s_bQuit = false;
+    }
+
+    if (count > 0)
+    {
+        s_pWorkers = new GridWorker[count];
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            s_pWorkers[i].index = i + 1;
+            s_pWorkers[i].generation = s_uGeneration;
+            if (pthread_create(&s_pWorkers[i].thread, NULL, gridWorkerMain, &s_pWorkers[i]) != 0)
+            {
+                break;
+            }
+            s_uWorkerCount = i + 1;
+        }
+    }
+}
+
+unsigned int ccGridGetWorkerThreadCount(void)
+{
+    return s_uWorkerCount;
+}
+
+void ccGridParallelFor(unsigned int count, unsigned int itemCost, CC_GRID_RANGE_FUNC func, void *context)
+{
+    if (s_uWorkerCount == 0 || count < 2 || (unsigned long long)count * itemCost < kCCGridParallelMinCost)
+    {
+        func(context, 0, count);
+        return;
+    }
+
+    pthread_mutex_lock(&s_workerMutex);
+    s_pJobFunc = func;
+    s_pJobContext = context;
+    s_uJobCount = count;
+    s_uPending = s_uWorkerCount;
+    ++s_uGeneration;
+    pthread_cond_broadcast(&s_jobCondition);
+    pthread_mutex_unlock(&s_workerMutex);
+
+    runRange(func, context, count, 0, s_uWorkerCount + 1);
+
+    pthread_mutex_lock(&s_workerMutex);
+    while (s_uPending > 0)
+    {
+        pthread_cond_wait(&s_doneCondition, &s_workerMutex);
+    }
+    pthread_mutex_unlock(&s_workerMutex);
+}
+
+NS_CC_END
@@ -0,0 +1,71 @@
+/****************************************************************************
+Copyright (c) 2013 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#ifndef __EFFECTS_CCGRIDKERNELS_H__
+#define __EFFECTS_CCGRIDKERNELS_H__
+
+/** @file ccGridKernels.h
+Helpers of the grid actions (CCWaves3D, CCRipple3D, CCLiquid, CCTwirl, CCWavesTiles3D...), which update
+the flat vertex arrays of CCGrid3D and CCTiledGrid3D every frame.
+Sines are evaluated 4 at a time with SSE2 or NEON, and large grids can be split across worker threads.
+*/
+
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+/** out[i] = sin(in[i]) for count floats. in and out may be the same array.
+ A polynomial accurate to a few 1e-7 on [-pi, pi], that loses about 1e-7 per multiple of pi beyond.
+ Uses SSE2 or NEON when ccGetCPUFeatures reports them.
+*/
+CC_DLL void ccSinArray(const float *in, float *out, unsigned int count);
+
+/** function run by ccGridParallelFor on the items [begin, end) */
+typedef void (*CC_GRID_RANGE_FUNC)(void *context, unsigned int begin, unsigned int end);
+
+/** Runs func over the items [0, count), split in contiguous ranges.
+ When there are worker threads and count * itemCost reaches kCCGridParallelMinCost, the ranges run
+ on the workers and on the calling thread at the same time, so func must only write the items it is given.
+ Call it from the cocos2d thread only.
+*/
+CC_DLL void ccGridParallelFor(unsigned int count, unsigned int itemCost, CC_GRID_RANGE_FUNC func, void *context);
+
+/** below this cost (grid vertices, usually) ccGridParallelFor stays on the calling thread */
+enum {
+    kCCGridParallelMinCost = 8192,
+};
+
+/** Sets the number of threads helping the cocos2d thread with large grids.
+ 0, the default, keeps the grid actions on the cocos2d thread: the engine never starts workers by itself, so
+ the parallel path is only used by applications that call this. It pays off for grids of more than about
+ kCCGridParallelMinCost vertices, such as 128x96; the usual 15x10 grids always stay on the calling thread.
+ The "Waves3D, 2 grid threads" scene of EffectsTest runs one. Call it from the cocos2d thread only.
+*/
+CC_DLL void ccGridSetWorkerThreadCount(unsigned int count);
+
+/** returns the number of grid worker threads */
+CC_DLL unsigned int ccGridGetWorkerThreadCount(void);
+
+NS_CC_END
+
+#endif // __EFFECTS_CCGRIDKERNELS_H__
@@ -261,6 +261,28 @@ To enable set it to a value different than 0. Disabled by default.
 #define CC_ENABLE_PROFILERS 0
 #endif
 
+/** @def CC_ENABLE_POOL_ALLOCATOR
+ If enabled, the classes declared with CC_POOL_ALLOCATED() (actions, sprites, strings, touches, sets...)
+ are allocated by CCPoolAllocator instead of the system allocator.
+
+ To enable set it to a value different than 0. Disabled by default.
+ @since v2.1.4
+ */
+#ifndef CC_ENABLE_POOL_ALLOCATOR
+#define CC_ENABLE_POOL_ALLOCATOR 0
+#endif
+
+/** @def CC_USE_ZSTD
+ If enabled, CCZ files compressed with Zstandard (CCZ_COMPRESSION_ZSTD) can be loaded.
+ The application must then link against libzstd.
+
+ To enable set it to a value different than 0. Disabled by default.
+ @since v2.1.4
+ */
+#ifndef CC_USE_ZSTD
+#define CC_USE_ZSTD 0
+#endif
+
 /** Enable Lua engine debug log */
 #ifndef CC_LUA_ENGINE_DEBUG
 #define CC_LUA_ENGINE_DEBUG 0
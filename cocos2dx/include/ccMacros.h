@@ -246,6 +246,14 @@ It should work same as apples CFSwapInt32LittleToHost(..)
 extern unsigned int CC_DLL g_uNumberOfDraws;
 #define CC_INCREMENT_GL_DRAWS(__n__) g_uNumberOfDraws += __n__
 
+/** @def CC_INCREMENT_CULLED_NODES
+ Increments the count of nodes and batched sprites skipped by viewport culling.
+ The count per frame is displayed next to the GL draws when the CCDirector's stats and CCNode culling are enabled.
+ @since v2.1.4
+ */
+extern unsigned int CC_DLL g_uNumberOfCulledNodes;
+#define CC_INCREMENT_CULLED_NODES(__n__) g_uNumberOfCulledNodes += __n__
+
 /*******************/
 /** Notifications **/
 /*******************/
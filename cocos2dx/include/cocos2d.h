@@ -115,6 +115,7 @@ THE SOFTWARE.
 #include "misc_nodes/CCMotionStreak.h"
 #include "misc_nodes/CCProgressTimer.h"
 #include "misc_nodes/CCRenderTexture.h"
+#include "misc_nodes/CCRenderCacheNode.h"
 
 // particle_nodes
 #include "particle_nodes/CCParticleBatchNode.h"
@@ -229,6 +230,8 @@ THE SOFTWARE.
 #include "support/CCNotificationCenter.h"
 #include "support/CCPointExtension.h"
 #include "support/CCProfiling.h"
+#include "support/CCPoolAllocator.h"
+#include "support/CCFrameTimeHistogram.h"
 #include "support/user_default/CCUserDefault.h"
 #include "support/CCVertex.h"
 #include "support/tinyxml2/tinyxml2.h"
@@ -243,6 +246,8 @@ THE SOFTWARE.
 #include "textures/CCTextureAtlas.h"
 #include "textures/CCTextureCache.h"
 #include "textures/CCTexturePVR.h"
+#include "textures/CCTextureKTX.h"
+#include "textures/CCDynamicAtlas.h"
 
 // tilemap_parallax_nodes
 #include "tilemap_parallax_nodes/CCParallaxNode.h"
@@ -173,6 +173,8 @@ void CCLabelAtlas::updateAtlasValues()
         quad.br.colors = c;
         m_pTextureAtlas->updateQuad(&quad, i);
     }
+
+    invalidateRenderCache();
 }
 
 //CCLabelAtlas - CCLabelProtocol
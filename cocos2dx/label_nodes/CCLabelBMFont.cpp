@@ -52,8 +52,8 @@ static unsigned short* copyUTF16StringN(unsigned short* str)
 {
     int length = str ? cc_wcslen(str) : 0;
     unsigned short* ret = new unsigned short[length+1];
-    for (int i = 0; i < length; ++i) {
-        ret[i] = str[i];
+    if (length > 0) {
+        memcpy(ret, str, length * sizeof(unsigned short));
     }
     ret[length] = 0;
     return ret;
@@ -1079,20 +1079,9 @@ void CCLabelBMFont::updateLabel()
         }
 
         multiline_string.insert(multiline_string.end(), last_word.begin(), last_word.end());
+        multiline_string.push_back(0);
 
-        int size = multiline_string.size();
-        unsigned short* str_new = new unsigned short[size + 1];
-
-        for (int i = 0; i < size; ++i)
-        {
-            str_new[i] = multiline_string[i];
-        }
-
-        str_new[size] = '\0';
-
-        this->setString(str_new, false);
-        
-        CC_SAFE_DELETE_ARRAY(str_new);
+        this->setString(&multiline_string[0], false);
     }
 
     // Step 2: Make alignment
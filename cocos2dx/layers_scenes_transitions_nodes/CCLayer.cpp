@@ -531,6 +531,7 @@ GLubyte CCLayerRGBA::getDisplayedOpacity()
 void CCLayerRGBA::setOpacity(GLubyte opacity)
 {
 	_displayedOpacity = _realOpacity = opacity;
+    invalidateRenderCache();
     
 	if( _cascadeOpacityEnabled )
     {
@@ -557,6 +558,7 @@ const ccColor3B& CCLayerRGBA::getDisplayedColor()
 void CCLayerRGBA::setColor(const ccColor3B& color)
 {
 	_displayedColor = _realColor = color;
+    invalidateRenderCache();
 	
 	if (_cascadeColorEnabled)
     {
@@ -574,6 +576,7 @@ void CCLayerRGBA::setColor(const ccColor3B& color)
 void CCLayerRGBA::updateDisplayedOpacity(GLubyte parentOpacity)
 {
 	_displayedOpacity = _realOpacity * parentOpacity/255.0;
+    invalidateRenderCache();
     
     if (_cascadeOpacityEnabled)
     {
@@ -594,6 +597,7 @@ void CCLayerRGBA::updateDisplayedColor(const ccColor3B& parentColor)
 	_displayedColor.r = _realColor.r * parentColor.r/255.0;
 	_displayedColor.g = _realColor.g * parentColor.g/255.0;
 	_displayedColor.b = _realColor.b * parentColor.b/255.0;
+    invalidateRenderCache();
     
     if (_cascadeColorEnabled)
     {
@@ -767,6 +771,7 @@ void CCLayerColor::updateColor()
         m_pSquareColors[i].b = _displayedColor.b / 255.0f;
         m_pSquareColors[i].a = _displayedOpacity / 255.0f;
     }
+    invalidateRenderCache();
 }
 
 void CCLayerColor::draw()
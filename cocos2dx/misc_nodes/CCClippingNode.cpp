@@ -219,6 +219,9 @@ void CCClippingNode::visit()
     glGetIntegerv(GL_STENCIL_PASS_DEPTH_FAIL, (GLint *)&currentStencilPassDepthFail);
     glGetIntegerv(GL_STENCIL_PASS_DEPTH_PASS, (GLint *)&currentStencilPassDepthPass);
     
+    // batched primitives must not be clipped by this node
+    ccDrawFlush();
+
     // enable stencil use
     glEnable(GL_STENCIL_TEST);
     // check for OpenGL error while enabling stencil test
@@ -344,6 +347,7 @@ void CCClippingNode::visit()
     
     // draw (according to the stencil test func) this node and its childs
     CCNode::visit();
+    ccDrawFlush();
     
     ///////////////////////////////////
     // CLEANUP
@@ -318,6 +318,8 @@ void CCMotionStreak::update(float delta)
 
         m_uPreviousNuPoints = m_uNuPoints;
     }
+
+    invalidateRenderCache();
 }
 
 void CCMotionStreak::reset()
@@ -208,6 +208,8 @@ void CCProgressTimer::updateColor(void)
             m_pVertexData[i].colors = sc;
         }            
     }
+
+    invalidateRenderCache();
 }
 
 void CCProgressTimer::updateProgress(void)
@@ -223,6 +225,8 @@ void CCProgressTimer::updateProgress(void)
     default:
         break;
     }
+
+    invalidateRenderCache();
 }
 
 void CCProgressTimer::setAnchorPoint(CCPoint anchorPoint)
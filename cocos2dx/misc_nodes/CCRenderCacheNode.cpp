@@ -0,0 +1,257 @@
+/****************************************************************************
+Copyright (c) 2013 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#include "CCRenderCacheNode.h"
+#include "CCRenderTexture.h"
+#include "CCDirector.h"
+#include "effects/CCGrid.h"
+#include "cocoa/CCArray.h"
+#include "support/CCPointExtension.h"
+#include "kazmath/GL/matrix.h"
+#include <math.h>
+
+NS_CC_BEGIN
+
+CCRenderCacheNode::CCRenderCacheNode()
+: m_pRenderTexture(NULL)
+, m_bCacheDirty(true)
+, m_bCacheEnabled(true)
+, m_uCacheRenderCount(0)
+{
+}
+
+CCRenderCacheNode::~CCRenderCacheNode()
+{
+    CC_SAFE_RELEASE(m_pRenderTexture);
+}
+
+CCRenderCacheNode* CCRenderCacheNode::create()
+{
+    CCRenderCacheNode *pRet = new CCRenderCacheNode();
+    if (pRet && pRet->init())
+    {
+        pRet->autorelease();
+        return pRet;
+    }
+    CC_SAFE_DELETE(pRet);
+    return NULL;
+}
+
+CCRenderCacheNode* CCRenderCacheNode::create(const CCSize& size)
+{
+    CCRenderCacheNode *pRet = create();
+    if (pRet)
+    {
+        pRet->setContentSize(size);
+    }
+    return pRet;
+}
+
+bool CCRenderCacheNode::init()
+{
+    if (!CCNode::init())
+    {
+        return false;
+    }
+    setContentSize(CCDirector::sharedDirector()->getWinSize());
+    return true;
+}
+
+void CCRenderCacheNode::onEnter()
+{
+    CCNode::onEnter();
+
+    // the children may have changed while they were not running
+    invalidateCache();
+}
+
+void CCRenderCacheNode::setContentSize(const CCSize& size)
+{
+    if (!size.equals(m_obContentSize))
+    {
+        CC_SAFE_RELEASE_NULL(m_pRenderTexture);
+        m_bCacheDirty = true;
+    }
+    CCNode::setContentSize(size);
+}
+
+void CCRenderCacheNode::invalidateCache()
+{
+    m_bCacheDirty = true;
+
+    // a cache node inside another one
+    invalidateRenderCache();
+}
+
+bool CCRenderCacheNode::isCacheDirty()
+{
+    return m_bCacheDirty;
+}
+
+void CCRenderCacheNode::setCacheEnabled(bool bEnabled)
+{
+    if (bEnabled != m_bCacheEnabled)
+    {
+        m_bCacheEnabled = bEnabled;
+        if (!bEnabled)
+        {
+            CC_SAFE_RELEASE_NULL(m_pRenderTexture);
+        }
+        m_bCacheDirty = true;
+    }
+}
+
+bool CCRenderCacheNode::isCacheEnabled()
+{
+    return m_bCacheEnabled;
+}
+
+unsigned int CCRenderCacheNode::getCacheRenderCount()
+{
+    return m_uCacheRenderCount;
+}
+
+CCRenderCacheNode* CCRenderCacheNode::getRenderCacheForChildren()
+{
+    return this;
+}
+
+void CCRenderCacheNode::drawContent()
+{
+    unsigned int i = 0;
+
+    if (m_pChildren && m_pChildren->count() > 0)
+    {
+        sortAllChildren();
+        // draw children zOrder < 0
+        ccArray *arrayData = m_pChildren->data;
+        for ( ; i < arrayData->num; i++)
+        {
+            CCNode *pNode = (CCNode*) arrayData->arr[i];
+            if (pNode && pNode->getZOrder() < 0)
+            {
+                pNode->visit();
+            }
+            else
+            {
+                break;
+            }
+        }
+        // self draw
+        this->draw();
+
+        for ( ; i < arrayData->num; i++)
+        {
+            CCNode *pNode = (CCNode*) arrayData->arr[i];
+            if (pNode)
+            {
+                pNode->visit();
+            }
+        }
+    }
+    else
+    {
+        this->draw();
+    }
+}
+
+bool CCRenderCacheNode::renderCache()
+{
+    int width = (int)ceilf(m_obContentSize.width);
+    int height = (int)ceilf(m_obContentSize.height);
+    if (width <= 0 || height <= 0)
+    {
+        return false;
+    }
+
+    if (!m_pRenderTexture)
+    {
+        m_pRenderTexture = CCRenderTexture::create(width, height, kCCTexture2DPixelFormat_RGBA8888);
+        if (!m_pRenderTexture)
+        {
+            return false;
+        }
+        m_pRenderTexture->retain();
+        // the sprite of the render texture is centered on its origin
+        m_pRenderTexture->setPosition(ccp(width * 0.5f, height * 0.5f));
+    }
+
+    // setters called while the children are drawn make the cache dirty again
+    m_bCacheDirty = false;
+    m_uCacheRenderCount++;
+
+    // CCRenderTexture::end() restores the viewport of the window, but this node may be drawn into another render texture
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    m_pRenderTexture->beginWithClear(0, 0, 0, 0);
+
+    // the texture maps the content box of this node, in its own coordinates. end() pops both matrices
+    kmMat4 orthoMatrix;
+    kmMat4OrthographicProjection(&orthoMatrix, 0, (float)width, 0, (float)height, -1024, 1024);
+    kmGLMatrixMode(KM_GL_PROJECTION);
+    kmGLLoadMatrix(&orthoMatrix);
+    kmGLMatrixMode(KM_GL_MODELVIEW);
+    kmGLLoadIdentity();
+
+    drawContent();
+
+    m_pRenderTexture->end();
+
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+    return true;
+}
+
+void CCRenderCacheNode::visit()
+{
+    // quick return if not visible. children won't be drawn.
+    if (!m_bVisible)
+    {
+        return;
+    }
+
+    // the descendants only report their changes while running, and grid effects need the real children
+    bool bCache = m_bCacheEnabled && m_bRunning && !(m_pGrid && m_pGrid->isActive());
+    if (bCache && m_bCacheDirty && !renderCache())
+    {
+        bCache = false;
+    }
+    if (!bCache || !m_pRenderTexture)
+    {
+        CCNode::visit();
+        return;
+    }
+
+    kmGLPushMatrix();
+
+    this->transform();
+    m_pRenderTexture->visit();
+
+    kmGLPopMatrix();
+
+    // reset for next frame
+    m_uOrderOfArrival = 0;
+}
+
+NS_CC_END
@@ -0,0 +1,112 @@
+/****************************************************************************
+Copyright (c) 2013 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#ifndef __MISCNODE_CCRENDER_CACHE_NODE_H__
+#define __MISCNODE_CCRENDER_CACHE_NODE_H__
+
+#include "base_nodes/CCNode.h"
+
+NS_CC_BEGIN
+
+class CCRenderTexture;
+
+/**
+ * @addtogroup misc_nodes
+ * @{
+ */
+
+/** CCRenderCacheNode is a subclass of CCNode.
+ It renders its children once into a CCRenderTexture, then draws that texture with a single
+ draw call until one of its descendants changes.
+
+ Use it for complex subtrees that rarely change, e.g. a panel made of dozens of
+ CCScale9Sprite, labels and sprites.
+
+ The setters that change how a node is drawn (position, scale, visibility, color, opacity,
+ texture, sprite frame, label string, children...) invalidate the cache automatically,
+ so running actions on descendants works, at the cost of a render into the texture
+ in each frame where something changed. Particle systems and motion streaks invalidate the
+ cache on every update: keep them out of cached subtrees.
+ After changing a descendant in another way, call invalidateRenderCache() on it,
+ or invalidateCache() on this node.
+
+ The cache covers the content size of the node, from its origin: whatever the children
+ draw outside of it is clipped. The content size defaults to the window size.
+ The children are rendered flat, without the 3D projection or the camera of the director,
+ and without a depth or stencil buffer, so CCClippingNode does not work inside the cache.
+ Semi transparent children are composited the way CCRenderTexture does.
+
+ @since v2.1.4
+ */
+class CC_DLL CCRenderCacheNode : public CCNode
+{
+public:
+    CCRenderCacheNode();
+    virtual ~CCRenderCacheNode();
+
+    /** creates a cache node as big as the window */
+    static CCRenderCacheNode* create();
+
+    /** creates a cache node of the given size, in points */
+    static CCRenderCacheNode* create(const CCSize& size);
+
+    virtual bool init();
+    virtual void onEnter();
+    virtual void visit();
+
+    /** A new size reallocates the cache texture */
+    virtual void setContentSize(const CCSize& size);
+
+    /** The children will be rendered into the cache again before the next draw */
+    void invalidateCache();
+    bool isCacheDirty();
+
+    /** When disabled the children are drawn every frame, as with a plain CCNode, and the texture is freed.
+     Default: true
+     */
+    void setCacheEnabled(bool bEnabled);
+    bool isCacheEnabled();
+
+    /** How many times the children were rendered into the cache. Useful to find what keeps invalidating it. */
+    unsigned int getCacheRenderCount();
+
+protected:
+    virtual CCRenderCacheNode* getRenderCacheForChildren();
+
+    /// renders the children into m_pRenderTexture, creating it if needed. Returns false if there is no texture to draw.
+    bool renderCache();
+    /// visits the children and draws this node, without the transform of this node
+    void drawContent();
+
+    CCRenderTexture *m_pRenderTexture;
+    bool m_bCacheDirty;
+    bool m_bCacheEnabled;
+    unsigned int m_uCacheRenderCount;
+};
+
+// end of misc_nodes group
+/// @}
+
+NS_CC_END
+
+#endif // __MISCNODE_CCRENDER_CACHE_NODE_H__
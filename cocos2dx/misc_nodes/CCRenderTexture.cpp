@@ -26,6 +26,7 @@ THE SOFTWARE.
 #include "CCConfiguration.h"
 #include "misc_nodes/CCRenderTexture.h"
 #include "CCDirector.h"
+#include "CCScheduler.h"
 #include "platform/platform.h"
 #include "platform/CCImage.h"
 #include "shaders/CCGLProgram.h"
@@ -38,6 +39,11 @@ THE SOFTWARE.
 #include "support/CCNotificationCenter.h"
 #include "CCEventType.h"
 #include "effects/CCGrid.h"
+#include "draw_nodes/CCDrawingPrimitives.h"
+#include "cocoa/CCString.h"
+#include <pthread.h>
+#include <queue>
+#include <vector>
 // extern
 #include "kazmath/GL/matrix.h"
 
@@ -361,6 +367,9 @@ bool CCRenderTexture::initWithWidthAndHeight(int w, int h, CCTexture2DPixelForma
 
 void CCRenderTexture::begin()
 {
+    // batched primitives drawn so far belong to the previous render target
+    ccDrawFlush();
+
     kmGLMatrixMode(KM_GL_PROJECTION);
 	kmGLPushMatrix();
 	kmGLMatrixMode(KM_GL_MODELVIEW);
@@ -461,6 +470,8 @@ void CCRenderTexture::beginWithClear(float r, float g, float b, float a, float d
 
 void CCRenderTexture::end()
 {
+    ccDrawFlush();
+
     CCDirector *director = CCDirector::sharedDirector();
     
     glBindFramebuffer(GL_FRAMEBUFFER, m_nOldFBO);
@@ -702,4 +713,286 @@ CCImage* CCRenderTexture::newCCImage(bool flipImage)
     return pImage;
 }
 
+// --------------------- asynchronous readback ---------------------
+
+// Pixel buffer objects need glMapBuffer, which OpenGL ES 2.0 does not have
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32 || CC_TARGET_PLATFORM == CC_PLATFORM_MAC) && defined(GL_PIXEL_PACK_BUFFER)
+#define CC_RENDER_TEXTURE_USE_PBO 1
+#else
+#define CC_RENDER_TEXTURE_USE_PBO 0
+#endif
+
+// frames to wait before mapping a pixel buffer, so the GPU has finished writing it
+#define CC_READBACK_FRAME_DELAY 2
+
+typedef struct _AsyncReadback
+{
+    CCObject*       target;
+    SEL_CallFuncO   selector;
+    GLuint          pixelBuffer;        // 0 once the pixels are in memory
+    unsigned int    framesLeft;
+    int             width;
+    int             height;
+    unsigned char*  pixels;
+    bool            flip;
+    std::string     path;               // empty to hand the image to the target
+    CCImage*        image;
+    bool            succeeded;
+} AsyncReadback;
+
+static pthread_t                    s_readbackThread;
+static bool                         s_bReadbackThreadStarted = false;
+static pthread_mutex_t              s_readbackMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t               s_readbackCondition = PTHREAD_COND_INITIALIZER;
+static std::queue<AsyncReadback*>   s_readbackQueue;            // waiting for the worker
+static std::queue<AsyncReadback*>   s_readbackDoneQueue;        // waiting for the callback
+
+// flips and encodes the images read back, outside of the main thread
+static void* readbackWorker(void* data)
+{
+    for (;;)
+    {
+        pthread_mutex_lock(&s_readbackMutex);
+        while (s_readbackQueue.empty())
+        {
+            pthread_cond_wait(&s_readbackCondition, &s_readbackMutex);
+        }
+        AsyncReadback* job = s_readbackQueue.front();
+        s_readbackQueue.pop();
+        pthread_mutex_unlock(&s_readbackMutex);
+
+        if (job->pixels)
+        {
+            if (job->flip)
+            {
+                // glReadPixels returns the rows bottom up
+                int rowSize = job->width * 4;
+                unsigned char* row = new unsigned char[rowSize];
+                for (int i = 0; i < job->height / 2; ++i)
+                {
+                    unsigned char* top = job->pixels + i * rowSize;
+                    unsigned char* bottom = job->pixels + (job->height - i - 1) * rowSize;
+                    memcpy(row, top, rowSize);
+                    memcpy(top, bottom, rowSize);
+                    memcpy(bottom, row, rowSize);
+                }
+                delete [] row;
+            }
+
+            job->image = new CCImage();
+            job->succeeded = job->image->initWithImageData(job->pixels, job->width * job->height * 4, CCImage::kFmtRawData, job->width, job->height, 8);
+            CC_SAFE_DELETE_ARRAY(job->pixels);
+
+            if (! job->path.empty())
+            {
+                job->succeeded = job->succeeded && job->image->saveToFile(job->path.c_str(), true);
+                CC_SAFE_RELEASE_NULL(job->image);
+            }
+        }
+
+        pthread_mutex_lock(&s_readbackMutex);
+        s_readbackDoneQueue.push(job);
+        pthread_mutex_unlock(&s_readbackMutex);
+    }
+
+    return NULL;
+}
+
+// Polls the pending readbacks once per frame while there are some, independently of the
+// render textures that started them (they may be released before the readback completes).
+class CCRenderTextureReadbacks : public CCObject
+{
+public:
+    static CCRenderTextureReadbacks* sharedReadbacks()
+    {
+        static CCRenderTextureReadbacks* s_pSharedReadbacks = new CCRenderTextureReadbacks();
+        return s_pSharedReadbacks;
+    }
+
+    CCRenderTextureReadbacks() : m_uInFlight(0) {}
+
+    void add(AsyncReadback* job)
+    {
+        if (m_uInFlight++ == 0)
+        {
+            CCDirector::sharedDirector()->getScheduler()->scheduleSelector(schedule_selector(CCRenderTextureReadbacks::update), this, 0, false);
+        }
+
+        if (job->pixelBuffer)
+        {
+            m_pMapping.push_back(job);
+        }
+        else
+        {
+            encode(job);
+        }
+    }
+
+    void update(float dt)
+    {
+        // map the pixel buffers the GPU should be done with
+        for (unsigned int i = 0; i < m_pMapping.size(); )
+        {
+            AsyncReadback* job = m_pMapping[i];
+            if (--job->framesLeft > 0)
+            {
+                ++i;
+                continue;
+            }
+            m_pMapping.erase(m_pMapping.begin() + i);
+            mapPixelBuffer(job);
+            encode(job);
+        }
+
+        // and call back for the finished ones
+        for (;;)
+        {
+            pthread_mutex_lock(&s_readbackMutex);
+            AsyncReadback* job = NULL;
+            if (! s_readbackDoneQueue.empty())
+            {
+                job = s_readbackDoneQueue.front();
+                s_readbackDoneQueue.pop();
+            }
+            pthread_mutex_unlock(&s_readbackMutex);
+
+            if (! job)
+            {
+                break;
+            }
+
+            if (job->target && job->selector)
+            {
+                if (job->path.empty())
+                {
+                    (job->target->*job->selector)(job->succeeded ? job->image : NULL);
+                }
+                else
+                {
+                    (job->target->*job->selector)(job->succeeded ? CCString::create(job->path) : NULL);
+                }
+            }
+            CC_SAFE_RELEASE(job->image);
+            CC_SAFE_RELEASE(job->target);
+            delete job;
+
+            if (--m_uInFlight == 0)
+            {
+                CCDirector::sharedDirector()->getScheduler()->unscheduleSelector(schedule_selector(CCRenderTextureReadbacks::update), this);
+            }
+        }
+    }
+
+private:
+    void mapPixelBuffer(AsyncReadback* job)
+    {
+#if CC_RENDER_TEXTURE_USE_PBO
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, job->pixelBuffer);
+        void* mapped = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+        if (mapped)
+        {
+            memcpy(job->pixels, mapped, job->width * job->height * 4);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        else
+        {
+            CCLOG("cocos2d: CCRenderTexture: failed to map the pixel buffer");
+            CC_SAFE_DELETE_ARRAY(job->pixels);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        glDeleteBuffers(1, &job->pixelBuffer);
+#endif
+        job->pixelBuffer = 0;
+    }
+
+    void encode(AsyncReadback* job)
+    {
+        pthread_mutex_lock(&s_readbackMutex);
+        if (! s_bReadbackThreadStarted)
+        {
+            s_bReadbackThreadStarted = pthread_create(&s_readbackThread, NULL, readbackWorker, NULL) == 0;
+            if (s_bReadbackThreadStarted)
+            {
+                pthread_detach(s_readbackThread);
+            }
+        }
+        s_readbackQueue.push(job);
+        pthread_cond_signal(&s_readbackCondition);
+        pthread_mutex_unlock(&s_readbackMutex);
+
+        if (! s_bReadbackThreadStarted)
+        {
+            CCLOG("cocos2d: CCRenderTexture: failed to start the readback thread");
+        }
+    }
+
+    std::vector<AsyncReadback*> m_pMapping;
+    unsigned int m_uInFlight;
+};
+
+bool CCRenderTexture::readImageAsync(CCObject *target, SEL_CallFuncO selector, bool flipImage)
+{
+    return startReadback(target, selector, flipImage, std::string());
+}
+
+bool CCRenderTexture::saveToFileAsync(const char *fileName, tCCImageFormat format, CCObject *target, SEL_CallFuncO selector)
+{
+    CCAssert(format == kCCImageFormatJPEG || format == kCCImageFormatPNG,
+             "the image can only be saved as JPG or PNG format");
+
+    std::string fullpath = CCFileUtils::sharedFileUtils()->getWritablePath() + fileName;
+    return startReadback(target, selector, true, fullpath);
+}
+
+bool CCRenderTexture::startReadback(CCObject *target, SEL_CallFuncO selector, bool flipImage, const std::string& path)
+{
+    CCAssert(m_ePixelFormat == kCCTexture2DPixelFormat_RGBA8888, "only RGBA8888 can be saved as image");
+
+    if (NULL == m_pTexture)
+    {
+        return false;
+    }
+
+    const CCSize& s = m_pTexture->getContentSizeInPixels();
+    int width = (int)s.width;
+    int height = (int)s.height;
+
+    AsyncReadback* job = new AsyncReadback();
+    job->target = target;
+    job->selector = selector;
+    job->pixelBuffer = 0;
+    job->framesLeft = 0;
+    job->width = width;
+    job->height = height;
+    job->pixels = new unsigned char[width * height * 4];
+    job->flip = flipImage;
+    job->path = path;
+    job->image = NULL;
+    job->succeeded = false;
+
+    this->begin();
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+#if CC_RENDER_TEXTURE_USE_PBO
+    if (CCConfiguration::sharedConfiguration()->supportsPixelBufferObject())
+    {
+        // the read is queued into the buffer; it is mapped a few frames later
+        glGenBuffers(1, &job->pixelBuffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, job->pixelBuffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, width * height * 4, NULL, GL_STREAM_READ);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        job->framesLeft = CC_READBACK_FRAME_DELAY;
+    }
+    else
+#endif
+    {
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, job->pixels);
+    }
+    this->end();
+
+    CC_SAFE_RETAIN(job->target);
+    CCRenderTextureReadbacks::sharedReadbacks()->add(job);
+    return true;
+}
+
 NS_CC_END
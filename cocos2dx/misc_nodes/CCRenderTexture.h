@@ -124,6 +124,24 @@ public:
         Returns YES if the operation is successful.
      */
     bool saveToFile(const char *name, tCCImageFormat format);
+
+    /** reads the texture back without waiting for the GPU, then flips it on a worker thread.
+     On a later frame selector is called on target with the CCImage, or NULL if the read failed.
+     The image is released after the call: retain it to keep it.
+     Pixel buffer objects are used when CCConfiguration::supportsPixelBufferObject() is true;
+     otherwise the pixels are read synchronously and only the flip is deferred.
+     Returns false if the read could not be started.
+     @since v2.1.4
+     */
+    bool readImageAsync(CCObject *target, SEL_CallFuncO selector, bool flipImage = true);
+
+    /** saves the texture into a file like saveToFile(), but reads it back as readImageAsync() does
+     and encodes it on a worker thread. On a later frame selector is called on target with a
+     CCString holding the full path of the file, or NULL if it could not be saved.
+     Returns false if the read could not be started.
+     @since v2.1.4
+     */
+    bool saveToFileAsync(const char *name, tCCImageFormat format, CCObject *target, SEL_CallFuncO selector);
     
     /** Listen "come to background" message, and save render texture.
      It only has effect on Android.
@@ -159,6 +177,7 @@ public:
 
 private:
     void beginWithClear(float r, float g, float b, float a, float depthValue, int stencilValue, GLbitfield flags);
+    bool startReadback(CCObject *target, SEL_CallFuncO selector, bool flipImage, const std::string& path);
 
 protected:
     GLuint       m_uFBO;
@@ -604,6 +604,8 @@ void CCParticleSystem::update(float dt)
 {
     CC_PROFILER_START_CATEGORY(kCCProfilerCategoryParticles , "CCParticleSystem - update");
 
+    unsigned int uPreviousParticleCount = m_uParticleCount;
+
     if (m_bIsActive && m_fEmissionRate)
     {
         float rate = 1.0f / m_fEmissionRate;
@@ -766,6 +768,12 @@ void CCParticleSystem::update(float dt)
         postStep();
     }
 
+    // the particles moved, unless there were none in this frame and the previous one
+    if (uPreviousParticleCount || m_uParticleCount)
+    {
+        invalidateRenderCache();
+    }
+
     CC_PROFILER_STOP_CATEGORY(kCCProfilerCategoryParticles , "CCParticleSystem - update");
 }
 
@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "CCCommon.h"
 #include "CCStdC.h"
 #include "CCFileUtils.h"
+#include "support/image_support/ccPixelConversion.h"
 #include "png.h"
 #include "jpeglib.h"
 #include "tiffio.h"
@@ -450,15 +451,8 @@ bool CCImage::_initWithPngData(void * pData, int nDatalen)
         if (channel == 4)
         {
             m_bHasAlpha = true;
-            unsigned int *tmp = (unsigned int *)m_pData;
-            for(unsigned short i = 0; i < m_nHeight; i++)
-            {
-                for(unsigned int j = 0; j < rowbytes; j += 4)
-                {
-                    *tmp++ = CC_RGB_PREMULTIPLY_ALPHA( row_pointers[i][j], row_pointers[i][j + 1], 
-                                                      row_pointers[i][j + 2], row_pointers[i][j + 3] );
-                }
-            }
+            // the rows are contiguous in m_pData
+            ccPremultiplyAlphaRGBA8888(m_pData, m_nWidth * m_nHeight);
             
             m_bPreMulti = true;
         }
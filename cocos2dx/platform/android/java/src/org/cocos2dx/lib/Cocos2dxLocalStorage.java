@@ -101,6 +101,46 @@ public class Cocos2dxLocalStorage {
     	}
     }
     
+    public static void beginTransaction() {
+    	try {
+    		mDatabase.beginTransaction();
+    	} catch (Exception e) {
+    		e.printStackTrace();
+    	}
+    }
+    
+    public static void commitTransaction() {
+    	try {
+    		mDatabase.setTransactionSuccessful();
+    		mDatabase.endTransaction();
+    	} catch (Exception e) {
+    		e.printStackTrace();
+    	}
+    }
+    
+    public static boolean setJournalMode(String mode) {
+    	boolean ret = false;
+    	try {
+    		// the pragma returns the mode in use afterwards
+    		Cursor c = mDatabase.rawQuery("PRAGMA journal_mode=" + mode, null);
+    		if (c.moveToFirst()) {
+    			ret = mode.equalsIgnoreCase(c.getString(0));
+    		}
+    		c.close();
+    	} catch (Exception e) {
+    		e.printStackTrace();
+    	}
+    	return ret;
+    }
+    
+    public static void setSynchronous(int level) {
+    	try {
+    		mDatabase.execSQL("PRAGMA synchronous=" + level);
+    	} catch (Exception e) {
+    		e.printStackTrace();
+    	}
+    }
+    
 
     /**
      * This creates/opens the database.
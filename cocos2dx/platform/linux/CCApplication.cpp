@@ -5,11 +5,11 @@
  *      Author: laschweinski
  */
 #include "CCApplication.h"
-#include <unistd.h>
-#include <sys/time.h>
 #include <string>
 #include "CCDirector.h"
 #include "platform/CCFileUtils.h"
+#include "support/CCFrameTimeHistogram.h"
+#include "GL/glfw.h"
 
 NS_CC_BEGIN
 
@@ -17,15 +17,6 @@ NS_CC_BEGIN
 // sharedApplication pointer
 CCApplication * CCApplication::sm_pSharedApplication = 0;
 
-static long getCurrentMillSecond() {
-	long lLastTime;
-	struct timeval stCurrentTime;
-
-	gettimeofday(&stCurrentTime,NULL);
-	lLastTime = stCurrentTime.tv_sec*1000+stCurrentTime.tv_usec*0.001; //millseconds
-	return lLastTime;
-}
-
 CCApplication::CCApplication()
 {
 	CC_ASSERT(! sm_pSharedApplication);
@@ -36,7 +27,6 @@ CCApplication::~CCApplication()
 {
 	CC_ASSERT(this == sm_pSharedApplication);
 	sm_pSharedApplication = NULL;
-	m_nAnimationInterval = 1.0f/60.0f*1000.0f;
 }
 
 int CCApplication::run()
@@ -48,22 +38,28 @@ int CCApplication::run()
 	}
 
 
+	CCDirector* pDirector = CCDirector::sharedDirector();
 	for (;;) {
-		long iLastTime = getCurrentMillSecond();
-		CCDirector::sharedDirector()->mainLoop();
-		long iCurTime = getCurrentMillSecond();
-		if (iCurTime-iLastTime<m_nAnimationInterval){
-			usleep((m_nAnimationInterval - iCurTime+iLastTime)*1000);
-		}
-
+		pDirector->mainLoop();
+		m_obFramePacer.waitForNextFrame(pDirector->getFrameTimeHistogram());
 	}
 	return -1;
 }
 
 void CCApplication::setAnimationInterval(double interval)
 {
-	//TODO do something else
-	m_nAnimationInterval = interval*1000.0f;
+	m_obFramePacer.setInterval(interval);
+}
+
+void CCApplication::setVSyncEnabled(bool bEnabled)
+{
+	glfwSwapInterval(bEnabled ? 1 : 0);
+	m_obFramePacer.setVSyncEnabled(bEnabled);
+}
+
+bool CCApplication::isVSyncEnabled()
+{
+	return m_obFramePacer.isVSyncEnabled();
 }
 
 void CCApplication::setResourceRootPath(const std::string& rootResDir)
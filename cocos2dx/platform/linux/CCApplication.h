@@ -10,6 +10,7 @@
 
 #include "platform/CCCommon.h"
 #include "platform/CCApplicationProtocol.h"
+#include "CCFramePacer.h"
 #include <string>
 
 NS_CC_BEGIN
@@ -27,6 +28,13 @@ public:
 	 */
 	void setAnimationInterval(double interval);
 
+	/**
+	 @brief	Waits for the vertical sync when swapping the buffers, instead of sleeping until the next frame.
+	 Call it once the CCEGLView is created. Disabled by default.
+	 */
+	void setVSyncEnabled(bool bEnabled);
+	bool isVSyncEnabled();
+
 	/**
 	 @brief	Run the message loop.
 	 */
@@ -58,7 +66,7 @@ public:
      */
     virtual TargetPlatform getTargetPlatform();
 protected:
-    long       m_nAnimationInterval;  //micro second
+    CCFramePacer m_obFramePacer;
     std::string m_resourceRootPath;
     
 	static CCApplication * sm_pSharedApplication;
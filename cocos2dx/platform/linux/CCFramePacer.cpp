@@ -0,0 +1,128 @@
+/****************************************************************************
+Copyright (c) 2013 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#include "CCFramePacer.h"
+#include "support/CCFrameTimeHistogram.h"
+#include <time.h>
+#include <errno.h>
+
+NS_CC_BEGIN
+
+#define NSEC_PER_SEC            1000000000LL
+// bounds of the time the sleeps are cut short by
+#define MIN_SPIN_MARGIN         50000LL
+#define MAX_SPIN_MARGIN         4000000LL
+#define INITIAL_SPIN_MARGIN     1000000LL
+
+static long long getMonotonicTime()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * NSEC_PER_SEC + now.tv_nsec;
+}
+
+static void sleepUntil(long long deadline)
+{
+    struct timespec until;
+    until.tv_sec = deadline / NSEC_PER_SEC;
+    until.tv_nsec = deadline % NSEC_PER_SEC;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL) == EINTR)
+    {
+    }
+}
+
+CCFramePacer::CCFramePacer()
+: m_llInterval(NSEC_PER_SEC / 60)
+, m_llFrameStart(0)
+, m_llSpinMargin(INITIAL_SPIN_MARGIN)
+, m_bVSyncEnabled(false)
+{
+}
+
+void CCFramePacer::setInterval(double interval)
+{
+    m_llInterval = (long long)(interval * NSEC_PER_SEC);
+}
+
+void CCFramePacer::waitForNextFrame(CCFrameTimeHistogram* pHistogram)
+{
+    long long now = getMonotonicTime();
+    if (m_llFrameStart == 0)
+    {
+        // first frame: nothing to measure yet
+        m_llFrameStart = now;
+        return;
+    }
+
+    long long deadline = m_llFrameStart + m_llInterval;
+    long long frameStart;
+    bool missed;
+
+    if (m_bVSyncEnabled)
+    {
+        // the swap already waited for the display, a frame is missed when a refresh is skipped
+        missed = now - m_llFrameStart > m_llInterval + m_llInterval / 2;
+        frameStart = now;
+    }
+    else if (now > deadline)
+    {
+        missed = true;
+        frameStart = now;
+    }
+    else
+    {
+        missed = false;
+
+        long long wakeup = deadline - m_llSpinMargin;
+        if (wakeup > now)
+        {
+            sleepUntil(wakeup);
+
+            // the margin follows the latest late wake up, and slowly shrinks back when they are on time
+            long long late = getMonotonicTime() - wakeup;
+            long long decayed = m_llSpinMargin - m_llSpinMargin / 100;
+            m_llSpinMargin = late > decayed ? late : decayed;
+            if (m_llSpinMargin < MIN_SPIN_MARGIN)
+            {
+                m_llSpinMargin = MIN_SPIN_MARGIN;
+            }
+            else if (m_llSpinMargin > MAX_SPIN_MARGIN)
+            {
+                m_llSpinMargin = MAX_SPIN_MARGIN;
+            }
+        }
+
+        while (getMonotonicTime() < deadline)
+        {
+        }
+        frameStart = deadline;
+    }
+
+    if (pHistogram)
+    {
+        pHistogram->addFrame((frameStart - m_llFrameStart) / 1e6f, missed);
+    }
+    m_llFrameStart = frameStart;
+}
+
+NS_CC_END
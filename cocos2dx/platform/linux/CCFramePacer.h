@@ -0,0 +1,74 @@
+/****************************************************************************
+Copyright (c) 2013 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#ifndef __CC_FRAME_PACER_LINUX_H__
+#define __CC_FRAME_PACER_LINUX_H__
+
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+class CCFrameTimeHistogram;
+
+/** @brief Paces the main loop of CCApplication to the animation interval.
+
+ The deadlines are absolute times of CLOCK_MONOTONIC, one interval apart, so the sleeps don't
+ accumulate drift. The loop sleeps with clock_nanosleep() until a little before the deadline
+ and spins for the rest: the margin follows how late the sleeps wake up on this system.
+ A frame which ends after its deadline is a missed deadline; the next deadlines start again
+ from its end instead of rushing to catch up.
+
+ When the buffer swap waits for the vertical sync the pacer doesn't sleep, it only measures.
+ @since v2.1.4
+ */
+class CCFramePacer
+{
+public:
+    CCFramePacer();
+
+    /** time between two frames, in seconds */
+    void setInterval(double interval);
+    inline double getInterval() const { return m_llInterval / 1e9; }
+
+    /** set to true when the buffer swap waits for the vertical sync */
+    inline void setVSyncEnabled(bool bEnabled) { m_bVSyncEnabled = bEnabled; }
+    inline bool isVSyncEnabled() const { return m_bVSyncEnabled; }
+
+    /** Called after the frame is drawn: waits for its deadline, then counts its duration,
+     from the start of the previous frame, in pHistogram if it isn't NULL.
+     */
+    void waitForNextFrame(CCFrameTimeHistogram* pHistogram);
+
+    /** time the sleeps are cut short by, in nanoseconds */
+    inline long long getSpinMargin() const { return m_llSpinMargin; }
+
+private:
+    long long m_llInterval;
+    long long m_llFrameStart;
+    long long m_llSpinMargin;
+    bool m_bVSyncEnabled;
+};
+
+NS_CC_END
+
+#endif // __CC_FRAME_PACER_LINUX_H__
@@ -27,11 +27,13 @@ THE SOFTWARE.
 
 #include "CCDirector.h"
 #include "CCGLProgram.h"
+#include "CCShaderCache.h"
 #include "ccGLStateCache.h"
 #include "ccMacros.h"
 #include "platform/CCFileUtils.h"
 #include "support/data_support/uthash.h"
 #include "cocoa/CCString.h"
+#include "platform/platform.h"
 // extern
 #include "kazmath/GL/matrix.h"
 #include "kazmath/kazmath.h"
@@ -45,12 +47,37 @@ typedef struct _hashUniformEntry
     UT_hash_handle  hh;          // hash entry
 } tHashUniformEntry;
 
+// prepended to every shader source
+static const GLchar* s_pszShaderHeader =
+    "uniform mat4 CC_PMatrix;\n"
+    "uniform mat4 CC_MVMatrix;\n"
+    "uniform mat4 CC_MVPMatrix;\n"
+    "uniform vec4 CC_Time;\n"
+    "uniform vec4 CC_SinTime;\n"
+    "uniform vec4 CC_CosTime;\n"
+    "uniform vec4 CC_Random01;\n"
+    "//CC INCLUDES END\n\n";
+
+// 64 bits FNV-1a, the key of the program binaries
+static unsigned long long ccProgramHash(unsigned long long hash, const void* data, size_t length)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
 CCGLProgram::CCGLProgram()
 : m_uProgram(0)
 , m_uVertShader(0)
 , m_uFragShader(0)
 , m_pHashForUniforms(NULL)
 , m_bUsesTime(false)
+, m_bCompilePending(false)
+, m_uBinaryKey(0)
+, m_fBuildTime(0)
 {
     memset(m_uUniforms, 0, sizeof(m_uUniforms));
 }
@@ -85,6 +112,34 @@ bool CCGLProgram::initWithVertexShaderByteArray(const GLchar* vShaderByteArray,
     CHECK_GL_ERROR_DEBUG();
 
     m_uVertShader = m_uFragShader = 0;
+    m_pHashForUniforms = NULL;
+    m_fBuildTime = 0;
+
+    const GLchar* sources[] = { s_pszShaderHeader, vShaderByteArray, fShaderByteArray };
+    m_uBinaryKey = 14695981039346656037ULL;
+    for (unsigned int i = 0; i < sizeof(sources) / sizeof(sources[0]); i++)
+    {
+        // the terminator tells a missing shader from an empty one
+        m_uBinaryKey = sources[i] ? ccProgramHash(m_uBinaryKey, sources[i], strlen(sources[i]) + 1) : ccProgramHash(m_uBinaryKey, "", 0);
+    }
+
+    m_bCompilePending = CCShaderCache::sharedShaderCache()->isProgramBinaryCacheEnabled();
+    if (m_bCompilePending)
+    {
+        // link() compiles them if the program isn't cached
+        m_sVertSource = vShaderByteArray ? vShaderByteArray : "";
+        m_sFragSource = fShaderByteArray ? fShaderByteArray : "";
+        return true;
+    }
+
+    compileShaders(vShaderByteArray, fShaderByteArray);
+    return true;
+}
+
+void CCGLProgram::compileShaders(const GLchar* vShaderByteArray, const GLchar* fShaderByteArray)
+{
+    struct cc_timeval start, end;
+    CCTime::gettimeofdayCocos2d(&start, NULL);
 
     if (vShaderByteArray)
     {
@@ -113,11 +168,11 @@ bool CCGLProgram::initWithVertexShaderByteArray(const GLchar* vShaderByteArray,
     {
         glAttachShader(m_uProgram, m_uFragShader);
     }
-    m_pHashForUniforms = NULL;
     
     CHECK_GL_ERROR_DEBUG();
 
-    return true;
+    CCTime::gettimeofdayCocos2d(&end, NULL);
+    m_fBuildTime += (float)CCTime::timersubCocos2d(&start, &end);
 }
 
 bool CCGLProgram::initWithVertexShaderFilename(const char* vShaderFilename, const char* fShaderFilename)
@@ -149,14 +204,7 @@ bool CCGLProgram::compileShader(GLuint * shader, GLenum type, const GLchar* sour
 #if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32 && CC_TARGET_PLATFORM != CC_PLATFORM_LINUX && CC_TARGET_PLATFORM != CC_PLATFORM_MAC)
         (type == GL_VERTEX_SHADER ? "precision highp float;\n" : "precision mediump float;\n"),
 #endif
-        "uniform mat4 CC_PMatrix;\n"
-        "uniform mat4 CC_MVMatrix;\n"
-        "uniform mat4 CC_MVPMatrix;\n"
-        "uniform vec4 CC_Time;\n"
-        "uniform vec4 CC_SinTime;\n"
-        "uniform vec4 CC_CosTime;\n"
-        "uniform vec4 CC_Random01;\n"
-        "//CC INCLUDES END\n\n",
+        s_pszShaderHeader,
         source,
     };
 
@@ -193,6 +241,10 @@ bool CCGLProgram::compileShader(GLuint * shader, GLenum type, const GLchar* sour
 void CCGLProgram::addAttribute(const char* attributeName, GLuint index)
 {
     glBindAttribLocation(m_uProgram, index, attributeName);
+
+    // the bindings are part of the linked binary
+    m_uBinaryKey = ccProgramHash(m_uBinaryKey, attributeName, strlen(attributeName) + 1);
+    m_uBinaryKey = ccProgramHash(m_uBinaryKey, &index, sizeof(index));
 }
 
 void CCGLProgram::updateUniforms()
@@ -226,7 +278,28 @@ bool CCGLProgram::link()
     CCAssert(m_uProgram != 0, "Cannot link invalid program");
     
     GLint status = GL_TRUE;
-    
+    CCShaderCache* pCache = CCShaderCache::sharedShaderCache();
+    bool bStoreBinary = m_bCompilePending;
+
+    if (m_bCompilePending)
+    {
+        m_bCompilePending = false;
+        if (pCache->loadProgramBinary(m_uProgram, m_uBinaryKey))
+        {
+            m_sVertSource.clear();
+            m_sFragSource.clear();
+            return true;
+        }
+
+        compileShaders(m_sVertSource.empty() ? NULL : m_sVertSource.c_str(), m_sFragSource.empty() ? NULL : m_sFragSource.c_str());
+        m_sVertSource.clear();
+        m_sFragSource.clear();
+        pCache->prepareProgramBinary(m_uProgram);
+    }
+
+    struct cc_timeval start, end;
+    CCTime::gettimeofdayCocos2d(&start, NULL);
+
     glLinkProgram(m_uProgram);
 
     if (m_uVertShader)
@@ -240,6 +313,18 @@ bool CCGLProgram::link()
     }
     
     m_uVertShader = m_uFragShader = 0;
+
+    CCTime::gettimeofdayCocos2d(&end, NULL);
+    pCache->addProgramBuildTime(m_fBuildTime + (float)CCTime::timersubCocos2d(&start, &end));
+
+    if (bStoreBinary)
+    {
+        glGetProgramiv(m_uProgram, GL_LINK_STATUS, &status);
+        if (status == GL_TRUE)
+        {
+            pCache->storeProgramBinary(m_uProgram, m_uBinaryKey);
+        }
+    }
 	
 #if DEBUG
     glGetProgramiv(m_uProgram, GL_LINK_STATUS, &status);
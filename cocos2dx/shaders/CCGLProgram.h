@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "cocoa/CCObject.h"
 
 #include "CCGL.h"
+#include <string>
 
 NS_CC_BEGIN
 
@@ -192,6 +193,7 @@ private:
     bool updateUniformLocation(GLint location, GLvoid* data, unsigned int bytes);
     const char* description();
     bool compileShader(GLuint * shader, GLenum type, const GLchar* source);
+    void compileShaders(const GLchar* vShaderByteArray, const GLchar* fShaderByteArray);
     const char* logForOpenGLObject(GLuint object, GLInfoFunction infoFunc, GLLogFunction logFunc);
 
 private:
@@ -201,6 +203,13 @@ private:
     GLint             m_uUniforms[kCCUniform_MAX];
     struct _hashUniformEntry* m_pHashForUniforms;
     bool              m_bUsesTime;
+
+    // compiling waits for link() when the program may be loaded from the CCShaderCache binary cache
+    bool              m_bCompilePending;
+    std::string       m_sVertSource;
+    std::string       m_sFragSource;
+    unsigned long long m_uBinaryKey;    // hash of the sources and attribute bindings
+    float             m_fBuildTime;     // milliseconds spent compiling so far
 };
 
 // end of shaders group
@@ -28,6 +28,33 @@ THE SOFTWARE.
 #include "CCGLProgram.h"
 #include "ccMacros.h"
 #include "ccShaders.h"
+#include "CCConfiguration.h"
+#include "platform/CCFileUtils.h"
+#include "platform/platform.h"
+#include <stdio.h>
+
+// glGetProgramBinary / glProgramBinary entry points of the platforms that can have them
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
+#define CC_PROGRAM_BINARY_SUPPORTED         1
+#define ccGetProgramBinary                  glGetProgramBinaryOES
+#define ccProgramBinary                     glProgramBinaryOES
+#define CC_GL_PROGRAM_BINARY_LENGTH         GL_PROGRAM_BINARY_LENGTH_OES
+#define CC_GL_NUM_PROGRAM_BINARY_FORMATS    GL_NUM_PROGRAM_BINARY_FORMATS_OES
+#elif (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+#define CC_PROGRAM_BINARY_SUPPORTED         1
+#define ccGetProgramBinary                  glGetProgramBinary
+#define ccProgramBinary                     glProgramBinary
+#define CC_GL_PROGRAM_BINARY_LENGTH         GL_PROGRAM_BINARY_LENGTH
+#define CC_GL_NUM_PROGRAM_BINARY_FORMATS    GL_NUM_PROGRAM_BINARY_FORMATS
+#else
+#define CC_PROGRAM_BINARY_SUPPORTED         0
+#endif
+
+// file layout: signature, version, driver string, count, then per program: key, format, size, binary
+#define CC_PROGRAM_BINARY_FILE              "cc_program_binaries.bin"
+#define CC_PROGRAM_BINARY_SIGNATURE         "CCPB"
+#define CC_PROGRAM_BINARY_VERSION           1
+#define CC_PROGRAM_BINARY_MAX_SIZE          (16 * 1024 * 1024)
 
 NS_CC_BEGIN
 
@@ -65,6 +92,13 @@ void CCShaderCache::purgeSharedShaderCache()
 
 CCShaderCache::CCShaderCache()
 : m_pPrograms(0)
+, m_bProgramBinaryCacheEnabled(false)
+, m_bProgramBinariesLoaded(false)
+, m_bProgramBinariesDirty(false)
+, m_uProgramBinaryHits(0)
+, m_uProgramsBuilt(0)
+, m_fProgramBinaryLoadTime(0)
+, m_fProgramBuildTime(0)
 {
 
 }
@@ -72,12 +106,14 @@ CCShaderCache::CCShaderCache()
 CCShaderCache::~CCShaderCache()
 {
     CCLOGINFO("cocos2d deallocing 0x%X", this);
+    saveProgramBinaryCache();
     m_pPrograms->release();
 }
 
 bool CCShaderCache::init()
 {
     m_pPrograms = new CCDictionary();
+    setProgramBinaryCacheEnabled(true);
     loadDefaultShaders();
     return true;
 }
@@ -151,6 +187,8 @@ void CCShaderCache::loadDefaultShaders()
     
     m_pPrograms->setObject(p, kCCShader_PositionLengthTexureColor);
     p->release();
+
+    saveProgramBinaryCache();
 }
 
 void CCShaderCache::reloadDefaultShaders()
@@ -207,7 +245,9 @@ void CCShaderCache::reloadDefaultShaders()
 	//
     p = programForKey(kCCShader_PositionLengthTexureColor);
     p->reset();
-    loadDefaultShader(p, kCCShaderType_Position_uColor);
+    loadDefaultShader(p, kCCShaderType_PositionLengthTexureColor);
+
+    saveProgramBinaryCache();
 }
 
 void CCShaderCache::loadDefaultShader(CCGLProgram *p, int type)
@@ -293,4 +333,267 @@ void CCShaderCache::addProgram(CCGLProgram* program, const char* key)
     m_pPrograms->setObject(program, key);
 }
 
+void CCShaderCache::setProgramBinaryCacheEnabled(bool bEnabled)
+{
+#if CC_PROGRAM_BINARY_SUPPORTED
+    if (bEnabled && CCConfiguration::sharedConfiguration()->supportsProgramBinary())
+    {
+        // some drivers expose the extension without any binary format
+        GLint nFormats = 0;
+        glGetIntegerv(CC_GL_NUM_PROGRAM_BINARY_FORMATS, &nFormats);
+        m_bProgramBinaryCacheEnabled = nFormats > 0;
+    }
+    else
+    {
+        m_bProgramBinaryCacheEnabled = false;
+    }
+#else
+    m_bProgramBinaryCacheEnabled = false;
+#endif
+}
+
+bool CCShaderCache::isProgramBinaryCacheEnabled()
+{
+    return m_bProgramBinaryCacheEnabled;
+}
+
+std::string CCShaderCache::programBinaryFilePath()
+{
+    return CCFileUtils::sharedFileUtils()->getWritablePath() + CC_PROGRAM_BINARY_FILE;
+}
+
+std::string CCShaderCache::programBinaryDriver()
+{
+    // binaries are only valid for the driver that produced them
+    const GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+    std::string driver;
+    for (unsigned int i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        const char *pszName = (const char *)glGetString(names[i]);
+        driver += pszName ? pszName : "";
+        driver += '\n';
+    }
+    return driver;
+}
+
+void CCShaderCache::loadProgramBinaryFile()
+{
+    m_bProgramBinariesLoaded = true;
+
+    FILE *fp = fopen(programBinaryFilePath().c_str(), "rb");
+    if (!fp)
+    {
+        return;
+    }
+
+    std::string driver = programBinaryDriver();
+    char signature[4];
+    unsigned int version = 0, driverLength = 0, count = 0;
+    bool bValid = fread(signature, 1, 4, fp) == 4 && memcmp(signature, CC_PROGRAM_BINARY_SIGNATURE, 4) == 0
+        && fread(&version, sizeof(version), 1, fp) == 1 && version == CC_PROGRAM_BINARY_VERSION
+        && fread(&driverLength, sizeof(driverLength), 1, fp) == 1 && driverLength == driver.size();
+
+    if (bValid)
+    {
+        std::vector<char> fileDriver(driverLength + 1);
+        bValid = fread(&fileDriver[0], 1, driverLength, fp) == driverLength
+            && driver.compare(0, driverLength, &fileDriver[0], driverLength) == 0
+            && fread(&count, sizeof(count), 1, fp) == 1;
+    }
+
+    for (unsigned int i = 0; bValid && i < count; i++)
+    {
+        unsigned long long key = 0;
+        unsigned int format = 0, size = 0;
+        bValid = fread(&key, sizeof(key), 1, fp) == 1
+            && fread(&format, sizeof(format), 1, fp) == 1
+            && fread(&size, sizeof(size), 1, fp) == 1
+            && size > 0 && size <= CC_PROGRAM_BINARY_MAX_SIZE;
+        if (bValid)
+        {
+            ProgramBinary &binary = m_obProgramBinaries[key];
+            binary.format = format;
+            binary.data.resize(size);
+            bValid = fread(&binary.data[0], 1, size, fp) == size;
+        }
+    }
+    fclose(fp);
+
+    if (!bValid)
+    {
+        // written by another driver or version, or truncated: start over
+        CCLOG("cocos2d: CCShaderCache: discarding stale program binaries");
+        m_obProgramBinaries.clear();
+        m_bProgramBinariesDirty = true;
+    }
+}
+
+void CCShaderCache::saveProgramBinaryCache()
+{
+    if (!m_bProgramBinariesDirty)
+    {
+        return;
+    }
+    m_bProgramBinariesDirty = false;
+
+    std::string path = programBinaryFilePath();
+    if (m_obProgramBinaries.empty())
+    {
+        remove(path.c_str());
+        return;
+    }
+
+    FILE *fp = fopen(path.c_str(), "wb");
+    if (!fp)
+    {
+        CCLOG("cocos2d: CCShaderCache: can't write %s", path.c_str());
+        return;
+    }
+
+    std::string driver = programBinaryDriver();
+    unsigned int version = CC_PROGRAM_BINARY_VERSION;
+    unsigned int driverLength = driver.size();
+    unsigned int count = m_obProgramBinaries.size();
+    bool bWritten = fwrite(CC_PROGRAM_BINARY_SIGNATURE, 1, 4, fp) == 4
+        && fwrite(&version, sizeof(version), 1, fp) == 1
+        && fwrite(&driverLength, sizeof(driverLength), 1, fp) == 1
+        && fwrite(driver.data(), 1, driverLength, fp) == driverLength
+        && fwrite(&count, sizeof(count), 1, fp) == 1;
+
+    std::map<unsigned long long, ProgramBinary>::iterator it;
+    for (it = m_obProgramBinaries.begin(); bWritten && it != m_obProgramBinaries.end(); ++it)
+    {
+        unsigned int format = it->second.format;
+        unsigned int size = it->second.data.size();
+        bWritten = fwrite(&it->first, sizeof(it->first), 1, fp) == 1
+            && fwrite(&format, sizeof(format), 1, fp) == 1
+            && fwrite(&size, sizeof(size), 1, fp) == 1
+            && fwrite(&it->second.data[0], 1, size, fp) == size;
+    }
+
+    if (fclose(fp) != 0 || !bWritten)
+    {
+        // a partial file would be discarded when loaded, don't leave it around
+        CCLOG("cocos2d: CCShaderCache: can't write %s", path.c_str());
+        remove(path.c_str());
+    }
+}
+
+void CCShaderCache::removeProgramBinaryCache()
+{
+    m_obProgramBinaries.clear();
+    m_bProgramBinariesLoaded = true;
+    m_bProgramBinariesDirty = false;
+    remove(programBinaryFilePath().c_str());
+}
+
+void CCShaderCache::dumpProgramBinaryCacheInfo()
+{
+    unsigned int totalBytes = 0;
+    std::map<unsigned long long, ProgramBinary>::iterator it;
+    for (it = m_obProgramBinaries.begin(); it != m_obProgramBinaries.end(); ++it)
+    {
+        totalBytes += it->second.data.size();
+    }
+
+    CCLog("cocos2d: CCShaderCache: program binaries %s, %u cached (%.1f KB)",
+          m_bProgramBinaryCacheEnabled ? "enabled" : "disabled", (unsigned int)m_obProgramBinaries.size(), totalBytes / 1024.0f);
+    CCLog("cocos2d: CCShaderCache: %u programs loaded from binaries in %.2f ms, %u built from sources in %.2f ms",
+          m_uProgramBinaryHits, m_fProgramBinaryLoadTime, m_uProgramsBuilt, m_fProgramBuildTime);
+}
+
+bool CCShaderCache::loadProgramBinary(GLuint program, unsigned long long key)
+{
+#if CC_PROGRAM_BINARY_SUPPORTED
+    if (!m_bProgramBinaryCacheEnabled)
+    {
+        return false;
+    }
+
+    if (!m_bProgramBinariesLoaded)
+    {
+        loadProgramBinaryFile();
+    }
+
+    std::map<unsigned long long, ProgramBinary>::iterator it = m_obProgramBinaries.find(key);
+    if (it == m_obProgramBinaries.end())
+    {
+        return false;
+    }
+
+    struct cc_timeval start, end;
+    CCTime::gettimeofdayCocos2d(&start, NULL);
+
+    ccProgramBinary(program, it->second.format, &it->second.data[0], it->second.data.size());
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE)
+    {
+        // rejected, e.g. after a driver update that kept its version string
+        CCLOG("cocos2d: CCShaderCache: program binary rejected, compiling the program");
+        glGetError();
+        m_obProgramBinaries.erase(it);
+        m_bProgramBinariesDirty = true;
+        return false;
+    }
+
+    CCTime::gettimeofdayCocos2d(&end, NULL);
+    m_fProgramBinaryLoadTime += (float)CCTime::timersubCocos2d(&start, &end);
+    m_uProgramBinaryHits++;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void CCShaderCache::prepareProgramBinary(GLuint program)
+{
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    if (m_bProgramBinaryCacheEnabled)
+    {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+#endif
+}
+
+void CCShaderCache::storeProgramBinary(GLuint program, unsigned long long key)
+{
+#if CC_PROGRAM_BINARY_SUPPORTED
+    if (!m_bProgramBinaryCacheEnabled)
+    {
+        return;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(program, CC_GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0 || length > CC_PROGRAM_BINARY_MAX_SIZE)
+    {
+        return;
+    }
+
+    ProgramBinary &binary = m_obProgramBinaries[key];
+    binary.data.resize(length);
+
+    GLsizei written = 0;
+    GLenum format = 0;
+    ccGetProgramBinary(program, length, &written, &format, &binary.data[0]);
+    if (written <= 0)
+    {
+        m_obProgramBinaries.erase(key);
+        return;
+    }
+
+    binary.format = format;
+    binary.data.resize(written);
+    m_bProgramBinariesDirty = true;
+#endif
+}
+
+void CCShaderCache::addProgramBuildTime(float fMilliseconds)
+{
+    m_uProgramsBuilt++;
+    m_fProgramBuildTime += fMilliseconds;
+}
+
 NS_CC_END
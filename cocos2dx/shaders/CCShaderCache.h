@@ -28,6 +28,9 @@ THE SOFTWARE.
 #define __CCSHADERCACHE_H__
 
 #include "cocoa/CCDictionary.h"
+#include "CCGL.h"
+#include <map>
+#include <vector>
 
 NS_CC_BEGIN
 
@@ -66,12 +69,85 @@ public:
     /** adds a CCGLProgram to the cache for a given name */
     void addProgram(CCGLProgram* program, const char* key);
 
+    /** Enables the on-disk cache of linked program binaries.
+     Programs whose sources, attributes and driver match a cached binary are loaded with
+     glProgramBinary instead of being compiled and linked, which shortens the cold start and
+     reloadDefaultShaders() after a context loss.
+     It is enabled by default when the driver supports program binaries.
+     @since v2.1.4
+     */
+    void setProgramBinaryCacheEnabled(bool bEnabled);
+
+    /** Whether or not programs are loaded from cached binaries
+     @since v2.1.4
+     */
+    bool isProgramBinaryCacheEnabled();
+
+    /** Writes the binaries added since the last save to the writable path.
+     Done after the default shaders are loaded; call it after creating custom programs.
+     @since v2.1.4
+     */
+    void saveProgramBinaryCache();
+
+    /** Removes the cached binaries from memory and disk
+     @since v2.1.4
+     */
+    void removeProgramBinaryCache();
+
+    /** Logs the binary cache hits and the time spent building programs
+     @since v2.1.4
+     */
+    void dumpProgramBinaryCacheInfo();
+
+    /** Loads the binary cached for key into program. Returns false if there is none or the
+     driver rejected it, in which case the program must be compiled.
+     Used by CCGLProgram.
+     @since v2.1.4
+     */
+    bool loadProgramBinary(GLuint program, unsigned long long key);
+
+    /** Prepares program, before it is linked, for storeProgramBinary().
+     Used by CCGLProgram.
+     @since v2.1.4
+     */
+    void prepareProgramBinary(GLuint program);
+
+    /** Caches the binary of a linked program under key.
+     Used by CCGLProgram.
+     @since v2.1.4
+     */
+    void storeProgramBinary(GLuint program, unsigned long long key);
+
+    /** Accounts time spent compiling and linking a program from its sources.
+     Used by CCGLProgram.
+     @since v2.1.4
+     */
+    void addProgramBuildTime(float fMilliseconds);
+
 private:
     bool init();
     void loadDefaultShader(CCGLProgram *program, int type);
+    void loadProgramBinaryFile();
+    std::string programBinaryFilePath();
+    std::string programBinaryDriver();
 
     CCDictionary* m_pPrograms;
 
+    struct ProgramBinary
+    {
+        GLenum format;
+        std::vector<unsigned char> data;
+    };
+    std::map<unsigned long long, ProgramBinary> m_obProgramBinaries;
+    bool m_bProgramBinaryCacheEnabled;
+    bool m_bProgramBinariesLoaded;
+    bool m_bProgramBinariesDirty;
+
+    unsigned int m_uProgramBinaryHits;
+    unsigned int m_uProgramsBuilt;
+    float m_fProgramBinaryLoadTime;
+    float m_fProgramBuildTime;
+
 };
 
 // end of shaders group
@@ -87,7 +87,7 @@ void CCAnimationCache::removeAnimationByName(const char* name)
 
 CCAnimation* CCAnimationCache::animationByName(const char* name)
 {
-    return (CCAnimation*)m_pAnimations->objectForKey(name);
+    return (CCAnimation*)m_pAnimations->objectForKey(CCDictKey(name));
 }
 
 void CCAnimationCache::parseVersion1(CCDictionary* animations)
@@ -219,6 +219,13 @@ bool CCSprite::initWithFile(const char *pszFilename)
 {
     CCAssert(pszFilename != NULL, "Invalid filename for sprite");
 
+    // packed into the dynamic atlas, if any, so it can be batched with the other loose images
+    CCSpriteFrame *pFrame = CCTextureCache::sharedTextureCache()->addImageToDynamicAtlas(pszFilename);
+    if (pFrame)
+    {
+        return initWithSpriteFrame(pFrame);
+    }
+
     CCTexture2D *pTexture = CCTextureCache::sharedTextureCache()->addImage(pszFilename);
     if (pTexture)
     {
@@ -355,6 +362,8 @@ void CCSprite::setTextureRect(const CCRect& rect, bool rotated, const CCSize& un
         m_sQuad.tl.vertices = vertex3(x1, y2, 0);
         m_sQuad.tr.vertices = vertex3(x2, y2, 0);
     }
+
+    invalidateRenderCache();
 }
 
 // override this method to generate "double scale" sprites
@@ -929,6 +938,8 @@ void CCSprite::updateColor(void)
 
     // self render
     // do nothing
+
+    invalidateRenderCache();
 }
 
 void CCSprite::setOpacity(GLubyte opacity)
@@ -1091,6 +1102,7 @@ void CCSprite::setTexture(CCTexture2D *texture)
         CC_SAFE_RELEASE(m_pobTexture);
         m_pobTexture = texture;
         updateBlendFunc();
+        invalidateRenderCache();
     }
 }
 
@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "textures/CCTextureAtlas.h"
 #include "ccTypes.h"
 #include "cocoa/CCDictionary.h"
+#include "support/CCPoolAllocator.h"
 #include <string>
 #ifdef EMSCRIPTEN
 #include "base_nodes/CCGLBufferedNode.h"
@@ -84,6 +85,8 @@ class CC_DLL CCSprite : public CCNodeRGBA, public CCTextureProtocol
 , public CCGLBufferedNode
 #endif // EMSCRIPTEN
 {
+    CC_POOL_ALLOCATED()
+
 public:
     /// @{
     /// @name Creators
@@ -238,6 +241,7 @@ public:
      * This method will find pszFilename from local file system, load its content to CCTexture2D,
      * then use CCTexture2D to create a sprite.
      * After initialization, the rect used will be the size of the image. The offset will be (0,0).
+     * If the texture cache has a dynamic atlas, the image is packed into it (see CCTextureCache::setDynamicAtlas).
      *
      * @param   pszFilename The path to an image file in local file system
      * @return  true if the sprite is initialized properly, false otherwise.
@@ -145,10 +145,12 @@ void CCSpriteBatchNode::visit(void)
 
     kmGLPushMatrix();
 
-    if (m_pGrid && m_pGrid->isActive())
+    bool bGridActive = m_pGrid && m_pGrid->isActive();
+    if (bGridActive)
     {
         m_pGrid->beforeDraw();
         transformAncestors();
+        suspendCulling(true);
     }
 
     sortAllChildren();
@@ -156,8 +158,9 @@ void CCSpriteBatchNode::visit(void)
 
     draw();
 
-    if (m_pGrid && m_pGrid->isActive())
+    if (bGridActive)
     {
+        suspendCulling(false);
         m_pGrid->afterDraw(this);
     }
 
@@ -401,11 +404,71 @@ void CCSpriteBatchNode::draw(void)
 
     ccGLBlendFunc( m_blendFunc.src, m_blendFunc.dst );
 
-    m_pobTextureAtlas->drawQuads();
+    if (isCullingActive())
+    {
+        drawVisibleQuads();
+    }
+    else
+    {
+        m_pobTextureAtlas->drawQuads();
+    }
 
     CC_PROFILER_STOP("CCSpriteBatchNode - draw");
 }
 
+// Each run of consecutive on-screen quads costs a draw call. When visible and culled sprites interleave, the extra
+// calls cost more than the skipped vertices save, so past this many runs the whole atlas is drawn at once.
+#define CC_BATCH_MAX_VISIBLE_RUNS   4
+
+void CCSpriteBatchNode::drawVisibleQuads(void)
+{
+    kmMat4 mvp;
+    currentModelViewProjection(&mvp);
+
+    // the quads are in this node's coordinates: find the runs of consecutive on-screen quads
+    ccV3F_C4B_T2F_Quad *quads = m_pobTextureAtlas->getQuads();
+    unsigned int total = m_pobTextureAtlas->getTotalQuads();
+    unsigned int runStarts[CC_BATCH_MAX_VISIBLE_RUNS];
+    unsigned int runEnds[CC_BATCH_MAX_VISIBLE_RUNS];
+    unsigned int runs = 0;
+    unsigned int culled = 0;
+    bool inRun = false;
+    for (unsigned int i = 0; i < total; i++)
+    {
+        const ccV3F_C4B_T2F_Quad& quad = quads[i];
+        if (isQuadOutsideViewport(mvp, quad.bl.vertices, quad.br.vertices, quad.tl.vertices, quad.tr.vertices))
+        {
+            if (inRun)
+            {
+                runEnds[runs++] = i;
+                inRun = false;
+            }
+            culled++;
+        }
+        else if (! inRun)
+        {
+            if (runs == CC_BATCH_MAX_VISIBLE_RUNS)
+            {
+                m_pobTextureAtlas->drawQuads();
+                return;
+            }
+            runStarts[runs] = i;
+            inRun = true;
+        }
+    }
+    if (inRun)
+    {
+        runEnds[runs++] = total;
+    }
+
+    for (unsigned int r = 0; r < runs; r++)
+    {
+        m_pobTextureAtlas->drawNumberOfQuads(runEnds[r] - runStarts[r], runStarts[r]);
+    }
+
+    CC_INCREMENT_CULLED_NODES(culled);
+}
+
 void CCSpriteBatchNode::increaseAtlasCapacity(void)
 {
     // if we're going beyond the current TextureAtlas's capacity,
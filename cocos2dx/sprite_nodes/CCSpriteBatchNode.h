@@ -165,6 +165,9 @@ private:
     void updateAtlasIndex(CCSprite* sprite, int* curIndex);
     void swap(int oldIndex, int newIndex);
     void updateBlendFunc();
+    // draws only the quads inside the viewport, used when culling is enabled. Draws all of them
+    // when the visible ones are split into too many runs.
+    void drawVisibleQuads(void);
 
 protected:
     CCTextureAtlas *m_pobTextureAtlas;
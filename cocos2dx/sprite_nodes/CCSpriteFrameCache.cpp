@@ -395,14 +395,16 @@ void CCSpriteFrameCache::removeSpriteFramesFromTexture(CCTexture2D* texture)
 
 CCSpriteFrame* CCSpriteFrameCache::spriteFrameByName(const char *pszName)
 {
-    CCSpriteFrame* frame = (CCSpriteFrame*)m_pSpriteFrames->objectForKey(pszName);
+    // hash the name once for both dictionaries, without copying it into a std::string
+    CCDictKey name(pszName);
+    CCSpriteFrame* frame = (CCSpriteFrame*)m_pSpriteFrames->objectForKey(name);
     if (!frame)
     {
         // try alias dictionary
-        CCString *key = (CCString*)m_pSpriteFramesAliases->objectForKey(pszName);  
+        CCString *key = (CCString*)m_pSpriteFramesAliases->objectForKey(name);
         if (key)
         {
-            frame = (CCSpriteFrame*)m_pSpriteFrames->objectForKey(key->getCString());
+            frame = (CCSpriteFrame*)m_pSpriteFrames->objectForKey(CCDictKey(key->getCString()));
             if (! frame)
             {
                 CCLOG("cocos2d: CCSpriteFrameCache: Frame '%s' not found", pszName);
@@ -0,0 +1,115 @@
+/****************************************************************************
+Copyright (c) 2013 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#include "CCFrameTimeHistogram.h"
+#include "platform/CCCommon.h"
+#include <string.h>
+
+NS_CC_BEGIN
+
+CCFrameTimeHistogram::CCFrameTimeHistogram()
+{
+    reset();
+}
+
+void CCFrameTimeHistogram::addFrame(float ms, bool missed)
+{
+    if (ms < 0)
+    {
+        ms = 0;
+    }
+
+    unsigned int bucket = (unsigned int)(ms * kCCFrameTimeHistogramBucketsPerMs);
+    if (bucket >= kBucketCount)
+    {
+        bucket = kBucketCount - 1;
+    }
+    m_pBuckets[bucket]++;
+
+    m_uFrameCount++;
+    if (missed)
+    {
+        m_uMissedDeadlines++;
+    }
+    m_dTotalTime += ms;
+    if (ms > m_fMaxFrameTime)
+    {
+        m_fMaxFrameTime = ms;
+    }
+}
+
+void CCFrameTimeHistogram::reset()
+{
+    memset(m_pBuckets, 0, sizeof(m_pBuckets));
+    m_uFrameCount = 0;
+    m_uMissedDeadlines = 0;
+    m_dTotalTime = 0;
+    m_fMaxFrameTime = 0;
+}
+
+float CCFrameTimeHistogram::getMeanFrameTime() const
+{
+    return m_uFrameCount ? (float)(m_dTotalTime / m_uFrameCount) : 0.0f;
+}
+
+float CCFrameTimeHistogram::getPercentile(float percentile) const
+{
+    if (m_uFrameCount == 0)
+    {
+        return 0.0f;
+    }
+
+    // rank of the frame, 1 based, under which percentile percent of the frames are
+    double rank = m_uFrameCount * (double)percentile / 100.0;
+    unsigned int target = rank < 1 ? 1 : (unsigned int)rank;
+    if (target < rank)
+    {
+        target++;
+    }
+    if (target > m_uFrameCount)
+    {
+        target = m_uFrameCount;
+    }
+
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < kBucketCount - 1; i++)
+    {
+        count += m_pBuckets[i];
+        if (count >= target)
+        {
+            // upper bound of the bucket, never above the longest frame
+            float ms = (float)(i + 1) / kCCFrameTimeHistogramBucketsPerMs;
+            return ms < m_fMaxFrameTime ? ms : m_fMaxFrameTime;
+        }
+    }
+    return m_fMaxFrameTime;
+}
+
+void CCFrameTimeHistogram::dump() const
+{
+    CCLog("cocos2d: %u frames, mean %.2f ms, p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, max %.2f ms, %u missed deadlines",
+          m_uFrameCount, getMeanFrameTime(), getPercentile(50), getPercentile(95), getPercentile(99),
+          m_fMaxFrameTime, m_uMissedDeadlines);
+}
+
+NS_CC_END
@@ -0,0 +1,91 @@
+/****************************************************************************
+Copyright (c) 2013 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#ifndef __SUPPORT_CCFRAMETIMEHISTOGRAM_H__
+#define __SUPPORT_CCFRAMETIMEHISTOGRAM_H__
+
+#include "ccConfig.h"
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup global
+ * @{
+ */
+
+#define kCCFrameTimeHistogramBucketsPerMs   10
+#define kCCFrameTimeHistogramMaxMs          100
+
+/** @brief Histogram of the frame times, in 0.1 ms buckets up to 100 ms.
+
+ Longer frames are counted in an overflow bucket. Percentiles are read from the buckets,
+ so they are precise to 0.1 ms, or reported as the longest frame when they fall in the overflow.
+
+ CCDirector owns one, see CCDirector::getFrameTimeHistogram(). It is filled by the main loop
+ of the platforms which pace their frames themselves, Linux for now.
+ @since v2.1.4
+ */
+class CC_DLL CCFrameTimeHistogram
+{
+public:
+    CCFrameTimeHistogram();
+
+    /** counts a frame which lasted ms milliseconds; missed is true when it ended after its deadline */
+    void addFrame(float ms, bool missed);
+    /** forgets all the frames */
+    void reset();
+
+    /** frames counted since the last reset */
+    inline unsigned int getFrameCount() const { return m_uFrameCount; }
+    /** frames which ended after their deadline */
+    inline unsigned int getMissedDeadlines() const { return m_uMissedDeadlines; }
+    /** mean frame time, in milliseconds */
+    float getMeanFrameTime() const;
+    /** longest frame time, in milliseconds */
+    inline float getMaxFrameTime() const { return m_fMaxFrameTime; }
+    /** frame time under which percentile percent of the frames are, 0 to 100. Returns 0 without frames. */
+    float getPercentile(float percentile) const;
+
+    /** Output to CCLOG the frame count, p50, p95 and p99, the longest frame and the missed deadlines */
+    void dump() const;
+
+private:
+    enum
+    {
+        kBucketCount = kCCFrameTimeHistogramMaxMs * kCCFrameTimeHistogramBucketsPerMs + 1
+    };
+
+    unsigned int m_pBuckets[kBucketCount];
+    unsigned int m_uFrameCount;
+    unsigned int m_uMissedDeadlines;
+    double m_dTotalTime;
+    float m_fMaxFrameTime;
+};
+
+// end of global group
+/// @}
+
+NS_CC_END
+
+#endif // __SUPPORT_CCFRAMETIMEHISTOGRAM_H__
@@ -0,0 +1,227 @@
+/****************************************************************************
+Copyright (c) 2013 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "CCPoolAllocator.h"
+#include "ccMacros.h"
+#include <pthread.h>
+#include <new>
+
+NS_CC_BEGIN
+
+#define kCCPoolAllocatorGranularity 16
+#define kCCPoolAllocatorSizeCount (kCCPoolAllocatorMaxSize / kCCPoolAllocatorGranularity)
+// memory reserved at once for a size, at least 8 blocks
+#define kCCPoolAllocatorSlabSize (16 * 1024)
+
+struct FreeBlock
+{
+    FreeBlock* next;
+};
+
+struct SizeClass
+{
+    FreeBlock* mainFreeList;        // used by the main thread only, without locking
+    FreeBlock* sharedFreeList;      // used by the other threads, under mutex
+    pthread_mutex_t mutex;
+    unsigned int allocations;
+    unsigned int live;
+    unsigned int peak;
+    unsigned int reserved;
+};
+
+static SizeClass s_sizeClasses[kCCPoolAllocatorSizeCount];
+static pthread_once_t s_initOnce = PTHREAD_ONCE_INIT;
+static pthread_t s_mainThread;
+static bool s_bHasMainThread = false;
+
+static void initSizeClasses()
+{
+    for (int i = 0; i < kCCPoolAllocatorSizeCount; ++i)
+    {
+        pthread_mutex_init(&s_sizeClasses[i].mutex, NULL);
+    }
+}
+
+static inline bool isMainThread()
+{
+    return s_bHasMainThread && pthread_equal(pthread_self(), s_mainThread);
+}
+
+// reserves a slab of blocks of the given size class and returns them linked
+static FreeBlock* allocateSlab(SizeClass& sizeClass, size_t blockSize)
+{
+    size_t count = kCCPoolAllocatorSlabSize / blockSize;
+    if (count < 8)
+    {
+        count = 8;
+    }
+
+    // operator new fails the same way a plain new of the object would
+    char* slab = (char*)::operator new(count * blockSize);
+    for (size_t i = 0; i < count - 1; ++i)
+    {
+        ((FreeBlock*)(slab + i * blockSize))->next = (FreeBlock*)(slab + (i + 1) * blockSize);
+    }
+    ((FreeBlock*)(slab + (count - 1) * blockSize))->next = NULL;
+
+    sizeClass.reserved += (unsigned int)(count * blockSize);
+    return (FreeBlock*)slab;
+}
+
+static inline void countAllocation(SizeClass& sizeClass)
+{
+    ++sizeClass.allocations;
+    if (++sizeClass.live > sizeClass.peak)
+    {
+        sizeClass.peak = sizeClass.live;
+    }
+}
+
+void* CCPoolAllocator::allocate(size_t size)
+{
+    if (size == 0)
+    {
+        size = 1;
+    }
+    if (size > kCCPoolAllocatorMaxSize)
+    {
+        return ::operator new(size);
+    }
+
+    unsigned int index = (unsigned int)((size - 1) / kCCPoolAllocatorGranularity);
+    size_t blockSize = (index + 1) * kCCPoolAllocatorGranularity;
+    SizeClass& sizeClass = s_sizeClasses[index];
+    FreeBlock* block;
+
+    if (isMainThread())
+    {
+        block = sizeClass.mainFreeList;
+        if (block == NULL)
+        {
+            // take the blocks freed by the other threads before reserving more
+            pthread_once(&s_initOnce, initSizeClasses);
+            pthread_mutex_lock(&sizeClass.mutex);
+            block = sizeClass.sharedFreeList;
+            sizeClass.sharedFreeList = NULL;
+            if (block == NULL)
+            {
+                block = allocateSlab(sizeClass, blockSize);
+            }
+            pthread_mutex_unlock(&sizeClass.mutex);
+        }
+        sizeClass.mainFreeList = block->next;
+        countAllocation(sizeClass);
+        return block;
+    }
+
+    pthread_once(&s_initOnce, initSizeClasses);
+    pthread_mutex_lock(&sizeClass.mutex);
+    block = sizeClass.sharedFreeList;
+    if (block == NULL)
+    {
+        block = allocateSlab(sizeClass, blockSize);
+    }
+    sizeClass.sharedFreeList = block->next;
+    countAllocation(sizeClass);
+    pthread_mutex_unlock(&sizeClass.mutex);
+    return block;
+}
+
+void CCPoolAllocator::deallocate(void* p, size_t size)
+{
+    if (p == NULL)
+    {
+        return;
+    }
+    if (size == 0)
+    {
+        size = 1;
+    }
+    if (size > kCCPoolAllocatorMaxSize)
+    {
+        ::operator delete(p);
+        return;
+    }
+
+    // the blocks of a size are interchangeable: they go to the free list of the calling thread
+    SizeClass& sizeClass = s_sizeClasses[(size - 1) / kCCPoolAllocatorGranularity];
+    FreeBlock* block = (FreeBlock*)p;
+    if (isMainThread())
+    {
+        block->next = sizeClass.mainFreeList;
+        sizeClass.mainFreeList = block;
+        --sizeClass.live;
+        return;
+    }
+
+    pthread_once(&s_initOnce, initSizeClasses);
+    pthread_mutex_lock(&sizeClass.mutex);
+    block->next = sizeClass.sharedFreeList;
+    sizeClass.sharedFreeList = block;
+    --sizeClass.live;
+    pthread_mutex_unlock(&sizeClass.mutex);
+}
+
+void CCPoolAllocator::setMainThread()
+{
+    s_mainThread = pthread_self();
+    s_bHasMainThread = true;
+}
+
+unsigned int CCPoolAllocator::getLiveBlockCount()
+{
+    unsigned int count = 0;
+    for (int i = 0; i < kCCPoolAllocatorSizeCount; ++i)
+    {
+        count += s_sizeClasses[i].live;
+    }
+    return count;
+}
+
+unsigned int CCPoolAllocator::getReservedMemory()
+{
+    unsigned int bytes = 0;
+    for (int i = 0; i < kCCPoolAllocatorSizeCount; ++i)
+    {
+        bytes += s_sizeClasses[i].reserved;
+    }
+    return bytes;
+}
+
+void CCPoolAllocator::dumpStatistics()
+{
+    CCLOG("cocos2d: CCPoolAllocator: %u live blocks, %u KB reserved", getLiveBlockCount(), getReservedMemory() / 1024);
+    for (int i = 0; i < kCCPoolAllocatorSizeCount; ++i)
+    {
+        const SizeClass& sizeClass = s_sizeClasses[i];
+        if (sizeClass.allocations > 0)
+        {
+            CCLOG("cocos2d: %4d bytes: %10u allocations, %7u live, %7u peak, %6u KB reserved",
+                  (i + 1) * kCCPoolAllocatorGranularity, sizeClass.allocations, sizeClass.live, sizeClass.peak,
+                  sizeClass.reserved / 1024);
+        }
+    }
+}
+
+NS_CC_END
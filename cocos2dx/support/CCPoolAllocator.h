@@ -0,0 +1,98 @@
+/****************************************************************************
+Copyright (c) 2013 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __SUPPORT_CCPOOLALLOCATOR_H__
+#define __SUPPORT_CCPOOLALLOCATOR_H__
+
+#include "ccConfig.h"
+#include "platform/CCPlatformMacros.h"
+#include <stddef.h>
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup global
+ * @{
+ */
+
+/** @brief Size segregated pool allocator for the small objects created and destroyed every frame.
+
+ Blocks are grouped by size, rounded up to 16 bytes, up to kCCPoolAllocatorMaxSize bytes; larger
+ requests go to the system allocator. Freed blocks are kept in a free list of their size and reused,
+ the memory is never returned to the system.
+
+ The thread calling setMainThread(), the one of CCDirector, allocates and frees without locking.
+ The other threads share a second free list per size, protected by a mutex.
+
+ Classes use it with CC_POOL_ALLOCATED(), which declares their operator new and delete;
+ the classes deriving from them use it too. It is off unless CC_ENABLE_POOL_ALLOCATOR is defined to 1.
+ @since v2.1.4
+ */
+class CC_DLL CCPoolAllocator
+{
+public:
+    /** returns a block of at least size bytes, aligned like the blocks of operator new */
+    static void* allocate(size_t size);
+    /** frees a block returned by allocate(size); size must be the same */
+    static void deallocate(void* p, size_t size);
+
+    /** the calling thread allocates without locking. Called by CCDirector. */
+    static void setMainThread();
+
+    /** blocks currently allocated from the pools, all sizes */
+    static unsigned int getLiveBlockCount();
+    /** memory reserved by the pools, in bytes */
+    static unsigned int getReservedMemory();
+
+    /** Output to CCLOG the allocations, live and peak blocks and reserved memory of every size in use.
+     The counters of the main thread aren't locked: they are approximate when other threads allocate too.
+     */
+    static void dumpStatistics();
+};
+
+#define kCCPoolAllocatorMaxSize 1024
+
+/** @def CC_POOL_ALLOCATED
+ Makes a class, and the classes deriving from it, allocated by CCPoolAllocator.
+ Put it in the class declaration. The destructor of the class must be virtual,
+ so that operator delete receives the size of the actual object.
+ Placement new is declared too, since a class operator new hides the global ones.
+ */
+#if CC_ENABLE_POOL_ALLOCATOR
+#define CC_POOL_ALLOCATED() \
+public: \
+    static void* operator new(size_t size) { return CCPoolAllocator::allocate(size); } \
+    static void operator delete(void* p, size_t size) { CCPoolAllocator::deallocate(p, size); } \
+    static void* operator new(size_t, void* place) { return place; } \
+    static void operator delete(void*, void*) {}
+#else
+#define CC_POOL_ALLOCATED()
+#endif
+
+// end of global group
+/// @}
+
+NS_CC_END
+
+#endif // __SUPPORT_CCPOOLALLOCATOR_H__
@@ -24,6 +24,18 @@
 
 #include "ccUTF8.h"
 #include "platform/CCCommon.h"
+#include "support/image_support/ccPixelConversion.h"
+#include <string.h>
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define CC_UTF8_SSE2 1
+        #include <emmintrin.h>
+    #endif
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)
+    #define CC_UTF8_NEON 1
+    #include <arm_neon.h>
+#endif
 
 NS_CC_BEGIN
 
@@ -34,6 +46,172 @@ int cc_wcslen(const unsigned short* str)
     return i;
 }
 
+// ASCII fast paths: runs of characters below 0x80 are scanned and converted 16 at a time with SSE2 or NEON,
+// 8 at a time in a 64 bit word otherwise. The runs end at the first other character, left to the scalar code.
+// The callers only enter them for runs of two characters or more: CJK text has single spaces between
+// its characters, cheaper to handle one by one.
+
+#define CC_UTF8_ASCII_MASK  0x8080808080808080ULL
+
+#if defined(CC_UTF8_NEON)
+static inline bool isASCII16(uint8x16_t v)
+{
+    uint8x8_t bits = vorr_u8(vget_low_u8(v), vget_high_u8(v));
+    return (vget_lane_u64(vreinterpret_u64_u8(bits), 0) & CC_UTF8_ASCII_MASK) == 0;
+}
+#endif
+
+// number of bytes below 0x80 at the start of p[0, n)
+static int asciiPrefix(const unsigned char* p, int n)
+{
+    int i = 0;
+#if defined(CC_UTF8_SSE2)
+    if (ccGetCPUFeatures() & kCCCPUFeature_SSE2)
+    {
+        for (; i + 16 <= n; i += 16)
+        {
+            if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(p + i))))
+            {
+                break;
+            }
+        }
+    }
+#elif defined(CC_UTF8_NEON)
+    if (ccGetCPUFeatures() & kCCCPUFeature_NEON)
+    {
+        for (; i + 16 <= n; i += 16)
+        {
+            if (! isASCII16(vld1q_u8(p + i)))
+            {
+                break;
+            }
+        }
+    }
+#endif
+    for (; i + 8 <= n; i += 8)
+    {
+        unsigned long long word;
+        memcpy(&word, p + i, 8);
+        if (word & CC_UTF8_ASCII_MASK)
+        {
+            break;
+        }
+    }
+    while (i < n && p[i] < 0x80)
+    {
+        ++i;
+    }
+    return i;
+}
+
+// copies the bytes below 0x80 at the start of in[0, n) to out, returns their count
+static int widenASCII(const unsigned char* in, int n, unsigned short* out)
+{
+    int i = 0;
+#if defined(CC_UTF8_SSE2)
+    if (ccGetCPUFeatures() & kCCCPUFeature_SSE2)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)(in + i));
+            if (_mm_movemask_epi8(v))
+            {
+                break;
+            }
+            _mm_storeu_si128((__m128i*)(out + i), _mm_unpacklo_epi8(v, zero));
+            _mm_storeu_si128((__m128i*)(out + i + 8), _mm_unpackhi_epi8(v, zero));
+        }
+    }
+#elif defined(CC_UTF8_NEON)
+    if (ccGetCPUFeatures() & kCCCPUFeature_NEON)
+    {
+        for (; i + 16 <= n; i += 16)
+        {
+            uint8x16_t v = vld1q_u8(in + i);
+            if (! isASCII16(v))
+            {
+                break;
+            }
+            vst1q_u16(out + i, vmovl_u8(vget_low_u8(v)));
+            vst1q_u16(out + i + 8, vmovl_u8(vget_high_u8(v)));
+        }
+    }
+#endif
+    while (i < n && in[i] < 0x80)
+    {
+        out[i] = in[i];
+        ++i;
+    }
+    return i;
+}
+
+// number of UTF-16 units below 0x80 at the start of in[0, n), copied to out as bytes if it isn't NULL
+static int narrowASCII(const unsigned short* in, int n, char* out)
+{
+    int i = 0;
+#if defined(CC_UTF8_SSE2)
+    if (ccGetCPUFeatures() & kCCCPUFeature_SSE2)
+    {
+        const __m128i high = _mm_set1_epi16((short)0xff80);
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i a = _mm_loadu_si128((const __m128i*)(in + i));
+            __m128i b = _mm_loadu_si128((const __m128i*)(in + i + 8));
+            __m128i bits = _mm_and_si128(_mm_or_si128(a, b), high);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(bits, zero)) != 0xffff)
+            {
+                break;
+            }
+            if (out)
+            {
+                _mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(a, b));
+            }
+        }
+    }
+#elif defined(CC_UTF8_NEON)
+    if (ccGetCPUFeatures() & kCCCPUFeature_NEON)
+    {
+        for (; i + 16 <= n; i += 16)
+        {
+            uint16x8_t a = vld1q_u16(in + i);
+            uint16x8_t b = vld1q_u16(in + i + 8);
+            uint16x8_t bits = vandq_u16(vorrq_u16(a, b), vdupq_n_u16(0xff80));
+            uint16x4_t folded = vorr_u16(vget_low_u16(bits), vget_high_u16(bits));
+            if (vget_lane_u64(vreinterpret_u64_u16(folded), 0))
+            {
+                break;
+            }
+            if (out)
+            {
+                vst1q_u8((uint8_t*)(out + i), vcombine_u8(vmovn_u16(a), vmovn_u16(b)));
+            }
+        }
+    }
+#endif
+    while (i < n && in[i] < 0x80)
+    {
+        if (out)
+        {
+            out[i] = (char)in[i];
+        }
+        ++i;
+    }
+    return i;
+}
+
+// length in bytes of str: up to its terminating 0, and at most max bytes if max >= 0
+static int utf8ByteLength(const char* str, int max)
+{
+    if (max < 0)
+    {
+        return (int)strlen(str);
+    }
+    const char* zero = (const char*)memchr(str, 0, max);
+    return zero ? (int)(zero - str) : max;
+}
+
 /* Code from GLIB gutf8.c starts here. */
 
 #define UTF8_COMPUTE(Char, Mask, Len)        \
@@ -127,7 +305,7 @@ static const char *const g_utf8_skip = utf8_skip_data;
  *
  * Return value: the index of the last character that is not c.
  * */
-unsigned int cc_utf8_find_last_not_char(std::vector<unsigned short> str, unsigned short c)
+unsigned int cc_utf8_find_last_not_char(const std::vector<unsigned short>& str, unsigned short c)
 {
     int len = str.size();
     
@@ -209,44 +387,78 @@ long
 cc_utf8_strlen (const char * p, int max)
 {
     long len = 0;
-    const char *start = p;
     
-    if (!(p != NULL || max == 0))
+    if (p == NULL || max == 0)
     {
         return 0;
     }
     
-    if (max < 0)
+    const unsigned char* s = (const unsigned char*)p;
+    int n = utf8ByteLength(p, max);
+    int i = 0;
+    while (i < n)
     {
-        while (*p)
+        if (s[i] >= 0x80)
         {
-            p = cc_utf8_next_char (p);
+            i += g_utf8_skip[s[i]];
+            /* only count complete chars */
+            if (i > n)
+                break;
             ++len;
         }
-    }
-    else
-    {
-        if (max == 0 || !*p)
-            return 0;
-        
-        p = cc_utf8_next_char (p);
-        
-        while (p - start < max && *p)
+        else if (i + 1 < n && s[i + 1] < 0x80)
         {
-            ++len;
-            p = cc_utf8_next_char (p);
+            int ascii = asciiPrefix(s + i, n - i);
+            i += ascii;
+            len += ascii;
         }
-        
-        /* only do the last len increment if we got a complete
-         * char (don't count partial chars)
-         */
-        if (p - start == max)
+        else
+        {
+            ++i;
             ++len;
+        }
     }
     
     return len;
 }
 
+int cc_utf8_count_chars(const char* p, int max)
+{
+    if (p == NULL || max == 0)
+    {
+        return 0;
+    }
+
+    const unsigned char* s = (const unsigned char*)p;
+    int n = utf8ByteLength(p, max);
+    int count = 0;
+    int i = 0;
+    while (i < n)
+    {
+        if (s[i] >= 0x80)
+        {
+            if ((s[i] & 0xC0) != 0x80)
+            {
+                ++count;
+            }
+            ++i;
+        }
+        else if (i + 1 < n && s[i + 1] < 0x80)
+        {
+            int ascii = asciiPrefix(s + i, n - i);
+            i += ascii;
+            count += ascii;
+        }
+        else
+        {
+            ++i;
+            ++count;
+        }
+    }
+
+    return count;
+}
+
 /*
  * g_utf8_get_char:
  * @p: a pointer to Unicode character encoded as UTF-8
@@ -275,6 +487,38 @@ cc_utf8_get_char (const char * p)
 }
 
 
+/*
+ * Converts the complete characters of in[0, n) to out, which holds at least
+ * cc_utf8_strlen(in, n) units, and returns their count.
+ */
+static int utf8ToUTF16(const unsigned char* in, int n, unsigned short* out)
+{
+    int count = 0;
+    int i = 0;
+    while (i < n)
+    {
+        if (in[i] >= 0x80)
+        {
+            int skip = g_utf8_skip[in[i]];
+            if (i + skip > n)
+                break;
+            out[count++] = cc_utf8_get_char((const char*)in + i);
+            i += skip;
+        }
+        else if (i + 1 < n && in[i + 1] < 0x80)
+        {
+            int ascii = widenASCII(in + i, n - i, out + count);
+            i += ascii;
+            count += ascii;
+        }
+        else
+        {
+            out[count++] = in[i++];
+        }
+    }
+    return count;
+}
+
 unsigned short* cc_utf8_to_utf16(const char* str_old, int length/* = -1 */, int* rUtf16Size/* = NULL */)
 {
     int len = cc_utf8_strlen(str_old, length);
@@ -285,25 +529,104 @@ unsigned short* cc_utf8_to_utf16(const char* str_old, int length/* = -1 */, int*
     unsigned short* str_new = new unsigned short[len + 1];
     str_new[len] = 0;
     
-    for (int i = 0; i < len; ++i)
+    if (len > 0)
     {
-        str_new[i] = cc_utf8_get_char(str_old);
-        str_old = cc_utf8_next_char(str_old);
+        utf8ToUTF16((const unsigned char*)str_old, utf8ByteLength(str_old, length), str_new);
     }
     
     return str_new;
 }
 
-std::vector<unsigned short> cc_utf16_vec_from_utf16_str(const unsigned short* str)
+void cc_utf8_to_utf16(const char* str, int length, std::vector<unsigned short>& out)
 {
-    int len = cc_wcslen(str);
-    std::vector<unsigned short> str_new;
+    if (str == NULL || length == 0)
+    {
+        out.clear();
+        return;
+    }
     
-    for (int i = 0; i < len; ++i)
+    // a character takes at least one byte: convert in place and drop the extra room
+    int n = utf8ByteLength(str, length);
+    out.resize(n);
+    if (n > 0)
     {
-        str_new.push_back(str[i]);
+        out.resize(utf8ToUTF16((const unsigned char*)str, n, &out[0]));
     }
-    return str_new;
+}
+
+std::vector<unsigned short> cc_utf16_vec_from_utf16_str(const unsigned short* str)
+{
+    return std::vector<unsigned short>(str, str + cc_wcslen(str));
+}
+
+void cc_utf16_vec_from_utf16_str(const unsigned short* str, std::vector<unsigned short>& out)
+{
+    out.assign(str, str + cc_wcslen(str));
+}
+
+bool cc_utf8_validate(const char* str, int max/* = -1 */, const char** end/* = NULL */)
+{
+    const unsigned char* s = (const unsigned char*)str;
+    int n = (str == NULL || max == 0) ? 0 : utf8ByteLength(str, max);
+    bool valid = true;
+    int i = 0;
+    while (i < n)
+    {
+        unsigned char c = s[i];
+        if (c < 0x80)
+        {
+            i += (i + 1 < n && s[i + 1] < 0x80) ? asciiPrefix(s + i, n - i) : 1;
+            continue;
+        }
+        
+        unsigned int ch, min;
+        int len;
+        if (c >= 0xc2 && c <= 0xdf)
+        {
+            len = 2;
+            ch = c & 0x1f;
+            min = 0x80;
+        }
+        else if ((c & 0xf0) == 0xe0)
+        {
+            len = 3;
+            ch = c & 0x0f;
+            min = 0x800;
+        }
+        else if (c >= 0xf0 && c <= 0xf4)
+        {
+            len = 4;
+            ch = c & 0x07;
+            min = 0x10000;
+        }
+        else
+        {
+            valid = false;
+            break;
+        }
+        
+        if (i + len > n)
+        {
+            valid = false;
+            break;
+        }
+        int k = 1;
+        for (; k < len && (s[i + k] & 0xc0) == 0x80; ++k)
+        {
+            ch = (ch << 6) | (s[i + k] & 0x3f);
+        }
+        /* truncated, overlong, surrogate or beyond U+10FFFF */
+        if (k < len || ch < min || ch > 0x10ffff || (ch & 0xfffff800) == 0xd800)
+        {
+            valid = false;
+            break;
+        }
+        i += len;
+    }
+    
+    if (end)
+        *end = str + i;
+    return valid;
 }
 
 /**
@@ -408,16 +731,31 @@ cc_utf16_to_utf8 (const unsigned short  *str,
     const unsigned short *in;
     char *out;
     char *result = NULL;
+    long n_units;
     int n_bytes;
     unsigned short high_surrogate;
     
     if (str == 0) return NULL;
     
+    /* the units to convert, up to the terminating 0 */
+    n_units = 0;
+    while ((len < 0 || n_units < len) && str[n_units])
+        n_units++;
+    
     n_bytes = 0;
     in = str;
     high_surrogate = 0;
-    while ((len < 0 || in - str < len) && *in)
+    while (in < str + n_units)
     {
+        if (!high_surrogate && in[0] < 0x80 && in + 1 < str + n_units && in[1] < 0x80)
+        {
+            int ascii = narrowASCII(in, str + n_units - in, NULL);
+            n_bytes += ascii;
+            in += ascii;
+            if (in == str + n_units)
+                break;
+        }
+        
         unsigned short c = *in;
         unsigned short wc;
         
@@ -474,6 +812,15 @@ cc_utf16_to_utf8 (const unsigned short  *str,
     in = str;
     while (out < result + n_bytes)
     {
+        if (!high_surrogate && in[0] < 0x80 && in + 1 < str + n_units && in[1] < 0x80)
+        {
+            int ascii = narrowASCII(in, str + n_units - in, out);
+            out += ascii;
+            in += ascii;
+            if (out == result + n_bytes)
+                break;
+        }
+        
         unsigned short c = *in;
         unsigned short wc;
         
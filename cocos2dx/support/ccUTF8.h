@@ -11,6 +11,9 @@
 #include "platform/CCPlatformMacros.h"
 #include <vector>
 
+// Runs of ASCII characters are scanned and converted 16 at a time with SSE2 or NEON,
+// when ccGetCPUFeatures() reports them.
+
 NS_CC_BEGIN
 
 CC_DLL int cc_wcslen(const unsigned short* str);
@@ -41,16 +44,50 @@ CC_DLL bool isspace_unicode(unsigned short ch);
 CC_DLL long
 cc_utf8_strlen (const char * p, int max);
 
+/*
+ * cc_utf8_count_chars:
+ * @p: pointer to the start of a UTF-8 encoded string.
+ * @max: the maximum number of bytes to examine, or -1 to stop at
+ *       the terminating 0 only.
+ *
+ * Counts the bytes that don't continue a character (10xxxxxx).
+ * Unlike cc_utf8_strlen, stray continuation bytes aren't counted and
+ * a truncated character at the end is: this is how text input nodes
+ * count the characters they delete one by one.
+ *
+ * Return value: the number of characters
+ * */
+CC_DLL int cc_utf8_count_chars(const char* p, int max = -1);
+
 /*
  * @str:    the string to search through.
  * @c:        the character to not look for.
  *
  * Return value: the index of the last character that is not c.
  * */
-CC_DLL unsigned int cc_utf8_find_last_not_char(std::vector<unsigned short> str, unsigned short c);
+CC_DLL unsigned int cc_utf8_find_last_not_char(const std::vector<unsigned short>& str, unsigned short c);
 
 CC_DLL std::vector<unsigned short> cc_utf16_vec_from_utf16_str(const unsigned short* str);
 
+/*
+ * Same as above, filling @out and reusing its memory.
+ * */
+CC_DLL void cc_utf16_vec_from_utf16_str(const unsigned short* str, std::vector<unsigned short>& out);
+
+/*
+ * cc_utf8_validate:
+ * @str: pointer to the start of a UTF-8 encoded string.
+ * @max: the maximum number of bytes to examine, or -1 to stop at
+ *       the terminating 0 only.
+ * @end: location to store the end of the valid data, or %NULL.
+ *
+ * Checks that @str is well-formed UTF-8: shortest forms only, no
+ * surrogates, nothing above U+10FFFF, no truncated character.
+ *
+ * Return value: true if the whole string is valid.
+ * */
+CC_DLL bool cc_utf8_validate(const char* str, int max = -1, const char** end = NULL);
+
 /*
  * cc_utf8_to_utf16:
  * @str_old: pointer to the start of a C string.
@@ -61,6 +98,13 @@ CC_DLL std::vector<unsigned short> cc_utf16_vec_from_utf16_str(const unsigned sh
  * */
 CC_DLL unsigned short* cc_utf8_to_utf16(const char* str_old, int length = -1, int* rUtf16Size = NULL);
 
+/*
+ * Same as above, converting in a single pass into @out, without the
+ * terminating 0. The memory of @out is reused: keep the vector around
+ * when converting many strings.
+ * */
+CC_DLL void cc_utf8_to_utf16(const char* str, int length, std::vector<unsigned short>& out);
+
 /**
  * cc_utf16_to_utf8:
  * @str: a UTF-16 encoded string
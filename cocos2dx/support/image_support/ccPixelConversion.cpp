@@ -0,0 +1,754 @@
+/****************************************************************************
+Copyright (c) 2013 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#include "ccPixelConversion.h"
+#include "platform/CCCommon.h"
+#include <string.h>
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define CC_PIXEL_SSE2 1
+        #include <emmintrin.h>
+    #endif
+    // SSSE3 is not part of the x86 baseline: the kernels are compiled for it anyway and only used
+    // when cpuid reports it
+    #if defined(CC_PIXEL_SSE2) && (defined(__SSSE3__) || defined(_MSC_VER))
+        #define CC_PIXEL_SSSE3 1
+        #define CC_SSSE3_TARGET
+    #elif defined(CC_PIXEL_SSE2) && (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+        #define CC_PIXEL_SSSE3 1
+        #define CC_SSSE3_TARGET __attribute__((target("ssse3")))
+    #endif
+    #ifdef CC_PIXEL_SSSE3
+        #include <tmmintrin.h>
+    #endif
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(__aarch64__)
+    // NEON is chosen at compile time: armv7 builds made with -mfpu=neon, and every arm64 build
+    #define CC_PIXEL_NEON 1
+    #include <arm_neon.h>
+#endif
+
+NS_CC_BEGIN
+
+// CPU features
+
+static unsigned int detectCPUFeatures()
+{
+    unsigned int features = 0;
+#if defined(CC_PIXEL_SSE2)
+    unsigned int ecx = 0, edx = 0;
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    ecx = info[2];
+    edx = info[3];
+#else
+    unsigned int eax = 0, ebx = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    {
+        ecx = edx = 0;
+    }
+#endif
+    if (edx & (1 << 26))
+    {
+        features |= kCCCPUFeature_SSE2;
+#if defined(CC_PIXEL_SSSE3)
+        if (ecx & (1 << 9))
+        {
+            features |= kCCCPUFeature_SSSE3;
+        }
+#endif
+    }
+#elif defined(CC_PIXEL_NEON)
+    features |= kCCCPUFeature_NEON;
+#endif
+    return features;
+}
+
+static const unsigned int s_uDetectedCPUFeatures = detectCPUFeatures();
+static unsigned int s_uCPUFeaturesMask = ~0u;
+
+unsigned int ccGetCPUFeatures(void)
+{
+    return s_uDetectedCPUFeatures & s_uCPUFeaturesMask;
+}
+
+void ccSetCPUFeaturesMask(unsigned int mask)
+{
+    s_uCPUFeaturesMask = mask;
+}
+
+// ordered dithering
+
+static const unsigned char s_bayer4x4[4][4] = {
+    {  0,  8,  2, 10 },
+    { 12,  4, 14,  6 },
+    {  3, 11,  1,  9 },
+    { 15,  7, 13,  5 },
+};
+
+// Fills bias with the values added to 4 consecutive RGBA pixels of row y before a channel is truncated
+// to rBits/gBits/bBits bits: a threshold in [0, 2^(8-bits)). Alpha is never dithered.
+static void ditherBias(unsigned char bias[16], unsigned int y, bool dither, unsigned int rBits, unsigned int gBits, unsigned int bBits)
+{
+    memset(bias, 0, 16);
+    if (dither)
+    {
+        for (unsigned int x = 0; x < 4; ++x)
+        {
+            unsigned char threshold = s_bayer4x4[y & 3][x];
+            bias[x * 4 + 0] = threshold >> (rBits - 4);
+            bias[x * 4 + 1] = threshold >> (gBits - 4);
+            bias[x * 4 + 2] = threshold >> (bBits - 4);
+        }
+    }
+}
+
+static inline unsigned int addSaturate(unsigned int c, unsigned int bias)
+{
+    c += bias;
+    return c > 255 ? 255 : c;
+}
+
+// SIMD helpers
+
+#if defined(CC_PIXEL_SSE2)
+// packs the low 16 bits of every 32 bit lane of lo and hi into 8 shorts
+static inline __m128i packLow16(__m128i lo, __m128i hi)
+{
+    lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+    hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+    return _mm_packs_epi32(lo, hi);
+}
+#endif
+
+// 16 bit formats. pack() works on one pixel, pack4() on 4 RGBA8888 pixels held in 32 bit lanes (SSE2)
+// and pack8() on 8 pixels split in channels (NEON).
+
+struct FormatRGB565
+{
+    enum { kRBits = 5, kGBits = 6, kBBits = 5 };
+
+    static inline unsigned short pack(unsigned int r, unsigned int g, unsigned int b, unsigned int)
+    {
+        return (unsigned short)(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+    }
+#if defined(CC_PIXEL_SSE2)
+    static inline __m128i pack4(__m128i p)
+    {
+        __m128i r = _mm_and_si128(_mm_slli_epi32(p, 8), _mm_set1_epi32(0xF800));
+        __m128i g = _mm_and_si128(_mm_srli_epi32(p, 5), _mm_set1_epi32(0x07E0));
+        __m128i b = _mm_and_si128(_mm_srli_epi32(p, 19), _mm_set1_epi32(0x001F));
+        return _mm_or_si128(_mm_or_si128(r, g), b);
+    }
+#endif
+#if defined(CC_PIXEL_NEON)
+    static inline uint16x8_t pack8(uint8x8_t r, uint8x8_t g, uint8x8_t b, uint8x8_t)
+    {
+        uint16x8_t v = vshlq_n_u16(vmovl_u8(vshr_n_u8(r, 3)), 11);
+        v = vorrq_u16(v, vshlq_n_u16(vmovl_u8(vshr_n_u8(g, 2)), 5));
+        return vorrq_u16(v, vmovl_u8(vshr_n_u8(b, 3)));
+    }
+#endif
+};
+
+struct FormatRGBA4444
+{
+    enum { kRBits = 4, kGBits = 4, kBBits = 4 };
+
+    static inline unsigned short pack(unsigned int r, unsigned int g, unsigned int b, unsigned int a)
+    {
+        return (unsigned short)(((r >> 4) << 12) | ((g >> 4) << 8) | ((b >> 4) << 4) | (a >> 4));
+    }
+#if defined(CC_PIXEL_SSE2)
+    static inline __m128i pack4(__m128i p)
+    {
+        __m128i r = _mm_and_si128(_mm_slli_epi32(p, 8), _mm_set1_epi32(0xF000));
+        __m128i g = _mm_and_si128(_mm_srli_epi32(p, 4), _mm_set1_epi32(0x0F00));
+        __m128i b = _mm_and_si128(_mm_srli_epi32(p, 16), _mm_set1_epi32(0x00F0));
+        __m128i a = _mm_srli_epi32(p, 28);
+        return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+    }
+#endif
+#if defined(CC_PIXEL_NEON)
+    static inline uint16x8_t pack8(uint8x8_t r, uint8x8_t g, uint8x8_t b, uint8x8_t a)
+    {
+        uint16x8_t v = vshlq_n_u16(vmovl_u8(vshr_n_u8(r, 4)), 12);
+        v = vorrq_u16(v, vshlq_n_u16(vmovl_u8(vshr_n_u8(g, 4)), 8));
+        v = vorrq_u16(v, vshlq_n_u16(vmovl_u8(vshr_n_u8(b, 4)), 4));
+        return vorrq_u16(v, vmovl_u8(vshr_n_u8(a, 4)));
+    }
+#endif
+};
+
+struct FormatRGB5A1
+{
+    enum { kRBits = 5, kGBits = 5, kBBits = 5 };
+
+    static inline unsigned short pack(unsigned int r, unsigned int g, unsigned int b, unsigned int a)
+    {
+        return (unsigned short)(((r >> 3) << 11) | ((g >> 3) << 6) | ((b >> 3) << 1) | (a >> 7));
+    }
+#if defined(CC_PIXEL_SSE2)
+    static inline __m128i pack4(__m128i p)
+    {
+        __m128i r = _mm_and_si128(_mm_slli_epi32(p, 8), _mm_set1_epi32(0xF800));
+        __m128i g = _mm_and_si128(_mm_srli_epi32(p, 5), _mm_set1_epi32(0x07C0));
+        __m128i b = _mm_and_si128(_mm_srli_epi32(p, 18), _mm_set1_epi32(0x003E));
+        __m128i a = _mm_srli_epi32(p, 31);
+        return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, a));
+    }
+#endif
+#if defined(CC_PIXEL_NEON)
+    static inline uint16x8_t pack8(uint8x8_t r, uint8x8_t g, uint8x8_t b, uint8x8_t a)
+    {
+        uint16x8_t v = vshlq_n_u16(vmovl_u8(vshr_n_u8(r, 3)), 11);
+        v = vorrq_u16(v, vshlq_n_u16(vmovl_u8(vshr_n_u8(g, 3)), 6));
+        v = vorrq_u16(v, vshlq_n_u16(vmovl_u8(vshr_n_u8(b, 3)), 1));
+        return vorrq_u16(v, vmovl_u8(vshr_n_u8(a, 7)));
+    }
+#endif
+};
+
+#if defined(CC_PIXEL_SSSE3)
+// expands 4 RGB888 pixels held in the low 12 bytes of v to RGBA8888 (alpha 0)
+CC_SSSE3_TARGET static inline __m128i expandRGB888(__m128i v)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    return _mm_shuffle_epi8(v, shuffle);
+}
+
+template <class F>
+CC_SSSE3_TARGET static unsigned int convertRowRGB888SSSE3(const unsigned char *in, unsigned short *out, unsigned int count, const unsigned char *bias)
+{
+    __m128i vbias = _mm_loadu_si128((const __m128i*)bias);
+    unsigned int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const unsigned char *src = in + i * 3;
+        __m128i v0 = _mm_loadu_si128((const __m128i*)src);
+        __m128i v1 = _mm_loadu_si128((const __m128i*)(src + 16));
+        __m128i v2 = _mm_loadu_si128((const __m128i*)(src + 32));
+        __m128i p0 = _mm_adds_epu8(expandRGB888(v0), vbias);
+        __m128i p1 = _mm_adds_epu8(expandRGB888(_mm_alignr_epi8(v1, v0, 12)), vbias);
+        __m128i p2 = _mm_adds_epu8(expandRGB888(_mm_alignr_epi8(v2, v1, 8)), vbias);
+        __m128i p3 = _mm_adds_epu8(expandRGB888(_mm_srli_si128(v2, 4)), vbias);
+        _mm_storeu_si128((__m128i*)(out + i), packLow16(F::pack4(p0), F::pack4(p1)));
+        _mm_storeu_si128((__m128i*)(out + i + 8), packLow16(F::pack4(p2), F::pack4(p3)));
+    }
+    return i;
+}
+
+CC_SSSE3_TARGET static unsigned int convertRGBA8888ToRGB888SSSE3(const unsigned char *in, unsigned char *out, unsigned int count)
+{
+    // drops the alpha bytes and leaves the 12 RGB bytes in the low part of the register
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    unsigned int i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m128i *src = (const __m128i*)(in + i * 4);
+        __m128i *dst = (__m128i*)(out + i * 3);
+        __m128i s0 = _mm_shuffle_epi8(_mm_loadu_si128(src + 0), shuffle);
+        __m128i s1 = _mm_shuffle_epi8(_mm_loadu_si128(src + 1), shuffle);
+        __m128i s2 = _mm_shuffle_epi8(_mm_loadu_si128(src + 2), shuffle);
+        __m128i s3 = _mm_shuffle_epi8(_mm_loadu_si128(src + 3), shuffle);
+        _mm_storeu_si128(dst + 0, _mm_or_si128(s0, _mm_slli_si128(s1, 12)));
+        _mm_storeu_si128(dst + 1, _mm_or_si128(_mm_srli_si128(s1, 4), _mm_slli_si128(s2, 8)));
+        _mm_storeu_si128(dst + 2, _mm_or_si128(_mm_srli_si128(s2, 8), _mm_slli_si128(s3, 4)));
+    }
+    return i;
+}
+#endif
+
+#if defined(CC_PIXEL_NEON)
+// splits the 16 byte RGBA bias of 4 pixels in 3 channel vectors covering 16 pixels
+static inline void neonBias(const unsigned char *bias, uint8x16_t &r, uint8x16_t &g, uint8x16_t &b)
+{
+    unsigned char planes[3][16];
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        planes[0][i] = bias[(i & 3) * 4 + 0];
+        planes[1][i] = bias[(i & 3) * 4 + 1];
+        planes[2][i] = bias[(i & 3) * 4 + 2];
+    }
+    r = vld1q_u8(planes[0]);
+    g = vld1q_u8(planes[1]);
+    b = vld1q_u8(planes[2]);
+}
+
+template <class F>
+static inline void storeNEON(unsigned short *out, uint8x16_t r, uint8x16_t g, uint8x16_t b, uint8x16_t a)
+{
+    vst1q_u16(out, F::pack8(vget_low_u8(r), vget_low_u8(g), vget_low_u8(b), vget_low_u8(a)));
+    vst1q_u16(out + 8, F::pack8(vget_high_u8(r), vget_high_u8(g), vget_high_u8(b), vget_high_u8(a)));
+}
+#endif
+
+// Converts count pixels of one row. bias holds the dither values of 4 pixels, all zero when not dithering;
+// the row starts at a multiple of 4 pixels so the vector loops can use it as is.
+template <class F>
+static void convertRowRGBA8888(const unsigned char *in, unsigned short *out, unsigned int count, const unsigned char *bias, unsigned int features)
+{
+    unsigned int i = 0;
+#if defined(CC_PIXEL_SSE2)
+    if (features & kCCCPUFeature_SSE2)
+    {
+        __m128i vbias = _mm_loadu_si128((const __m128i*)bias);
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i p0 = _mm_adds_epu8(_mm_loadu_si128((const __m128i*)(in + i * 4)), vbias);
+            __m128i p1 = _mm_adds_epu8(_mm_loadu_si128((const __m128i*)(in + i * 4 + 16)), vbias);
+            _mm_storeu_si128((__m128i*)(out + i), packLow16(F::pack4(p0), F::pack4(p1)));
+        }
+    }
+#elif defined(CC_PIXEL_NEON)
+    if (features & kCCCPUFeature_NEON)
+    {
+        uint8x16_t br, bg, bb;
+        neonBias(bias, br, bg, bb);
+        for (; i + 16 <= count; i += 16)
+        {
+            uint8x16x4_t p = vld4q_u8(in + i * 4);
+            storeNEON<F>(out + i, vqaddq_u8(p.val[0], br), vqaddq_u8(p.val[1], bg), vqaddq_u8(p.val[2], bb), p.val[3]);
+        }
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        const unsigned char *src = in + i * 4;
+        const unsigned char *b = bias + (i & 3) * 4;
+        out[i] = F::pack(addSaturate(src[0], b[0]), addSaturate(src[1], b[1]), addSaturate(src[2], b[2]), src[3]);
+    }
+}
+
+template <class F>
+static void convertRowRGB888(const unsigned char *in, unsigned short *out, unsigned int count, const unsigned char *bias, unsigned int features)
+{
+    unsigned int i = 0;
+#if defined(CC_PIXEL_SSSE3)
+    if (features & kCCCPUFeature_SSSE3)
+    {
+        i = convertRowRGB888SSSE3<F>(in, out, count, bias);
+    }
+#elif defined(CC_PIXEL_NEON)
+    if (features & kCCCPUFeature_NEON)
+    {
+        uint8x16_t br, bg, bb;
+        neonBias(bias, br, bg, bb);
+        for (; i + 16 <= count; i += 16)
+        {
+            uint8x16x3_t p = vld3q_u8(in + i * 3);
+            storeNEON<F>(out + i, vqaddq_u8(p.val[0], br), vqaddq_u8(p.val[1], bg), vqaddq_u8(p.val[2], bb), vdupq_n_u8(255));
+        }
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        const unsigned char *src = in + i * 3;
+        const unsigned char *b = bias + (i & 3) * 4;
+        out[i] = F::pack(addSaturate(src[0], b[0]), addSaturate(src[1], b[1]), addSaturate(src[2], b[2]), 255);
+    }
+}
+
+template <class F>
+static void convertTo16(const unsigned char *in, unsigned int inBpp, unsigned short *out, unsigned int width, unsigned int height, bool dither, unsigned int features)
+{
+    unsigned char bias[16];
+
+    if (! dither)
+    {
+        // without dithering the image is one long row
+        width *= height;
+        height = 1;
+    }
+
+    for (unsigned int y = 0; y < height; ++y)
+    {
+        ditherBias(bias, y, dither, F::kRBits, F::kGBits, F::kBBits);
+        if (inBpp == 4)
+        {
+            convertRowRGBA8888<F>(in, out, width, bias, features);
+        }
+        else
+        {
+            convertRowRGB888<F>(in, out, width, bias, features);
+        }
+        in += width * inBpp;
+        out += width;
+    }
+}
+
+void ccConvertRGBA8888ToRGB565(const unsigned char *in, unsigned short *out, unsigned int width, unsigned int height, bool dither)
+{
+    convertTo16<FormatRGB565>(in, 4, out, width, height, dither, ccGetCPUFeatures());
+}
+
+void ccConvertRGBA8888ToRGBA4444(const unsigned char *in, unsigned short *out, unsigned int width, unsigned int height, bool dither)
+{
+    convertTo16<FormatRGBA4444>(in, 4, out, width, height, dither, ccGetCPUFeatures());
+}
+
+void ccConvertRGBA8888ToRGB5A1(const unsigned char *in, unsigned short *out, unsigned int width, unsigned int height, bool dither)
+{
+    convertTo16<FormatRGB5A1>(in, 4, out, width, height, dither, ccGetCPUFeatures());
+}
+
+void ccConvertRGB888ToRGB565(const unsigned char *in, unsigned short *out, unsigned int width, unsigned int height, bool dither)
+{
+    convertTo16<FormatRGB565>(in, 3, out, width, height, dither, ccGetCPUFeatures());
+}
+
+// premultiplication
+
+static void premultiplyAlpha(unsigned char *pixels, unsigned int count, unsigned int features)
+{
+    unsigned int i = 0;
+#if defined(CC_PIXEL_SSE2)
+    if (features & kCCCPUFeature_SSE2)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i one = _mm_set1_epi16(1);
+        const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i *p = (__m128i*)(pixels + i * 4);
+            __m128i v = _mm_loadu_si128(p);
+            __m128i lo = _mm_unpacklo_epi8(v, zero);
+            __m128i hi = _mm_unpackhi_epi8(v, zero);
+            __m128i alo = _mm_add_epi16(_mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, 0xFF), 0xFF), one);
+            __m128i ahi = _mm_add_epi16(_mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, 0xFF), 0xFF), one);
+            lo = _mm_srli_epi16(_mm_mullo_epi16(lo, alo), 8);
+            hi = _mm_srli_epi16(_mm_mullo_epi16(hi, ahi), 8);
+            __m128i rgb = _mm_andnot_si128(alphaMask, _mm_packus_epi16(lo, hi));
+            _mm_storeu_si128(p, _mm_or_si128(rgb, _mm_and_si128(v, alphaMask)));
+        }
+    }
+#elif defined(CC_PIXEL_NEON)
+    if (features & kCCCPUFeature_NEON)
+    {
+        for (; i + 16 <= count; i += 16)
+        {
+            unsigned char *p = pixels + i * 4;
+            uint8x16x4_t v = vld4q_u8(p);
+            uint8x8_t alo = vget_low_u8(v.val[3]);
+            uint8x8_t ahi = vget_high_u8(v.val[3]);
+            for (int c = 0; c < 3; ++c)
+            {
+                // c * (a + 1) == c * a + c
+                uint8x8_t clo = vget_low_u8(v.val[c]);
+                uint8x8_t chi = vget_high_u8(v.val[c]);
+                v.val[c] = vcombine_u8(vshrn_n_u16(vaddw_u8(vmull_u8(clo, alo), clo), 8),
+                                       vshrn_n_u16(vaddw_u8(vmull_u8(chi, ahi), chi), 8));
+            }
+            vst4q_u8(p, v);
+        }
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        unsigned char *p = pixels + i * 4;
+        unsigned int a = p[3] + 1;
+        p[0] = (unsigned char)((p[0] * a) >> 8);
+        p[1] = (unsigned char)((p[1] * a) >> 8);
+        p[2] = (unsigned char)((p[2] * a) >> 8);
+    }
+}
+
+void ccPremultiplyAlphaRGBA8888(unsigned char *pixels, unsigned int count)
+{
+    premultiplyAlpha(pixels, count, ccGetCPUFeatures());
+}
+
+// 8, 16 and 24 bit formats
+
+static void convertToRGB888(const unsigned char *in, unsigned char *out, unsigned int count, unsigned int features)
+{
+    unsigned int i = 0;
+#if defined(CC_PIXEL_SSSE3)
+    if (features & kCCCPUFeature_SSSE3)
+    {
+        i = convertRGBA8888ToRGB888SSSE3(in, out, count);
+    }
+#elif defined(CC_PIXEL_NEON)
+    if (features & kCCCPUFeature_NEON)
+    {
+        for (; i + 16 <= count; i += 16)
+        {
+            uint8x16x4_t p = vld4q_u8(in + i * 4);
+            uint8x16x3_t rgb = { { p.val[0], p.val[1], p.val[2] } };
+            vst3q_u8(out + i * 3, rgb);
+        }
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        out[i * 3 + 0] = in[i * 4 + 0];
+        out[i * 3 + 1] = in[i * 4 + 1];
+        out[i * 3 + 2] = in[i * 4 + 2];
+    }
+}
+
+void ccConvertRGBA8888ToRGB888(const unsigned char *in, unsigned char *out, unsigned int count)
+{
+    convertToRGB888(in, out, count, ccGetCPUFeatures());
+}
+
+static void convertToA8(const unsigned char *in, unsigned char *out, unsigned int count, unsigned int features)
+{
+    unsigned int i = 0;
+#if defined(CC_PIXEL_SSE2)
+    if (features & kCCCPUFeature_SSE2)
+    {
+        for (; i + 16 <= count; i += 16)
+        {
+            const __m128i *src = (const __m128i*)(in + i * 4);
+            __m128i a0 = _mm_srli_epi32(_mm_loadu_si128(src + 0), 24);
+            __m128i a1 = _mm_srli_epi32(_mm_loadu_si128(src + 1), 24);
+            __m128i a2 = _mm_srli_epi32(_mm_loadu_si128(src + 2), 24);
+            __m128i a3 = _mm_srli_epi32(_mm_loadu_si128(src + 3), 24);
+            _mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(_mm_packs_epi32(a0, a1), _mm_packs_epi32(a2, a3)));
+        }
+    }
+#elif defined(CC_PIXEL_NEON)
+    if (features & kCCCPUFeature_NEON)
+    {
+        for (; i + 16 <= count; i += 16)
+        {
+            vst1q_u8(out + i, vld4q_u8(in + i * 4).val[3]);
+        }
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        out[i] = in[i * 4 + 3];
+    }
+}
+
+void ccConvertRGBA8888ToA8(const unsigned char *in, unsigned char *out, unsigned int count)
+{
+    convertToA8(in, out, count, ccGetCPUFeatures());
+}
+
+static inline unsigned char intensity(const unsigned char *p)
+{
+    return (unsigned char)((p[0] * 77 + p[1] * 150 + p[2] * 29) >> 8);
+}
+
+#if defined(CC_PIXEL_SSE2)
+// intensity and alpha of 8 pixels, as 8 shorts each
+static inline void intensityAlphaSSE2(const unsigned char *in, __m128i &i16, __m128i &a16)
+{
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    __m128i p0 = _mm_loadu_si128((const __m128i*)in);
+    __m128i p1 = _mm_loadu_si128((const __m128i*)(in + 16));
+    __m128i r = _mm_packs_epi32(_mm_and_si128(p0, mask), _mm_and_si128(p1, mask));
+    __m128i g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 8), mask), _mm_and_si128(_mm_srli_epi32(p1, 8), mask));
+    __m128i b = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 16), mask), _mm_and_si128(_mm_srli_epi32(p1, 16), mask));
+    a16 = _mm_packs_epi32(_mm_srli_epi32(p0, 24), _mm_srli_epi32(p1, 24));
+    // the sum is at most 255 * 256 and fits in an unsigned short
+    __m128i sum = _mm_add_epi16(_mm_mullo_epi16(r, _mm_set1_epi16(77)), _mm_mullo_epi16(g, _mm_set1_epi16(150)));
+    sum = _mm_add_epi16(sum, _mm_mullo_epi16(b, _mm_set1_epi16(29)));
+    i16 = _mm_srli_epi16(sum, 8);
+}
+#endif
+
+#if defined(CC_PIXEL_NEON)
+static inline uint8x8_t intensityNEON(uint8x8_t r, uint8x8_t g, uint8x8_t b)
+{
+    uint16x8_t sum = vmull_u8(r, vdup_n_u8(77));
+    sum = vmlal_u8(sum, g, vdup_n_u8(150));
+    sum = vmlal_u8(sum, b, vdup_n_u8(29));
+    return vshrn_n_u16(sum, 8);
+}
+
+static inline uint8x16_t intensityNEON(const uint8x16x4_t &p)
+{
+    return vcombine_u8(intensityNEON(vget_low_u8(p.val[0]), vget_low_u8(p.val[1]), vget_low_u8(p.val[2])),
+                       intensityNEON(vget_high_u8(p.val[0]), vget_high_u8(p.val[1]), vget_high_u8(p.val[2])));
+}
+#endif
+
+static void convertToI8(const unsigned char *in, unsigned char *out, unsigned int count, unsigned int features)
+{
+    unsigned int i = 0;
+#if defined(CC_PIXEL_SSE2)
+    if (features & kCCCPUFeature_SSE2)
+    {
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i i0, i1, a;
+            intensityAlphaSSE2(in + i * 4, i0, a);
+            intensityAlphaSSE2(in + i * 4 + 32, i1, a);
+            _mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(i0, i1));
+        }
+    }
+#elif defined(CC_PIXEL_NEON)
+    if (features & kCCCPUFeature_NEON)
+    {
+        for (; i + 16 <= count; i += 16)
+        {
+            vst1q_u8(out + i, intensityNEON(vld4q_u8(in + i * 4)));
+        }
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        out[i] = intensity(in + i * 4);
+    }
+}
+
+void ccConvertRGBA8888ToI8(const unsigned char *in, unsigned char *out, unsigned int count)
+{
+    convertToI8(in, out, count, ccGetCPUFeatures());
+}
+
+static void convertToAI88(const unsigned char *in, unsigned char *out, unsigned int count, unsigned int features)
+{
+    unsigned int i = 0;
+#if defined(CC_PIXEL_SSE2)
+    if (features & kCCCPUFeature_SSE2)
+    {
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i i16, a16;
+            intensityAlphaSSE2(in + i * 4, i16, a16);
+            _mm_storeu_si128((__m128i*)(out + i * 2), _mm_or_si128(i16, _mm_slli_epi16(a16, 8)));
+        }
+    }
+#elif defined(CC_PIXEL_NEON)
+    if (features & kCCCPUFeature_NEON)
+    {
+        for (; i + 16 <= count; i += 16)
+        {
+            uint8x16x4_t p = vld4q_u8(in + i * 4);
+            uint8x16x2_t ia = { { intensityNEON(p), p.val[3] } };
+            vst2q_u8(out + i * 2, ia);
+        }
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        out[i * 2 + 0] = intensity(in + i * 4);
+        out[i * 2 + 1] = in[i * 4 + 3];
+    }
+}
+
+void ccConvertRGBA8888ToAI88(const unsigned char *in, unsigned char *out, unsigned int count)
+{
+    convertToAI88(in, out, count, ccGetCPUFeatures());
+}
+
+
+// checks
+
+static const struct
+{
+    const char *name;
+    unsigned int bytesPerPixel;
+} s_checkedKernels[] = {
+    { "RGBA8888 -> RGB565", 2 },
+    { "RGBA8888 -> RGBA4444", 2 },
+    { "RGBA8888 -> RGB5A1", 2 },
+    { "RGB888 -> RGB565", 2 },
+    { "RGBA8888 -> RGB888", 3 },
+    { "RGBA8888 -> A8", 1 },
+    { "RGBA8888 -> I8", 1 },
+    { "RGBA8888 -> AI88", 2 },
+    { "premultiply RGBA8888", 4 },
+};
+
+static void runCheckedKernel(unsigned int kernel, const unsigned char *rgba, const unsigned char *rgb, unsigned char *out,
+                             unsigned int width, unsigned int height, bool dither, unsigned int features)
+{
+    unsigned int count = width * height;
+    switch (kernel)
+    {
+    case 0: convertTo16<FormatRGB565>(rgba, 4, (unsigned short*)out, width, height, dither, features); break;
+    case 1: convertTo16<FormatRGBA4444>(rgba, 4, (unsigned short*)out, width, height, dither, features); break;
+    case 2: convertTo16<FormatRGB5A1>(rgba, 4, (unsigned short*)out, width, height, dither, features); break;
+    case 3: convertTo16<FormatRGB565>(rgb, 3, (unsigned short*)out, width, height, dither, features); break;
+    case 4: convertToRGB888(rgba, out, count, features); break;
+    case 5: convertToA8(rgba, out, count, features); break;
+    case 6: convertToI8(rgba, out, count, features); break;
+    case 7: convertToAI88(rgba, out, count, features); break;
+    default:
+        memcpy(out, rgba, count * 4);
+        premultiplyAlpha(out, count, features);
+        break;
+    }
+}
+
+bool ccCheckPixelConversion(void)
+{
+    unsigned int features = ccGetCPUFeatures();
+    if (! features)
+    {
+        return true;
+    }
+
+    // odd sizes, so that the scalar tails run after the vector loops
+    static const unsigned int sizes[][2] = { { 1, 1 }, { 7, 3 }, { 33, 9 }, { 67, 5 } };
+    enum { kMaxPixels = 67 * 5 };
+    // unsigned short aligned for the 16 bit outputs
+    unsigned short scalarOut[kMaxPixels * 2];
+    unsigned short simdOut[kMaxPixels * 2];
+    unsigned char rgba[kMaxPixels * 4];
+    unsigned char rgb[kMaxPixels * 3];
+
+    // the same pseudo random pixels every time, without touching the seed of rand()
+    unsigned int seed = 12345;
+    for (unsigned int i = 0; i < kMaxPixels * 4; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        rgba[i] = (unsigned char)(seed >> 16);
+    }
+    memcpy(rgb, rgba, sizeof(rgb));
+
+    bool identical = true;
+    for (unsigned int k = 0; k < sizeof(s_checkedKernels) / sizeof(s_checkedKernels[0]); ++k)
+    {
+        for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+        {
+            unsigned int width = sizes[s][0], height = sizes[s][1];
+            for (int dither = 0; dither < 2; ++dither)
+            {
+                runCheckedKernel(k, rgba, rgb, (unsigned char*)scalarOut, width, height, dither != 0, 0);
+                runCheckedKernel(k, rgba, rgb, (unsigned char*)simdOut, width, height, dither != 0, features);
+                if (memcmp(scalarOut, simdOut, width * height * s_checkedKernels[k].bytesPerPixel) != 0)
+                {
+                    CCLog("cocos2d: %s differs from the scalar conversion for %ux%u pixels%s", s_checkedKernels[k].name,
+                          width, height, dither ? ", dithered" : "");
+                    identical = false;
+                }
+            }
+        }
+    }
+    return identical;
+}
+
+NS_CC_END
@@ -0,0 +1,84 @@
+/****************************************************************************
+Copyright (c) 2013 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#ifndef __SUPPORT_IMAGE_SUPPORT_CCPIXELCONVERSION_H__
+#define __SUPPORT_IMAGE_SUPPORT_CCPIXELCONVERSION_H__
+
+/** @file ccPixelConversion.h
+Pixel format conversion and alpha premultiplication kernels used when images are uploaded as textures.
+Every function has a scalar implementation and, when the CPU supports it, a SSE2/SSSE3 or NEON one.
+All the implementations produce exactly the same bytes.
+
+Input pixels are RGBA8888 (or RGB888 when stated) stored as bytes in R, G, B, A order.
+16 bit outputs are native endian unsigned shorts, as glTexImage2D expects them.
+*/
+
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+/** instruction sets the conversion kernels can use */
+enum {
+    kCCCPUFeature_SSE2  = 1 << 0,
+    kCCCPUFeature_SSSE3 = 1 << 1,
+    kCCCPUFeature_NEON  = 1 << 2,
+};
+
+/** returns the kCCCPUFeature flags supported by both the CPU and this build, restricted by ccSetCPUFeaturesMask */
+CC_DLL unsigned int ccGetCPUFeatures(void);
+
+/** restricts the instruction sets the kernels may use. 0 forces the scalar code, ~0 (the default) enables everything.
+ Useful to compare the implementations; not meant to be changed while textures are loaded in another thread.
+*/
+CC_DLL void ccSetCPUFeaturesMask(unsigned int mask);
+
+/** premultiplies count RGBA8888 pixels in place: c = c * (a + 1) >> 8 */
+CC_DLL void ccPremultiplyAlphaRGBA8888(unsigned char *pixels, unsigned int count);
+
+/** RGBA8888 to RGB565. When dither is true a 4x4 ordered dither is applied to the color channels. */
+CC_DLL void ccConvertRGBA8888ToRGB565(const unsigned char *in, unsigned short *out, unsigned int width, unsigned int height, bool dither);
+/** RGBA8888 to RGBA4444. When dither is true a 4x4 ordered dither is applied to the color channels. */
+CC_DLL void ccConvertRGBA8888ToRGBA4444(const unsigned char *in, unsigned short *out, unsigned int width, unsigned int height, bool dither);
+/** RGBA8888 to RGB5A1. When dither is true a 4x4 ordered dither is applied to the color channels. */
+CC_DLL void ccConvertRGBA8888ToRGB5A1(const unsigned char *in, unsigned short *out, unsigned int width, unsigned int height, bool dither);
+/** RGB888 to RGB565. When dither is true a 4x4 ordered dither is applied. */
+CC_DLL void ccConvertRGB888ToRGB565(const unsigned char *in, unsigned short *out, unsigned int width, unsigned int height, bool dither);
+
+/** RGBA8888 to RGB888, count pixels */
+CC_DLL void ccConvertRGBA8888ToRGB888(const unsigned char *in, unsigned char *out, unsigned int count);
+/** RGBA8888 to A8, count pixels */
+CC_DLL void ccConvertRGBA8888ToA8(const unsigned char *in, unsigned char *out, unsigned int count);
+/** RGBA8888 to I8, count pixels. Intensity is (77 * r + 150 * g + 29 * b) >> 8. */
+CC_DLL void ccConvertRGBA8888ToI8(const unsigned char *in, unsigned char *out, unsigned int count);
+/** RGBA8888 to AI88 (GL_LUMINANCE_ALPHA: intensity then alpha), count pixels */
+CC_DLL void ccConvertRGBA8888ToAI88(const unsigned char *in, unsigned char *out, unsigned int count);
+
+/** runs every kernel on generated pixels with the instruction sets of ccGetCPUFeatures and with the scalar code, and
+ logs the kernels whose bytes differ. Doesn't change the mask. CCTexture2D calls it once in debug builds.
+ @return true when all the outputs are identical
+*/
+CC_DLL bool ccCheckPixelConversion(void);
+
+NS_CC_END
+
+#endif // __SUPPORT_IMAGE_SUPPORT_CCPIXELCONVERSION_H__
@@ -0,0 +1,427 @@
+/****************************************************************************
+Copyright (c) 2013 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+/*
+ * ETC1 / ETC2 decoding follows the OpenGL ES 3.0 specification, Annex C.
+ * S3TC decoding follows the GL_EXT_texture_compression_s3tc specification.
+ */
+
+#include "ccTextureDecoders.h"
+#include <string.h>
+
+namespace cocos2d {
+
+static const int s_etcModifierTable[8][4] = {
+    {  2,   8,  -2,   -8 },
+    {  5,  17,  -5,  -17 },
+    {  9,  29,  -9,  -29 },
+    { 13,  42, -13,  -42 },
+    { 18,  60, -18,  -60 },
+    { 24,  80, -24,  -80 },
+    { 33, 106, -33, -106 },
+    { 47, 183, -47, -183 },
+};
+
+static const int s_etcDistanceTable[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+static const int s_eacModifierTable[16][8] = {
+    { -3, -6, -9, -15, 2, 5, 8, 14 },
+    { -3, -7, -10, -13, 2, 6, 9, 12 },
+    { -2, -5, -8, -13, 1, 4, 7, 12 },
+    { -2, -4, -6, -13, 1, 3, 5, 12 },
+    { -3, -6, -8, -12, 2, 5, 7, 11 },
+    { -3, -7, -9, -11, 2, 6, 8, 10 },
+    { -4, -7, -8, -11, 3, 6, 7, 10 },
+    { -3, -5, -8, -11, 2, 4, 7, 10 },
+    { -2, -6, -8, -10, 1, 5, 7, 9 },
+    { -2, -5, -8, -10, 1, 4, 7, 9 },
+    { -2, -4, -8, -10, 1, 3, 7, 9 },
+    { -2, -5, -7, -10, 1, 4, 6, 9 },
+    { -3, -4, -7, -10, 2, 3, 6, 9 },
+    { -1, -2, -3, -10, 0, 1, 2, 9 },
+    { -4, -6, -8, -9, 3, 5, 7, 8 },
+    { -3, -5, -7, -9, 2, 4, 6, 8 },
+};
+
+static inline unsigned char clamp255(int value)
+{
+    return (unsigned char)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+static inline unsigned int readBE32(const unsigned char *p)
+{
+    return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | (unsigned int)p[3];
+}
+
+static inline unsigned int bits(unsigned int word, int high, int low)
+{
+    return (word >> low) & ((1u << (high - low + 1)) - 1);
+}
+
+static inline int extend4(unsigned int v) { return (int)((v << 4) | v); }
+static inline int extend5(unsigned int v) { return (int)((v << 3) | (v >> 2)); }
+static inline int extend6(unsigned int v) { return (int)((v << 2) | (v >> 4)); }
+static inline int extend7(unsigned int v) { return (int)((v << 1) | (v >> 6)); }
+
+// sign extends a 3 bits two's complement value
+static inline int signed3(unsigned int v)
+{
+    return (v & 4) ? (int)v - 8 : (int)v;
+}
+
+// ETC pixel indices are stored column major: pixel (x, y) uses bit (x * 4 + y)
+static inline unsigned int etcPixelIndex(unsigned int low, int x, int y)
+{
+    int i = x * 4 + y;
+    return (((low >> (i + 16)) & 1) << 1) | ((low >> i) & 1);
+}
+
+static void decodeETCIndividualOrDifferential(unsigned int high, unsigned int low, int c1[3], int c2[3], unsigned char *block)
+{
+    int table1 = bits(high, 7, 5);
+    int table2 = bits(high, 4, 2);
+    bool flip = (high & 1) != 0;
+
+    for (int y = 0; y < 4; ++y)
+    {
+        for (int x = 0; x < 4; ++x)
+        {
+            bool first = flip ? (y < 2) : (x < 2);
+            const int *base = first ? c1 : c2;
+            int modifier = s_etcModifierTable[first ? table1 : table2][etcPixelIndex(low, x, y)];
+            unsigned char *pixel = block + (y * 4 + x) * 4;
+            pixel[0] = clamp255(base[0] + modifier);
+            pixel[1] = clamp255(base[1] + modifier);
+            pixel[2] = clamp255(base[2] + modifier);
+            pixel[3] = 255;
+        }
+    }
+}
+
+static void decodeETCPaintColors(unsigned int low, int paint[4][3], unsigned char *block)
+{
+    for (int y = 0; y < 4; ++y)
+    {
+        for (int x = 0; x < 4; ++x)
+        {
+            const int *color = paint[etcPixelIndex(low, x, y)];
+            unsigned char *pixel = block + (y * 4 + x) * 4;
+            pixel[0] = clamp255(color[0]);
+            pixel[1] = clamp255(color[1]);
+            pixel[2] = clamp255(color[2]);
+            pixel[3] = 255;
+        }
+    }
+}
+
+static void decodeETCPlanar(unsigned int high, unsigned int low, unsigned char *block)
+{
+    int ro = extend6(bits(high, 30, 25));
+    int go = extend7((bits(high, 24, 24) << 6) | bits(high, 22, 17));
+    int bo = extend6((bits(high, 16, 16) << 5) | (bits(high, 12, 11) << 3) | bits(high, 9, 7));
+    int rh = extend6((bits(high, 6, 2) << 1) | bits(high, 0, 0));
+    int gh = extend7(bits(low, 31, 25));
+    int bh = extend6(bits(low, 24, 19));
+    int rv = extend6(bits(low, 18, 13));
+    int gv = extend7(bits(low, 12, 6));
+    int bv = extend6(bits(low, 5, 0));
+
+    for (int y = 0; y < 4; ++y)
+    {
+        for (int x = 0; x < 4; ++x)
+        {
+            unsigned char *pixel = block + (y * 4 + x) * 4;
+            pixel[0] = clamp255((x * (rh - ro) + y * (rv - ro) + 4 * ro + 2) >> 2);
+            pixel[1] = clamp255((x * (gh - go) + y * (gv - go) + 4 * go + 2) >> 2);
+            pixel[2] = clamp255((x * (bh - bo) + y * (bv - bo) + 4 * bo + 2) >> 2);
+            pixel[3] = 255;
+        }
+    }
+}
+
+// decodes one 64 bits ETC1 / ETC2 RGB block into 4x4 RGBA pixels
+static void decodeETCBlock(const unsigned char *data, bool etc2, unsigned char *block)
+{
+    unsigned int high = readBE32(data);
+    unsigned int low = readBE32(data + 4);
+    int c1[3], c2[3];
+
+    if ((high & 2) == 0)
+    {
+        // individual mode
+        c1[0] = extend4(bits(high, 31, 28));
+        c2[0] = extend4(bits(high, 27, 24));
+        c1[1] = extend4(bits(high, 23, 20));
+        c2[1] = extend4(bits(high, 19, 16));
+        c1[2] = extend4(bits(high, 15, 12));
+        c2[2] = extend4(bits(high, 11, 8));
+        decodeETCIndividualOrDifferential(high, low, c1, c2, block);
+        return;
+    }
+
+    // differential mode, the overflow cases select the ETC2 modes
+    int r = (int)bits(high, 31, 27), dr = signed3(bits(high, 26, 24));
+    int g = (int)bits(high, 23, 19), dg = signed3(bits(high, 18, 16));
+    int b = (int)bits(high, 15, 11), db = signed3(bits(high, 10, 8));
+
+    if (etc2 && (r + dr < 0 || r + dr > 31))
+    {
+        // T mode
+        int paint[4][3];
+        int base1[3] = { extend4((bits(high, 28, 27) << 2) | bits(high, 25, 24)), extend4(bits(high, 23, 20)), extend4(bits(high, 19, 16)) };
+        int base2[3] = { extend4(bits(high, 15, 12)), extend4(bits(high, 11, 8)), extend4(bits(high, 7, 4)) };
+        int d = s_etcDistanceTable[(bits(high, 3, 2) << 1) | bits(high, 0, 0)];
+        for (int i = 0; i < 3; ++i)
+        {
+            paint[0][i] = base1[i];
+            paint[1][i] = base2[i] + d;
+            paint[2][i] = base2[i];
+            paint[3][i] = base2[i] - d;
+        }
+        decodeETCPaintColors(low, paint, block);
+    }
+    else if (etc2 && (g + dg < 0 || g + dg > 31))
+    {
+        // H mode
+        int paint[4][3];
+        int base1[3] = { extend4(bits(high, 30, 27)), extend4((bits(high, 26, 24) << 1) | bits(high, 20, 20)), extend4((bits(high, 19, 19) << 3) | bits(high, 17, 15)) };
+        int base2[3] = { extend4(bits(high, 14, 11)), extend4(bits(high, 10, 7)), extend4(bits(high, 6, 3)) };
+        int value1 = (base1[0] << 16) | (base1[1] << 8) | base1[2];
+        int value2 = (base2[0] << 16) | (base2[1] << 8) | base2[2];
+        int d = s_etcDistanceTable[(bits(high, 2, 2) << 2) | (bits(high, 0, 0) << 1) | (value1 >= value2 ? 1 : 0)];
+        for (int i = 0; i < 3; ++i)
+        {
+            paint[0][i] = base1[i] + d;
+            paint[1][i] = base1[i] - d;
+            paint[2][i] = base2[i] + d;
+            paint[3][i] = base2[i] - d;
+        }
+        decodeETCPaintColors(low, paint, block);
+    }
+    else if (etc2 && (b + db < 0 || b + db > 31))
+    {
+        decodeETCPlanar(high, low, block);
+    }
+    else
+    {
+        c1[0] = extend5(r);
+        c1[1] = extend5(g);
+        c1[2] = extend5(b);
+        c2[0] = extend5((r + dr) & 31);
+        c2[1] = extend5((g + dg) & 31);
+        c2[2] = extend5((b + db) & 31);
+        decodeETCIndividualOrDifferential(high, low, c1, c2, block);
+    }
+}
+
+// decodes the 64 bits EAC alpha block of ETC2 RGBA8 into the alpha channel of block
+static void decodeEACAlphaBlock(const unsigned char *data, unsigned char *block)
+{
+    int base = data[0];
+    int multiplier = data[1] >> 4;
+    const int *modifiers = s_eacModifierTable[data[1] & 0x0f];
+
+    // 48 bits of 3 bits indices, column major
+    unsigned long long indices = 0;
+    for (int i = 2; i < 8; ++i)
+    {
+        indices = (indices << 8) | data[i];
+    }
+
+    for (int x = 0; x < 4; ++x)
+    {
+        for (int y = 0; y < 4; ++y)
+        {
+            int i = x * 4 + y;
+            int index = (int)((indices >> (45 - i * 3)) & 7);
+            block[(y * 4 + x) * 4 + 3] = clamp255(base + modifiers[index] * multiplier);
+        }
+    }
+}
+
+static inline void unpack565(unsigned int c, int rgb[3])
+{
+    rgb[0] = extend5((c >> 11) & 31);
+    rgb[1] = extend6((c >> 5) & 63);
+    rgb[2] = extend5(c & 31);
+}
+
+// decodes the 64 bits DXT color block, DXT3/5 always use the four colors mode
+static void decodeS3TCColorBlock(const unsigned char *data, bool dxt1, unsigned char *block)
+{
+    unsigned int c0 = data[0] | (data[1] << 8);
+    unsigned int c1 = data[2] | (data[3] << 8);
+    unsigned int indices = data[4] | (data[5] << 8) | (data[6] << 16) | ((unsigned int)data[7] << 24);
+    int colors[4][4];
+
+    unpack565(c0, colors[0]);
+    unpack565(c1, colors[1]);
+    colors[0][3] = colors[1][3] = colors[2][3] = colors[3][3] = 255;
+
+    if (c0 > c1 || ! dxt1)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            colors[2][i] = (2 * colors[0][i] + colors[1][i]) / 3;
+            colors[3][i] = (colors[0][i] + 2 * colors[1][i]) / 3;
+        }
+    }
+    else
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            colors[2][i] = (colors[0][i] + colors[1][i]) / 2;
+            colors[3][i] = 0;
+        }
+        colors[3][3] = 0;
+    }
+
+    for (int i = 0; i < 16; ++i)
+    {
+        const int *color = colors[(indices >> (i * 2)) & 3];
+        unsigned char *pixel = block + i * 4;
+        pixel[0] = (unsigned char)color[0];
+        pixel[1] = (unsigned char)color[1];
+        pixel[2] = (unsigned char)color[2];
+        pixel[3] = (unsigned char)color[3];
+    }
+}
+
+static void decodeDXT3AlphaBlock(const unsigned char *data, unsigned char *block)
+{
+    for (int i = 0; i < 16; ++i)
+    {
+        unsigned int alpha = (data[i / 2] >> ((i & 1) * 4)) & 0x0f;
+        block[i * 4 + 3] = (unsigned char)extend4(alpha);
+    }
+}
+
+static void decodeDXT5AlphaBlock(const unsigned char *data, unsigned char *block)
+{
+    int alphas[8];
+    alphas[0] = data[0];
+    alphas[1] = data[1];
+    if (alphas[0] > alphas[1])
+    {
+        for (int i = 1; i < 7; ++i)
+        {
+            alphas[i + 1] = ((7 - i) * alphas[0] + i * alphas[1]) / 7;
+        }
+    }
+    else
+    {
+        for (int i = 1; i < 5; ++i)
+        {
+            alphas[i + 1] = ((5 - i) * alphas[0] + i * alphas[1]) / 5;
+        }
+        alphas[6] = 0;
+        alphas[7] = 255;
+    }
+
+    // 48 bits of 3 bits indices, little endian, row major
+    unsigned long long indices = 0;
+    for (int i = 7; i >= 2; --i)
+    {
+        indices = (indices << 8) | data[i];
+    }
+
+    for (int i = 0; i < 16; ++i)
+    {
+        block[i * 4 + 3] = (unsigned char)alphas[(indices >> (i * 3)) & 7];
+    }
+}
+
+static unsigned int blockSizeForFormat(ccCompressedFormat format)
+{
+    switch (format)
+    {
+        case kCCCompressedFormat_ETC1:
+        case kCCCompressedFormat_ETC2_RGB:
+        case kCCCompressedFormat_S3TC_DXT1:
+            return 8;
+        default:
+            return 16;
+    }
+}
+
+unsigned int ccCompressedImageSize(ccCompressedFormat format, unsigned int width, unsigned int height)
+{
+    return ((width + 3) / 4) * ((height + 3) / 4) * blockSizeForFormat(format);
+}
+
+bool ccDecodeCompressedImage(ccCompressedFormat format, const unsigned char *data, unsigned int dataLen,
+                             unsigned int width, unsigned int height, unsigned char *out)
+{
+    if (data == NULL || out == NULL || dataLen < ccCompressedImageSize(format, width, height))
+    {
+        return false;
+    }
+
+    unsigned int blockSize = blockSizeForFormat(format);
+    unsigned char block[4 * 4 * 4];
+
+    for (unsigned int by = 0; by < height; by += 4)
+    {
+        for (unsigned int bx = 0; bx < width; bx += 4)
+        {
+            switch (format)
+            {
+                case kCCCompressedFormat_ETC1:
+                    decodeETCBlock(data, false, block);
+                    break;
+                case kCCCompressedFormat_ETC2_RGB:
+                    decodeETCBlock(data, true, block);
+                    break;
+                case kCCCompressedFormat_ETC2_RGBA:
+                    decodeETCBlock(data + 8, true, block);
+                    decodeEACAlphaBlock(data, block);
+                    break;
+                case kCCCompressedFormat_S3TC_DXT1:
+                    decodeS3TCColorBlock(data, true, block);
+                    break;
+                case kCCCompressedFormat_S3TC_DXT3:
+                    decodeS3TCColorBlock(data + 8, false, block);
+                    decodeDXT3AlphaBlock(data, block);
+                    break;
+                case kCCCompressedFormat_S3TC_DXT5:
+                    decodeS3TCColorBlock(data + 8, false, block);
+                    decodeDXT5AlphaBlock(data, block);
+                    break;
+            }
+            data += blockSize;
+
+            // copy the block, clipping it at the right and bottom edges of the image
+            unsigned int columns = (width - bx) < 4 ? (width - bx) : 4;
+            unsigned int rows = (height - by) < 4 ? (height - by) : 4;
+            for (unsigned int y = 0; y < rows; ++y)
+            {
+                memcpy(out + ((by + y) * width + bx) * 4, block + y * 16, columns * 4);
+            }
+        }
+    }
+
+    return true;
+}
+
+}//namespace cocos2d
@@ -0,0 +1,56 @@
+/****************************************************************************
+Copyright (c) 2013 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#ifndef __SUPPORT_IMAGE_SUPPORT_CCTEXTUREDECODERS_H__
+#define __SUPPORT_IMAGE_SUPPORT_CCTEXTUREDECODERS_H__
+
+/** @file ccTextureDecoders.h
+Software decoders for block compressed texture formats.
+They are used when the GL context can't sample a compressed texture directly.
+*/
+
+namespace cocos2d {
+
+/** block compressed formats understood by ccDecodeCompressedImage */
+typedef enum {
+    kCCCompressedFormat_ETC1,
+    kCCCompressedFormat_ETC2_RGB,
+    kCCCompressedFormat_ETC2_RGBA,
+    kCCCompressedFormat_S3TC_DXT1,
+    kCCCompressedFormat_S3TC_DXT3,
+    kCCCompressedFormat_S3TC_DXT5,
+} ccCompressedFormat;
+
+/** returns the size in bytes of a width x height image in the given format */
+unsigned int ccCompressedImageSize(ccCompressedFormat format, unsigned int width, unsigned int height);
+
+/** decodes a width x height compressed image into RGBA8888 pixels.
+ @param out must hold width * height * 4 bytes
+ @return false if dataLen is smaller than the image
+*/
+bool ccDecodeCompressedImage(ccCompressedFormat format, const unsigned char *data, unsigned int dataLen,
+                             unsigned int width, unsigned int height, unsigned char *out);
+
+}//namespace cocos2d
+
+#endif // __SUPPORT_IMAGE_SUPPORT_CCTEXTUREDECODERS_H__
@@ -30,12 +30,19 @@
 #include "platform/CCFileUtils.h"
 #include "unzip.h"
 #include <map>
+#include <string.h>
+#include <pthread.h>
+
+#if CC_USE_ZSTD
+#include <zstd.h>
+#endif
 
 NS_CC_BEGIN
 
 unsigned int ZipUtils::s_uEncryptedPvrKeyParts[4] = {0,0,0,0};
 unsigned int ZipUtils::s_uEncryptionKey[1024];
 bool ZipUtils::s_bEncryptionKeyIsValid = false;
+unsigned int ZipUtils::s_uCCZThreadCount = 4;
 
 // --------------------- ZipUtils ---------------------
 
@@ -300,6 +307,185 @@ int ZipUtils::ccInflateGZipFile(const char *path, unsigned char **out)
     return offset;
 }
 
+// --------------------- CCZ decoders ---------------------
+
+static unsigned int cczReadInt32(const unsigned char *p)
+{
+    return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16) | ((unsigned int)p[2] << 8) | (unsigned int)p[3];
+}
+
+// Decodes an LZ4 block (no frame). Every length is checked against both buffers, and the
+// block must fill out exactly.
+static bool cczDecodeLZ4(const unsigned char *in, unsigned int inLen, unsigned char *out, unsigned int outLen)
+{
+    const unsigned char* ip = in;
+    const unsigned char* const iend = in + inLen;
+    unsigned char* op = out;
+    unsigned char* const oend = out + outLen;
+    
+    while( ip < iend )
+    {
+        unsigned int token = *ip++;
+        
+        // literals
+        size_t length = token >> 4;
+        if( length == 15 )
+        {
+            unsigned int s;
+            do
+            {
+                if( ip >= iend )
+                {
+                    return false;
+                }
+                s = *ip++;
+                length += s;
+            } while( s == 255 );
+        }
+        if( length > (size_t)(iend - ip) || length > (size_t)(oend - op) )
+        {
+            return false;
+        }
+        memcpy(op, ip, length);
+        ip += length;
+        op += length;
+        
+        // the last sequence only holds literals
+        if( ip == iend )
+        {
+            break;
+        }
+        
+        // match
+        if( iend - ip < 2 )
+        {
+            return false;
+        }
+        size_t distance = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if( distance == 0 || distance > (size_t)(op - out) )
+        {
+            return false;
+        }
+        
+        length = token & 15;
+        if( length == 15 )
+        {
+            unsigned int s;
+            do
+            {
+                if( ip >= iend )
+                {
+                    return false;
+                }
+                s = *ip++;
+                length += s;
+            } while( s == 255 );
+        }
+        length += 4;
+        if( length > (size_t)(oend - op) )
+        {
+            return false;
+        }
+        
+        const unsigned char* match = op - distance;
+        if( distance >= length )
+        {
+            memcpy(op, match, length);
+            op += length;
+        }
+        else
+        {
+            // overlapping copy repeats the last distance bytes
+            unsigned char* const end = op + length;
+            while( op < end )
+            {
+                *op++ = *match++;
+            }
+        }
+    }
+    
+    return op == oend;
+}
+
+static bool cczInflateBlock(unsigned short compression, const unsigned char *in, unsigned int inLen,
+                            unsigned char *out, unsigned int outLen)
+{
+    switch( compression )
+    {
+        case CCZ_COMPRESSION_ZLIB:
+        {
+            uLongf destlen = outLen;
+            return uncompress(out, &destlen, in, inLen) == Z_OK && destlen == outLen;
+        }
+        case CCZ_COMPRESSION_NONE:
+            if( inLen != outLen )
+            {
+                return false;
+            }
+            memcpy(out, in, outLen);
+            return true;
+        case CCZ_COMPRESSION_LZ4:
+            return cczDecodeLZ4(in, inLen, out, outLen);
+#if CC_USE_ZSTD
+        case CCZ_COMPRESSION_ZSTD:
+        {
+            size_t ret = ZSTD_decompress(out, outLen, in, inLen);
+            return ! ZSTD_isError(ret) && ret == outLen;
+        }
+#endif
+        default:
+            return false;
+    }
+}
+
+struct CCZChunk
+{
+    const unsigned char* source;
+    unsigned int sourceLen;
+    unsigned char* out;
+    unsigned int outLen;
+};
+
+struct CCZChunkJob
+{
+    unsigned short compression;
+    CCZChunk* chunks;
+    unsigned int count;
+    unsigned int next;
+    bool failed;
+    pthread_mutex_t mutex;
+};
+
+// Takes chunks off the job until none is left or one of them failed
+static void* cczChunkWorker(void *data)
+{
+    CCZChunkJob* job = (CCZChunkJob*)data;
+    
+    for( ;; )
+    {
+        pthread_mutex_lock(&job->mutex);
+        unsigned int index = job->next++;
+        bool stop = job->failed || index >= job->count;
+        pthread_mutex_unlock(&job->mutex);
+        
+        if( stop )
+        {
+            break;
+        }
+        
+        const CCZChunk& chunk = job->chunks[index];
+        if( ! cczInflateBlock(job->compression, chunk.source, chunk.sourceLen, chunk.out, chunk.outLen) )
+        {
+            pthread_mutex_lock(&job->mutex);
+            job->failed = true;
+            pthread_mutex_unlock(&job->mutex);
+        }
+    }
+    
+    return NULL;
+}
+
 int ZipUtils::ccInflateCCZFile(const char *path, unsigned char **out)
 {
     CCAssert(out, "");
@@ -317,53 +503,49 @@ int ZipUtils::ccInflateCCZFile(const char *path, unsigned char **out)
         return -1;
     }
     
-    struct CCZHeader *header = (struct CCZHeader*) compressed;
+    int ret = ccInflateCCZBuffer(compressed, fileLen, out);
+    delete [] compressed;
+    return ret;
+}
+
+int ZipUtils::ccInflateCCZBuffer(unsigned char *buffer, unsigned int bufferLen, unsigned char **out)
+{
+    CCAssert(out, "");
+    
+    if(NULL == buffer || bufferLen < sizeof(struct CCZHeader))
+    {
+        CCLOG("cocos2d: Invalid CCZ file");
+        return -1;
+    }
+    
+    struct CCZHeader *header = (struct CCZHeader*) buffer;
+    unsigned int version = CC_SWAP_INT16_BIG_TO_HOST( header->version );
+    unsigned short compression = CC_SWAP_INT16_BIG_TO_HOST( header->compression_type );
     
     // verify header
     if( header->sig[0] == 'C' && header->sig[1] == 'C' && header->sig[2] == 'Z' && header->sig[3] == '!' )
     {
         // verify header version
-        unsigned int version = CC_SWAP_INT16_BIG_TO_HOST( header->version );
-        if( version > 2 )
+        if( version > CCZ_VERSION_CHUNKED )
         {
             CCLOG("cocos2d: Unsupported CCZ header format");
-            delete [] compressed;
-            return -1;
-        }
-        
-        // verify compression format
-        if( CC_SWAP_INT16_BIG_TO_HOST(header->compression_type) != CCZ_COMPRESSION_ZLIB )
-        {
-            CCLOG("cocos2d: CCZ Unsupported compression method");
-            delete [] compressed;
             return -1;
         }
     }
     else if( header->sig[0] == 'C' && header->sig[1] == 'C' && header->sig[2] == 'Z' && header->sig[3] == 'p' )
     {
         // encrypted ccz file
-        header = (struct CCZHeader*) compressed;
         
         // verify header version
-        unsigned int version = CC_SWAP_INT16_BIG_TO_HOST( header->version );
         if( version > 0 )
         {
             CCLOG("cocos2d: Unsupported CCZ header format");
-            delete [] compressed;
-            return -1;
-        }
-        
-        // verify compression format
-        if( CC_SWAP_INT16_BIG_TO_HOST(header->compression_type) != CCZ_COMPRESSION_ZLIB )
-        {
-            CCLOG("cocos2d: CCZ Unsupported compression method");
-            delete [] compressed;
             return -1;
         }
         
         // decrypt
-        unsigned int* ints = (unsigned int*)(compressed+12);
-        int enclen = (fileLen-12)/4;
+        unsigned int* ints = (unsigned int*)(buffer+12);
+        int enclen = (bufferLen-12)/4;
         
         ccDecodeEncodedPvr(ints, enclen);
                 
@@ -375,7 +557,6 @@ int ZipUtils::ccInflateCCZFile(const char *path, unsigned char **out)
         if(calculated != required)
         {
             CCLOG("cocos2d: Can't decrypt image file. Is the decryption key valid?");
-            delete [] compressed;
             return -1;
         }
 #endif
@@ -383,7 +564,17 @@ int ZipUtils::ccInflateCCZFile(const char *path, unsigned char **out)
     else
     {
         CCLOG("cocos2d: Invalid CCZ file");
-        delete [] compressed;
+        return -1;
+    }
+    
+    // verify compression format
+    if( compression != CCZ_COMPRESSION_ZLIB && compression != CCZ_COMPRESSION_NONE && compression != CCZ_COMPRESSION_LZ4
+#if CC_USE_ZSTD
+        && compression != CCZ_COMPRESSION_ZSTD
+#endif
+        )
+    {
+        CCLOG("cocos2d: CCZ Unsupported compression method");
         return -1;
     }
     
@@ -393,17 +584,23 @@ int ZipUtils::ccInflateCCZFile(const char *path, unsigned char **out)
     if(! *out )
     {
         CCLOG("cocos2d: CCZ: Failed to allocate memory for texture");
-        delete [] compressed;
         return -1;
     }
     
-    unsigned long destlen = len;
-    unsigned long source = (unsigned long) compressed + sizeof(*header);
-    int ret = uncompress(*out, &destlen, (Bytef*)source, fileLen - sizeof(*header) );
+    const unsigned char* source = buffer + sizeof(*header);
+    unsigned int sourceLen = bufferLen - sizeof(*header);
+    bool ok;
     
-    delete [] compressed;
+    if( version == CCZ_VERSION_CHUNKED )
+    {
+        ok = ccInflateCCZChunks(compression, source, sourceLen, *out, len);
+    }
+    else
+    {
+        ok = cczInflateBlock(compression, source, sourceLen, *out, len);
+    }
     
-    if( ret != Z_OK )
+    if( ! ok )
     {
         CCLOG("cocos2d: CCZ: Failed to uncompress data");
         free( *out );
@@ -414,6 +611,90 @@ int ZipUtils::ccInflateCCZFile(const char *path, unsigned char **out)
     return len;
 }
 
+bool ZipUtils::ccInflateCCZChunks(unsigned short compression, const unsigned char *source, unsigned int sourceLen,
+                                  unsigned char *out, unsigned int outLen)
+{
+    if( sourceLen < sizeof(struct CCZChunkHeader) )
+    {
+        return false;
+    }
+    
+    unsigned int chunkSize = cczReadInt32(source);
+    unsigned int chunkCount = cczReadInt32(source + 4);
+    const unsigned char* sizes = source + sizeof(struct CCZChunkHeader);
+    
+    // the chunks must exactly cover the uncompressed data and their size table must fit in the file
+    if( chunkSize == 0 || chunkCount != ((unsigned long long)outLen + chunkSize - 1) / chunkSize
+        || chunkCount > (sourceLen - sizeof(struct CCZChunkHeader)) / 4 )
+    {
+        return false;
+    }
+    
+    CCZChunkJob job;
+    job.compression = compression;
+    job.count = chunkCount;
+    job.chunks = new CCZChunk[chunkCount];
+    job.next = 0;
+    job.failed = false;
+    
+    unsigned int offset = sizeof(struct CCZChunkHeader) + chunkCount * 4;
+    for( unsigned int i = 0; i < chunkCount; ++i )
+    {
+        CCZChunk& chunk = job.chunks[i];
+        chunk.sourceLen = cczReadInt32(sizes + i * 4);
+        if( chunk.sourceLen > sourceLen - offset )
+        {
+            delete [] job.chunks;
+            return false;
+        }
+        chunk.source = source + offset;
+        chunk.out = out + i * chunkSize;
+        chunk.outLen = (i + 1 < chunkCount) ? chunkSize : outLen - i * chunkSize;
+        offset += chunk.sourceLen;
+    }
+    
+    unsigned int threadCount = MIN(s_uCCZThreadCount, chunkCount);
+    pthread_t* threads = NULL;
+    unsigned int started = 0;
+    
+    pthread_mutex_init(&job.mutex, NULL);
+    if( threadCount > 1 )
+    {
+        threads = new pthread_t[threadCount - 1];
+        for( ; started < threadCount - 1; ++started )
+        {
+            // whatever could not be started is inflated by the calling thread
+            if( pthread_create(&threads[started], NULL, cczChunkWorker, &job) != 0 )
+            {
+                break;
+            }
+        }
+    }
+    
+    cczChunkWorker(&job);
+    
+    for( unsigned int i = 0; i < started; ++i )
+    {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_mutex_destroy(&job.mutex);
+    
+    delete [] threads;
+    delete [] job.chunks;
+    
+    return ! job.failed;
+}
+
+void ZipUtils::ccSetCCZThreadCount(unsigned int count)
+{
+    s_uCCZThreadCount = MAX(count, 1);
+}
+
+unsigned int ZipUtils::ccGetCCZThreadCount()
+{
+    return s_uCCZThreadCount;
+}
+
 void ZipUtils::ccSetPvrEncryptionKeyPart(int index, unsigned int value)
 {
     CCAssert(index >= 0, "Cocos2d: key part index cannot be less than 0");
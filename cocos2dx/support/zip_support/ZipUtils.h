@@ -34,17 +34,35 @@ namespace cocos2d
     */
     struct CCZHeader {
         unsigned char   sig[4];             // signature. Should be 'CCZ!' 4 bytes
-        unsigned short  compression_type;   // should 0
-        unsigned short  version;            // should be 2 (although version type==1 is also supported)
+        unsigned short  compression_type;   // one of the CCZ_COMPRESSION_ values
+        unsigned short  version;            // should be 2 (although version type==1 is also supported), or CCZ_VERSION_CHUNKED
         unsigned int    reserved;           // Reserved for users.
         unsigned int    len;                // size of the uncompressed file
     };
 
+    /** @struct CCZChunkHeader
+     Follows the CCZHeader of chunked files (version CCZ_VERSION_CHUNKED). It is followed by
+     chunk_count big endian compressed sizes, then by the chunks themselves. Every chunk is
+     compressed on its own with the header compression_type, and inflates to chunk_size bytes
+     except the last one, which holds the remainder of CCZHeader::len.
+     @since v2.1.4
+    */
+    struct CCZChunkHeader {
+        unsigned int    chunk_size;         // size of an uncompressed chunk
+        unsigned int    chunk_count;        // number of chunks
+    };
+
     enum {
         CCZ_COMPRESSION_ZLIB,               // zlib format.
         CCZ_COMPRESSION_BZIP2,              // bzip2 format (not supported yet)
         CCZ_COMPRESSION_GZIP,               // gzip format (not supported yet)
-        CCZ_COMPRESSION_NONE,               // plain (not supported yet)
+        CCZ_COMPRESSION_NONE,               // plain
+        CCZ_COMPRESSION_LZ4,                // lz4 block format
+        CCZ_COMPRESSION_ZSTD,               // zstandard format (only when built with CC_USE_ZSTD)
+    };
+
+    enum {
+        CCZ_VERSION_CHUNKED = 3,            // the payload is split into independently compressed chunks
     };
 
     class CC_DLL ZipUtils
@@ -89,6 +107,29 @@ namespace cocos2d
         */
         static int ccInflateCCZFile(const char *filename, unsigned char **out);
 
+        /** inflates a CCZ file already loaded in memory. Encrypted buffers are decrypted in place.
+        *
+        * @returns the length of the deflated buffer
+        *
+        * @since v2.1.4
+        */
+        static int ccInflateCCZBuffer(unsigned char *buffer, unsigned int bufferLen, unsigned char **out);
+
+        /** Sets how many threads, the calling one included, inflate the chunks of a chunked
+        * CCZ file. The chunks are inflated straight into the returned buffer, so they are
+        * ready to be uploaded as soon as the call returns. 1 inflates them on the calling
+        * thread only. Default: 4.
+        *
+        * @since v2.1.4
+        */
+        static void ccSetCCZThreadCount(unsigned int count);
+
+        /** Returns how many threads inflate the chunks of a chunked CCZ file.
+        *
+        * @since v2.1.4
+        */
+        static unsigned int ccGetCCZThreadCount();
+
         /** Sets the pvr.ccz encryption key parts separately for added
         * security.
         *
@@ -147,9 +188,13 @@ namespace cocos2d
         static inline void ccDecodeEncodedPvr (unsigned int *data, int len);
         static inline unsigned int ccChecksumPvr(const unsigned int *data, int len);
 
+        static bool ccInflateCCZChunks(unsigned short compression, const unsigned char *source, unsigned int sourceLen,
+                                       unsigned char *out, unsigned int outLen);
+
         static unsigned int s_uEncryptedPvrKeyParts[4];
         static unsigned int s_uEncryptionKey[1024];
         static bool s_bEncryptionKeyIsValid;
+        static unsigned int s_uCCZThreadCount;
     };
 
     // forward declaration
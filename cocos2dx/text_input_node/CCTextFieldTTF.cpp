@@ -26,24 +26,13 @@ THE SOFTWARE.
 
 #include "CCDirector.h"
 #include "CCEGLView.h"
+#include "support/ccUTF8.h"
 
 NS_CC_BEGIN
 
 static int _calcCharCount(const char * pszText)
 {
-    int n = 0;
-    char ch = 0;
-    while ((ch = *pszText))
-    {
-        CC_BREAK_IF(! ch);
-
-        if (0x80 != (0xC0 & ch))
-        {
-            ++n;
-        }
-        ++pszText;
-    }
-    return n;
+    return cc_utf8_count_chars(pszText);
 }
 
 //////////////////////////////////////////////////////////////////////////
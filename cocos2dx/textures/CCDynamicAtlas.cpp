@@ -0,0 +1,579 @@
+/****************************************************************************
+Copyright (c) 2013 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "CCDynamicAtlas.h"
+#include "CCTexture2D.h"
+#include "CCTextureCache.h"
+#include "ccMacros.h"
+#include "CCDirector.h"
+#include "platform/CCImage.h"
+#include "platform/CCFileUtils.h"
+#include "sprite_nodes/CCSpriteFrame.h"
+#include "shaders/ccGLStateCache.h"
+#include "support/image_support/ccPixelConversion.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <algorithm>
+
+NS_CC_BEGIN
+
+// every image is surrounded by a copy of its edges
+static const int kCCDynamicAtlasPadding = 1;
+
+// A RGBA8888 texture with a copy of its pixels and a skyline of the space already used.
+class CCDynamicAtlasPage : public CCTexture2D
+{
+public:
+    CCDynamicAtlasPage()
+    : m_pPixels(NULL)
+    , m_nPageWidth(0)
+    , m_nPageHeight(0)
+    {
+    }
+
+    virtual ~CCDynamicAtlasPage()
+    {
+        CC_SAFE_FREE(m_pPixels);
+    }
+
+    bool initWithPageSize(int width, int height)
+    {
+        m_pPixels = (unsigned char*)calloc(width * height, 4);
+        if (! m_pPixels)
+        {
+            return false;
+        }
+        m_nPageWidth = width;
+        m_nPageHeight = height;
+
+        SkylineNode node = { 0, 0, width };
+        m_skyline.push_back(node);
+
+        CCSize size = CCSizeMake((float)width, (float)height);
+        if (! initWithData(m_pPixels, kCCTexture2DPixelFormat_RGBA8888, width, height, size))
+        {
+            return false;
+        }
+        m_bHasPremultipliedAlpha = true;
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+        // the copy is kept up to date, so it can restore the texture as it is when the context is lost
+        VolatileTexture::addDataTexture(this, m_pPixels, kCCTexture2DPixelFormat_RGBA8888, size);
+#endif
+        return true;
+    }
+
+    // finds the lowest position of a width x height rect, returns false if there is none
+    bool insert(int width, int height, int* pX, int* pY)
+    {
+        int bestIndex = -1;
+        int bestBottom = m_nPageHeight + 1;
+        int bestWidth = m_nPageWidth + 1;
+        int bestY = 0;
+
+        for (unsigned int i = 0; i < m_skyline.size(); ++i)
+        {
+            int y;
+            if (fit(i, width, height, &y))
+            {
+                if (y + height < bestBottom || (y + height == bestBottom && m_skyline[i].width < bestWidth))
+                {
+                    bestIndex = (int)i;
+                    bestBottom = y + height;
+                    bestWidth = m_skyline[i].width;
+                    bestY = y;
+                }
+            }
+        }
+
+        if (bestIndex < 0)
+        {
+            return false;
+        }
+
+        *pX = m_skyline[bestIndex].x;
+        *pY = bestY;
+
+        SkylineNode node = { *pX, bestY + height, width };
+        m_skyline.insert(m_skyline.begin() + bestIndex, node);
+
+        // shrink or remove the nodes now covered by the new one
+        for (unsigned int i = bestIndex + 1; i < m_skyline.size(); )
+        {
+            const SkylineNode& prev = m_skyline[i - 1];
+            SkylineNode& cur = m_skyline[i];
+            int overlap = prev.x + prev.width - cur.x;
+            if (overlap <= 0)
+            {
+                break;
+            }
+            cur.x += overlap;
+            cur.width -= overlap;
+            if (cur.width > 0)
+            {
+                break;
+            }
+            m_skyline.erase(m_skyline.begin() + i);
+        }
+
+        // merge the neighbours at the same height
+        for (unsigned int i = 0; i + 1 < m_skyline.size(); )
+        {
+            if (m_skyline[i].y == m_skyline[i + 1].y)
+            {
+                m_skyline[i].width += m_skyline[i + 1].width;
+                m_skyline.erase(m_skyline.begin() + i + 1);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+        return true;
+    }
+
+    // copies a width x height block from another page, without uploading it
+    void copyBlock(CCDynamicAtlasPage* pSource, int srcX, int srcY, int dstX, int dstY, int width, int height)
+    {
+        for (int row = 0; row < height; ++row)
+        {
+            memcpy(m_pPixels + ((dstY + row) * m_nPageWidth + dstX) * 4,
+                   pSource->m_pPixels + ((srcY + row) * pSource->m_nPageWidth + srcX) * 4,
+                   width * 4);
+        }
+    }
+
+    // writes a premultiplied RGBA8888 image at (x, y) with its edges extruded around it, without uploading it
+    void drawImage(const unsigned char* pImage, int width, int height, int x, int y)
+    {
+        int p = kCCDynamicAtlasPadding;
+        for (int row = -p; row < height + p; ++row)
+        {
+            int srcRow = std::min(std::max(row, 0), height - 1);
+            const unsigned char* src = pImage + srcRow * width * 4;
+            unsigned char* dst = m_pPixels + ((y + p + row) * m_nPageWidth + x + p) * 4;
+
+            memcpy(dst, src, width * 4);
+            for (int i = 1; i <= p; ++i)
+            {
+                memcpy(dst - i * 4, src, 4);
+                memcpy(dst + (width - 1 + i) * 4, src + (width - 1) * 4, 4);
+            }
+        }
+    }
+
+    // uploads whole rows: the copy is contiguous and a single call is cheaper than one per image row
+    void upload(int y, int height)
+    {
+        ccGLBindTexture2D(getName());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, m_nPageWidth, height, GL_RGBA, GL_UNSIGNED_BYTE,
+                        m_pPixels + y * m_nPageWidth * 4);
+    }
+
+private:
+    struct SkylineNode
+    {
+        int x, y, width;
+    };
+
+    // returns in *pY the height at which a rect starting at node index rests, false if it doesn't fit
+    bool fit(unsigned int index, int width, int height, int* pY)
+    {
+        int x = m_skyline[index].x;
+        if (x + width > m_nPageWidth)
+        {
+            return false;
+        }
+
+        int y = m_skyline[index].y;
+        int widthLeft = width;
+        while (widthLeft > 0)
+        {
+            y = std::max(y, m_skyline[index].y);
+            if (y + height > m_nPageHeight)
+            {
+                return false;
+            }
+            widthLeft -= m_skyline[index].width;
+            ++index;
+        }
+        *pY = y;
+        return true;
+    }
+
+    unsigned char* m_pPixels;
+    int m_nPageWidth;
+    int m_nPageHeight;
+    std::vector<SkylineNode> m_skyline;
+};
+
+CCDynamicAtlas::CCDynamicAtlas()
+: m_uPageWidth(0)
+, m_uPageHeight(0)
+, m_uMaxImageSize(0)
+, m_uUsedArea(0)
+, m_uWastedArea(0)
+{
+}
+
+CCDynamicAtlas::~CCDynamicAtlas()
+{
+    removeAllImages();
+}
+
+CCDynamicAtlas* CCDynamicAtlas::create(unsigned int uPageWidth, unsigned int uPageHeight)
+{
+    CCDynamicAtlas* pRet = new CCDynamicAtlas();
+    if (pRet && pRet->init(uPageWidth, uPageHeight))
+    {
+        pRet->autorelease();
+        return pRet;
+    }
+    CC_SAFE_DELETE(pRet);
+    return NULL;
+}
+
+bool CCDynamicAtlas::init(unsigned int uPageWidth, unsigned int uPageHeight)
+{
+    CCAssert(uPageWidth > 2 * kCCDynamicAtlasPadding && uPageHeight > 2 * kCCDynamicAtlasPadding, "Invalid page size");
+    m_uPageWidth = uPageWidth;
+    m_uPageHeight = uPageHeight;
+    m_uMaxImageSize = std::min(uPageWidth, uPageHeight) / 4;
+    return true;
+}
+
+CCSpriteFrame* CCDynamicAtlas::addImage(const char* path)
+{
+    CCAssert(path != NULL, "Invalid path");
+
+    std::string fullpath = CCFileUtils::sharedFileUtils()->fullPathForFilename(path);
+    CCSpriteFrame* pFrame = spriteFrameForKey(fullpath.c_str());
+    if (pFrame)
+    {
+        return pFrame;
+    }
+
+    std::string lowerCase(fullpath);
+    for (unsigned int i = 0; i < lowerCase.length(); ++i)
+    {
+        lowerCase[i] = tolower(lowerCase[i]);
+    }
+
+    CCImage::EImageFormat eImageFormat = CCImage::kFmtUnKnown;
+    if (std::string::npos != lowerCase.find(".png"))
+    {
+        eImageFormat = CCImage::kFmtPng;
+    }
+    else if (std::string::npos != lowerCase.find(".jpg") || std::string::npos != lowerCase.find(".jpeg"))
+    {
+        eImageFormat = CCImage::kFmtJpg;
+    }
+    else if (std::string::npos != lowerCase.find(".tif") || std::string::npos != lowerCase.find(".tiff"))
+    {
+        eImageFormat = CCImage::kFmtTiff;
+    }
+    else if (std::string::npos != lowerCase.find(".webp"))
+    {
+        eImageFormat = CCImage::kFmtWebp;
+    }
+    else
+    {
+        return NULL;
+    }
+
+    CCImage* pImage = new CCImage();
+    if (pImage && pImage->initWithImageFile(fullpath.c_str(), eImageFormat))
+    {
+        pFrame = addImage(pImage, fullpath.c_str());
+    }
+    CC_SAFE_RELEASE(pImage);
+    return pFrame;
+}
+
+CCSpriteFrame* CCDynamicAtlas::addImage(CCImage* pImage, const char* key)
+{
+    CCAssert(pImage != NULL && key != NULL, "Invalid image or key");
+
+    CCDynamicAtlasEntryMap::iterator it = m_entries.find(key);
+    if (it != m_entries.end())
+    {
+        return it->second.frame;
+    }
+
+    int width = pImage->getWidth();
+    int height = pImage->getHeight();
+    if (width == 0 || height == 0 || pImage->getBitsPerComponent() != 8
+        || (unsigned int)width > m_uMaxImageSize || (unsigned int)height > m_uMaxImageSize
+        || (unsigned int)width + 2 * kCCDynamicAtlasPadding > m_uPageWidth
+        || (unsigned int)height + 2 * kCCDynamicAtlasPadding > m_uPageHeight)
+    {
+        return NULL;
+    }
+
+    // pages hold premultiplied RGBA8888
+    unsigned int count = width * height;
+    unsigned char* pPixels = (unsigned char*)malloc(count * 4);
+    if (! pPixels)
+    {
+        return NULL;
+    }
+    const unsigned char* pData = pImage->getData();
+    if (pImage->hasAlpha())
+    {
+        memcpy(pPixels, pData, count * 4);
+        if (! pImage->isPremultipliedAlpha())
+        {
+            ccPremultiplyAlphaRGBA8888(pPixels, count);
+        }
+    }
+    else
+    {
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            pPixels[i * 4 + 0] = pData[i * 3 + 0];
+            pPixels[i * 4 + 1] = pData[i * 3 + 1];
+            pPixels[i * 4 + 2] = pData[i * 3 + 2];
+            pPixels[i * 4 + 3] = 255;
+        }
+    }
+
+    int paddedWidth = width + 2 * kCCDynamicAtlasPadding;
+    int paddedHeight = height + 2 * kCCDynamicAtlasPadding;
+    CCDynamicAtlasPage* pPage = NULL;
+    int x = 0, y = 0;
+    if (! allocate(paddedWidth, paddedHeight, &pPage, &x, &y))
+    {
+        free(pPixels);
+        return NULL;
+    }
+
+    pPage->drawImage(pPixels, width, height, x, y);
+    pPage->upload(y, paddedHeight);
+    free(pPixels);
+
+    CCDynamicAtlasEntry& entry = m_entries[key];
+    entry.page = pPage;
+    entry.x = x;
+    entry.y = y;
+    entry.width = width;
+    entry.height = height;
+    entry.frame = new CCSpriteFrame();
+    entry.frame->initWithTexture(pPage, CCRectZero);
+    updateFrame(entry);
+    m_uUsedArea += paddedWidth * paddedHeight;
+
+    return entry.frame;
+}
+
+CCSpriteFrame* CCDynamicAtlas::spriteFrameForKey(const char* key)
+{
+    CCDynamicAtlasEntryMap::iterator it = m_entries.find(key);
+    return it != m_entries.end() ? it->second.frame : NULL;
+}
+
+void CCDynamicAtlas::removeImageForKey(const char* key)
+{
+    CCDynamicAtlasEntryMap::iterator it = m_entries.find(key);
+    if (it == m_entries.end())
+    {
+        return;
+    }
+
+    unsigned int area = (it->second.width + 2 * kCCDynamicAtlasPadding) * (it->second.height + 2 * kCCDynamicAtlasPadding);
+    m_uUsedArea -= area;
+    m_uWastedArea += area;
+    it->second.frame->release();
+    m_entries.erase(it);
+}
+
+void CCDynamicAtlas::removeAllImages()
+{
+    for (CCDynamicAtlasEntryMap::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+    {
+        it->second.frame->release();
+    }
+    m_entries.clear();
+
+    for (unsigned int i = 0; i < m_pages.size(); ++i)
+    {
+        m_pages[i]->release();
+    }
+    m_pages.clear();
+    m_uUsedArea = 0;
+    m_uWastedArea = 0;
+}
+void CCDynamicAtlas::repack()
+{
+    if (m_entries.empty())
+    {
+        removeAllImages();
+        return;
+    }
+
+    // tallest first packs tighter; (-height, index) keeps the order of the keys among equal heights
+    std::vector<CCDynamicAtlasEntry*> entries;
+    std::vector<std::pair<int, int> > order;
+    for (CCDynamicAtlasEntryMap::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+    {
+        order.push_back(std::make_pair(-it->second.height, (int)entries.size()));
+        entries.push_back(&it->second);
+    }
+    std::sort(order.begin(), order.end());
+
+    // lay the images out in new pages, the entries are only updated once all of them fit
+    std::vector<CCDynamicAtlasPage*> oldPages;
+    oldPages.swap(m_pages);
+
+    CCDynamicAtlasEntry placement = { NULL, 0, 0, 0, 0, NULL };
+    std::vector<CCDynamicAtlasEntry> placements(entries.size(), placement);
+    for (unsigned int i = 0; i < order.size(); ++i)
+    {
+        CCDynamicAtlasEntry& entry = *entries[order[i].second];
+        int paddedWidth = entry.width + 2 * kCCDynamicAtlasPadding;
+        int paddedHeight = entry.height + 2 * kCCDynamicAtlasPadding;
+
+        CCDynamicAtlasPage* pPage = NULL;
+        int x = 0, y = 0;
+        for (unsigned int j = 0; j < m_pages.size() && ! pPage; ++j)
+        {
+            if (m_pages[j]->insert(paddedWidth, paddedHeight, &x, &y))
+            {
+                pPage = m_pages[j];
+            }
+        }
+        if (! pPage)
+        {
+            pPage = addPage();
+            if (! pPage || ! pPage->insert(paddedWidth, paddedHeight, &x, &y))
+            {
+                CCLOG("cocos2d: CCDynamicAtlas: couldn't repack, keeping the current pages");
+                for (unsigned int j = 0; j < m_pages.size(); ++j)
+                {
+                    m_pages[j]->release();
+                }
+                m_pages.swap(oldPages);
+                return;
+            }
+        }
+
+        pPage->copyBlock(entry.page, entry.x, entry.y, x, y, paddedWidth, paddedHeight);
+        placements[order[i].second].page = pPage;
+        placements[order[i].second].x = x;
+        placements[order[i].second].y = y;
+    }
+
+    for (unsigned int i = 0; i < m_pages.size(); ++i)
+    {
+        m_pages[i]->upload(0, m_uPageHeight);
+    }
+    for (unsigned int i = 0; i < entries.size(); ++i)
+    {
+        entries[i]->page = placements[i].page;
+        entries[i]->x = placements[i].x;
+        entries[i]->y = placements[i].y;
+        updateFrame(*entries[i]);
+    }
+
+    // sprites still using the old pages retain them
+    for (unsigned int i = 0; i < oldPages.size(); ++i)
+    {
+        oldPages[i]->release();
+    }
+    m_uWastedArea = 0;
+}
+
+CCTexture2D* CCDynamicAtlas::getPage(unsigned int uIndex)
+{
+    return uIndex < m_pages.size() ? m_pages[uIndex] : NULL;
+}
+
+float CCDynamicAtlas::getOccupancy()
+{
+    if (m_pages.empty())
+    {
+        return 0.0f;
+    }
+    return (float)m_uUsedArea / ((float)m_uPageWidth * m_uPageHeight * m_pages.size());
+}
+
+bool CCDynamicAtlas::allocate(int width, int height, CCDynamicAtlasPage** ppPage, int* pX, int* pY)
+{
+    for (unsigned int i = 0; i < m_pages.size(); ++i)
+    {
+        if (m_pages[i]->insert(width, height, pX, pY))
+        {
+            *ppPage = m_pages[i];
+            return true;
+        }
+    }
+
+    // the holes left by removed images might be enough: repacking is cheaper than another page
+    if (m_uWastedArea >= (unsigned int)(width * height))
+    {
+        repack();
+        for (unsigned int i = 0; i < m_pages.size(); ++i)
+        {
+            if (m_pages[i]->insert(width, height, pX, pY))
+            {
+                *ppPage = m_pages[i];
+                return true;
+            }
+        }
+    }
+
+    CCDynamicAtlasPage* pPage = addPage();
+    if (pPage && pPage->insert(width, height, pX, pY))
+    {
+        *ppPage = pPage;
+        return true;
+    }
+    return false;
+}
+
+CCDynamicAtlasPage* CCDynamicAtlas::addPage()
+{
+    CCDynamicAtlasPage* pPage = new CCDynamicAtlasPage();
+    if (pPage && pPage->initWithPageSize(m_uPageWidth, m_uPageHeight))
+    {
+        m_pages.push_back(pPage);
+        return pPage;
+    }
+    CC_SAFE_RELEASE(pPage);
+    return NULL;
+}
+
+void CCDynamicAtlas::updateFrame(CCDynamicAtlasEntry& entry)
+{
+    CCRect rect = CCRectMake((float)(entry.x + kCCDynamicAtlasPadding), (float)(entry.y + kCCDynamicAtlasPadding),
+                             (float)entry.width, (float)entry.height);
+    CCSpriteFrame* pFrame = entry.frame;
+    pFrame->setTexture(entry.page);
+    pFrame->setRectInPixels(rect);
+    pFrame->setOriginalSizeInPixels(rect.size);
+    pFrame->setOriginalSize(CC_SIZE_PIXELS_TO_POINTS(rect.size));
+    pFrame->setOffsetInPixels(CCPointZero);
+}
+
+NS_CC_END
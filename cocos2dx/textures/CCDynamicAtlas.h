@@ -0,0 +1,137 @@
+/****************************************************************************
+Copyright (c) 2013 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCDYNAMIC_ATLAS_H__
+#define __CCDYNAMIC_ATLAS_H__
+
+#include "cocoa/CCObject.h"
+#include <string>
+#include <vector>
+#include <map>
+
+NS_CC_BEGIN
+
+class CCImage;
+class CCTexture2D;
+class CCSpriteFrame;
+class CCDynamicAtlasPage;
+
+/**
+ * @addtogroup textures
+ * @{
+ */
+
+/** @brief Packs loose images into shared RGBA8888 textures ("pages") at runtime.
+
+ Every image added gets a CCSpriteFrame that points into a page, so sprites created from
+ images of the same page can be drawn by a single CCSpriteBatchNode, like sprites of a
+ sprite sheet made offline.
+
+ Images are placed with a skyline bottom-left packer and surrounded by a one pixel copy of
+ their edges, so linear filtering does not bleed from the neighbours.
+ Removing an image leaves a hole in its page. repack() rebuilds the pages without the holes;
+ it is also done automatically when an image doesn't fit and the holes are large enough.
+ Repacking creates new page textures and updates the sprite frames owned by the atlas:
+ sprites created before keep rendering from the previous pages, which stay alive as long
+ as they are used.
+
+ Each page keeps a copy of its pixels in memory, to repack and to restore the texture
+ when the GL context is lost.
+
+ CCTextureCache::setDynamicAtlas() makes CCSprite::create(filename) use an atlas.
+ @since v2.1.4
+ */
+class CC_DLL CCDynamicAtlas : public CCObject
+{
+public:
+    CCDynamicAtlas();
+    virtual ~CCDynamicAtlas();
+
+    /** creates an atlas whose pages are uPageWidth x uPageHeight pixels */
+    static CCDynamicAtlas* create(unsigned int uPageWidth, unsigned int uPageHeight);
+    bool init(unsigned int uPageWidth, unsigned int uPageHeight);
+
+    /** loads and packs a png, jpeg, tiff or webp file. The full path of the file is the key.
+     Returns the sprite frame of the image, or NULL if it can't be loaded or is larger than getMaxImageSize().
+     */
+    CCSpriteFrame* addImage(const char* path);
+
+    /** packs an 8 bits per component image under the given key.
+     Returns the sprite frame of the image, or NULL if it is larger than getMaxImageSize().
+     */
+    CCSpriteFrame* addImage(CCImage* pImage, const char* key);
+
+    /** returns the sprite frame of a packed image, NULL if there is none */
+    CCSpriteFrame* spriteFrameForKey(const char* key);
+
+    /** removes an image. Its space is reclaimed by the next repack. */
+    void removeImageForKey(const char* key);
+
+    /** removes every image and page */
+    void removeAllImages();
+
+    /** packs the images again into new pages, without the space of the removed images */
+    void repack();
+
+    /** images larger than this, in pixels, are not packed. Default: a quarter of the page size */
+    void setMaxImageSize(unsigned int uSize) { m_uMaxImageSize = uSize; }
+    unsigned int getMaxImageSize() { return m_uMaxImageSize; }
+
+    unsigned int getImageCount() { return (unsigned int)m_entries.size(); }
+    unsigned int getPageCount() { return (unsigned int)m_pages.size(); }
+    CCTexture2D* getPage(unsigned int uIndex);
+
+    /** fraction of the pages' area used by the packed images, holes excluded */
+    float getOccupancy();
+
+private:
+    struct CCDynamicAtlasEntry
+    {
+        CCDynamicAtlasPage* page;   // weak, m_pages retains it
+        int x, y;                   // position of the padded rect in the page
+        int width, height;          // size of the image, without padding
+        CCSpriteFrame* frame;       // retained
+    };
+    typedef std::map<std::string, CCDynamicAtlasEntry> CCDynamicAtlasEntryMap;
+
+    // finds room for a width x height image, adding a page if needed
+    bool allocate(int width, int height, CCDynamicAtlasPage** ppPage, int* pX, int* pY);
+    CCDynamicAtlasPage* addPage();
+    void updateFrame(CCDynamicAtlasEntry& entry);
+
+    unsigned int m_uPageWidth;
+    unsigned int m_uPageHeight;
+    unsigned int m_uMaxImageSize;
+    unsigned int m_uUsedArea;       // padded area of the packed images
+    unsigned int m_uWastedArea;     // padded area of the removed images, until the next repack
+    std::vector<CCDynamicAtlasPage*> m_pages;
+    CCDynamicAtlasEntryMap m_entries;
+};
+
+// end of textures group
+/// @}
+
+NS_CC_END
+
+#endif //__CCDYNAMIC_ATLAS_H__
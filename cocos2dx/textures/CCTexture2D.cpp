@@ -38,8 +38,10 @@ THE SOFTWARE.
 #include "platform/CCImage.h"
 #include "CCGL.h"
 #include "support/ccUtils.h"
+#include "support/image_support/ccPixelConversion.h"
 #include "platform/CCPlatformMacros.h"
 #include "textures/CCTexturePVR.h"
+#include "textures/CCTextureKTX.h"
 #include "CCDirector.h"
 #include "shaders/CCGLProgram.h"
 #include "shaders/ccGLStateCache.h"
@@ -60,6 +62,9 @@ static CCTexture2DPixelFormat g_defaultAlphaPixelFormat = kCCTexture2DPixelForma
 // By default PVR images are treated as if they don't have the alpha channel premultiplied
 static bool PVRHaveAlphaPremultiplied_ = false;
 
+// By default images are truncated, not dithered, when converted to 16-bit formats
+static bool g_bDitherWhenConvertingTo16Bit = false;
+
 CCTexture2D::CCTexture2D()
 : m_bPVRHaveAlphaPremultiplied(true)
 , m_uPixelsWide(0)
@@ -274,10 +279,8 @@ bool CCTexture2D::initWithImage(CCImage *uiImage)
 
 bool CCTexture2D::initPremultipliedATextureWithImage(CCImage *image, unsigned int width, unsigned int height)
 {
-    unsigned char*            tempData = image->getData();
-    unsigned int*             inPixel32 = NULL;
-    unsigned char*            inPixel8 = NULL;
-    unsigned short*           outPixel16 = NULL;
+    unsigned char*            inPixel = image->getData();
+    unsigned char*            tempData = inPixel;
     bool                      hasAlpha = image->hasAlpha();
     CCSize                    imageSize = CCSizeMake((float)(image->getWidth()), (float)(image->getHeight()));
     CCTexture2DPixelFormat    pixelFormat;
@@ -301,103 +304,70 @@ bool CCTexture2D::initPremultipliedATextureWithImage(CCImage *image, unsigned in
         
     }
     
+#if COCOS2D_DEBUG > 0
+    // the SIMD kernels must give the bytes of the scalar ones: checked once, on this CPU
+    static bool s_bPixelConversionChecked = false;
+    if (! s_bPixelConversionChecked)
+    {
+        s_bPixelConversionChecked = true;
+        bool identical = ccCheckPixelConversion();
+        CCAssert(identical, "SIMD pixel conversion differs from the scalar one");
+    }
+#endif
+
     // Repack the pixel data into the right format
     unsigned int length = width * height;
-    
+
     if (pixelFormat == kCCTexture2DPixelFormat_RGB565)
     {
+        tempData = new unsigned char[length * 2];
         if (hasAlpha)
         {
             // Convert "RRRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA" to "RRRRRGGGGGGBBBBB"
-            
-            tempData = new unsigned char[width * height * 2];
-            outPixel16 = (unsigned short*)tempData;
-            inPixel32 = (unsigned int*)image->getData();
-            
-            for(unsigned int i = 0; i < length; ++i, ++inPixel32)
-            {
-                *outPixel16++ = 
-                ((((*inPixel32 >>  0) & 0xFF) >> 3) << 11) |  // R
-                ((((*inPixel32 >>  8) & 0xFF) >> 2) << 5)  |  // G
-                ((((*inPixel32 >> 16) & 0xFF) >> 3) << 0);    // B
-            }
+            ccConvertRGBA8888ToRGB565(inPixel, (unsigned short*)tempData, width, height, g_bDitherWhenConvertingTo16Bit);
         }
         else 
         {
             // Convert "RRRRRRRRRGGGGGGGGBBBBBBBB" to "RRRRRGGGGGGBBBBB"
-            
-            tempData = new unsigned char[width * height * 2];
-            outPixel16 = (unsigned short*)tempData;
-            inPixel8 = (unsigned char*)image->getData();
-            
-            for(unsigned int i = 0; i < length; ++i)
-            {
-                *outPixel16++ = 
-                (((*inPixel8++ & 0xFF) >> 3) << 11) |  // R
-                (((*inPixel8++ & 0xFF) >> 2) << 5)  |  // G
-                (((*inPixel8++ & 0xFF) >> 3) << 0);    // B
-            }
+            ccConvertRGB888ToRGB565(inPixel, (unsigned short*)tempData, width, height, g_bDitherWhenConvertingTo16Bit);
         }    
     }
     else if (pixelFormat == kCCTexture2DPixelFormat_RGBA4444)
     {
         // Convert "RRRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA" to "RRRRGGGGBBBBAAAA"
-        
-        inPixel32 = (unsigned int*)image->getData();  
-        tempData = new unsigned char[width * height * 2];
-        outPixel16 = (unsigned short*)tempData;
-        
-        for(unsigned int i = 0; i < length; ++i, ++inPixel32)
-        {
-            *outPixel16++ = 
-            ((((*inPixel32 >> 0) & 0xFF) >> 4) << 12) | // R
-            ((((*inPixel32 >> 8) & 0xFF) >> 4) <<  8) | // G
-            ((((*inPixel32 >> 16) & 0xFF) >> 4) << 4) | // B
-            ((((*inPixel32 >> 24) & 0xFF) >> 4) << 0);  // A
-        }
+        tempData = new unsigned char[length * 2];
+        ccConvertRGBA8888ToRGBA4444(inPixel, (unsigned short*)tempData, width, height, g_bDitherWhenConvertingTo16Bit);
     }
     else if (pixelFormat == kCCTexture2DPixelFormat_RGB5A1)
     {
         // Convert "RRRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA" to "RRRRRGGGGGBBBBBA"
-        inPixel32 = (unsigned int*)image->getData();   
-        tempData = new unsigned char[width * height * 2];
-        outPixel16 = (unsigned short*)tempData;
-        
-        for(unsigned int i = 0; i < length; ++i, ++inPixel32)
-        {
-            *outPixel16++ = 
-            ((((*inPixel32 >> 0) & 0xFF) >> 3) << 11) | // R
-            ((((*inPixel32 >> 8) & 0xFF) >> 3) <<  6) | // G
-            ((((*inPixel32 >> 16) & 0xFF) >> 3) << 1) | // B
-            ((((*inPixel32 >> 24) & 0xFF) >> 7) << 0);  // A
-        }
+        tempData = new unsigned char[length * 2];
+        ccConvertRGBA8888ToRGB5A1(inPixel, (unsigned short*)tempData, width, height, g_bDitherWhenConvertingTo16Bit);
     }
     else if (pixelFormat == kCCTexture2DPixelFormat_A8)
     {
         // Convert "RRRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA" to "AAAAAAAA"
-        inPixel32 = (unsigned int*)image->getData();
-        tempData = new unsigned char[width * height];
-        unsigned char *outPixel8 = tempData;
-        
-        for(unsigned int i = 0; i < length; ++i, ++inPixel32)
-        {
-            *outPixel8++ = (*inPixel32 >> 24) & 0xFF;  // A
-        }
+        tempData = new unsigned char[length];
+        ccConvertRGBA8888ToA8(inPixel, tempData, length);
+    }
+    else if (pixelFormat == kCCTexture2DPixelFormat_I8)
+    {
+        // Convert "RRRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA" to "IIIIIIII"
+        tempData = new unsigned char[length];
+        ccConvertRGBA8888ToI8(inPixel, tempData, length);
+    }
+    else if (pixelFormat == kCCTexture2DPixelFormat_AI88)
+    {
+        // Convert "RRRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA" to "IIIIIIIIAAAAAAAA"
+        tempData = new unsigned char[length * 2];
+        ccConvertRGBA8888ToAI88(inPixel, tempData, length);
     }
     
     if (hasAlpha && pixelFormat == kCCTexture2DPixelFormat_RGB888)
     {
         // Convert "RRRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA" to "RRRRRRRRGGGGGGGGBBBBBBBB"
-        inPixel32 = (unsigned int*)image->getData();
-        tempData = new unsigned char[width * height * 3];
-        unsigned char *outPixel8 = tempData;
-        
-        for(unsigned int i = 0; i < length; ++i, ++inPixel32)
-        {
-            *outPixel8++ = (*inPixel32 >> 0) & 0xFF; // R
-            *outPixel8++ = (*inPixel32 >> 8) & 0xFF; // G
-            *outPixel8++ = (*inPixel32 >> 16) & 0xFF; // B
-        }
+        tempData = new unsigned char[length * 3];
+        ccConvertRGBA8888ToRGB888(inPixel, tempData, length);
     }
     
     initWithData(tempData, pixelFormat, width, height, imageSize);
@@ -566,6 +536,40 @@ bool CCTexture2D::initWithPVRFile(const char* file)
     return bRet;
 }
 
+bool CCTexture2D::initWithKTXFile(const char* file)
+{
+    bool bRet = false;
+    // nothing to do with CCObject::init
+
+    CCTextureKTX *ktx = new CCTextureKTX;
+    bRet = ktx->initWithContentsOfFile(file);
+
+    if (bRet)
+    {
+        ktx->setRetainName(true); // don't dealloc texture on release
+
+        m_uName = ktx->getName();
+        m_fMaxS = 1.0f;
+        m_fMaxT = 1.0f;
+        m_uPixelsWide = ktx->getWidth();
+        m_uPixelsHigh = ktx->getHeight();
+        m_tContentSize = CCSizeMake((float)m_uPixelsWide, (float)m_uPixelsHigh);
+        m_bHasPremultipliedAlpha = ktx->hasPremultipliedAlpha();
+        m_ePixelFormat = ktx->getFormat();
+        m_bHasMipmaps = ktx->getNumberOfMipmaps() > 1;
+
+        setShaderProgram(CCShaderCache::sharedShaderCache()->programForKey(kCCShader_PositionTexture));
+    }
+    else
+    {
+        CCLOG("cocos2d: Couldn't load KTX image %s", file);
+    }
+
+    ktx->release();
+
+    return bRet;
+}
+
 void CCTexture2D::PVRImagesHavePremultipliedAlpha(bool haveAlphaPremultiplied)
 {
     PVRHaveAlphaPremultiplied_ = haveAlphaPremultiplied;
@@ -681,6 +685,24 @@ const char* CCTexture2D::stringForFormat()
 		case kCCTexture2DPixelFormat_PVRTC2:
 			return  "PVRTC2";
 
+		case kCCTexture2DPixelFormat_ETC1:
+			return  "ETC1";
+
+		case kCCTexture2DPixelFormat_ETC2_RGB:
+			return  "ETC2_RGB";
+
+		case kCCTexture2DPixelFormat_ETC2_RGBA:
+			return  "ETC2_RGBA";
+
+		case kCCTexture2DPixelFormat_S3TC_DXT1:
+			return  "DXT1";
+
+		case kCCTexture2DPixelFormat_S3TC_DXT3:
+			return  "DXT3";
+
+		case kCCTexture2DPixelFormat_S3TC_DXT5:
+			return  "DXT5";
+
 		default:
 			CCAssert(false , "unrecognized pixel format");
 			CCLOG("stringForFormat: %ld, cannot give useful result", (long)m_ePixelFormat);
@@ -707,6 +729,16 @@ CCTexture2DPixelFormat CCTexture2D::defaultAlphaPixelFormat()
     return g_defaultAlphaPixelFormat;
 }
 
+void CCTexture2D::setDitherWhenConvertingTo16Bit(bool dither)
+{
+    g_bDitherWhenConvertingTo16Bit = dither;
+}
+
+bool CCTexture2D::isDitheringWhenConvertingTo16Bit()
+{
+    return g_bDitherWhenConvertingTo16Bit;
+}
+
 unsigned int CCTexture2D::bitsPerPixelForFormat(CCTexture2DPixelFormat format)
 {
 	unsigned int ret=0;
@@ -743,6 +775,16 @@ unsigned int CCTexture2D::bitsPerPixelForFormat(CCTexture2DPixelFormat format)
 		case kCCTexture2DPixelFormat_PVRTC2:
 			ret = 2;
 			break;
+		case kCCTexture2DPixelFormat_ETC1:
+		case kCCTexture2DPixelFormat_ETC2_RGB:
+		case kCCTexture2DPixelFormat_S3TC_DXT1:
+			ret = 4;
+			break;
+		case kCCTexture2DPixelFormat_ETC2_RGBA:
+		case kCCTexture2DPixelFormat_S3TC_DXT3:
+		case kCCTexture2DPixelFormat_S3TC_DXT5:
+			ret = 8;
+			break;
 		default:
 			ret = -1;
 			CCAssert(false , "unrecognized pixel format");
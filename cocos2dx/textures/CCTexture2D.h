@@ -70,6 +70,18 @@ typedef enum {
     kCCTexture2DPixelFormat_PVRTC4,
     //! 2-bit PVRTC-compressed texture: PVRTC2
     kCCTexture2DPixelFormat_PVRTC2,
+    //! 4-bit ETC1-compressed texture: ETC1
+    kCCTexture2DPixelFormat_ETC1,
+    //! 4-bit ETC2-compressed texture without Alpha channel: ETC2 RGB8
+    kCCTexture2DPixelFormat_ETC2_RGB,
+    //! 8-bit ETC2-compressed texture with EAC Alpha channel: ETC2 RGBA8
+    kCCTexture2DPixelFormat_ETC2_RGBA,
+    //! 4-bit S3TC-compressed texture: DXT1
+    kCCTexture2DPixelFormat_S3TC_DXT1,
+    //! 8-bit S3TC-compressed texture with explicit Alpha: DXT3
+    kCCTexture2DPixelFormat_S3TC_DXT3,
+    //! 8-bit S3TC-compressed texture with interpolated Alpha: DXT5
+    kCCTexture2DPixelFormat_S3TC_DXT5,
 
     //! Default texture format: RGBA8888
     kCCTexture2DPixelFormat_Default = kCCTexture2DPixelFormat_RGBA8888,
@@ -148,6 +160,12 @@ public:
     /** Initializes a texture from a PVR file */
     bool initWithPVRFile(const char* file);
 
+    /** Initializes a texture from a KTX file.
+     ETC1, ETC2 and S3TC data the GPU can't sample is decoded to RGBA8888.
+     @since v2.1.4
+     */
+    bool initWithKTXFile(const char* file);
+
     /** sets the min filter, mag filter, wrap s and wrap t texture parameters.
     If the texture size is NPOT (non power of 2), then in can only use GL_CLAMP_TO_EDGE in GL_TEXTURE_WRAP_{S,T}.
 
@@ -233,6 +251,20 @@ public:
      */
     static void PVRImagesHavePremultipliedAlpha(bool haveAlphaPremultiplied);
 
+    /** enables (or not) a 4x4 ordered dither when images are converted to RGB565, RGBA4444 or RGB5A1.
+     It hides the banding of gradients at no memory cost.
+
+     By default it is disabled.
+
+     @since v2.1.4
+     */
+    static void setDitherWhenConvertingTo16Bit(bool dither);
+
+    /** returns whether images are dithered when converted to 16-bit formats
+     @since v2.1.4
+     */
+    static bool isDitheringWhenConvertingTo16Bit();
+
     /** content size */
     const CCSize& getContentSizeInPixels();
     
@@ -609,9 +609,11 @@ void CCTextureAtlas::drawNumberOfQuads(unsigned int n, unsigned int start)
         //		glBufferData(GL_ARRAY_BUFFER, sizeof(quads_[0]) * (n-start), &quads_[start], GL_DYNAMIC_DRAW);
 		
 		// option 3: orphaning + glMapBuffer
-		glBufferData(GL_ARRAY_BUFFER, sizeof(m_pQuads[0]) * (n-start), NULL, GL_DYNAMIC_DRAW);
+		// all the quads: the buffer is no longer dirty, so the next ranges drawn this frame must be up to date too
+		unsigned int count = MIN(MAX(m_uTotalQuads, start + n), m_uCapacity);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(m_pQuads[0]) * count, NULL, GL_DYNAMIC_DRAW);
 		void *buf = glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY);
-		memcpy(buf, m_pQuads, sizeof(m_pQuads[0])* (n-start));
+		memcpy(buf, m_pQuads, sizeof(m_pQuads[0]) * count);
 		glUnmapBuffer(GL_ARRAY_BUFFER);
 		
 		glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -649,7 +651,9 @@ void CCTextureAtlas::drawNumberOfQuads(unsigned int n, unsigned int start)
     // XXX: update is done in draw... perhaps it should be done in a timer
     if (m_bDirty) 
     {
-        glBufferSubData(GL_ARRAY_BUFFER, sizeof(m_pQuads[0])*start, sizeof(m_pQuads[0]) * n , &m_pQuads[start] );
+        // all the quads: the buffer is no longer dirty, so the next ranges drawn this frame must be up to date too
+        unsigned int count = MIN(MAX(m_uTotalQuads, start + n), m_uCapacity);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(m_pQuads[0]) * count, m_pQuads);
         m_bDirty = false;
     }
 
@@ -26,6 +26,8 @@ THE SOFTWARE.
 
 #include "CCTextureCache.h"
 #include "CCTexture2D.h"
+#include "CCTextureKTX.h"
+#include "CCDynamicAtlas.h"
 #include "ccMacros.h"
 #include "CCDirector.h"
 #include "platform/platform.h"
@@ -41,6 +43,8 @@ THE SOFTWARE.
 #include <cctype>
 #include <queue>
 #include <list>
+#include <vector>
+#include <algorithm>
 #include <pthread.h>
 
 using namespace std;
@@ -203,6 +207,12 @@ CCTextureCache::CCTextureCache()
     CCAssert(g_sharedTextureCache == NULL, "Attempted to allocate a second instance of a singleton.");
     
     m_pTextures = new CCDictionary();
+    m_bUseCompressedTextureVariants = false;
+    m_uTextureMemoryBudget = 0;
+    m_uTextureMemoryUsed = 0;
+    m_uUseCounter = 0;
+    m_pDelegate = NULL;
+    m_pDynamicAtlas = NULL;
 }
 
 CCTextureCache::~CCTextureCache()
@@ -212,6 +222,7 @@ CCTextureCache::~CCTextureCache()
 
     pthread_cond_signal(&s_SleepCondition);
     CC_SAFE_RELEASE(m_pTextures);
+    CC_SAFE_RELEASE(m_pDynamicAtlas);
 }
 
 void CCTextureCache::purgeSharedTextureCache()
@@ -251,7 +262,7 @@ void CCTextureCache::addImageAsync(const char *path, CCObject *target, SEL_CallF
     std::string pathKey = path;
 
     pathKey = CCFileUtils::sharedFileUtils()->fullPathForFilename(pathKey.c_str());
-    texture = (CCTexture2D*)m_pTextures->objectForKey(pathKey.c_str());
+    texture = touchTexture(pathKey);
 
     std::string fullpath = pathKey;
     if (texture != NULL)
@@ -342,7 +353,7 @@ void CCTextureCache::addImageAsyncCallBack(float dt)
 #endif
 
         // cache the texture
-        m_pTextures->setObject(texture, filename);
+        cacheTexture(texture, filename);
         texture->autorelease();
 
         if (target && selector)
@@ -382,7 +393,7 @@ CCTexture2D * CCTextureCache::addImage(const char * path)
     {
         return NULL;
     }
-    texture = (CCTexture2D*)m_pTextures->objectForKey(pathKey.c_str());
+    texture = touchTexture(pathKey);
 
     std::string fullpath = pathKey; // (CCFileUtils::sharedFileUtils()->fullPathFromRelativePath(path));
     if (! texture) 
@@ -392,13 +403,21 @@ CCTexture2D * CCTextureCache::addImage(const char * path)
         {
             lowerCase[i] = tolower(lowerCase[i]);
         }
-        // all images are handled by UIImage except PVR extension that is handled by our own handler
+        // all images are handled by UIImage except PVR and KTX extensions that are handled by our own handlers
         do 
         {
             if (std::string::npos != lowerCase.find(".pvr"))
             {
                 texture = this->addPVRImage(fullpath.c_str());
             }
+            else if (std::string::npos != lowerCase.find(".ktx"))
+            {
+                texture = this->addKTXImage(fullpath.c_str());
+            }
+            else if (m_bUseCompressedTextureVariants && (texture = addCompressedTextureVariant(fullpath)) != NULL)
+            {
+                break;
+            }
             else
             {
                 CCImage::EImageFormat eImageFormat = CCImage::kFmtUnKnown;
@@ -438,7 +457,7 @@ CCTexture2D * CCTextureCache::addImage(const char * path)
                     // cache the texture file name
                     VolatileTexture::addImageTexture(texture, fullpath.c_str(), eImageFormat);
 #endif
-                    m_pTextures->setObject(texture, pathKey.c_str());
+                    cacheTexture(texture, pathKey);
                     texture->release();
                 }
                 else
@@ -462,7 +481,7 @@ CCTexture2D * CCTextureCache::addPVRImage(const char* path)
     CCTexture2D* texture = NULL;
     std::string key(path);
     
-    if( (texture = (CCTexture2D*)m_pTextures->objectForKey(key.c_str())) ) 
+    if( (texture = touchTexture(key)) ) 
     {
         return texture;
     }
@@ -476,7 +495,7 @@ CCTexture2D * CCTextureCache::addPVRImage(const char* path)
         // cache the texture file name
         VolatileTexture::addImageTexture(texture, fullpath.c_str(), CCImage::kFmtRawData);
 #endif
-        m_pTextures->setObject(texture, key.c_str());
+        cacheTexture(texture, key);
         texture->autorelease();
     }
     else
@@ -488,6 +507,89 @@ CCTexture2D * CCTextureCache::addPVRImage(const char* path)
     return texture;
 }
 
+CCTexture2D * CCTextureCache::addKTXImage(const char* path)
+{
+    CCAssert(path != NULL, "TextureCache: fileimage MUST not be nil");
+
+    CCTexture2D* texture = NULL;
+    std::string key(path);
+
+    if( (texture = touchTexture(key)) )
+    {
+        return texture;
+    }
+
+    // Split up directory and filename
+    std::string fullpath = CCFileUtils::sharedFileUtils()->fullPathForFilename(key.c_str());
+    texture = new CCTexture2D();
+    if(texture != NULL && texture->initWithKTXFile(fullpath.c_str()) )
+    {
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+        // cache the texture file name
+        VolatileTexture::addImageTexture(texture, fullpath.c_str(), CCImage::kFmtRawData);
+#endif
+        cacheTexture(texture, key);
+        texture->autorelease();
+    }
+    else
+    {
+        CCLOG("cocos2d: Couldn't add KTXImage:%s in CCTextureCache",key.c_str());
+        CC_SAFE_DELETE(texture);
+    }
+
+    return texture;
+}
+
+CCTexture2D* CCTextureCache::addCompressedTextureVariant(const std::string& fullpath)
+{
+    size_t pos = fullpath.find_last_of('.');
+    if (pos == std::string::npos)
+    {
+        return NULL;
+    }
+    std::string basePath = fullpath.substr(0, pos);
+
+    // best quality first
+    static const struct {
+        const char* suffix;
+        CCTexture2DPixelFormat format;
+    } variants[] = {
+        { ".etc2.ktx", kCCTexture2DPixelFormat_ETC2_RGBA },
+        { ".s3tc.ktx", kCCTexture2DPixelFormat_S3TC_DXT5 },
+        { ".etc1.ktx", kCCTexture2DPixelFormat_ETC1 },
+    };
+
+    CCFileUtils* fileUtils = CCFileUtils::sharedFileUtils();
+    for (unsigned int i = 0; i < sizeof(variants) / sizeof(variants[0]); ++i)
+    {
+        if (! CCTextureKTX::isPixelFormatSupported(variants[i].format))
+        {
+            continue;
+        }
+
+        std::string variantPath = basePath + variants[i].suffix;
+        if (! fileUtils->isFileExist(variantPath))
+        {
+            continue;
+        }
+
+        CCTexture2D* texture = new CCTexture2D();
+        if (texture->initWithKTXFile(variantPath.c_str()))
+        {
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+            VolatileTexture::addImageTexture(texture, variantPath.c_str(), CCImage::kFmtRawData);
+#endif
+            // cache it with the name of the original image, so textureForKey() keeps working
+            cacheTexture(texture, fullpath);
+            texture->release();
+            return texture;
+        }
+        texture->release();
+    }
+
+    return NULL;
+}
+
 CCTexture2D* CCTextureCache::addUIImage(CCImage *image, const char *key)
 {
     CCAssert(image != NULL, "TextureCache: image MUST not be nil");
@@ -506,7 +608,7 @@ CCTexture2D* CCTextureCache::addUIImage(CCImage *image, const char *key)
     do 
     {
         // If key is nil, then create a new texture each time
-        if(key && (texture = (CCTexture2D *)m_pTextures->objectForKey(forKey.c_str())))
+        if(key && (texture = touchTexture(forKey)))
         {
             break;
         }
@@ -517,7 +619,7 @@ CCTexture2D* CCTextureCache::addUIImage(CCImage *image, const char *key)
 
         if(key && texture)
         {
-            m_pTextures->setObject(texture, forKey.c_str());
+            cacheTexture(texture, forKey);
             texture->autorelease();
         }
         else
@@ -539,6 +641,8 @@ CCTexture2D* CCTextureCache::addUIImage(CCImage *image, const char *key)
 void CCTextureCache::removeAllTextures()
 {
     m_pTextures->removeAllObjects();
+    m_entries.clear();
+    m_uTextureMemoryUsed = 0;
 }
 
 void CCTextureCache::removeUnusedTextures()
@@ -578,7 +682,7 @@ void CCTextureCache::removeUnusedTextures()
         for (list<CCDictElement*>::iterator iter = elementToRemove.begin(); iter != elementToRemove.end(); ++iter)
         {
             CCLOG("cocos2d: CCTextureCache: removing unused texture: %s", (*iter)->getStrKey());
-            m_pTextures->removeObjectForElememt(*iter);
+            uncacheTexture((*iter)->getStrKey());
         }
     }
 }
@@ -591,7 +695,11 @@ void CCTextureCache::removeTexture(CCTexture2D* texture)
     }
 
     CCArray* keys = m_pTextures->allKeysForObject(texture);
-    m_pTextures->removeObjectsForKeys(keys);
+    CCObject* pObj = NULL;
+    CCARRAY_FOREACH(keys, pObj)
+    {
+        uncacheTexture(((CCString*)pObj)->getCString());
+    }
 }
 
 void CCTextureCache::removeTextureForKey(const char *textureKeyName)
@@ -602,12 +710,12 @@ void CCTextureCache::removeTextureForKey(const char *textureKeyName)
     }
 
     string fullPath = CCFileUtils::sharedFileUtils()->fullPathForFilename(textureKeyName);
-    m_pTextures->removeObjectForKey(fullPath);
+    uncacheTexture(fullPath);
 }
 
 CCTexture2D* CCTextureCache::textureForKey(const char* key)
 {
-    return (CCTexture2D*)m_pTextures->objectForKey(CCFileUtils::sharedFileUtils()->fullPathForFilename(key));
+    return touchTexture(CCFileUtils::sharedFileUtils()->fullPathForFilename(key));
 }
 
 void CCTextureCache::reloadAllTextures()
@@ -642,6 +750,178 @@ void CCTextureCache::dumpCachedTextureInfo()
     }
 
     CCLOG("cocos2d: CCTextureCache dumpDebugInfo: %ld textures, for %lu KB (%.2f MB)", (long)count, (long)totalBytes / 1024, totalBytes / (1024.0f*1024.0f));
+    if (m_uTextureMemoryBudget)
+    {
+        CCLOG("cocos2d: CCTextureCache budget: %lu KB used (mipmaps included) of %lu KB", (long)m_uTextureMemoryUsed / 1024, (long)m_uTextureMemoryBudget / 1024);
+    }
+}
+
+// TextureCache - Memory budget
+
+unsigned int CCTextureCache::textureMemorySize(CCTexture2D* texture)
+{
+    unsigned int bytes = texture->getPixelsWide() * texture->getPixelsHigh() * texture->bitsPerPixelForFormat() / 8;
+    if (texture->hasMipmaps())
+    {
+        // the mipmap chain adds a third of the base level
+        bytes += bytes / 3;
+    }
+    return bytes;
+}
+
+void CCTextureCache::cacheTexture(CCTexture2D* texture, const std::string& key)
+{
+    m_pTextures->setObject(texture, key);
+
+    CCTextureCacheEntry& entry = m_entries[key];
+    if (entry.texture)
+    {
+        // the key was already cached: replace its accounting
+        m_uTextureMemoryUsed -= entry.bytes;
+    }
+    else
+    {
+        entry.pinned = false;
+    }
+    entry.texture = texture;
+    entry.bytes = textureMemorySize(texture);
+    entry.lastUse = ++m_uUseCounter;
+    m_uTextureMemoryUsed += entry.bytes;
+
+    evictTextures(key);
+}
+
+void CCTextureCache::uncacheTexture(const std::string& key)
+{
+    CCTextureCacheEntryMap::iterator it = m_entries.find(key);
+    if (it != m_entries.end())
+    {
+        m_uTextureMemoryUsed -= it->second.bytes;
+        m_entries.erase(it);
+    }
+    m_pTextures->removeObjectForKey(key);
+}
+
+CCTexture2D* CCTextureCache::touchTexture(const std::string& key)
+{
+    CCTextureCacheEntryMap::iterator it = m_entries.find(key);
+    if (it == m_entries.end())
+    {
+        return NULL;
+    }
+
+    CCTextureCacheEntry& entry = it->second;
+    entry.lastUse = ++m_uUseCounter;
+
+    // mipmaps may have been generated since the texture was cached
+    unsigned int bytes = textureMemorySize(entry.texture);
+    m_uTextureMemoryUsed = m_uTextureMemoryUsed - entry.bytes + bytes;
+    entry.bytes = bytes;
+
+    return entry.texture;
+}
+
+static bool compareLastUse(const std::pair<unsigned int, std::string>& a, const std::pair<unsigned int, std::string>& b)
+{
+    return a.first < b.first;
+}
+
+void CCTextureCache::evictTextures(const std::string& keepKey)
+{
+    if (m_uTextureMemoryBudget == 0 || m_uTextureMemoryUsed <= m_uTextureMemoryBudget)
+    {
+        return;
+    }
+
+    // textures only retained by the cache, least recently used first
+    std::vector<std::pair<unsigned int, std::string> > candidates;
+    for (CCTextureCacheEntryMap::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+    {
+        const CCTextureCacheEntry& entry = it->second;
+        if (! entry.pinned && entry.texture->retainCount() == 1 && it->first != keepKey)
+        {
+            candidates.push_back(std::make_pair(entry.lastUse, it->first));
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), compareLastUse);
+
+    for (unsigned int i = 0; i < candidates.size() && m_uTextureMemoryUsed > m_uTextureMemoryBudget; ++i)
+    {
+        const std::string& key = candidates[i].second;
+        CCTextureCacheEntryMap::iterator it = m_entries.find(key);
+        if (it == m_entries.end())
+        {
+            // already removed by the delegate
+            continue;
+        }
+        CCTextureCacheEntry& entry = it->second;
+        CCLOG("cocos2d: CCTextureCache: evicting texture: %s (%u KB)", key.c_str(), entry.bytes / 1024);
+        if (m_pDelegate)
+        {
+            m_pDelegate->textureCacheWillEvictTexture(this, entry.texture, key.c_str());
+        }
+        uncacheTexture(key);
+    }
+
+    if (m_uTextureMemoryUsed > m_uTextureMemoryBudget)
+    {
+        CCLOG("cocos2d: CCTextureCache: %u KB of textures in use exceed the budget of %u KB",
+              m_uTextureMemoryUsed / 1024, m_uTextureMemoryBudget / 1024);
+    }
+}
+
+void CCTextureCache::setTextureMemoryBudget(unsigned int bytes)
+{
+    m_uTextureMemoryBudget = bytes;
+    evictTextures("");
+}
+
+void CCTextureCache::setTexturePinned(CCTexture2D* texture, bool pinned)
+{
+    for (CCTextureCacheEntryMap::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+    {
+        if (it->second.texture == texture)
+        {
+            it->second.pinned = pinned;
+        }
+    }
+}
+
+bool CCTextureCache::isTexturePinned(CCTexture2D* texture)
+{
+    for (CCTextureCacheEntryMap::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+    {
+        if (it->second.texture == texture && it->second.pinned)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void CCTextureCache::setDynamicAtlas(CCDynamicAtlas* pAtlas)
+{
+    CC_SAFE_RETAIN(pAtlas);
+    CC_SAFE_RELEASE(m_pDynamicAtlas);
+    m_pDynamicAtlas = pAtlas;
+}
+
+CCSpriteFrame* CCTextureCache::addImageToDynamicAtlas(const char* fileimage)
+{
+    CCAssert(fileimage != NULL, "TextureCache: fileimage MUST not be NULL");
+
+    if (! m_pDynamicAtlas)
+    {
+        return NULL;
+    }
+
+    // an image already loaded as a texture keeps being used as such
+    std::string fullpath = CCFileUtils::sharedFileUtils()->fullPathForFilename(fileimage);
+    if (m_pTextures->objectForKey(fullpath.c_str()))
+    {
+        return NULL;
+    }
+    return m_pDynamicAtlas->addImage(fullpath.c_str());
 }
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -814,6 +1094,10 @@ void VolatileTexture::reloadAllTextures()
                     vt->texture->initWithPVRFile(vt->m_strFileName.c_str());
                     CCTexture2D::setDefaultAlphaPixelFormat(oldPixelFormat);
                 } 
+                else if (std::string::npos != lowerCase.find(".ktx"))
+                {
+                    vt->texture->initWithKTXFile(vt->m_strFileName.c_str());
+                }
                 else 
                 {
                     CCImage* pImage = new CCImage();
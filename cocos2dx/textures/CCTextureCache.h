@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "cocoa/CCDictionary.h"
 #include "textures/CCTexture2D.h"
 #include <string>
+#include <map>
 
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
@@ -42,12 +43,27 @@ NS_CC_BEGIN
 
 class CCLock;
 class CCImage;
+class CCSpriteFrame;
+class CCDynamicAtlas;
 
 /**
  * @addtogroup textures
  * @{
  */
 
+class CCTextureCache;
+
+/** @brief Receives the textures CCTextureCache evicts to stay within its memory budget
+ @since v2.1.4
+ */
+class CC_DLL CCTextureCacheDelegate
+{
+public:
+    virtual ~CCTextureCacheDelegate() {}
+    /** called right before the texture cached under key is removed from the cache. The texture is still valid. */
+    virtual void textureCacheWillEvictTexture(CCTextureCache* cache, CCTexture2D* texture, const char* key) = 0;
+};
+
 /** @brief Singleton that handles the loading of textures
 * Once the texture is loaded, the next time it will return
 * a reference of the previously loaded texture reducing GPU & CPU memory
@@ -55,13 +71,42 @@ class CCImage;
 class CC_DLL CCTextureCache : public CCObject
 {
 protected:
+    // memory accounting of a cached texture, kept next to m_pTextures under the same key
+    struct CCTextureCacheEntry
+    {
+        CCTexture2D* texture;   // weak, m_pTextures retains it
+        unsigned int bytes;
+        unsigned int lastUse;
+        bool pinned;
+    };
+    typedef std::map<std::string, CCTextureCacheEntry> CCTextureCacheEntryMap;
+
     CCDictionary* m_pTextures;
     //pthread_mutex_t                *m_pDictLock;
+    bool m_bUseCompressedTextureVariants;
 
+    CCTextureCacheEntryMap m_entries;
+    unsigned int m_uTextureMemoryBudget;
+    unsigned int m_uTextureMemoryUsed;
+    unsigned int m_uUseCounter;
+    CCTextureCacheDelegate* m_pDelegate;
+    CCDynamicAtlas* m_pDynamicAtlas;
 
 private:
+    // adds texture to m_pTextures and to the accounting, then evicts textures if the budget is exceeded
+    void cacheTexture(CCTexture2D* texture, const std::string& key);
+    // removes key from m_pTextures and from the accounting
+    void uncacheTexture(const std::string& key);
+    // marks the texture cached under key as the most recently used one and returns it
+    CCTexture2D* touchTexture(const std::string& key);
+    // evicts the least recently used unreferenced textures until the budget is met; keepKey is never evicted
+    void evictTextures(const std::string& keepKey);
+
     /// todo: void addImageWithAsyncObject(CCAsyncObject* async);
     void addImageAsyncCallBack(float dt);
+    
+    // loads the best compressed variant of fullpath the GPU supports, NULL if there is none
+    CCTexture2D* addCompressedTextureVariant(const std::string& fullpath);
 
 public:
 
@@ -84,7 +129,7 @@ public:
     * If the file image was not previously loaded, it will create a new CCTexture2D
     *  object and it will return it. It will use the filename as a key.
     * Otherwise it will return a reference of a previously loaded image.
-    * Supported image extensions: .png, .bmp, .tiff, .jpeg, .pvr, .gif
+    * Supported image extensions: .png, .bmp, .tiff, .jpeg, .pvr, .ktx, .gif
     */
     CCTexture2D* addImage(const char* fileimage);
 
@@ -155,6 +200,68 @@ public:
     */
     CCTexture2D* addPVRImage(const char* filename);
 
+    /** Returns a Texture2D object given a KTX filename
+    * If the file image was not previously loaded, it will create a new CCTexture2D
+    *  object and it will return it. Otherwise it will return a reference of a previously loaded image
+    * @since v2.1.4
+    */
+    CCTexture2D* addKTXImage(const char* filename);
+
+    /** Sets whether addImage() prefers the compressed variants of an image.
+    * When enabled, addImage("hero.png") loads "hero.etc2.ktx", "hero.s3tc.ktx" or "hero.etc1.ktx" instead,
+    * the first one that exists next to "hero.png" and that the GPU can sample, and falls back to "hero.png".
+    * The variants are generated by tools/ktx-converter. Disabled by default.
+    * @since v2.1.4
+    */
+    void setUseCompressedTextureVariants(bool bUse) { m_bUseCompressedTextureVariants = bUse; }
+    bool isUsingCompressedTextureVariants() { return m_bUseCompressedTextureVariants; }
+
+    /** Sets the memory budget of the cached textures, in bytes. 0, the default, means no budget.
+    * When a texture is added and the cached textures use more than the budget, the least recently used
+    * textures that are only referenced by the cache (retain count of 1) and are not pinned are removed
+    * until the budget is met again. A texture cached under several keys is counted once per key.
+    * @since v2.1.4
+    */
+    void setTextureMemoryBudget(unsigned int bytes);
+    unsigned int getTextureMemoryBudget() { return m_uTextureMemoryBudget; }
+
+    /** Returns the memory used by the cached textures, in bytes, as estimated from their size, format and mipmaps
+    * @since v2.1.4
+    */
+    unsigned int getTextureMemoryUsed() { return m_uTextureMemoryUsed; }
+
+    /** Returns the memory used by a texture, in bytes: width * height * bpp / 8, plus a third with mipmaps
+    * @since v2.1.4
+    */
+    static unsigned int textureMemorySize(CCTexture2D* texture);
+
+    /** Pins (or unpins) a cached texture. Pinned textures are never evicted to meet the memory budget,
+    * but removeUnusedTextures() and removeTexture() still remove them.
+    * @since v2.1.4
+    */
+    void setTexturePinned(CCTexture2D* texture, bool pinned);
+    bool isTexturePinned(CCTexture2D* texture);
+
+    /** Sets the delegate told about the textures evicted to meet the memory budget. It is not retained.
+    * @since v2.1.4
+    */
+    void setDelegate(CCTextureCacheDelegate* pDelegate) { m_pDelegate = pDelegate; }
+    CCTextureCacheDelegate* getDelegate() { return m_pDelegate; }
+
+    /** Sets the atlas CCSprite::create(filename) packs its image into, so sprites made from loose images
+    * can share a texture and be batched. It is retained. NULL, the default, disables it.
+    * @since v2.1.4
+    */
+    void setDynamicAtlas(CCDynamicAtlas* pAtlas);
+    CCDynamicAtlas* getDynamicAtlas() { return m_pDynamicAtlas; }
+
+    /** Returns the sprite frame of an image packed into the dynamic atlas, packing it if needed.
+    * Returns NULL if there is no dynamic atlas, if the image is already cached as a texture or if it
+    * can't be packed (too large, unsupported format).
+    * @since v2.1.4
+    */
+    CCSpriteFrame* addImageToDynamicAtlas(const char* fileimage);
+
     /** Reload all textures
     It's only useful when the value of CC_ENABLE_CACHE_TEXTURE_DATA is 1
     */
@@ -0,0 +1,515 @@
+/****************************************************************************
+Copyright (c) 2013 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "CCTexture2D.h"
+#include "CCTextureKTX.h"
+#include "ccMacros.h"
+#include "CCConfiguration.h"
+#include "support/ccUtils.h"
+#include "support/image_support/ccTextureDecoders.h"
+#include "CCStdC.h"
+#include "platform/CCFileUtils.h"
+#include "support/zip_support/ZipUtils.h"
+#include "shaders/ccGLStateCache.h"
+#include <ctype.h>
+#include <string.h>
+
+// Not all platforms include the headers that define these enums
+#ifndef GL_ETC1_RGB8_OES
+#define GL_ETC1_RGB8_OES                    0x8D64
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2             0x9274
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC        0x9278
+#endif
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT     0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT    0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT3_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT    0x83F2
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT    0x83F3
+#endif
+
+NS_CC_BEGIN
+
+//
+// XXX DO NO ALTER THE ORDER IN THIS LIST XXX
+//
+static const ccKTXTexturePixelFormatInfo KTXTableFormats[] = {
+
+    // 0: RGBA_8888
+    {GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE, 32, false, true, kCCTexture2DPixelFormat_RGBA8888},
+    // 1: RGB_888
+    {GL_RGB, GL_RGB, GL_UNSIGNED_BYTE, 24, false, false, kCCTexture2DPixelFormat_RGB888},
+    // 2: RGBA_4444
+    {GL_RGBA, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4, 16, false, true, kCCTexture2DPixelFormat_RGBA4444},
+    // 3: RGBA_5551
+    {GL_RGBA, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, 16, false, true, kCCTexture2DPixelFormat_RGB5A1},
+    // 4: RGB_565
+    {GL_RGB, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, 16, false, false, kCCTexture2DPixelFormat_RGB565},
+    // 5: ETC1
+    {GL_ETC1_RGB8_OES, 0, 0, 4, true, false, kCCTexture2DPixelFormat_ETC1},
+    // 6: ETC2 RGB8
+    {GL_COMPRESSED_RGB8_ETC2, 0, 0, 4, true, false, kCCTexture2DPixelFormat_ETC2_RGB},
+    // 7: ETC2 RGBA8
+    {GL_COMPRESSED_RGBA8_ETC2_EAC, 0, 0, 8, true, true, kCCTexture2DPixelFormat_ETC2_RGBA},
+    // 8: DXT1 RGB
+    {GL_COMPRESSED_RGB_S3TC_DXT1_EXT, 0, 0, 4, true, false, kCCTexture2DPixelFormat_S3TC_DXT1},
+    // 9: DXT1 RGBA
+    {GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, 0, 0, 4, true, true, kCCTexture2DPixelFormat_S3TC_DXT1},
+    // 10: DXT3
+    {GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, 0, 0, 8, true, true, kCCTexture2DPixelFormat_S3TC_DXT3},
+    // 11: DXT5
+    {GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, 0, 0, 8, true, true, kCCTexture2DPixelFormat_S3TC_DXT5},
+};
+
+#define KTX_MAX_TABLE_ELEMENTS (sizeof(KTXTableFormats) / sizeof(KTXTableFormats[0]))
+
+static const unsigned char gKTXTexIdentifier[12] = {
+    0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'
+};
+
+#define KTX_ENDIANNESS_NATIVE   0x04030201
+#define KTX_ENDIANNESS_SWAPPED  0x01020304
+
+#define KTX_PREMULTIPLIED_ALPHA_KEY "cocos2d.premultipliedAlpha"
+
+typedef struct {
+    unsigned char identifier[12];
+    uint32_t endianness;
+    uint32_t glType;
+    uint32_t glTypeSize;
+    uint32_t glFormat;
+    uint32_t glInternalFormat;
+    uint32_t glBaseInternalFormat;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t numberOfArrayElements;
+    uint32_t numberOfFaces;
+    uint32_t numberOfMipmapLevels;
+    uint32_t bytesOfKeyValueData;
+} ccKTXTexHeader;
+
+static inline uint32_t ktxRead32(const unsigned char* p, bool swap)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return swap ? CC_SWAP32(value) : value;
+}
+
+static bool ccCompressedFormatForPixelFormat(CCTexture2DPixelFormat pixelFormat, ccCompressedFormat *format)
+{
+    switch (pixelFormat)
+    {
+        case kCCTexture2DPixelFormat_ETC1:
+            *format = kCCCompressedFormat_ETC1;
+            return true;
+        case kCCTexture2DPixelFormat_ETC2_RGB:
+            *format = kCCCompressedFormat_ETC2_RGB;
+            return true;
+        case kCCTexture2DPixelFormat_ETC2_RGBA:
+            *format = kCCCompressedFormat_ETC2_RGBA;
+            return true;
+        case kCCTexture2DPixelFormat_S3TC_DXT1:
+            *format = kCCCompressedFormat_S3TC_DXT1;
+            return true;
+        case kCCTexture2DPixelFormat_S3TC_DXT3:
+            *format = kCCCompressedFormat_S3TC_DXT3;
+            return true;
+        case kCCTexture2DPixelFormat_S3TC_DXT5:
+            *format = kCCCompressedFormat_S3TC_DXT5;
+            return true;
+        default:
+            return false;
+    }
+}
+
+CCTextureKTX::CCTextureKTX()
+: m_uNumberOfMipmaps(0)
+, m_uWidth(0)
+, m_uHeight(0)
+, m_uName(0)
+, m_bHasAlpha(false)
+, m_bHasPremultipliedAlpha(false)
+, m_bDecoded(false)
+, m_bRetainName(false)
+, m_eFormat(kCCTexture2DPixelFormat_Default)
+, m_pPixelFormatInfo(NULL)
+{
+}
+
+CCTextureKTX::~CCTextureKTX()
+{
+    CCLOGINFO( "cocos2d: deallocing CCTextureKTX" );
+
+    if (m_uName != 0 && ! m_bRetainName)
+    {
+        ccGLDeleteTexture(m_uName);
+    }
+}
+
+bool CCTextureKTX::isPixelFormatSupported(CCTexture2DPixelFormat format)
+{
+    CCConfiguration *configuration = CCConfiguration::sharedConfiguration();
+
+    switch (format)
+    {
+        case kCCTexture2DPixelFormat_ETC1:
+            // ETC2 decoders accept ETC1 data as well
+            return configuration->supportsETC1() || configuration->supportsETC2();
+        case kCCTexture2DPixelFormat_ETC2_RGB:
+        case kCCTexture2DPixelFormat_ETC2_RGBA:
+            return configuration->supportsETC2();
+        case kCCTexture2DPixelFormat_S3TC_DXT1:
+        case kCCTexture2DPixelFormat_S3TC_DXT3:
+        case kCCTexture2DPixelFormat_S3TC_DXT5:
+            return configuration->supportsS3TC();
+        default:
+            return true;
+    }
+}
+
+void CCTextureKTX::parseKeyValueData(unsigned char* data, unsigned int len, bool swap)
+{
+    unsigned int offset = 0;
+    while (offset + 4 <= len)
+    {
+        uint32_t keyAndValueByteSize = ktxRead32(data + offset, swap);
+        offset += 4;
+        if (keyAndValueByteSize > len - offset)
+        {
+            break;
+        }
+
+        const char *key = (const char *)(data + offset);
+        const char *keyEnd = (const char *)memchr(key, 0, keyAndValueByteSize);
+        if (keyEnd != NULL && strcmp(key, KTX_PREMULTIPLIED_ALPHA_KEY) == 0)
+        {
+            const char *value = keyEnd + 1;
+            unsigned int valueLength = keyAndValueByteSize - (unsigned int)(value - key);
+            m_bHasPremultipliedAlpha = (valueLength >= 4 && strncmp(value, "true", 4) == 0);
+        }
+
+        // key and value are padded to 4 bytes
+        offset += (keyAndValueByteSize + 3) & ~3;
+    }
+}
+
+bool CCTextureKTX::unpackKTXData(unsigned char* data, unsigned int len)
+{
+    if (data == NULL || len < sizeof(ccKTXTexHeader) || memcmp(data, gKTXTexIdentifier, sizeof(gKTXTexIdentifier)) != 0)
+    {
+        return false;
+    }
+
+    uint32_t endianness = ktxRead32(data + 12, false);
+    if (endianness != KTX_ENDIANNESS_NATIVE && endianness != KTX_ENDIANNESS_SWAPPED)
+    {
+        CCLOG("cocos2d: WARNING: invalid ktx endianness: 0x%08x", endianness);
+        return false;
+    }
+    bool swap = (endianness == KTX_ENDIANNESS_SWAPPED);
+
+    uint32_t glType = ktxRead32(data + 16, swap);
+    uint32_t glTypeSize = ktxRead32(data + 20, swap);
+    uint32_t glFormat = ktxRead32(data + 24, swap);
+    uint32_t glInternalFormat = ktxRead32(data + 28, swap);
+    uint32_t width = ktxRead32(data + 36, swap);
+    uint32_t height = ktxRead32(data + 40, swap);
+    uint32_t depth = ktxRead32(data + 44, swap);
+    uint32_t numberOfArrayElements = ktxRead32(data + 48, swap);
+    uint32_t numberOfFaces = ktxRead32(data + 52, swap);
+    uint32_t numberOfMipmapLevels = ktxRead32(data + 56, swap);
+    uint32_t bytesOfKeyValueData = ktxRead32(data + 60, swap);
+
+    if (depth > 0 || numberOfArrayElements > 0 || numberOfFaces != 1 || height == 0)
+    {
+        CCLOG("cocos2d: WARNING: only 2D ktx textures are supported");
+        return false;
+    }
+
+    if (! CCConfiguration::sharedConfiguration()->supportsNPOT() &&
+        (width != ccNextPOT(width) || height != ccNextPOT(height)))
+    {
+        CCLOG("cocos2d: ERROR: Loading an NPOT texture (%dx%d) but is not supported on this device", width, height);
+        return false;
+    }
+
+    for (unsigned int i = 0; i < KTX_MAX_TABLE_ELEMENTS; i++)
+    {
+        const ccKTXTexturePixelFormatInfo *info = &KTXTableFormats[i];
+        if (glType == 0 ? (info->compressed && info->internalFormat == glInternalFormat)
+                        : (! info->compressed && info->format == glFormat && info->type == glType))
+        {
+            m_pPixelFormatInfo = info;
+            break;
+        }
+    }
+
+    if (m_pPixelFormatInfo == NULL)
+    {
+        CCLOG("cocos2d: WARNING: unsupported ktx pixel format: glType 0x%04x, glInternalFormat 0x%04x", glType, glInternalFormat);
+        return false;
+    }
+
+    unsigned int dataOffset = sizeof(ccKTXTexHeader);
+    if (bytesOfKeyValueData > len - dataOffset)
+    {
+        return false;
+    }
+    parseKeyValueData(data + dataOffset, bytesOfKeyValueData, swap);
+    dataOffset += bytesOfKeyValueData;
+
+    m_uWidth = width;
+    m_uHeight = height;
+    m_bHasAlpha = m_pPixelFormatInfo->alpha;
+    m_uNumberOfMipmaps = MAX(numberOfMipmapLevels, 1);
+    CCAssert(m_uNumberOfMipmaps < CC_KTXMIPMAP_MAX, "TextureKTX: Maximum number of mimpaps reached. Increate the CC_KTXMIPMAP_MAX value");
+
+    for (unsigned int i = 0; i < m_uNumberOfMipmaps; i++)
+    {
+        if (dataOffset + 4 > len)
+        {
+            CCLOG("cocos2d: WARNING: ktx file is truncated at mipmap level %u", i);
+            return false;
+        }
+
+        uint32_t imageSize = ktxRead32(data + dataOffset, swap);
+        dataOffset += 4;
+        if (imageSize > len - dataOffset)
+        {
+            CCLOG("cocos2d: WARNING: ktx file is truncated at mipmap level %u", i);
+            return false;
+        }
+
+        m_asMipmaps[i].address = data + dataOffset;
+        m_asMipmaps[i].len = imageSize;
+
+        // 16 bits pixels have to be converted to the host byte order
+        if (swap && glTypeSize == 2)
+        {
+            unsigned short *pixels = (unsigned short *)m_asMipmaps[i].address;
+            for (unsigned int j = 0; j < imageSize / 2; ++j)
+            {
+                pixels[j] = (unsigned short)((pixels[j] >> 8) | (pixels[j] << 8));
+            }
+        }
+
+        // mip levels are padded to 4 bytes
+        dataOffset += (imageSize + 3) & ~3;
+    }
+
+    return true;
+}
+
+bool CCTextureKTX::createGLTexture()
+{
+    unsigned int width = m_uWidth;
+    unsigned int height = m_uHeight;
+    GLenum err;
+
+    if (m_uName != 0)
+    {
+        ccGLDeleteTexture(m_uName);
+    }
+
+    // KTX rows are padded to 4 bytes, which matters only for the uncompressed formats
+    glPixelStorei(GL_UNPACK_ALIGNMENT, m_pPixelFormatInfo->compressed ? 1 : 4);
+
+    glGenTextures(1, &m_uName);
+    ccGLBindTexture2D(m_uName);
+
+    // Default: Anti alias.
+    if (m_uNumberOfMipmaps == 1)
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    }
+    else
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    CHECK_GL_ERROR_DEBUG(); // clean possible GL error
+
+    GLenum internalFormat = m_pPixelFormatInfo->internalFormat;
+    bool compressed = m_pPixelFormatInfo->compressed;
+
+    ccCompressedFormat decodeFormat = kCCCompressedFormat_ETC1;
+    unsigned char *decoded = NULL;
+
+    m_eFormat = m_pPixelFormatInfo->ccPixelFormat;
+    m_bDecoded = compressed && ! isPixelFormatSupported(m_eFormat);
+    if (m_bDecoded)
+    {
+        CCLOG("cocos2d: TextureKTX: %s is not supported by the GPU, decoding it", m_eFormat == kCCTexture2DPixelFormat_ETC1 ? "ETC1" :
+              (m_eFormat == kCCTexture2DPixelFormat_ETC2_RGB || m_eFormat == kCCTexture2DPixelFormat_ETC2_RGBA) ? "ETC2" : "S3TC");
+
+        ccCompressedFormatForPixelFormat(m_eFormat, &decodeFormat);
+        decoded = new unsigned char[width * height * 4];
+        m_eFormat = kCCTexture2DPixelFormat_RGBA8888;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+    else if (m_eFormat == kCCTexture2DPixelFormat_ETC1 && ! CCConfiguration::sharedConfiguration()->supportsETC1())
+    {
+        // ETC1 data is valid ETC2 data
+        internalFormat = GL_COMPRESSED_RGB8_ETC2;
+    }
+
+    bool ret = true;
+    for (unsigned int i = 0; i < m_uNumberOfMipmaps; ++i)
+    {
+        unsigned char *data = m_asMipmaps[i].address;
+        GLsizei datalen = m_asMipmaps[i].len;
+
+        if (m_bDecoded)
+        {
+            if (! ccDecodeCompressedImage(decodeFormat, data, datalen, width, height, decoded))
+            {
+                CCLOG("cocos2d: TextureKTX: Error decoding texture level: %u", i);
+                ret = false;
+                break;
+            }
+
+            if (! m_bHasAlpha)
+            {
+                // DXT1 without alpha decodes its transparent index as opaque black
+                for (unsigned int j = 3; j < width * height * 4; j += 4)
+                {
+                    decoded[j] = 255;
+                }
+            }
+
+            glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, decoded);
+        }
+        else if (compressed)
+        {
+            glCompressedTexImage2D(GL_TEXTURE_2D, i, internalFormat, width, height, 0, datalen, data);
+        }
+        else
+        {
+            glTexImage2D(GL_TEXTURE_2D, i, internalFormat, width, height, 0, m_pPixelFormatInfo->format, m_pPixelFormatInfo->type, data);
+        }
+
+        if (i > 0 && (width != height || ccNextPOT(width) != width ))
+        {
+            CCLOG("cocos2d: TextureKTX. WARNING. Mipmap level %u is not squared. Texture won't render correctly. width=%u != height=%u", i, width, height);
+        }
+
+        err = glGetError();
+        if (err != GL_NO_ERROR)
+        {
+            CCLOG("cocos2d: TextureKTX: Error uploading texture level: %u . glError: 0x%04X", i, err);
+            ret = false;
+            break;
+        }
+
+        width = MAX(width >> 1, 1);
+        height = MAX(height >> 1, 1);
+    }
+
+    CC_SAFE_DELETE_ARRAY(decoded);
+    return ret;
+}
+
+bool CCTextureKTX::initWithContentsOfFile(const char* path)
+{
+    unsigned char* ktxdata = NULL;
+    int ktxlen = 0;
+
+    std::string lowerCase(path);
+    for (unsigned int i = 0; i < lowerCase.length(); ++i)
+    {
+        lowerCase[i] = tolower(lowerCase[i]);
+    }
+
+    if (lowerCase.find(".ccz") != std::string::npos)
+    {
+        ktxlen = ZipUtils::ccInflateCCZFile(path, &ktxdata);
+    }
+    else if (lowerCase.find(".gz") != std::string::npos)
+    {
+        ktxlen = ZipUtils::ccInflateGZipFile(path, &ktxdata);
+    }
+    else
+    {
+        unsigned long size = 0;
+        ktxdata = CCFileUtils::sharedFileUtils()->getFileData(path, "rb", &size);
+        ktxlen = (int)size;
+    }
+
+    if (ktxlen < 0)
+    {
+        return false;
+    }
+
+    m_uNumberOfMipmaps = 0;
+
+    m_uName = 0;
+    m_uWidth = m_uHeight = 0;
+    m_pPixelFormatInfo = NULL;
+    m_bHasAlpha = false;
+    m_bHasPremultipliedAlpha = false;
+    m_bDecoded = false;
+
+    m_bRetainName = false; // cocos2d integration
+
+    bool bRet = unpackKTXData(ktxdata, ktxlen) && createGLTexture();
+
+    CC_SAFE_DELETE_ARRAY(ktxdata);
+
+    return bRet;
+}
+
+CCTextureKTX * CCTextureKTX::create(const char* path)
+{
+    CCTextureKTX * pTexture = new CCTextureKTX();
+    if (pTexture)
+    {
+        if (pTexture->initWithContentsOfFile(path))
+        {
+            pTexture->autorelease();
+        }
+        else
+        {
+            delete pTexture;
+            pTexture = NULL;
+        }
+    }
+
+    return pTexture;
+}
+
+NS_CC_END
@@ -0,0 +1,146 @@
+/****************************************************************************
+Copyright (c) 2013 cocos2d-x.org
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCKTXTEXTURE_H__
+#define __CCKTXTEXTURE_H__
+
+#include "CCStdC.h"
+#include "CCGL.h"
+#include "cocoa/CCObject.h"
+#include "textures/CCTexture2D.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup textures
+ * @{
+ */
+
+/**
+ @brief Structure which can tell where a KTX mipmap begins and how long is it
+*/
+struct CCKTXMipmap {
+    unsigned char *address;
+    unsigned int len;
+};
+
+typedef struct _ccKTXTexturePixelFormatInfo {
+    GLenum internalFormat;
+    GLenum format;
+    GLenum type;
+    uint32_t bpp;
+    bool compressed;
+    bool alpha;
+    CCTexture2DPixelFormat ccPixelFormat;
+} ccKTXTexturePixelFormatInfo;
+
+enum {
+    CC_KTXMIPMAP_MAX = 16,
+};
+
+/** CCTextureKTX
+
+ Object that loads KTX (Khronos texture container) images.
+
+ Supported KTX formats:
+    - ETC1
+    - ETC2 RGB8
+    - ETC2 RGBA8 (EAC alpha)
+    - S3TC DXT1, DXT3 and DXT5
+    - RGBA8888, RGB888, RGBA4444, RGBA5551, RGB565
+
+ Compressed data is uploaded as is when the GL context supports the format
+ (see CCConfiguration::supportsETC1, supportsETC2 and supportsS3TC).
+ Otherwise every mipmap level is decoded on the CPU and uploaded as RGBA8888,
+ so the same files work, with more memory, on every GPU.
+
+ Limitations:
+    Only 2D textures are supported: no arrays, cube maps or 3D textures.
+*/
+class CCTextureKTX : public CCObject
+{
+public:
+    CCTextureKTX();
+    virtual ~CCTextureKTX();
+
+    /** initializes a CCTextureKTX with a path */
+    bool initWithContentsOfFile(const char* path);
+
+    /** creates and initializes a CCTextureKTX with a path */
+    static CCTextureKTX* create(const char* path);
+
+    /** returns whether the current GL context can sample the given format without decoding it first */
+    static bool isPixelFormatSupported(CCTexture2DPixelFormat format);
+
+    // properties
+
+    /** texture id name */
+    inline unsigned int getName() { return m_uName; }
+    /** texture width */
+    inline unsigned int getWidth() { return m_uWidth; }
+    /** texture height */
+    inline unsigned int getHeight() { return m_uHeight; }
+    /** whether or not the texture has alpha */
+    inline bool hasAlpha() { return m_bHasAlpha; }
+    /** whether or not the texture has premultiplied alpha, written by the converter as "cocos2d.premultipliedAlpha" */
+    inline bool hasPremultipliedAlpha() { return m_bHasPremultipliedAlpha; }
+    /** how many mipmaps the texture has. 1 means one level (level 0 */
+    inline unsigned int getNumberOfMipmaps() { return m_uNumberOfMipmaps; }
+    /** format of the GL texture, RGBA8888 if the data had to be decoded */
+    inline CCTexture2DPixelFormat getFormat() { return m_eFormat; }
+    /** format of the data stored in the file */
+    inline CCTexture2DPixelFormat getFileFormat() { return m_pPixelFormatInfo ? m_pPixelFormatInfo->ccPixelFormat : m_eFormat; }
+    /** whether or not the data was decoded on the CPU because the GPU can't sample it */
+    inline bool isDecoded() { return m_bDecoded; }
+    inline bool isRetainName() { return m_bRetainName; }
+    inline void setRetainName(bool retainName) { m_bRetainName = retainName; }
+
+private:
+    bool unpackKTXData(unsigned char* data, unsigned int len);
+    void parseKeyValueData(unsigned char* data, unsigned int len, bool swap);
+    bool createGLTexture();
+
+protected:
+    struct CCKTXMipmap m_asMipmaps[CC_KTXMIPMAP_MAX];   // pointer to mipmap images
+    unsigned int m_uNumberOfMipmaps;                    // number of mipmap used
+
+    unsigned int m_uWidth, m_uHeight;
+    GLuint m_uName;
+    bool m_bHasAlpha;
+    bool m_bHasPremultipliedAlpha;
+    bool m_bDecoded;
+
+    // cocos2d integration
+    bool m_bRetainName;
+    CCTexture2DPixelFormat m_eFormat;
+
+    const ccKTXTexturePixelFormatInfo *m_pPixelFormatInfo;
+};
+
+// end of textures group
+/// @}
+
+NS_CC_END
+
+#endif //__CCKTXTEXTURE_H__
@@ -227,6 +227,7 @@ void CCTileMapAtlas::updateAtlasValueAt(const CCPoint& pos, const ccColor3B& val
     quad.bl.colors = color;
 
     m_pTextureAtlas->updateQuad(&quad, index);
+    invalidateRenderCache();
 }
 
 void CCTileMapAtlas::updateAtlasValues()
@@ -27,6 +27,7 @@ THE SOFTWARE.
 
 #include "cocoa/CCObject.h"
 #include "cocoa/CCGeometry.h"
+#include "support/CCPoolAllocator.h"
 
 NS_CC_BEGIN
 
@@ -37,6 +38,8 @@ NS_CC_BEGIN
 
 class CC_DLL CCTouch : public CCObject
 {
+    CC_POOL_ALLOCATED()
+
 public:
     CCTouch() 
         : m_nId(0),
@@ -7,6 +7,7 @@ LOCAL_MODULE_FILENAME := libextension
 
 LOCAL_SRC_FILES := AssetsManager/AssetsManager.cpp \
 CCBReader/CCBFileLoader.cpp \
+CCBReader/CCBFileCache.cpp \
 CCBReader/CCBReader.cpp \
 CCBReader/CCControlButtonLoader.cpp \
 CCBReader/CCControlLoader.cpp \
@@ -51,6 +52,7 @@ GUI/CCEditBox/CCEditBoxImplAndroid.cpp \
 network/HttpClient.cpp \
 physics_nodes/CCPhysicsDebugNode.cpp \
 physics_nodes/CCPhysicsSprite.cpp \
+physics_nodes/CCPhysicsWorldNode.cpp \
 LocalStorage/LocalStorageAndroid.cpp \
 spine/Animation.cpp \
 spine/AnimationState.cpp \
@@ -64,6 +66,7 @@ spine/BoneData.cpp \
 spine/Json.cpp \
 spine/RegionAttachment.cpp \
 spine/Skeleton.cpp \
+spine/SkeletonBinary.cpp \
 spine/SkeletonData.cpp \
 spine/SkeletonJson.cpp \
 spine/Skin.cpp \
@@ -0,0 +1,224 @@
+#include "CCBFileCache.h"
+#include "CCData.h"
+#include <float.h>
+
+using namespace cocos2d;
+using namespace std;
+
+NS_CC_EXT_BEGIN
+
+/*************************************************************************
+ Implementation of CCBFileTemplate
+ *************************************************************************/
+
+CCBFileTemplate::CCBFileTemplate()
+: mData(NULL)
+, mBodyOffset(0)
+, mJSControlled(false)
+, mParsed(false)
+, mLoadTime(0)
+{
+    resetStatistics();
+}
+
+CCBFileTemplate::~CCBFileTemplate()
+{
+    CC_SAFE_RELEASE(mData);
+}
+
+CCBFileTemplate* CCBFileTemplate::createWithFile(const char *pFullPath)
+{
+    struct cc_timeval start, end;
+    CCTime::gettimeofdayCocos2d(&start, NULL);
+
+    unsigned long size = 0;
+    unsigned char *pBytes = CCFileUtils::sharedFileUtils()->getFileData(pFullPath, "rb", &size);
+    if (pBytes == NULL || size == 0)
+    {
+        CC_SAFE_DELETE_ARRAY(pBytes);
+        return NULL;
+    }
+
+    CCBFileTemplate *pRet = new CCBFileTemplate();
+    pRet->autorelease();
+    pRet->mFileName = pFullPath;
+    pRet->mData = new CCData(pBytes, size);
+    CC_SAFE_DELETE_ARRAY(pBytes);
+
+    CCTime::gettimeofdayCocos2d(&end, NULL);
+    pRet->addLoadTime(CCTime::timersubCocos2d(&start, &end));
+    return pRet;
+}
+
+const char* CCBFileTemplate::getFileName()
+{
+    return mFileName.c_str();
+}
+
+CCData* CCBFileTemplate::getData()
+{
+    return mData;
+}
+
+bool CCBFileTemplate::isParsed()
+{
+    return mParsed;
+}
+
+void CCBFileTemplate::setParsed(const std::vector<std::string> &stringCache, int nBodyOffset, bool bJSControlled)
+{
+    mStringCache = stringCache;
+    mBodyOffset = nBodyOffset;
+    mJSControlled = bJSControlled;
+    mParsed = true;
+}
+
+const std::vector<std::string>& CCBFileTemplate::getStringCache()
+{
+    return mStringCache;
+}
+
+int CCBFileTemplate::getBodyOffset()
+{
+    return mBodyOffset;
+}
+
+bool CCBFileTemplate::isJSControlled()
+{
+    return mJSControlled;
+}
+
+double CCBFileTemplate::getLoadTime()
+{
+    return mLoadTime;
+}
+
+void CCBFileTemplate::addLoadTime(double dMilliseconds)
+{
+    mLoadTime += dMilliseconds;
+}
+
+unsigned int CCBFileTemplate::getInstantiationCount()
+{
+    return mInstantiationCount;
+}
+
+double CCBFileTemplate::getAverageInstantiationTime()
+{
+    return mInstantiationCount ? mTotalInstantiationTime / mInstantiationCount : 0;
+}
+
+double CCBFileTemplate::getMinInstantiationTime()
+{
+    return mInstantiationCount ? mMinInstantiationTime : 0;
+}
+
+double CCBFileTemplate::getMaxInstantiationTime()
+{
+    return mMaxInstantiationTime;
+}
+
+void CCBFileTemplate::addInstantiation(double dMilliseconds)
+{
+    mInstantiationCount++;
+    mTotalInstantiationTime += dMilliseconds;
+    mMinInstantiationTime = MIN(mMinInstantiationTime, dMilliseconds);
+    mMaxInstantiationTime = MAX(mMaxInstantiationTime, dMilliseconds);
+}
+
+void CCBFileTemplate::resetStatistics()
+{
+    mInstantiationCount = 0;
+    mTotalInstantiationTime = 0;
+    mMinInstantiationTime = DBL_MAX;
+    mMaxInstantiationTime = 0;
+}
+
+/*************************************************************************
+ Implementation of CCBFileCache
+ *************************************************************************/
+
+static CCBFileCache *s_pSharedFileCache = NULL;
+
+CCBFileCache::CCBFileCache()
+: mEnabled(true)
+{
+    mTemplates = new CCDictionary();
+}
+
+CCBFileCache::~CCBFileCache()
+{
+    CC_SAFE_RELEASE(mTemplates);
+}
+
+CCBFileCache* CCBFileCache::sharedFileCache()
+{
+    if (s_pSharedFileCache == NULL)
+    {
+        s_pSharedFileCache = new CCBFileCache();
+    }
+    return s_pSharedFileCache;
+}
+
+void CCBFileCache::purgeFileCache()
+{
+    CC_SAFE_RELEASE_NULL(s_pSharedFileCache);
+}
+
+CCBFileTemplate* CCBFileCache::templateForFile(const char *pFullPath)
+{
+    if (!mEnabled)
+    {
+        return CCBFileTemplate::createWithFile(pFullPath);
+    }
+
+    CCBFileTemplate *pTemplate = (CCBFileTemplate*)mTemplates->objectForKey(pFullPath);
+    if (pTemplate == NULL)
+    {
+        pTemplate = CCBFileTemplate::createWithFile(pFullPath);
+        if (pTemplate)
+        {
+            mTemplates->setObject(pTemplate, pFullPath);
+        }
+    }
+    return pTemplate;
+}
+
+void CCBFileCache::removeTemplateForFile(const char *pFullPath)
+{
+    mTemplates->removeObjectForKey(pFullPath);
+}
+
+void CCBFileCache::removeAllTemplates()
+{
+    mTemplates->removeAllObjects();
+}
+
+bool CCBFileCache::isEnabled()
+{
+    return mEnabled;
+}
+
+void CCBFileCache::setEnabled(bool bEnabled)
+{
+    mEnabled = bEnabled;
+    if (!mEnabled)
+    {
+        removeAllTemplates();
+    }
+}
+
+void CCBFileCache::dumpStatistics()
+{
+    CCLog("CCBFileCache: %u files", mTemplates->count());
+    CCDictElement *pElement = NULL;
+    CCDICT_FOREACH(mTemplates, pElement)
+    {
+        CCBFileTemplate *pTemplate = (CCBFileTemplate*)pElement->getObject();
+        CCLog("  %s: load %.3f ms, %u instances, avg %.3f ms, min %.3f ms, max %.3f ms", pTemplate->getFileName(),
+              pTemplate->getLoadTime(), pTemplate->getInstantiationCount(), pTemplate->getAverageInstantiationTime(),
+              pTemplate->getMinInstantiationTime(), pTemplate->getMaxInstantiationTime());
+    }
+}
+
+NS_CC_EXT_END
@@ -0,0 +1,103 @@
+#ifndef __CCB_CCBFILECACHE_H__
+#define __CCB_CCBFILECACHE_H__
+
+#include <string>
+#include <vector>
+#include "cocos2d.h"
+#include "ExtensionMacros.h"
+
+NS_CC_EXT_BEGIN
+
+class CCData;
+
+/**
+ * @brief The parsed, immutable part of a ccbi file, shared by every instantiation of it.
+ *
+ * Holds the file bytes, the decoded string cache and the offset the node graph starts at, so instantiating the file
+ * again skips the file read, the header and the string decoding. Also keeps timing counters for the file.
+ */
+class CCBFileTemplate : public CCObject
+{
+private:
+    std::string mFileName;
+    CCData *mData;
+    std::vector<std::string> mStringCache;
+    int mBodyOffset;
+    bool mJSControlled;
+    bool mParsed;
+
+    double mLoadTime;
+    unsigned int mInstantiationCount;
+    double mTotalInstantiationTime;
+    double mMinInstantiationTime;
+    double mMaxInstantiationTime;
+
+public:
+    CCBFileTemplate();
+    ~CCBFileTemplate();
+
+    /** Reads the file. Returns NULL if it cannot be read. */
+    static CCBFileTemplate* createWithFile(const char *pFullPath);
+
+    const char* getFileName();
+    CCData* getData();
+
+    /** Whether the header and string cache have been parsed; they are parsed by the first CCBReader reading the file. */
+    bool isParsed();
+    void setParsed(const std::vector<std::string> &stringCache, int nBodyOffset, bool bJSControlled);
+    const std::vector<std::string>& getStringCache();
+    /** Offset of the first byte after the string cache. */
+    int getBodyOffset();
+    bool isJSControlled();
+
+    /** Time spent reading the file and parsing its header and string cache, in milliseconds. */
+    double getLoadTime();
+    void addLoadTime(double dMilliseconds);
+
+    unsigned int getInstantiationCount();
+    /** Times spent building node graphs from the file, in milliseconds. */
+    double getAverageInstantiationTime();
+    double getMinInstantiationTime();
+    double getMaxInstantiationTime();
+    void addInstantiation(double dMilliseconds);
+    void resetStatistics();
+};
+
+/**
+ * @brief Process-wide cache of ccbi file templates, keyed by full path.
+ *
+ * CCBReader::readNodeGraphFromFile and sub ccb files go through it, so a layout instantiated many times (list cells,
+ * popups) is read and its strings decoded once. The node graph itself is still built for every instance, since member
+ * variables, selectors and animation managers are bound per instance.
+ * @since v2.1.4
+ */
+class CCBFileCache : public CCObject
+{
+private:
+    CCDictionary *mTemplates;
+    bool mEnabled;
+
+public:
+    CCBFileCache();
+    ~CCBFileCache();
+
+    static CCBFileCache* sharedFileCache();
+    static void purgeFileCache();
+
+    /** Returns the template for the file, reading it on first use. Returns NULL if the file cannot be read. */
+    CCBFileTemplate* templateForFile(const char *pFullPath);
+
+    void removeTemplateForFile(const char *pFullPath);
+    void removeAllTemplates();
+
+    /** When disabled, every read goes to the file again and nothing is cached. Enabled by default. */
+    bool isEnabled();
+    void setEnabled(bool bEnabled);
+
+    /** Logs the load and instantiation times of every cached file. */
+    void dumpStatistics();
+};
+
+NS_CC_EXT_END
+
+#endif // __CCB_CCBFILECACHE_H__
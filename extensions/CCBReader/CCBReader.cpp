@@ -12,6 +12,7 @@
 #include "CCBSequenceProperty.h"
 #include "CCBKeyframe.h"
 #include "CCBValue.h"
+#include "CCBFileCache.h"
 
 #include <ctype.h>
 
@@ -62,6 +63,8 @@ CCBReader::CCBReader(CCNodeLoaderLibrary * pCCNodeLoaderLibrary, CCBMemberVariab
 , mBytes(NULL)
 , mCurrentByte(-1)
 , mCurrentBit(-1)
+, mTemplate(NULL)
+, mSharedStringCache(NULL)
 , mOwner(NULL)
 , mActionManager(NULL)
 , mActionManagers(NULL)
@@ -85,6 +88,8 @@ CCBReader::CCBReader(CCBReader * pCCBReader)
 , mBytes(NULL)
 , mCurrentByte(-1)
 , mCurrentBit(-1)
+, mTemplate(NULL)
+, mSharedStringCache(NULL)
 , mOwner(NULL)
 , mActionManager(NULL)
 , mActionManagers(NULL)
@@ -117,6 +122,8 @@ CCBReader::CCBReader()
 , mBytes(NULL)
 , mCurrentByte(-1)
 , mCurrentBit(-1)
+, mTemplate(NULL)
+, mSharedStringCache(NULL)
 , mOwner(NULL)
 , mActionManager(NULL)
 , mActionManagers(NULL)
@@ -134,6 +141,7 @@ CCBReader::CCBReader()
 CCBReader::~CCBReader() {
     CC_SAFE_RELEASE_NULL(mOwner);
     CC_SAFE_RELEASE_NULL(mData);
+    CC_SAFE_RELEASE_NULL(mTemplate);
 
     this->mCCNodeLoaderLibrary->release();
 
@@ -246,21 +254,39 @@ CCNode* CCBReader::readNodeGraphFromFile(const char *pCCBFileName, CCObject *pOw
     }
 
     std::string strPath = CCFileUtils::sharedFileUtils()->fullPathForFilename(strCCBFileName.c_str());
-    unsigned long size = 0;
+    CCBFileTemplate *pTemplate = CCBFileCache::sharedFileCache()->templateForFile(strPath.c_str());
+    if (pTemplate == NULL)
+    {
+        CCLOG("CCBReader: unable to read %s", strPath.c_str());
+        return NULL;
+    }
 
-    unsigned char * pBytes = CCFileUtils::sharedFileUtils()->getFileData(strPath.c_str(), "rb", &size);
-    CCData *data = new CCData(pBytes, size);
-    CC_SAFE_DELETE_ARRAY(pBytes);
+    struct cc_timeval start, end;
+    CCTime::gettimeofdayCocos2d(&start, NULL);
+
+    setTemplate(pTemplate);
+    CCNode *ret =  this->readNodeGraphFromData(pTemplate->getData(), pOwner, parentSize);
+
+    CCTime::gettimeofdayCocos2d(&end, NULL);
+    pTemplate->addInstantiation(CCTime::timersubCocos2d(&start, &end));
 
-    CCNode *ret =  this->readNodeGraphFromData(data, pOwner, parentSize);
-    
-    data->release();
-    
     return ret;
 }
 
+void CCBReader::setTemplate(CCBFileTemplate *pTemplate)
+{
+    CC_SAFE_RETAIN(pTemplate);
+    CC_SAFE_RELEASE(mTemplate);
+    mTemplate = pTemplate;
+}
+
 CCNode* CCBReader::readNodeGraphFromData(CCData *pData, CCObject *pOwner, const CCSize &parentSize)
 {
+    if (mTemplate && mTemplate->getData() != pData)
+    {
+        setTemplate(NULL);
+    }
+
     mData = pData;
     CC_SAFE_RETAIN(mData);
     mBytes = mData->getBytes();
@@ -337,16 +363,37 @@ void CCBReader::cleanUpNodeGraph(CCNode *pNode)
 
 CCNode* CCBReader::readFileWithCleanUp(bool bCleanUp, CCDictionary* am)
 {
-    if (! readHeader())
+    if (mTemplate && mTemplate->isParsed())
     {
-        return NULL;
+        // The header and string cache were parsed by an earlier read of the same file.
+        mCurrentByte = mTemplate->getBodyOffset();
+        jsControlled = mTemplate->isJSControlled();
+        mActionManager->jsControlled = jsControlled;
+        mSharedStringCache = &mTemplate->getStringCache();
     }
-    
-    if (! readStringCache())
+    else
     {
-        return NULL;
+        struct cc_timeval start, end;
+        CCTime::gettimeofdayCocos2d(&start, NULL);
+
+        if (! readHeader())
+        {
+            return NULL;
+        }
+
+        if (! readStringCache())
+        {
+            return NULL;
+        }
+
+        if (mTemplate)
+        {
+            mTemplate->setParsed(mStringCache, mCurrentByte, jsControlled);
+            CCTime::gettimeofdayCocos2d(&end, NULL);
+            mTemplate->addLoadTime(CCTime::timersubCocos2d(&start, &end));
+        }
     }
-    
+
     if (! readSequences())
     {
         return NULL;
@@ -369,6 +416,10 @@ CCNode* CCBReader::readFileWithCleanUp(bool bCleanUp, CCDictionary* am)
 bool CCBReader::readStringCache() {
     int numStrings = this->readInt(false);
 
+    this->mStringCache.clear();
+    this->mStringCache.reserve(numStrings);
+    this->mSharedStringCache = NULL;
+
     for(int i = 0; i < numStrings; i++) {
         this->mStringCache.push_back(this->readUTF8());
     }
@@ -424,11 +475,7 @@ std::string CCBReader::readUTF8()
 
     int numBytes = b0 << 8 | b1;
 
-    char* pStr = (char*)malloc(numBytes+1);
-    memcpy(pStr, mBytes+mCurrentByte, numBytes);
-    pStr[numBytes] = '\0';
-    ret = pStr;
-    free(pStr);
+    ret.assign((const char*)(mBytes + mCurrentByte), numBytes);
 
     mCurrentByte += numBytes;
 
@@ -535,9 +582,9 @@ float CCBReader::readFloat() {
     }
 }
 
-std::string CCBReader::readCachedString() {
+const std::string& CCBReader::readCachedString() {
     int n = this->readInt(false);
-    return this->mStringCache[n];
+    return mSharedStringCache ? (*mSharedStringCache)[n] : this->mStringCache[n];
 }
 
 CCNode * CCBReader::readNodeGraph(CCNode * pParent) {
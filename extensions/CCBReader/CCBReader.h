@@ -162,6 +162,7 @@ class CCBSelectorResolver;
 class CCBAnimationManager;
 class CCData;
 class CCBKeyframe;
+class CCBFileTemplate;
 
 /**
  * @brief Parse CCBI file which is generated by CocosBuilder
@@ -176,6 +177,8 @@ private:
     int mCurrentBit;
     
     std::vector<std::string> mStringCache;
+    CCBFileTemplate *mTemplate; // retain
+    const std::vector<std::string> *mSharedStringCache;
     std::set<std::string> mLoadedSpriteSheets;
     
     CCObject *mOwner;
@@ -244,7 +247,7 @@ public:
     bool readBool();
     std::string readUTF8();
     float readFloat();
-    std::string readCachedString();
+    const std::string& readCachedString();
     bool isJSControlled();
             
     
@@ -275,6 +278,7 @@ public:
     CCNode* readFileWithCleanUp(bool bCleanUp, CCDictionary* am);
 
 private:
+    void setTemplate(CCBFileTemplate *pTemplate);
     void cleanUpNodeGraph(CCNode *pNode);
     bool readSequences();
     CCBKeyframe* readKeyframe(int type);
@@ -3,6 +3,7 @@
 #include "CCBMemberVariableAssigner.h"
 #include "CCBAnimationManager.h"
 #include "CCData.h"
+#include "CCBFileCache.h"
 #include "CCNode+CCBRelativePositioning.h"
 
 using namespace std;
@@ -40,7 +41,7 @@ void CCNodeLoader::parseProperties(CCNode * pNode, CCNode * pParent, CCBReader *
     for(int i = 0; i < propertyCount; i++) {
         bool isExtraProp = (i >= numRegularProps);
         int type = pCCBReader->readInt(false);
-        std::string propertyName = pCCBReader->readCachedString();
+        const std::string& propertyName = pCCBReader->readCachedString();
 
         // Check if the property can be set for this platform
         bool setProp = false;
@@ -867,17 +868,23 @@ CCNode * CCNodeLoader::parsePropTypeCCBFile(CCNode * pNode, CCNode * pParent, CC
     
     // Load sub file
     std::string path = CCFileUtils::sharedFileUtils()->fullPathForFilename(ccbFileName.c_str());
-    unsigned long size = 0;
-    unsigned char * pBytes = CCFileUtils::sharedFileUtils()->getFileData(path.c_str(), "rb", &size);
+    CCBFileTemplate *pTemplate = CCBFileCache::sharedFileCache()->templateForFile(path.c_str());
+    if (pTemplate == NULL)
+    {
+        CCLOG("CCNodeLoader: unable to read %s", path.c_str());
+        return NULL;
+    }
+
+    struct cc_timeval start, end;
+    CCTime::gettimeofdayCocos2d(&start, NULL);
 
     CCBReader * ccbReader = new CCBReader(pCCBReader);
     ccbReader->autorelease();
     ccbReader->getAnimationManager()->setRootContainerSize(pParent->getContentSize());
     
-    CCData *data = new CCData(pBytes, size);
-    CC_SAFE_DELETE_ARRAY(pBytes);
-
+    CCData *data = pTemplate->getData();
     data->retain();
+    ccbReader->setTemplate(pTemplate);
     ccbReader->mData = data;
     ccbReader->mBytes = data->getBytes();
     ccbReader->mCurrentByte = 0;
@@ -895,8 +902,6 @@ CCNode * CCNodeLoader::parsePropTypeCCBFile(CCNode * pNode, CCNode * pParent, CC
 //     ccbReader->mOwnerCallbackNodes = pCCBReader->mOwnerCallbackNodes;
 //     ccbReader->mOwnerCallbackNodes->retain();
 
-    data->release();
-    
     CCNode * ccbFileNode = ccbReader->readFileWithCleanUp(false, pCCBReader->getAnimationManagers());
     
     if (ccbFileNode && ccbReader->getAnimationManager()->getAutoPlaySequenceId() != -1)
@@ -904,6 +909,9 @@ CCNode * CCNodeLoader::parsePropTypeCCBFile(CCNode * pNode, CCNode * pParent, CC
         // Auto play animations
         ccbReader->getAnimationManager()->runAnimationsForSequenceIdTweenDuration(ccbReader->getAnimationManager()->getAutoPlaySequenceId(), 0);
     }
+
+    CCTime::gettimeofdayCocos2d(&end, NULL);
+    pTemplate->addInstantiation(CCTime::timersubCocos2d(&start, &end));
     
     return ccbFileNode;
 }
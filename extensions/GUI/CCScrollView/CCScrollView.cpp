@@ -494,6 +494,8 @@ void CCScrollView::beforeDraw()
 {
     if (m_bClippingToBounds)
     {
+        // batched primitives must not be clipped by this view
+        ccDrawFlush();
 		m_bScissorRestored = false;
         CCRect frame = getViewRect();
         if (CCEGLView::sharedOpenGLView()->isScissorEnabled()) {
@@ -523,6 +525,7 @@ void CCScrollView::afterDraw()
 {
     if (m_bClippingToBounds)
     {
+        ccDrawFlush();
         if (m_bScissorRestored) {//restore the parent's scissor rect
             CCEGLView::sharedOpenGLView()->setScissorInPoints(m_tParentScissorRect.origin.x, m_tParentScissorRect.origin.y, m_tParentScissorRect.size.width, m_tParentScissorRect.size.height);
         }
@@ -34,7 +34,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <pthread.h>
 #include <sqlite3.h>
+#include "LocalStorage.h"
+
+USING_NS_CC;
 
 static int _initialized = 0;
 static sqlite3 *_db;
@@ -42,6 +46,32 @@ static sqlite3_stmt *_stmt_select;
 static sqlite3_stmt *_stmt_remove;
 static sqlite3_stmt *_stmt_update;
 
+// transactions
+static int _transaction_open = 0;
+static int _transaction_depth = 0;
+static bool _auto_commit_per_frame = false;
+
+// every use of _db and of the statements holds this mutex, the async writer runs on its own thread
+static pthread_mutex_t _db_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// async write queue
+struct LocalStorageWrite
+{
+	std::string key;
+	std::string value;
+	bool remove;
+};
+
+static pthread_t _writer_thread;
+static int _writer_running = 0;
+static bool _writer_quit = false;
+static std::vector<LocalStorageWrite> _queued_writes;	// waiting for the writer
+static std::vector<LocalStorageWrite> _writing;			// being written by the writer
+static std::string _queued_value;
+static pthread_mutex_t _queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _queue_condition = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t _written_condition = PTHREAD_COND_INITIALIZER;
+
 
 static void localStorageLazyInit();
 static void localStorageCreateTable();
@@ -58,6 +88,167 @@ static void localStorageCreateTable()
 		printf("Error in CREATE TABLE\n");
 }
 
+static void localStorageExec( const char *sql )
+{
+	if( sqlite3_exec(_db, sql, NULL, NULL, NULL) != SQLITE_OK )
+		printf("Error in %s: %s\n", sql, sqlite3_errmsg(_db));
+}
+
+// the following helpers expect _db_mutex to be locked
+
+static void localStorageOpenTransaction()
+{
+	if( ! _transaction_open ) {
+		localStorageExec("BEGIN;");
+		_transaction_open = 1;
+	}
+}
+
+static void localStorageCloseTransaction()
+{
+	if( _transaction_open ) {
+		localStorageExec("COMMIT;");
+		_transaction_open = 0;
+	}
+}
+
+static void localStorageUpdate( const char *key, const char *value )
+{
+	int ok = sqlite3_bind_text(_stmt_update, 1, key, -1, SQLITE_TRANSIENT);
+	ok |= sqlite3_bind_text(_stmt_update, 2, value, -1, SQLITE_TRANSIENT);
+
+	ok |= sqlite3_step(_stmt_update);
+	
+	ok |= sqlite3_reset(_stmt_update);
+	
+	if( ok != SQLITE_OK && ok != SQLITE_DONE)
+		printf("Error in localStorage.setItem()\n");
+}
+
+static void localStorageRemove( const char *key )
+{
+	int ok = sqlite3_bind_text(_stmt_remove, 1, key, -1, SQLITE_TRANSIENT);
+	
+	ok |= sqlite3_step(_stmt_remove);
+	
+	ok |= sqlite3_reset(_stmt_remove);
+
+	if( ok != SQLITE_OK && ok != SQLITE_DONE)
+		printf("Error in localStorage.removeItem()\n");
+}
+
+static const char* localStorageSelect( const char *key )
+{
+	int ok = sqlite3_reset(_stmt_select);
+
+	ok |= sqlite3_bind_text(_stmt_select, 1, key, -1, SQLITE_TRANSIENT);
+	ok |= sqlite3_step(_stmt_select);
+	const unsigned char *ret = sqlite3_column_text(_stmt_select, 0);
+	
+
+	if( ok != SQLITE_OK && ok != SQLITE_DONE && ok != SQLITE_ROW)
+		printf("Error in localStorage.getItem()\n");
+
+	return (const char*)ret;
+}
+
+// writes outside of an explicit transaction join the per frame transaction
+static void localStorageWillWrite()
+{
+	if( _auto_commit_per_frame )
+		localStorageOpenTransaction();
+}
+
+/** Commits the per frame transaction */
+class LocalStorageFrameCommitter : public CCObject
+{
+public:
+	virtual void update(float dt)
+	{
+		pthread_mutex_lock(&_db_mutex);
+		if( _transaction_depth == 0 )
+			localStorageCloseTransaction();
+		pthread_mutex_unlock(&_db_mutex);
+	}
+};
+
+static LocalStorageFrameCommitter *_frame_committer = NULL;
+
+// async writes
+
+static void* localStorageWriter( void *data )
+{
+	pthread_mutex_lock(&_queue_mutex);
+	while( true ) {
+		while( _queued_writes.empty() && ! _writer_quit )
+			pthread_cond_wait(&_queue_condition, &_queue_mutex);
+
+		if( _queued_writes.empty() )
+			break;
+
+		_writing.swap(_queued_writes);
+		pthread_mutex_unlock(&_queue_mutex);
+
+		// everything queued so far goes in one commit, unless the main thread has a transaction open
+		pthread_mutex_lock(&_db_mutex);
+		bool own_transaction = ! _transaction_open;
+		if( own_transaction )
+			localStorageExec("BEGIN;");
+		for( size_t i = 0; i < _writing.size(); i++ ) {
+			if( _writing[i].remove )
+				localStorageRemove(_writing[i].key.c_str());
+			else
+				localStorageUpdate(_writing[i].key.c_str(), _writing[i].value.c_str());
+		}
+		if( own_transaction )
+			localStorageExec("COMMIT;");
+		pthread_mutex_unlock(&_db_mutex);
+
+		pthread_mutex_lock(&_queue_mutex);
+		_writing.clear();
+		pthread_cond_broadcast(&_written_condition);
+	}
+	pthread_mutex_unlock(&_queue_mutex);
+
+	return NULL;
+}
+
+static void localStorageQueueWrite( const char *key, const char *value, bool remove )
+{
+	assert( _initialized );
+
+	LocalStorageWrite write;
+	write.key = key;
+	write.value = value ? value : "";
+	write.remove = remove;
+
+	pthread_mutex_lock(&_queue_mutex);
+	if( ! _writer_running ) {
+		_writer_quit = false;
+		_writer_running = ( pthread_create(&_writer_thread, NULL, localStorageWriter, NULL) == 0 );
+	}
+	_queued_writes.push_back(write);
+	pthread_cond_signal(&_queue_condition);
+	pthread_mutex_unlock(&_queue_mutex);
+
+	if( ! _writer_running )
+		localStorageFlushAsync();
+}
+
+// looks for the most recent queued write of key. Expects _queue_mutex to be locked
+static const LocalStorageWrite* localStorageQueuedWrite( const std::string& key )
+{
+	for( size_t i = _queued_writes.size(); i > 0; i-- ) {
+		if( _queued_writes[i - 1].key == key )
+			return &_queued_writes[i - 1];
+	}
+	for( size_t i = _writing.size(); i > 0; i-- ) {
+		if( _writing[i - 1].key == key )
+			return &_writing[i - 1];
+	}
+	return NULL;
+}
+
 void localStorageInit( const char *fullpath)
 {
 	if( ! _initialized ) {
@@ -88,6 +279,8 @@ void localStorageInit( const char *fullpath)
 			// report error
 		}
 		
+		_transaction_open = 0;
+		_transaction_depth = 0;
 		_initialized = 1;
 	}
 }
@@ -95,6 +288,21 @@ void localStorageInit( const char *fullpath)
 void localStorageFree()
 {
 	if( _initialized ) {
+		localStorageSetAutoCommitPerFrame(false);
+
+		pthread_mutex_lock(&_queue_mutex);
+		bool join = _writer_running;
+		_writer_quit = true;
+		_writer_running = 0;
+		pthread_cond_signal(&_queue_condition);
+		pthread_mutex_unlock(&_queue_mutex);
+		if( join )
+			pthread_join(_writer_thread, NULL);
+
+		// an unbalanced localStorageBeginTransaction() still gets its writes stored
+		localStorageCloseTransaction();
+		_transaction_depth = 0;
+
 		sqlite3_finalize(_stmt_select);
 		sqlite3_finalize(_stmt_remove);
 		sqlite3_finalize(_stmt_update);		
@@ -109,16 +317,14 @@ void localStorageFree()
 void localStorageSetItem( const char *key, const char *value)
 {
 	assert( _initialized );
-	
-	int ok = sqlite3_bind_text(_stmt_update, 1, key, -1, SQLITE_TRANSIENT);
-	ok |= sqlite3_bind_text(_stmt_update, 2, value, -1, SQLITE_TRANSIENT);
 
-	ok |= sqlite3_step(_stmt_update);
-	
-	ok |= sqlite3_reset(_stmt_update);
-	
-	if( ok != SQLITE_OK && ok != SQLITE_DONE)
-		printf("Error in localStorage.setItem()\n");
+	// a queued write of the same key must not overwrite this one later
+	localStorageFlushAsync();
+
+	pthread_mutex_lock(&_db_mutex);
+	localStorageWillWrite();
+	localStorageUpdate(key, value);
+	pthread_mutex_unlock(&_db_mutex);
 }
 
 /** gets an item from the LS */
@@ -126,17 +332,24 @@ const char* localStorageGetItem( const char *key )
 {
 	assert( _initialized );
 
-	int ok = sqlite3_reset(_stmt_select);
-
-	ok |= sqlite3_bind_text(_stmt_select, 1, key, -1, SQLITE_TRANSIENT);
-	ok |= sqlite3_step(_stmt_select);
-	const unsigned char *ret = sqlite3_column_text(_stmt_select, 0);
-	
+	pthread_mutex_lock(&_queue_mutex);
+	const LocalStorageWrite *queued = localStorageQueuedWrite(key);
+	if( queued ) {
+		const char *ret = NULL;
+		if( ! queued->remove ) {
+			_queued_value = queued->value;
+			ret = _queued_value.c_str();
+		}
+		pthread_mutex_unlock(&_queue_mutex);
+		return ret;
+	}
+	pthread_mutex_unlock(&_queue_mutex);
 
-	if( ok != SQLITE_OK && ok != SQLITE_DONE && ok != SQLITE_ROW)
-		printf("Error in localStorage.getItem()\n");
+	pthread_mutex_lock(&_db_mutex);
+	const char *ret = localStorageSelect(key);
+	pthread_mutex_unlock(&_db_mutex);
 
-	return (const char*)ret;
+	return ret;
 }
 
 /** removes an item from the LS */
@@ -144,14 +357,171 @@ void localStorageRemoveItem( const char *key )
 {
 	assert( _initialized );
 
-	int ok = sqlite3_bind_text(_stmt_remove, 1, key, -1, SQLITE_TRANSIENT);
-	
-	ok |= sqlite3_step(_stmt_remove);
-	
-	ok |= sqlite3_reset(_stmt_remove);
+	localStorageFlushAsync();
 
-	if( ok != SQLITE_OK && ok != SQLITE_DONE)
-		printf("Error in localStorage.removeItem()\n");
+	pthread_mutex_lock(&_db_mutex);
+	localStorageWillWrite();
+	localStorageRemove(key);
+	pthread_mutex_unlock(&_db_mutex);
+}
+
+bool localStorageSetJournalMode( const char *mode )
+{
+	assert( _initialized );
+
+	std::string sql = std::string("PRAGMA journal_mode=") + mode + ";";
+	bool ok = false;
+
+	pthread_mutex_lock(&_db_mutex);
+	// the journal mode can't change inside a transaction
+	if( _transaction_depth == 0 )
+		localStorageCloseTransaction();
+
+	sqlite3_stmt *stmt;
+	if( sqlite3_prepare_v2(_db, sql.c_str(), -1, &stmt, NULL) == SQLITE_OK ) {
+		// the pragma returns the mode in use afterwards
+		if( sqlite3_step(stmt) == SQLITE_ROW ) {
+			const char *current = (const char*)sqlite3_column_text(stmt, 0);
+			ok = current && sqlite3_stricmp(current, mode) == 0;
+		}
+		sqlite3_finalize(stmt);
+	}
+	pthread_mutex_unlock(&_db_mutex);
+
+	if( ! ok )
+		printf("Error in localStorage.setJournalMode(%s)\n", mode);
+
+	return ok;
+}
+
+void localStorageSetSynchronous( int level )
+{
+	assert( _initialized );
+
+	char sql[32];
+	sprintf(sql, "PRAGMA synchronous=%d;", level);
+
+	pthread_mutex_lock(&_db_mutex);
+	localStorageExec(sql);
+	pthread_mutex_unlock(&_db_mutex);
+}
+
+void localStorageBeginTransaction()
+{
+	assert( _initialized );
+
+	pthread_mutex_lock(&_db_mutex);
+	localStorageOpenTransaction();
+	_transaction_depth++;
+	pthread_mutex_unlock(&_db_mutex);
+}
+
+void localStorageCommitTransaction()
+{
+	assert( _initialized );
+
+	pthread_mutex_lock(&_db_mutex);
+	assert( _transaction_depth > 0 );
+	if( _transaction_depth > 0 && --_transaction_depth == 0 )
+		localStorageCloseTransaction();
+	pthread_mutex_unlock(&_db_mutex);
+}
+
+void localStorageSetAutoCommitPerFrame( bool enabled )
+{
+	assert( _initialized );
+
+	if( enabled == _auto_commit_per_frame )
+		return;
+
+	CCScheduler *scheduler = CCDirector::sharedDirector()->getScheduler();
+	if( enabled ) {
+		_frame_committer = new LocalStorageFrameCommitter();
+		// after the other update callbacks of the frame
+		scheduler->scheduleUpdateForTarget(_frame_committer, INT_MAX, false);
+	}
+	else {
+		scheduler->unscheduleUpdateForTarget(_frame_committer);
+		CC_SAFE_RELEASE_NULL(_frame_committer);
+	}
+
+	pthread_mutex_lock(&_db_mutex);
+	_auto_commit_per_frame = enabled;
+	if( ! enabled && _transaction_depth == 0 )
+		localStorageCloseTransaction();
+	pthread_mutex_unlock(&_db_mutex);
+}
+
+void localStorageSetItems( const std::map<std::string, std::string>& items )
+{
+	assert( _initialized );
+
+	localStorageFlushAsync();
+
+	pthread_mutex_lock(&_db_mutex);
+	bool own_transaction = ! _transaction_open && ! _auto_commit_per_frame;
+	localStorageOpenTransaction();
+	for( std::map<std::string, std::string>::const_iterator it = items.begin(); it != items.end(); ++it )
+		localStorageUpdate(it->first.c_str(), it->second.c_str());
+	if( own_transaction )
+		localStorageCloseTransaction();
+	pthread_mutex_unlock(&_db_mutex);
+}
+
+void localStorageGetItems( const std::vector<std::string>& keys, std::map<std::string, std::string>& items )
+{
+	assert( _initialized );
+
+	pthread_mutex_lock(&_queue_mutex);
+	pthread_mutex_lock(&_db_mutex);
+	for( size_t i = 0; i < keys.size(); i++ ) {
+		const LocalStorageWrite *queued = localStorageQueuedWrite(keys[i]);
+		if( queued ) {
+			if( ! queued->remove )
+				items[keys[i]] = queued->value;
+			continue;
+		}
+
+		const char *value = localStorageSelect(keys[i].c_str());
+		if( value )
+			items[keys[i]] = value;
+	}
+	sqlite3_reset(_stmt_select);
+	pthread_mutex_unlock(&_db_mutex);
+	pthread_mutex_unlock(&_queue_mutex);
+}
+
+void localStorageSetItemAsync( const char *key, const char *value )
+{
+	localStorageQueueWrite(key, value, false);
+}
+
+void localStorageRemoveItemAsync( const char *key )
+{
+	localStorageQueueWrite(key, NULL, true);
+}
+
+void localStorageFlushAsync()
+{
+	pthread_mutex_lock(&_queue_mutex);
+	if( _writer_running ) {
+		while( ! _queued_writes.empty() || ! _writing.empty() )
+			pthread_cond_wait(&_written_condition, &_queue_mutex);
+	}
+	else if( ! _queued_writes.empty() ) {
+		// no writer thread, write on the calling thread
+		pthread_mutex_lock(&_db_mutex);
+		localStorageWillWrite();
+		for( size_t i = 0; i < _queued_writes.size(); i++ ) {
+			if( _queued_writes[i].remove )
+				localStorageRemove(_queued_writes[i].key.c_str());
+			else
+				localStorageUpdate(_queued_writes[i].key.c_str(), _queued_writes[i].value.c_str());
+		}
+		pthread_mutex_unlock(&_db_mutex);
+		_queued_writes.clear();
+	}
+	pthread_mutex_unlock(&_queue_mutex);
 }
 
 #endif // #if (CC_TARGET_PLATFORM != CC_PLATFORM_ANDROID)
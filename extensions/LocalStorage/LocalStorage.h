@@ -32,6 +32,9 @@ THE SOFTWARE.
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <map>
+#include <string>
+#include <vector>
 
 /** Initializes the database. If path is null, it will create an in-memory DB */
 void localStorageInit( const char *fullpath);
@@ -48,4 +51,66 @@ const char* localStorageGetItem( const char *key );
 /** removes an item from the LS */
 void localStorageRemoveItem( const char *key );
 
+/** Sets the sqlite journal mode of the DB: "WAL", "DELETE", "TRUNCATE", "MEMORY"...
+ In WAL mode a commit appends to a log instead of rewriting database pages, which
+ makes small commits much cheaper on slow storage.
+ Returns false if the DB refused the mode (in-memory DBs only support "MEMORY").
+ @since v2.1.4
+ */
+bool localStorageSetJournalMode( const char *mode );
+
+/** Sets the sqlite synchronous level: 0 (OFF), 1 (NORMAL) or 2 (FULL, the default).
+ NORMAL survives application crashes but may lose the last commits on power loss;
+ it is the usual setting together with WAL.
+ @since v2.1.4
+ */
+void localStorageSetSynchronous( int level );
+
+/** Starts a transaction. The writes up to the matching localStorageCommitTransaction()
+ are stored with a single commit instead of one commit each.
+ Transactions nest: only the outermost commit writes to disk.
+ @since v2.1.4
+ */
+void localStorageBeginTransaction();
+
+/** Commits the transaction started with localStorageBeginTransaction()
+ @since v2.1.4
+ */
+void localStorageCommitTransaction();
+
+/** When enabled, the writes done outside of an explicit transaction are collected
+ and committed once per frame by the scheduler. Disabling it commits the pending writes.
+ Default: false
+ @since v2.1.4
+ */
+void localStorageSetAutoCommitPerFrame( bool enabled );
+
+/** sets several items in the LS with a single commit
+ @since v2.1.4
+ */
+void localStorageSetItems( const std::map<std::string, std::string>& items );
+
+/** gets several items from the LS. Keys that are not in the LS are not added to items
+ @since v2.1.4
+ */
+void localStorageGetItems( const std::vector<std::string>& keys, std::map<std::string, std::string>& items );
+
+/** Queues an item to be set by a background thread. The thread writes everything
+ queued since its last run with a single commit.
+ localStorageGetItem() sees the queued value right away.
+ @note On Android the item is set right away on the calling thread.
+ @since v2.1.4
+ */
+void localStorageSetItemAsync( const char *key, const char *value );
+
+/** Queues an item to be removed by the background thread
+ @since v2.1.4
+ */
+void localStorageRemoveItemAsync( const char *key );
+
+/** Blocks until the queued writes are in the DB
+ @since v2.1.4
+ */
+void localStorageFlushAsync();
+
 #endif // __JSB_LOCALSTORAGE_H
@@ -38,9 +38,54 @@
 #include <string>
 #include "jni.h"
 #include "jni/JniHelper.h"
+#include "LocalStorage.h"
 
 USING_NS_CC;
 static int _initialized = 0;
+static int _transaction_depth = 0;
+static bool _frame_transaction_open = false;
+static bool _auto_commit_per_frame = false;
+
+static void localStorageCallVoid( const char *method )
+{
+    JniMethodInfo t;
+
+    if (JniHelper::getStaticMethodInfo(t, "org/cocos2dx/lib/Cocos2dxLocalStorage", method, "()V")) {
+        t.env->CallStaticVoidMethod(t.classID, t.methodID);
+        t.env->DeleteLocalRef(t.classID);
+    }
+}
+
+// writes outside of an explicit transaction join the per frame transaction
+static void localStorageWillWrite()
+{
+    if (_auto_commit_per_frame && _transaction_depth == 0 && !_frame_transaction_open) {
+        localStorageCallVoid("beginTransaction");
+        _frame_transaction_open = true;
+    }
+}
+
+static void localStorageCommitFrameTransaction()
+{
+    if (_frame_transaction_open) {
+        localStorageCallVoid("commitTransaction");
+        _frame_transaction_open = false;
+    }
+}
+
+/** Commits the per frame transaction */
+class LocalStorageFrameCommitter : public CCObject
+{
+public:
+    virtual void update(float dt)
+    {
+        if (_transaction_depth == 0) {
+            localStorageCommitFrameTransaction();
+        }
+    }
+};
+
+static LocalStorageFrameCommitter *_frame_committer = NULL;
 
 static void splitFilename (std::string& str)
 {
@@ -79,6 +124,10 @@ void localStorageInit( const char *fullpath)
 void localStorageFree()
 {
 	if( _initialized ) {
+		localStorageSetAutoCommitPerFrame(false);
+		while (_transaction_depth > 0) {
+			localStorageCommitTransaction();
+		}
 		
 		JniMethodInfo t;
         
@@ -96,6 +145,7 @@ void localStorageFree()
 void localStorageSetItem( const char *key, const char *value)
 {
 	assert( _initialized );
+	localStorageWillWrite();
 	
     JniMethodInfo t;
 
@@ -130,6 +180,7 @@ const char* localStorageGetItem( const char *key )
 void localStorageRemoveItem( const char *key )
 {
 	assert( _initialized );
+	localStorageWillWrite();
     JniMethodInfo t;
 
     if (JniHelper::getStaticMethodInfo(t, "org/cocos2dx/lib/Cocos2dxLocalStorage", "removeItem", "(Ljava/lang/String;)V")) {
@@ -141,4 +192,108 @@ void localStorageRemoveItem( const char *key )
 
 }
 
+bool localStorageSetJournalMode( const char *mode )
+{
+	assert( _initialized );
+    JniMethodInfo t;
+    jboolean ret = false;
+
+    // the journal mode can't change inside a transaction
+    if (_transaction_depth == 0) {
+        localStorageCommitFrameTransaction();
+    }
+
+    if (JniHelper::getStaticMethodInfo(t, "org/cocos2dx/lib/Cocos2dxLocalStorage", "setJournalMode", "(Ljava/lang/String;)Z")) {
+        jstring jmode = t.env->NewStringUTF(mode);
+        ret = t.env->CallStaticBooleanMethod(t.classID, t.methodID, jmode);
+        t.env->DeleteLocalRef(jmode);
+        t.env->DeleteLocalRef(t.classID);
+    }
+    return ret;
+}
+
+void localStorageSetSynchronous( int level )
+{
+	assert( _initialized );
+    JniMethodInfo t;
+
+    if (JniHelper::getStaticMethodInfo(t, "org/cocos2dx/lib/Cocos2dxLocalStorage", "setSynchronous", "(I)V")) {
+        t.env->CallStaticVoidMethod(t.classID, t.methodID, (jint)level);
+        t.env->DeleteLocalRef(t.classID);
+    }
+}
+
+void localStorageBeginTransaction()
+{
+	assert( _initialized );
+    // SQLiteDatabase transactions nest, the outermost one commits
+    localStorageCallVoid("beginTransaction");
+    _transaction_depth++;
+}
+
+void localStorageCommitTransaction()
+{
+	assert( _initialized && _transaction_depth > 0 );
+    if (_transaction_depth > 0) {
+        localStorageCallVoid("commitTransaction");
+        _transaction_depth--;
+    }
+}
+
+void localStorageSetAutoCommitPerFrame( bool enabled )
+{
+	assert( _initialized );
+    if (enabled == _auto_commit_per_frame) {
+        return;
+    }
+
+    CCScheduler *scheduler = CCDirector::sharedDirector()->getScheduler();
+    if (enabled) {
+        _frame_committer = new LocalStorageFrameCommitter();
+        // after the other update callbacks of the frame
+        scheduler->scheduleUpdateForTarget(_frame_committer, INT_MAX, false);
+    }
+    else {
+        scheduler->unscheduleUpdateForTarget(_frame_committer);
+        CC_SAFE_RELEASE_NULL(_frame_committer);
+        localStorageCommitFrameTransaction();
+    }
+    _auto_commit_per_frame = enabled;
+}
+
+void localStorageSetItems( const std::map<std::string, std::string>& items )
+{
+    localStorageBeginTransaction();
+    for (std::map<std::string, std::string>::const_iterator it = items.begin(); it != items.end(); ++it) {
+        localStorageSetItem(it->first.c_str(), it->second.c_str());
+    }
+    localStorageCommitTransaction();
+}
+
+void localStorageGetItems( const std::vector<std::string>& keys, std::map<std::string, std::string>& items )
+{
+    for (size_t i = 0; i < keys.size(); i++) {
+        const char *value = localStorageGetItem(keys[i].c_str());
+        // Cocos2dxLocalStorage.getItem() returns "" for the keys it doesn't have
+        if (value && value[0]) {
+            items[keys[i]] = value;
+        }
+    }
+}
+
+/** JNI can't find the cocos2d-x classes from a background thread, the async writes are done right away */
+void localStorageSetItemAsync( const char *key, const char *value )
+{
+    localStorageSetItem(key, value);
+}
+
+void localStorageRemoveItemAsync( const char *key )
+{
+    localStorageRemoveItem(key);
+}
+
+void localStorageFlushAsync()
+{
+}
+
 #endif // #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
@@ -3,7 +3,8 @@
 
 #include "ExtensionMacros.h"
 
-#include "CCBReader/CCBFileLoader.h"
+#include "CCBReader/CCBFileLoader.h"
+#include "CCBReader/CCBFileCache.h"
 #include "CCBReader/CCBMemberVariableAssigner.h"
 #include "CCBReader/CCBReader.h"
 #include "CCBReader/CCBSelectorResolver.h"
@@ -44,7 +45,8 @@
 // Physics integration
 #if CC_ENABLE_CHIPMUNK_INTEGRATION || CC_ENABLE_BOX2D_INTEGRATION
 #include "physics_nodes/CCPhysicsDebugNode.h"
-#include "physics_nodes/CCPhysicsSprite.h"
+#include "physics_nodes/CCPhysicsSprite.h"
+#include "physics_nodes/CCPhysicsWorldNode.h"
 #endif
 
 #include "spine/spine-cocos2dx.h"
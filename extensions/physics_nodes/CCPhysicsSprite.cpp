@@ -21,6 +21,7 @@
  */
 
 #include "CCPhysicsSprite.h"
+#include "CCPhysicsWorldNode.h"
 #include "support/CCPointExtension.h"
 
 #if CC_ENABLE_CHIPMUNK_INTEGRATION
@@ -39,8 +40,19 @@ CCPhysicsSprite::CCPhysicsSprite()
 , m_pB2Body(NULL)
 , m_fPTMRatio(0.0f)
 #endif
+, m_pPhysicsWorldNode(NULL)
+, m_fPreviousBodyAngle(0.0f)
+, m_fBodyAngle(0.0f)
 {}
 
+CCPhysicsSprite::~CCPhysicsSprite()
+{
+    if (m_pPhysicsWorldNode)
+    {
+        m_pPhysicsWorldNode->removePhysicsSprite(this);
+    }
+}
+
 CCPhysicsSprite* CCPhysicsSprite::create()
 {
     CCPhysicsSprite* pRet = new CCPhysicsSprite();
@@ -189,6 +201,39 @@ float CCPhysicsSprite::getPositionY()
     return m_obPosition.y;
 }
 
+CCPhysicsWorldNode* CCPhysicsSprite::getPhysicsWorldNode() const
+{
+    return m_pPhysicsWorldNode;
+}
+
+void CCPhysicsSprite::updatePosFromPhysics()
+{
+    if (m_pPhysicsWorldNode)
+    {
+        // the body may be stepped on another thread: use the state of the last step
+        m_obPosition = m_obBodyPosition;
+    }
+    else
+    {
+        float angle;
+        getBodyState(m_obPosition, angle);
+    }
+}
+
+void CCPhysicsSprite::getDrawnBodyState(CCPoint& position, float& angle) const
+{
+    if (m_pPhysicsWorldNode)
+    {
+        float alpha = m_pPhysicsWorldNode->getInterpolationAlpha();
+        position = ccpLerp(m_obPreviousBodyPosition, m_obBodyPosition, alpha);
+        angle = m_fPreviousBodyAngle + (m_fBodyAngle - m_fPreviousBodyAngle) * alpha;
+    }
+    else
+    {
+        getBodyState(position, angle);
+    }
+}
+
 #if CC_ENABLE_CHIPMUNK_INTEGRATION
 
 cpBody* CCPhysicsSprite::getCPBody() const
@@ -199,23 +244,40 @@ cpBody* CCPhysicsSprite::getCPBody() const
 void CCPhysicsSprite::setCPBody(cpBody *pBody)
 {
     m_pCPBody = pBody;
+    if (m_pPhysicsWorldNode)
+    {
+        m_pPhysicsWorldNode->resetPhysicsSprite(this);
+    }
 }
 
-void CCPhysicsSprite::updatePosFromPhysics()
+void CCPhysicsSprite::getBodyState(CCPoint& position, float& angle) const
 {
     cpVect cpPos = cpBodyGetPos(m_pCPBody);
-    m_obPosition = ccp(cpPos.x, cpPos.y);
+    position = ccp(cpPos.x, cpPos.y);
+    angle = cpBodyGetAngle(m_pCPBody);
 }
 
 void CCPhysicsSprite::setPosition(const CCPoint &pos)
 {
+    if (m_pPhysicsWorldNode)
+    {
+        m_pPhysicsWorldNode->waitForStep();
+    }
     cpVect cpPos = cpv(pos.x, pos.y);
     cpBodySetPos(m_pCPBody, cpPos);
+    if (m_pPhysicsWorldNode)
+    {
+        m_pPhysicsWorldNode->resetPhysicsSprite(this);
+    }
 }
 
 float CCPhysicsSprite::getRotation()
 {
-    return (m_bIgnoreBodyRotation ? CCSprite::getRotation() : -CC_RADIANS_TO_DEGREES(cpBodyGetAngle(m_pCPBody)));
+    if (m_bIgnoreBodyRotation)
+    {
+        return CCSprite::getRotation();
+    }
+    return -CC_RADIANS_TO_DEGREES(m_pPhysicsWorldNode ? m_fBodyAngle : cpBodyGetAngle(m_pCPBody));
 }
 
 void CCPhysicsSprite::setRotation(float fRotation)
@@ -226,7 +288,15 @@ void CCPhysicsSprite::setRotation(float fRotation)
     }
     else
     {
+        if (m_pPhysicsWorldNode)
+        {
+            m_pPhysicsWorldNode->waitForStep();
+        }
         cpBodySetAngle(m_pCPBody, -CC_DEGREES_TO_RADIANS(fRotation));
+        if (m_pPhysicsWorldNode)
+        {
+            m_pPhysicsWorldNode->resetPhysicsSprite(this);
+        }
     }
 }
 
@@ -236,9 +306,13 @@ CCAffineTransform CCPhysicsSprite::nodeToParentTransform()
     // Although scale is not used by physics engines, it is calculated just in case
 	// the sprite is animated (scaled up/down) using actions.
 	// For more info see: http://www.cocos2d-iphone.org/forum/topic/68990
-	cpVect rot = (m_bIgnoreBodyRotation ? cpvforangle(-CC_DEGREES_TO_RADIANS(m_fRotationX)) : m_pCPBody->rot);
-	float x = m_pCPBody->p.x + rot.x * -m_obAnchorPointInPoints.x * m_fScaleX - rot.y * -m_obAnchorPointInPoints.y * m_fScaleY;
-	float y = m_pCPBody->p.y + rot.y * -m_obAnchorPointInPoints.x * m_fScaleX + rot.x * -m_obAnchorPointInPoints.y * m_fScaleY;
+	CCPoint pos;
+	float angle;
+	getDrawnBodyState(pos, angle);
+	cpVect rot = (m_bIgnoreBodyRotation ? cpvforangle(-CC_DEGREES_TO_RADIANS(m_fRotationX)) :
+	              (m_pPhysicsWorldNode ? cpvforangle(angle) : m_pCPBody->rot));
+	float x = pos.x + rot.x * -m_obAnchorPointInPoints.x * m_fScaleX - rot.y * -m_obAnchorPointInPoints.y * m_fScaleY;
+	float y = pos.y + rot.y * -m_obAnchorPointInPoints.x * m_fScaleX + rot.x * -m_obAnchorPointInPoints.y * m_fScaleY;
 	
 	if (m_bIgnoreAnchorPointForPosition)
     {
@@ -261,6 +335,10 @@ b2Body* CCPhysicsSprite::getB2Body() const
 void CCPhysicsSprite::setB2Body(b2Body *pBody)
 {
     m_pB2Body = pBody;
+    if (m_pPhysicsWorldNode)
+    {
+        m_pPhysicsWorldNode->resetPhysicsSprite(this);
+    }
 }
 
 float CCPhysicsSprite::getPTMRatio() const
@@ -271,27 +349,43 @@ float CCPhysicsSprite::getPTMRatio() const
 void CCPhysicsSprite::setPTMRatio(float fRatio)
 {
     m_fPTMRatio = fRatio;
+    if (m_pPhysicsWorldNode)
+    {
+        m_pPhysicsWorldNode->resetPhysicsSprite(this);
+    }
 }
 
 // Override the setters and getters to always reflect the body's properties.
-void CCPhysicsSprite::updatePosFromPhysics()
+void CCPhysicsSprite::getBodyState(CCPoint& position, float& angle) const
 {
     b2Vec2 pos = m_pB2Body->GetPosition();
     float x = pos.x * m_fPTMRatio;
     float y = pos.y * m_fPTMRatio;
-    m_obPosition = ccp(x,y);
+    position = ccp(x,y);
+    angle = m_pB2Body->GetAngle();
 }
 
 void CCPhysicsSprite::setPosition(const CCPoint &pos)
 {
+    if (m_pPhysicsWorldNode)
+    {
+        m_pPhysicsWorldNode->waitForStep();
+    }
     float angle = m_pB2Body->GetAngle();
     m_pB2Body->SetTransform(b2Vec2(pos.x / m_fPTMRatio, pos.y / m_fPTMRatio), angle);
+    if (m_pPhysicsWorldNode)
+    {
+        m_pPhysicsWorldNode->resetPhysicsSprite(this);
+    }
 }
 
 float CCPhysicsSprite::getRotation()
 {
-    return (m_bIgnoreBodyRotation ? CCSprite::getRotation() :
-            CC_RADIANS_TO_DEGREES(m_pB2Body->GetAngle()));
+    if (m_bIgnoreBodyRotation)
+    {
+        return CCSprite::getRotation();
+    }
+    return CC_RADIANS_TO_DEGREES(m_pPhysicsWorldNode ? m_fBodyAngle : m_pB2Body->GetAngle());
 }
 
 void CCPhysicsSprite::setRotation(float fRotation)
@@ -302,19 +396,29 @@ void CCPhysicsSprite::setRotation(float fRotation)
     }
     else
     {
+        if (m_pPhysicsWorldNode)
+        {
+            m_pPhysicsWorldNode->waitForStep();
+        }
         b2Vec2 p = m_pB2Body->GetPosition();
         float radians = CC_DEGREES_TO_RADIANS(fRotation);
         m_pB2Body->SetTransform(p, radians);
+        if (m_pPhysicsWorldNode)
+        {
+            m_pPhysicsWorldNode->resetPhysicsSprite(this);
+        }
     }
 }
 
 // returns the transform matrix according the Box2D Body values
 CCAffineTransform CCPhysicsSprite::nodeToParentTransform()
 {
-    b2Vec2 pos  = m_pB2Body->GetPosition();
+    CCPoint pos;
+    float radians;
+    getDrawnBodyState(pos, radians);
 	
-	float x = pos.x * m_fPTMRatio;
-	float y = pos.y * m_fPTMRatio;
+	float x = pos.x;
+	float y = pos.y;
 	
 	if (m_bIgnoreAnchorPointForPosition)
     {
@@ -323,7 +427,6 @@ CCAffineTransform CCPhysicsSprite::nodeToParentTransform()
 	}
 	
 	// Make matrix
-	float radians = m_pB2Body->GetAngle();
 	float c = cosf(radians);
 	float s = sinf(radians);
 	
@@ -34,6 +34,9 @@ class b2Body;
 #endif
 
 NS_CC_EXT_BEGIN
+
+class CCPhysicsWorldNode;
+
 /** A CCSprite subclass that is bound to a physics body.
  It works with:
  - Chipmunk: Preprocessor macro CC_ENABLE_CHIPMUNK_INTEGRATION should be defined
@@ -45,6 +48,7 @@ NS_CC_EXT_BEGIN
  - Position and rotation are going to updated from the physics body
  - If you update the rotation or position manually, the physics body will be updated
  - You can't enble both Chipmunk support and Box2d support at the same time. Only one can be enabled at compile time
+ - Added to a CCPhysicsWorldNode, it draws the state of the body interpolated between the last two steps of the world
  */
 class CCPhysicsSprite : public CCSprite
 {
@@ -59,8 +63,17 @@ protected:
     // Pixels to Meters ratio
     float   m_fPTMRatio;
 #endif // CC_ENABLE_CHIPMUNK_INTEGRATION
+
+    // weak ref, set by CCPhysicsWorldNode::addPhysicsSprite
+    CCPhysicsWorldNode *m_pPhysicsWorldNode;
+    // states of the body before and after the last step of the world, in points and radians
+    CCPoint m_obPreviousBodyPosition;
+    float   m_fPreviousBodyAngle;
+    CCPoint m_obBodyPosition;
+    float   m_fBodyAngle;
 public:
     CCPhysicsSprite();
+    virtual ~CCPhysicsSprite();
 
     static CCPhysicsSprite* create();
     /** Creates an sprite with a texture.
@@ -123,8 +136,19 @@ public:
     void setPTMRatio(float fPTMRatio);
 #endif // CC_ENABLE_BOX2D_INTEGRATION
 
+    /** The world node interpolating the sprite, NULL if none.
+     @since v2.1.4
+     */
+    CCPhysicsWorldNode* getPhysicsWorldNode() const;
+
 protected:
+    friend class CCPhysicsWorldNode;
+
     void updatePosFromPhysics();
+    // reads the position of the body, in points, and its angle
+    void getBodyState(CCPoint& position, float& angle) const;
+    // the state to draw: the body, or its interpolated state when in a world node
+    void getDrawnBodyState(CCPoint& position, float& angle) const;
 };
 
 NS_CC_EXT_END
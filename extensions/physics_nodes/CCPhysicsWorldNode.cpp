@@ -0,0 +1,433 @@
+/* Copyright (c) 2013 cocos2d-x.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "CCPhysicsWorldNode.h"
+#include <math.h>
+
+#if CC_ENABLE_CHIPMUNK_INTEGRATION
+#include "chipmunk.h"
+#elif CC_ENABLE_BOX2D_INTEGRATION
+#include "Box2D/Box2D.h"
+#endif
+
+NS_CC_EXT_BEGIN
+
+CCPhysicsWorldNode::CCPhysicsWorldNode()
+#if CC_ENABLE_CHIPMUNK_INTEGRATION
+: m_pSpace(NULL)
+#elif CC_ENABLE_BOX2D_INTEGRATION
+: m_pWorld(NULL)
+, m_nVelocityIterations(8)
+, m_nPositionIterations(3)
+#endif
+, m_fFixedTimeStep(1.0f / 60)
+, m_uMaxStepsPerFrame(5)
+, m_fAccumulator(0.0f)
+, m_fInterpolationAlpha(0.0f)
+, m_fPendingAlpha(0.0f)
+, m_bWorkerThread(false)
+, m_uPendingSteps(0)
+, m_bQuitWorker(false)
+{
+}
+
+CCPhysicsWorldNode::~CCPhysicsWorldNode()
+{
+    stopWorkerThread();
+
+    for (std::vector<SpriteEntry>::iterator it = m_obSpriteEntries.begin(); it != m_obSpriteEntries.end(); ++it)
+    {
+        it->sprite->m_pPhysicsWorldNode = NULL;
+    }
+
+#if CC_ENABLE_CHIPMUNK_INTEGRATION
+    if (m_pSpace)
+    {
+        cpSpaceFree(m_pSpace);
+    }
+#elif CC_ENABLE_BOX2D_INTEGRATION
+    CC_SAFE_DELETE(m_pWorld);
+#endif
+}
+
+CCPhysicsWorldNode* CCPhysicsWorldNode::create()
+{
+    CCPhysicsWorldNode* pRet = new CCPhysicsWorldNode();
+    if (pRet && pRet->init())
+    {
+        pRet->autorelease();
+    }
+    else
+    {
+        CC_SAFE_DELETE(pRet);
+    }
+
+    return pRet;
+}
+
+bool CCPhysicsWorldNode::init()
+{
+#if CC_ENABLE_CHIPMUNK_INTEGRATION
+    m_pSpace = cpSpaceNew();
+    return m_pSpace != NULL;
+#elif CC_ENABLE_BOX2D_INTEGRATION
+    m_pWorld = new b2World(b2Vec2(0.0f, -10.0f));
+    return true;
+#endif
+}
+
+void CCPhysicsWorldNode::onEnter()
+{
+    CCNode::onEnter();
+    scheduleUpdate();
+}
+
+void CCPhysicsWorldNode::onExit()
+{
+    unscheduleUpdate();
+    waitForStep();
+    CCNode::onExit();
+}
+
+#if CC_ENABLE_CHIPMUNK_INTEGRATION
+
+cpSpace* CCPhysicsWorldNode::getSpace() const
+{
+    return m_pSpace;
+}
+
+#elif CC_ENABLE_BOX2D_INTEGRATION
+
+b2World* CCPhysicsWorldNode::getWorld() const
+{
+    return m_pWorld;
+}
+
+int CCPhysicsWorldNode::getVelocityIterations() const
+{
+    return m_nVelocityIterations;
+}
+
+void CCPhysicsWorldNode::setVelocityIterations(int nIterations)
+{
+    m_nVelocityIterations = nIterations;
+}
+
+int CCPhysicsWorldNode::getPositionIterations() const
+{
+    return m_nPositionIterations;
+}
+
+void CCPhysicsWorldNode::setPositionIterations(int nIterations)
+{
+    m_nPositionIterations = nIterations;
+}
+
+#endif // CC_ENABLE_BOX2D_INTEGRATION
+
+float CCPhysicsWorldNode::getFixedTimeStep() const
+{
+    return m_fFixedTimeStep;
+}
+
+void CCPhysicsWorldNode::setFixedTimeStep(float fTimeStep)
+{
+    CCAssert(fTimeStep > 0, "The time step must be positive");
+    m_fFixedTimeStep = fTimeStep;
+}
+
+unsigned int CCPhysicsWorldNode::getMaxStepsPerFrame() const
+{
+    return m_uMaxStepsPerFrame;
+}
+
+void CCPhysicsWorldNode::setMaxStepsPerFrame(unsigned int uMaxSteps)
+{
+    m_uMaxStepsPerFrame = uMaxSteps;
+}
+
+bool CCPhysicsWorldNode::isSteppingOnWorkerThread() const
+{
+    return m_bWorkerThread;
+}
+
+void CCPhysicsWorldNode::setSteppingOnWorkerThread(bool bWorkerThread)
+{
+    if (bWorkerThread == m_bWorkerThread)
+    {
+        return;
+    }
+
+    if (bWorkerThread)
+    {
+        startWorkerThread();
+    }
+    else
+    {
+        stopWorkerThread();
+        // the steps done by the worker thread weren't drawn yet
+        publishStates(m_fPendingAlpha);
+    }
+}
+
+float CCPhysicsWorldNode::getInterpolationAlpha() const
+{
+    return m_fInterpolationAlpha;
+}
+
+void CCPhysicsWorldNode::addPhysicsSprite(CCPhysicsSprite* pSprite)
+{
+    CCAssert(pSprite != NULL, "Argument must be non-nil");
+    if (pSprite->m_pPhysicsWorldNode == this)
+    {
+        return;
+    }
+    if (pSprite->m_pPhysicsWorldNode)
+    {
+        pSprite->m_pPhysicsWorldNode->removePhysicsSprite(pSprite);
+    }
+
+    waitForStep();
+
+    SpriteEntry entry;
+    entry.sprite = pSprite;
+    m_obSpriteEntries.push_back(entry);
+    pSprite->m_pPhysicsWorldNode = this;
+    resetPhysicsSprite(pSprite);
+}
+
+void CCPhysicsWorldNode::removePhysicsSprite(CCPhysicsSprite* pSprite)
+{
+    if (pSprite == NULL || pSprite->m_pPhysicsWorldNode != this)
+    {
+        return;
+    }
+
+    waitForStep();
+
+    for (std::vector<SpriteEntry>::iterator it = m_obSpriteEntries.begin(); it != m_obSpriteEntries.end(); ++it)
+    {
+        if (it->sprite == pSprite)
+        {
+            m_obSpriteEntries.erase(it);
+            break;
+        }
+    }
+    pSprite->m_pPhysicsWorldNode = NULL;
+}
+
+void CCPhysicsWorldNode::resetPhysicsSprite(CCPhysicsSprite* pSprite)
+{
+#if CC_ENABLE_CHIPMUNK_INTEGRATION
+    bool bHasBody = pSprite->getCPBody() != NULL;
+#elif CC_ENABLE_BOX2D_INTEGRATION
+    bool bHasBody = pSprite->getB2Body() != NULL;
+#endif
+    if (! bHasBody)
+    {
+        return;
+    }
+
+    waitForStep();
+
+    for (std::vector<SpriteEntry>::iterator it = m_obSpriteEntries.begin(); it != m_obSpriteEntries.end(); ++it)
+    {
+        if (it->sprite == pSprite)
+        {
+            // no interpolation from the previous place of the body
+            pSprite->getBodyState(it->position, it->angle);
+            it->previousPosition = it->position;
+            it->previousAngle = it->angle;
+
+            pSprite->m_obPreviousBodyPosition = pSprite->m_obBodyPosition = it->position;
+            pSprite->m_fPreviousBodyAngle = pSprite->m_fBodyAngle = it->angle;
+            break;
+        }
+    }
+}
+
+void CCPhysicsWorldNode::update(float dt)
+{
+    // the steps started by the previous frame are drawn by this one
+    waitForStep();
+    if (m_bWorkerThread)
+    {
+        publishStates(m_fPendingAlpha);
+    }
+
+    m_fAccumulator += dt;
+    unsigned int uSteps = (unsigned int)(m_fAccumulator / m_fFixedTimeStep);
+    if (uSteps > m_uMaxStepsPerFrame)
+    {
+        uSteps = m_uMaxStepsPerFrame;
+        m_fAccumulator = fmodf(m_fAccumulator, m_fFixedTimeStep);
+    }
+    else
+    {
+        m_fAccumulator -= uSteps * m_fFixedTimeStep;
+    }
+    float fAlpha = m_fAccumulator / m_fFixedTimeStep;
+
+    if (m_bWorkerThread)
+    {
+        m_fPendingAlpha = fAlpha;
+        if (uSteps > 0)
+        {
+            pthread_mutex_lock(&m_mutex);
+            m_uPendingSteps = uSteps;
+            pthread_cond_signal(&m_workCondition);
+            pthread_mutex_unlock(&m_mutex);
+        }
+    }
+    else
+    {
+        stepWorld(uSteps);
+        publishStates(fAlpha);
+    }
+}
+
+void CCPhysicsWorldNode::stepWorld(unsigned int uSteps)
+{
+    for (unsigned int i = 0; i < uSteps; ++i)
+    {
+        if (i == uSteps - 1)
+        {
+            for (std::vector<SpriteEntry>::iterator it = m_obSpriteEntries.begin(); it != m_obSpriteEntries.end(); ++it)
+            {
+                it->sprite->getBodyState(it->previousPosition, it->previousAngle);
+            }
+        }
+
+#if CC_ENABLE_CHIPMUNK_INTEGRATION
+        cpSpaceStep(m_pSpace, m_fFixedTimeStep);
+#elif CC_ENABLE_BOX2D_INTEGRATION
+        m_pWorld->Step(m_fFixedTimeStep, m_nVelocityIterations, m_nPositionIterations);
+#endif
+    }
+
+    if (uSteps > 0)
+    {
+        for (std::vector<SpriteEntry>::iterator it = m_obSpriteEntries.begin(); it != m_obSpriteEntries.end(); ++it)
+        {
+            it->sprite->getBodyState(it->position, it->angle);
+        }
+    }
+}
+
+void CCPhysicsWorldNode::publishStates(float fAlpha)
+{
+    for (std::vector<SpriteEntry>::iterator it = m_obSpriteEntries.begin(); it != m_obSpriteEntries.end(); ++it)
+    {
+        CCPhysicsSprite* pSprite = it->sprite;
+        pSprite->m_obPreviousBodyPosition = it->previousPosition;
+        pSprite->m_fPreviousBodyAngle = it->previousAngle;
+        pSprite->m_obBodyPosition = it->position;
+        pSprite->m_fBodyAngle = it->angle;
+    }
+    m_fInterpolationAlpha = fAlpha;
+}
+
+void CCPhysicsWorldNode::waitForStep()
+{
+    if (! m_bWorkerThread)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&m_mutex);
+    while (m_uPendingSteps > 0)
+    {
+        pthread_cond_wait(&m_doneCondition, &m_mutex);
+    }
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void CCPhysicsWorldNode::startWorkerThread()
+{
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_workCondition, NULL);
+    pthread_cond_init(&m_doneCondition, NULL);
+    m_uPendingSteps = 0;
+    m_bQuitWorker = false;
+
+    if (pthread_create(&m_worker, NULL, workerThreadMain, this) != 0)
+    {
+        CCLOG("cocos2d: CCPhysicsWorldNode: can't create the worker thread, stepping on the main thread");
+        pthread_cond_destroy(&m_doneCondition);
+        pthread_cond_destroy(&m_workCondition);
+        pthread_mutex_destroy(&m_mutex);
+        return;
+    }
+    m_bWorkerThread = true;
+}
+
+void CCPhysicsWorldNode::stopWorkerThread()
+{
+    if (! m_bWorkerThread)
+    {
+        return;
+    }
+
+    waitForStep();
+
+    pthread_mutex_lock(&m_mutex);
+    m_bQuitWorker = true;
+    pthread_cond_signal(&m_workCondition);
+    pthread_mutex_unlock(&m_mutex);
+    pthread_join(m_worker, NULL);
+
+    pthread_cond_destroy(&m_doneCondition);
+    pthread_cond_destroy(&m_workCondition);
+    pthread_mutex_destroy(&m_mutex);
+    m_bWorkerThread = false;
+}
+
+void* CCPhysicsWorldNode::workerThreadMain(void* pData)
+{
+    CCPhysicsWorldNode* pNode = (CCPhysicsWorldNode*)pData;
+
+    pthread_mutex_lock(&pNode->m_mutex);
+    while (true)
+    {
+        while (pNode->m_uPendingSteps == 0 && ! pNode->m_bQuitWorker)
+        {
+            pthread_cond_wait(&pNode->m_workCondition, &pNode->m_mutex);
+        }
+        if (pNode->m_bQuitWorker)
+        {
+            break;
+        }
+
+        unsigned int uSteps = pNode->m_uPendingSteps;
+        pthread_mutex_unlock(&pNode->m_mutex);
+
+        pNode->stepWorld(uSteps);
+
+        pthread_mutex_lock(&pNode->m_mutex);
+        pNode->m_uPendingSteps = 0;
+        pthread_cond_broadcast(&pNode->m_doneCondition);
+    }
+    pthread_mutex_unlock(&pNode->m_mutex);
+
+    return NULL;
+}
+
+NS_CC_EXT_END
@@ -0,0 +1,156 @@
+/* Copyright (c) 2013 cocos2d-x.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __PHYSICSNODES_CCPHYSICSWORLDNODE_H__
+#define __PHYSICSNODES_CCPHYSICSWORLDNODE_H__
+
+#include "CCPhysicsSprite.h"
+#include <pthread.h>
+#include <vector>
+
+#if CC_ENABLE_BOX2D_INTEGRATION
+class b2World;
+#endif
+
+NS_CC_EXT_BEGIN
+
+/** A node that owns a physics world and steps it at a fixed rate.
+
+ The frame time is accumulated and the world is stepped by getFixedTimeStep() seconds as many times
+ as it fits, so the simulation doesn't depend on the frame rate. The CCPhysicsSprite added with
+ addPhysicsSprite() draw the state of their body interpolated between the last two steps, by the
+ time left in the accumulator: they move smoothly even when the frame rate isn't a multiple of the
+ physics rate.
+
+ The world can be stepped on a worker thread, while the frame is drawn: the sprites then draw the
+ steps started by the previous frame. Call waitForStep() before touching the world, its bodies or
+ its shapes outside of the physics callbacks, which are called on the worker thread.
+
+ It works with:
+ - Chipmunk: Preprocessor macro CC_ENABLE_CHIPMUNK_INTEGRATION should be defined, it owns a cpSpace
+ - Box2d: Preprocessor macro CC_ENABLE_BOX2D_INTEGRATION should be defined, it owns a b2World
+
+ @since v2.1.4
+ */
+class CCPhysicsWorldNode : public CCNode
+{
+public:
+    CCPhysicsWorldNode();
+    virtual ~CCPhysicsWorldNode();
+
+    static CCPhysicsWorldNode* create();
+    virtual bool init();
+
+    virtual void onEnter();
+    virtual void onExit();
+    virtual void update(float dt);
+
+#if CC_ENABLE_CHIPMUNK_INTEGRATION
+    /** The space, freed with the node. Like with cpSpaceFree, its bodies and shapes aren't freed. */
+    cpSpace* getSpace() const;
+#elif CC_ENABLE_BOX2D_INTEGRATION
+    /** The world, deleted with the node, with its bodies. */
+    b2World* getWorld() const;
+
+    /** Iterations of the Box2D solver. Default: 8 and 3 */
+    int getVelocityIterations() const;
+    void setVelocityIterations(int nIterations);
+    int getPositionIterations() const;
+    void setPositionIterations(int nIterations);
+#endif // CC_ENABLE_BOX2D_INTEGRATION
+
+    /** Duration of a step, in seconds. Default: 1/60 */
+    float getFixedTimeStep() const;
+    void setFixedTimeStep(float fTimeStep);
+
+    /** Steps done in a frame at most, the time that didn't fit is dropped: a slow frame doesn't make
+     the next one slower. Default: 5 */
+    unsigned int getMaxStepsPerFrame() const;
+    void setMaxStepsPerFrame(unsigned int uMaxSteps);
+
+    /** Steps the world on a worker thread, while the frame is drawn. Default: false */
+    bool isSteppingOnWorkerThread() const;
+    void setSteppingOnWorkerThread(bool bWorkerThread);
+
+    /** Blocks until the steps started on the worker thread are done. Does nothing otherwise. */
+    void waitForStep();
+
+    /** Position of the drawn state between the last two steps, from 0 to 1 */
+    float getInterpolationAlpha() const;
+
+    /** The sprite draws its body interpolated. Its body must be in the world. The sprite isn't retained,
+     it is removed from the node when deleted.
+     */
+    void addPhysicsSprite(CCPhysicsSprite* pSprite);
+    void removePhysicsSprite(CCPhysicsSprite* pSprite);
+
+protected:
+    friend class CCPhysicsSprite;
+
+    struct SpriteEntry
+    {
+        CCPhysicsSprite* sprite;
+        CCPoint previousPosition;
+        float previousAngle;
+        CCPoint position;
+        float angle;
+    };
+
+    // reads the state of the body of the sprite into its entry and the sprite, after it was moved
+    void resetPhysicsSprite(CCPhysicsSprite* pSprite);
+    // steps the world uSteps times, saving the states before and after the last step in the entries
+    void stepWorld(unsigned int uSteps);
+    // copies the states of the entries to the sprites, to draw them
+    void publishStates(float fAlpha);
+
+    void startWorkerThread();
+    void stopWorkerThread();
+    static void* workerThreadMain(void* pData);
+
+#if CC_ENABLE_CHIPMUNK_INTEGRATION
+    cpSpace* m_pSpace;
+#elif CC_ENABLE_BOX2D_INTEGRATION
+    b2World* m_pWorld;
+    int m_nVelocityIterations;
+    int m_nPositionIterations;
+#endif
+
+    float m_fFixedTimeStep;
+    unsigned int m_uMaxStepsPerFrame;
+    float m_fAccumulator;
+    float m_fInterpolationAlpha;
+    // the alpha of the steps running on the worker thread, used when they are published
+    float m_fPendingAlpha;
+
+    std::vector<SpriteEntry> m_obSpriteEntries;
+
+    bool m_bWorkerThread;
+    pthread_t m_worker;
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_workCondition;
+    pthread_cond_t m_doneCondition;
+    unsigned int m_uPendingSteps;
+    bool m_bQuitWorker;
+};
+
+NS_CC_EXT_END
+
+#endif // __PHYSICSNODES_CCPHYSICSWORLDNODE_H__
@@ -88,6 +88,22 @@ void Timeline_apply (const Timeline* self, Skeleton* skeleton, float time, float
 	VTABLE(Timeline, self) ->apply(self, skeleton, time, alpha);
 }
 
+void _RotateTimeline_apply (const Timeline* timeline, Skeleton* skeleton, float time, float alpha);
+void _TranslateTimeline_apply (const Timeline* timeline, Skeleton* skeleton, float time, float alpha);
+void _ScaleTimeline_apply (const Timeline* timeline, Skeleton* skeleton, float time, float alpha);
+void _ColorTimeline_apply (const Timeline* timeline, Skeleton* skeleton, float time, float alpha);
+void _AttachmentTimeline_apply (const Timeline* timeline, Skeleton* skeleton, float time, float alpha);
+
+_TimelineType _Timeline_getType (const Timeline* self) {
+	void (*apply) (const Timeline* self, Skeleton* skeleton, float time, float alpha) = VTABLE(Timeline, self) ->apply;
+	if (apply == _RotateTimeline_apply) return _TIMELINE_ROTATE;
+	if (apply == _TranslateTimeline_apply) return _TIMELINE_TRANSLATE;
+	if (apply == _ScaleTimeline_apply) return _TIMELINE_SCALE;
+	if (apply == _ColorTimeline_apply) return _TIMELINE_COLOR;
+	if (apply == _AttachmentTimeline_apply) return _TIMELINE_ATTACHMENT;
+	return _TIMELINE_UNKNOWN;
+}
+
 /**/
 
 static const float CURVE_LINEAR = 0;
@@ -0,0 +1,591 @@
+/* Copyright (c) 2013 cocos2d-x.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <spine/SkeletonBinary.h>
+#include <stdio.h>
+#include <spine/extension.h>
+#include <spine/RegionAttachment.h>
+#include <spine/AtlasAttachmentLoader.h>
+
+namespace cocos2d { namespace extension {
+
+/* Layout, all numbers little endian:
+ *
+ * header      "SPNB" version:u8
+ * string      length+1:varint then the bytes, length 0 meaning null
+ * bones       count:varint { name parent+1:varint length x y rotation scaleX scaleY }
+ * slots       count:varint { name bone:varint attachmentName r g b a }
+ * skins       count:varint defaultSkin+1:varint { name count:varint { slot:varint key name type:u8 x y scaleX scaleY rotation
+ *             width height } }
+ * animations  count:varint { name duration timelineCount:varint { type:u8 index:varint frameCount:varint frames... curves... } }
+ *
+ * Floats are IEEE 754 singles. Skin entries are stored oldest first so reading them back keeps the lookup order. */
+static const unsigned char SIGNATURE[4] = {'S', 'P', 'N', 'B'};
+static const int VERSION = 1;
+
+typedef struct {
+	SkeletonBinary super;
+	int ownsLoader;
+} _Internal;
+
+SkeletonBinary* SkeletonBinary_createWithLoader (AttachmentLoader* attachmentLoader) {
+	SkeletonBinary* self = SUPER(NEW(_Internal));
+	self->scale = 1;
+	self->attachmentLoader = attachmentLoader;
+	return self;
+}
+
+SkeletonBinary* SkeletonBinary_create (Atlas* atlas) {
+	AtlasAttachmentLoader* attachmentLoader = AtlasAttachmentLoader_create(atlas);
+	SkeletonBinary* self = SkeletonBinary_createWithLoader(SUPER(attachmentLoader));
+	SUB_CAST(_Internal, self) ->ownsLoader = 1;
+	return self;
+}
+
+void SkeletonBinary_dispose (SkeletonBinary* self) {
+	if (SUB_CAST(_Internal, self) ->ownsLoader) AttachmentLoader_dispose(self->attachmentLoader);
+	FREE(self->error);
+	FREE(self);
+}
+
+static void _SkeletonBinary_setError (SkeletonBinary* self, const char* value1, const char* value2) {
+	FREE(self->error);
+	char message[256];
+	strcpy(message, value1);
+	int length = strlen(value1);
+	if (value2) strncat(message + length, value2, 256 - length - 1);
+	MALLOC_STR(self->error, message);
+}
+
+int/*bool*/SkeletonBinary_isBinary (const unsigned char* data, int length) {
+	return length >= 4 && memcmp(data, SIGNATURE, 4) == 0;
+}
+
+/**/
+
+typedef struct {
+	const unsigned char* cursor;
+	const unsigned char* end;
+	int/*bool*/overflow;
+	char buffer[256];
+} _Reader;
+
+static int readByte (_Reader* reader) {
+	if (reader->cursor >= reader->end) {
+		reader->overflow = 1;
+		return 0;
+	}
+	return *reader->cursor++;
+}
+
+/* Indices and counts are never negative: a value that doesn't fit in a positive int, or that takes more than 5 bytes,
+ * sets the overflow flag and reads as 0. */
+static int readVarint (_Reader* reader) {
+	unsigned int value = 0;
+	int shift = 0, b;
+	do {
+		if (shift == 35) {
+			reader->overflow = 1;
+			return 0;
+		}
+		b = readByte(reader);
+		if (shift == 28 && (b & 0x78)) {
+			reader->overflow = 1;
+			return 0;
+		}
+		value |= (unsigned int)(b & 0x7F) << shift;
+		shift += 7;
+	} while (b & 0x80);
+	return (int)value;
+}
+
+static float readFloat (_Reader* reader) {
+	if (reader->end - reader->cursor < 4) {
+		reader->overflow = 1;
+		reader->cursor = reader->end;
+		return 0;
+	}
+	const unsigned char* p = reader->cursor;
+	unsigned int bits = p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+	reader->cursor += 4;
+	float value;
+	memcpy(&value, &bits, 4);
+	return value;
+}
+
+/* Returns a pointer to the string, valid until the next call, or 0 for a null string. */
+static const char* readString (_Reader* reader) {
+	int length = readVarint(reader) - 1;
+	if (length < 0) return 0;
+	if (length >= (int)sizeof(reader->buffer) || reader->end - reader->cursor < length) {
+		reader->overflow = 1;
+		reader->cursor = reader->end;
+		return "";
+	}
+	memcpy(reader->buffer, reader->cursor, length);
+	reader->buffer[length] = '\0';
+	reader->cursor += length;
+	return reader->buffer;
+}
+
+/* Like readString, but a null string reads as empty, for names that are required. */
+static const char* readName (_Reader* reader) {
+	const char* name = readString(reader);
+	return name ? name : "";
+}
+
+static void readCurves (_Reader* reader, CurveTimeline* timeline, int frameCount) {
+	int i, n = (frameCount - 1) * 6;
+	for (i = 0; i < n; ++i)
+		timeline->curves[i] = readFloat(reader);
+}
+
+static Animation* _SkeletonBinary_readAnimation (SkeletonBinary* self, _Reader* reader, SkeletonData* skeletonData) {
+	int i, ii;
+	Animation* animation = Animation_create(readName(reader), 0);
+	animation->duration = readFloat(reader);
+	int timelineCount = readVarint(reader);
+	if (reader->overflow || timelineCount < 0 || timelineCount > reader->end - reader->cursor) {
+		reader->overflow = 1;
+		return animation;
+	}
+	FREE(animation->timelines);
+	animation->timelines = MALLOC(Timeline*, timelineCount);
+
+	for (i = 0; i < timelineCount; ++i) {
+		int type = readByte(reader);
+		int index = readVarint(reader);
+		int frameCount = readVarint(reader);
+		if (reader->overflow || index < 0 || frameCount < 1 || frameCount > reader->end - reader->cursor) {
+			reader->overflow = 1;
+			return animation;
+		}
+
+		Timeline* timeline;
+		switch (type) {
+		case _TIMELINE_ROTATE:
+		case _TIMELINE_TRANSLATE:
+		case _TIMELINE_SCALE: {
+			if (index >= skeletonData->boneCount) {
+				_SkeletonBinary_setError(self, "Bone index out of range in animation: ", animation->name);
+				return animation;
+			}
+			float scale = type == _TIMELINE_TRANSLATE ? self->scale : 1;
+			struct BaseTimeline* baseTimeline;
+			if (type == _TIMELINE_ROTATE)
+				baseTimeline = RotateTimeline_create(frameCount);
+			else if (type == _TIMELINE_TRANSLATE)
+				baseTimeline = TranslateTimeline_create(frameCount);
+			else
+				baseTimeline = ScaleTimeline_create(frameCount);
+			baseTimeline->boneIndex = index;
+			int frameSize = baseTimeline->framesLength / frameCount;
+			for (ii = 0; ii < baseTimeline->framesLength; ++ii)
+				baseTimeline->frames[ii] = readFloat(reader) * (ii % frameSize == 0 ? 1 : scale);
+			readCurves(reader, SUPER(baseTimeline), frameCount);
+			timeline = (Timeline*)baseTimeline;
+			break;
+		}
+		case _TIMELINE_COLOR: {
+			if (index >= skeletonData->slotCount) {
+				_SkeletonBinary_setError(self, "Slot index out of range in animation: ", animation->name);
+				return animation;
+			}
+			ColorTimeline* colorTimeline = ColorTimeline_create(frameCount);
+			colorTimeline->slotIndex = index;
+			for (ii = 0; ii < colorTimeline->framesLength; ++ii)
+				colorTimeline->frames[ii] = readFloat(reader);
+			readCurves(reader, SUPER(colorTimeline), frameCount);
+			timeline = (Timeline*)colorTimeline;
+			break;
+		}
+		case _TIMELINE_ATTACHMENT: {
+			if (index >= skeletonData->slotCount) {
+				_SkeletonBinary_setError(self, "Slot index out of range in animation: ", animation->name);
+				return animation;
+			}
+			AttachmentTimeline* attachmentTimeline = AttachmentTimeline_create(frameCount);
+			attachmentTimeline->slotIndex = index;
+			for (ii = 0; ii < frameCount; ++ii) {
+				float time = readFloat(reader);
+				AttachmentTimeline_setFrame(attachmentTimeline, ii, time, readString(reader));
+			}
+			timeline = (Timeline*)attachmentTimeline;
+			break;
+		}
+		default:
+			_SkeletonBinary_setError(self, "Invalid timeline type in animation: ", animation->name);
+			return animation;
+		}
+		animation->timelines[animation->timelineCount++] = timeline;
+	}
+	return animation;
+}
+
+SkeletonData* SkeletonBinary_readSkeletonDataFile (SkeletonBinary* self, const char* path) {
+	int length;
+	const unsigned char* binary = (const unsigned char*)_Util_readFile(path, &length);
+	if (!binary) {
+		_SkeletonBinary_setError(self, "Unable to read skeleton file: ", path);
+		return 0;
+	}
+	SkeletonData* skeletonData = SkeletonBinary_readSkeletonData(self, binary, length);
+	FREE(binary);
+	return skeletonData;
+}
+
+SkeletonData* SkeletonBinary_readSkeletonData (SkeletonBinary* self, const unsigned char* binary, int length) {
+	FREE(self->error);
+	CONST_CAST(char*, self->error) = 0;
+
+	if (!SkeletonBinary_isBinary(binary, length) || length < 5 || binary[4] != VERSION) {
+		_SkeletonBinary_setError(self, "Invalid skeleton binary", 0);
+		return 0;
+	}
+
+	_Reader reader;
+	reader.cursor = binary + 5;
+	reader.end = binary + length;
+	reader.overflow = 0;
+
+	SkeletonData* skeletonData = SkeletonData_create();
+	int i, ii;
+
+	/* Every count is checked against the bytes left, so a corrupt count cannot request a huge allocation. */
+#define READ_COUNT(COUNT) \
+	int COUNT = readVarint(&reader); \
+	if (reader.overflow || COUNT < 0 || COUNT > reader.end - reader.cursor) goto truncated;
+
+	READ_COUNT(boneCount);
+	skeletonData->bones = MALLOC(BoneData*, boneCount);
+	for (i = 0; i < boneCount; ++i) {
+		char name[256];
+		strcpy(name, readName(&reader));
+		int parentIndex = readVarint(&reader) - 1;
+		if (reader.overflow || parentIndex < -1 || parentIndex >= i) goto truncated;
+
+		BoneData* boneData = BoneData_create(name, parentIndex < 0 ? 0 : skeletonData->bones[parentIndex]);
+		boneData->length = readFloat(&reader) * self->scale;
+		boneData->x = readFloat(&reader) * self->scale;
+		boneData->y = readFloat(&reader) * self->scale;
+		boneData->rotation = readFloat(&reader);
+		boneData->scaleX = readFloat(&reader);
+		boneData->scaleY = readFloat(&reader);
+
+		skeletonData->bones[i] = boneData;
+		skeletonData->boneCount++;
+	}
+
+	{
+		READ_COUNT(slotCount);
+		skeletonData->slots = MALLOC(SlotData*, slotCount);
+		for (i = 0; i < slotCount; ++i) {
+			char name[256];
+			strcpy(name, readName(&reader));
+			int boneIndex = readVarint(&reader);
+			if (reader.overflow || boneIndex < 0 || boneIndex >= skeletonData->boneCount) goto truncated;
+
+			SlotData* slotData = SlotData_create(name, skeletonData->bones[boneIndex]);
+			SlotData_setAttachmentName(slotData, readString(&reader));
+			slotData->r = readFloat(&reader);
+			slotData->g = readFloat(&reader);
+			slotData->b = readFloat(&reader);
+			slotData->a = readFloat(&reader);
+
+			skeletonData->slots[i] = slotData;
+			skeletonData->slotCount++;
+		}
+	}
+
+	{
+		READ_COUNT(skinCount);
+		int defaultSkin = readVarint(&reader) - 1;
+		skeletonData->skins = MALLOC(Skin*, skinCount);
+		for (i = 0; i < skinCount; ++i) {
+			Skin* skin = Skin_create(readName(&reader));
+			skeletonData->skins[i] = skin;
+			skeletonData->skinCount++;
+			if (i == defaultSkin) skeletonData->defaultSkin = skin;
+
+			READ_COUNT(attachmentCount);
+			for (ii = 0; ii < attachmentCount; ++ii) {
+				int slotIndex = readVarint(&reader);
+				char skinAttachmentName[256];
+				strcpy(skinAttachmentName, readName(&reader));
+				const char* attachmentName = readString(&reader);
+				AttachmentType type = (AttachmentType)readByte(&reader);
+				float x = readFloat(&reader) * self->scale;
+				float y = readFloat(&reader) * self->scale;
+				float scaleX = readFloat(&reader);
+				float scaleY = readFloat(&reader);
+				float rotation = readFloat(&reader);
+				float width = readFloat(&reader) * self->scale;
+				float height = readFloat(&reader) * self->scale;
+				if (reader.overflow || slotIndex < 0 || slotIndex >= skeletonData->slotCount) goto truncated;
+
+				Attachment* attachment = AttachmentLoader_newAttachment(self->attachmentLoader, skin, type,
+						attachmentName ? attachmentName : skinAttachmentName);
+				if (!attachment) {
+					if (self->attachmentLoader->error1) {
+						SkeletonData_dispose(skeletonData);
+						_SkeletonBinary_setError(self, self->attachmentLoader->error1, self->attachmentLoader->error2);
+						return 0;
+					}
+					continue;
+				}
+
+				if (attachment->type == ATTACHMENT_REGION || attachment->type == ATTACHMENT_REGION_SEQUENCE) {
+					RegionAttachment* regionAttachment = (RegionAttachment*)attachment;
+					regionAttachment->x = x;
+					regionAttachment->y = y;
+					regionAttachment->scaleX = scaleX;
+					regionAttachment->scaleY = scaleY;
+					regionAttachment->rotation = rotation;
+					regionAttachment->width = width;
+					regionAttachment->height = height;
+					RegionAttachment_updateOffset(regionAttachment);
+				}
+
+				Skin_addAttachment(skin, slotIndex, skinAttachmentName, attachment);
+			}
+		}
+	}
+
+	{
+		READ_COUNT(animationCount);
+		skeletonData->animations = MALLOC(Animation*, animationCount);
+		for (i = 0; i < animationCount; ++i) {
+			Animation* animation = _SkeletonBinary_readAnimation(self, &reader, skeletonData);
+			skeletonData->animations[skeletonData->animationCount++] = animation;
+			if (self->error) {
+				SkeletonData_dispose(skeletonData);
+				return 0;
+			}
+			if (reader.overflow) goto truncated;
+		}
+	}
+#undef READ_COUNT
+
+	if (reader.overflow) goto truncated;
+	return skeletonData;
+
+truncated:
+	SkeletonData_dispose(skeletonData);
+	_SkeletonBinary_setError(self, "Truncated or corrupt skeleton binary", 0);
+	return 0;
+}
+
+/**/
+
+typedef struct {
+	unsigned char* data;
+	int length;
+	int capacity;
+} _Writer;
+
+static void writeBytes (_Writer* writer, const void* bytes, int count) {
+	if (writer->length + count > writer->capacity) {
+		int capacity = writer->capacity * 2;
+		if (capacity < writer->length + count) capacity = writer->length + count;
+		unsigned char* data = MALLOC(unsigned char, capacity);
+		memcpy(data, writer->data, writer->length);
+		FREE(writer->data);
+		writer->data = data;
+		writer->capacity = capacity;
+	}
+	memcpy(writer->data + writer->length, bytes, count);
+	writer->length += count;
+}
+
+static void writeByte (_Writer* writer, int value) {
+	unsigned char b = (unsigned char)value;
+	writeBytes(writer, &b, 1);
+}
+
+static void writeVarint (_Writer* writer, int value) {
+	unsigned int v = (unsigned int)value;
+	while (v >= 0x80) {
+		writeByte(writer, (v & 0x7F) | 0x80);
+		v >>= 7;
+	}
+	writeByte(writer, v);
+}
+
+static void writeFloat (_Writer* writer, float value) {
+	unsigned int bits;
+	memcpy(&bits, &value, 4);
+	unsigned char bytes[4] = {(unsigned char)bits, (unsigned char)(bits >> 8), (unsigned char)(bits >> 16),
+			(unsigned char)(bits >> 24)};
+	writeBytes(writer, bytes, 4);
+}
+
+static void writeString (_Writer* writer, const char* value) {
+	if (!value) {
+		writeVarint(writer, 0);
+		return;
+	}
+	int length = strlen(value);
+	writeVarint(writer, length + 1);
+	writeBytes(writer, value, length);
+}
+
+static int findBoneIndex (const SkeletonData* skeletonData, const BoneData* boneData) {
+	int i;
+	for (i = 0; i < skeletonData->boneCount; ++i)
+		if (skeletonData->bones[i] == boneData) return i;
+	return -1;
+}
+
+static int/*bool*/writeAnimation (_Writer* writer, const Animation* animation) {
+	int i, ii;
+	writeString(writer, animation->name);
+	writeFloat(writer, animation->duration);
+	writeVarint(writer, animation->timelineCount);
+	for (i = 0; i < animation->timelineCount; ++i) {
+		const Timeline* timeline = animation->timelines[i];
+		_TimelineType type = _Timeline_getType(timeline);
+		writeByte(writer, type);
+		switch (type) {
+		case _TIMELINE_ROTATE:
+		case _TIMELINE_TRANSLATE:
+		case _TIMELINE_SCALE:
+		case _TIMELINE_COLOR: {
+			/* ColorTimeline matches struct BaseTimeline up to the frames; only the index field differs in name. */
+			const struct BaseTimeline* baseTimeline = SUB_CAST(const struct BaseTimeline, timeline);
+			int frameSize = type == _TIMELINE_ROTATE ? 2 : type == _TIMELINE_COLOR ? 5 : 3;
+			int frameCount = baseTimeline->framesLength / frameSize;
+			writeVarint(writer, type == _TIMELINE_COLOR ? SUB_CAST(const ColorTimeline, timeline)->slotIndex : baseTimeline->boneIndex);
+			writeVarint(writer, frameCount);
+			for (ii = 0; ii < baseTimeline->framesLength; ++ii)
+				writeFloat(writer, baseTimeline->frames[ii]);
+			for (ii = 0; ii < (frameCount - 1) * 6; ++ii)
+				writeFloat(writer, baseTimeline->super.curves[ii]);
+			break;
+		}
+		case _TIMELINE_ATTACHMENT: {
+			const AttachmentTimeline* attachmentTimeline = SUB_CAST(const AttachmentTimeline, timeline);
+			writeVarint(writer, attachmentTimeline->slotIndex);
+			writeVarint(writer, attachmentTimeline->framesLength);
+			for (ii = 0; ii < attachmentTimeline->framesLength; ++ii) {
+				writeFloat(writer, attachmentTimeline->frames[ii]);
+				writeString(writer, attachmentTimeline->attachmentNames[ii]);
+			}
+			break;
+		}
+		default:
+			return 0;
+		}
+	}
+	return 1;
+}
+
+unsigned char* SkeletonBinary_writeSkeletonData (const SkeletonData* skeletonData, int* length) {
+	int i, ii;
+	_Writer writer;
+	writer.capacity = 4096;
+	writer.length = 0;
+	writer.data = MALLOC(unsigned char, writer.capacity);
+
+	writeBytes(&writer, SIGNATURE, 4);
+	writeByte(&writer, VERSION);
+
+	writeVarint(&writer, skeletonData->boneCount);
+	for (i = 0; i < skeletonData->boneCount; ++i) {
+		const BoneData* boneData = skeletonData->bones[i];
+		writeString(&writer, boneData->name);
+		writeVarint(&writer, boneData->parent ? findBoneIndex(skeletonData, boneData->parent) + 1 : 0);
+		writeFloat(&writer, boneData->length);
+		writeFloat(&writer, boneData->x);
+		writeFloat(&writer, boneData->y);
+		writeFloat(&writer, boneData->rotation);
+		writeFloat(&writer, boneData->scaleX);
+		writeFloat(&writer, boneData->scaleY);
+	}
+
+	writeVarint(&writer, skeletonData->slotCount);
+	for (i = 0; i < skeletonData->slotCount; ++i) {
+		const SlotData* slotData = skeletonData->slots[i];
+		writeString(&writer, slotData->name);
+		writeVarint(&writer, findBoneIndex(skeletonData, slotData->boneData));
+		writeString(&writer, slotData->attachmentName);
+		writeFloat(&writer, slotData->r);
+		writeFloat(&writer, slotData->g);
+		writeFloat(&writer, slotData->b);
+		writeFloat(&writer, slotData->a);
+	}
+
+	writeVarint(&writer, skeletonData->skinCount);
+	int defaultSkin = 0;
+	for (i = 0; i < skeletonData->skinCount; ++i)
+		if (skeletonData->skins[i] == skeletonData->defaultSkin) defaultSkin = i + 1;
+	writeVarint(&writer, defaultSkin);
+	for (i = 0; i < skeletonData->skinCount; ++i) {
+		const Skin* skin = skeletonData->skins[i];
+		writeString(&writer, skin->name);
+
+		int slotIndex;
+		const char* name;
+		Attachment* attachment;
+		int attachmentCount = 0;
+		while (_Skin_getEntry(skin, attachmentCount, &slotIndex, &name, &attachment))
+			attachmentCount++;
+		writeVarint(&writer, attachmentCount);
+		for (ii = attachmentCount - 1; ii >= 0; --ii) {
+			_Skin_getEntry(skin, ii, &slotIndex, &name, &attachment);
+			writeVarint(&writer, slotIndex);
+			writeString(&writer, name);
+			writeString(&writer, strcmp(attachment->name, name) == 0 ? 0 : attachment->name);
+			writeByte(&writer, attachment->type);
+			const RegionAttachment* regionAttachment = (const RegionAttachment*)attachment;
+			writeFloat(&writer, regionAttachment->x);
+			writeFloat(&writer, regionAttachment->y);
+			writeFloat(&writer, regionAttachment->scaleX);
+			writeFloat(&writer, regionAttachment->scaleY);
+			writeFloat(&writer, regionAttachment->rotation);
+			writeFloat(&writer, regionAttachment->width);
+			writeFloat(&writer, regionAttachment->height);
+		}
+	}
+
+	writeVarint(&writer, skeletonData->animationCount);
+	for (i = 0; i < skeletonData->animationCount; ++i) {
+		if (!writeAnimation(&writer, skeletonData->animations[i])) {
+			FREE(writer.data);
+			return 0;
+		}
+	}
+
+	*length = writer.length;
+	return writer.data;
+}
+
+int/*bool*/SkeletonBinary_writeSkeletonDataFile (const SkeletonData* skeletonData, const char* path) {
+	int length;
+	unsigned char* binary = SkeletonBinary_writeSkeletonData(skeletonData, &length);
+	if (!binary) return 0;
+	FILE* file = fopen(path, "wb");
+	int written = file ? (int)fwrite(binary, 1, length, file) : 0;
+	if (file) fclose(file);
+	FREE(binary);
+	return written == length;
+}
+
+}} // namespace cocos2d { namespace extension {
@@ -0,0 +1,59 @@
+/* Copyright (c) 2013 cocos2d-x.org
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SPINE_SKELETONBINARY_H_
+#define SPINE_SKELETONBINARY_H_
+
+#include <spine/Attachment.h>
+#include <spine/AttachmentLoader.h>
+#include <spine/SkeletonData.h>
+#include <spine/Atlas.h>
+#include <spine/Animation.h>
+
+namespace cocos2d { namespace extension {
+
+/* A compact binary form of SkeletonData. It holds the same data as the JSON format, with names resolved to indices and
+ * curves stored already evaluated, so reading it is a straight copy into the runtime structures. Write it from
+ * SkeletonData read from JSON with a scale of 1; the scale is applied again when the binary is read. */
+typedef struct {
+	float scale;
+	AttachmentLoader* attachmentLoader;
+	const char* const error;
+} SkeletonBinary;
+
+SkeletonBinary* SkeletonBinary_createWithLoader (AttachmentLoader* attachmentLoader);
+SkeletonBinary* SkeletonBinary_create (Atlas* atlas);
+void SkeletonBinary_dispose (SkeletonBinary* self);
+
+SkeletonData* SkeletonBinary_readSkeletonData (SkeletonBinary* self, const unsigned char* binary, int length);
+SkeletonData* SkeletonBinary_readSkeletonDataFile (SkeletonBinary* self, const char* path);
+
+/* Returns 1 if the data starts with the binary skeleton signature. */
+int/*bool*/SkeletonBinary_isBinary (const unsigned char* data, int length);
+
+/* Returns the binary form of the skeleton data, to be released with FREE, or 0 if it uses an unsupported timeline. */
+unsigned char* SkeletonBinary_writeSkeletonData (const SkeletonData* skeletonData, int* length);
+/* Returns 0 if the file could not be written. */
+int/*bool*/SkeletonBinary_writeSkeletonDataFile (const SkeletonData* skeletonData, const char* path);
+
+}} // namespace cocos2d { namespace extension {
+
+#endif /* SPINE_SKELETONBINARY_H_ */
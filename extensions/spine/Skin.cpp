@@ -91,6 +91,19 @@ Attachment* Skin_getAttachment (const Skin* self, int slotIndex, const char* nam
 	return 0;
 }
 
+int/*bool*/_Skin_getEntry (const Skin* self, int index, int* slotIndex, const char** name, Attachment** attachment) {
+	const _Entry* entry = SUB_CAST(_Internal, self) ->entries;
+	while (entry && index > 0) {
+		entry = entry->next;
+		index--;
+	}
+	if (!entry) return 0;
+	*slotIndex = entry->slotIndex;
+	*name = entry->name;
+	*attachment = entry->attachment;
+	return 1;
+}
+
 void Skin_attachAll (const Skin* self, Skeleton* skeleton, const Skin* oldSkin) {
 	const _Entry *entry = SUB_CAST(_Internal, oldSkin) ->entries;
 	while (entry) {
@@ -128,11 +128,23 @@ void _Attachment_deinit (Attachment* self);
 
 /**/
 
+/* Gets the skin's attachment at index, counting from the most recently added. Returns 0 once index is past the last one. */
+int/*bool*/_Skin_getEntry (const Skin* self, int index, int* slotIndex, const char** name, Attachment** attachment);
+
+/**/
+
 void _Timeline_init (Timeline* self, //
 		void (*dispose) (Timeline* self), //
 		void (*apply) (const Timeline* self, Skeleton* skeleton, float time, float alpha));
 void _Timeline_deinit (Timeline* self);
 
+typedef enum {
+	_TIMELINE_ROTATE, _TIMELINE_TRANSLATE, _TIMELINE_SCALE, _TIMELINE_COLOR, _TIMELINE_ATTACHMENT, _TIMELINE_UNKNOWN
+} _TimelineType;
+
+/* Identifies the built-in timelines by their apply function. */
+_TimelineType _Timeline_getType (const Timeline* self);
+
 /**/
 
 void _CurveTimeline_init (CurveTimeline* self, int frameCount, //
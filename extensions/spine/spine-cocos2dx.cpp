@@ -25,6 +25,7 @@
 
 #include <spine/spine-cocos2dx.h>
 #include <spine/extension.h>
+#include <pthread.h>
 
 USING_NS_CC;
 using std::min;
@@ -52,7 +53,7 @@ void _AtlasPage_disposeTexture (AtlasPage* self) {
 
 char* _Util_readFile (const char* path, int* length) {
 	unsigned long size;
-    char* data = reinterpret_cast<char*>(CCFileUtils::sharedFileUtils()->getFileData(path, "r", &size));
+    char* data = reinterpret_cast<char*>(CCFileUtils::sharedFileUtils()->getFileData(path, "rb", &size));
 	*length = size;
 	return data;
 }
@@ -113,32 +114,66 @@ void RegionAttachment_updateQuad (RegionAttachment* self, Slot* slot, ccV3F_C4B_
 	}
 }
 
+void RegionAttachment_computeQuad (const RegionAttachment* self, const Slot* slot, const CCAffineTransform& transform,
+	const ccColor4B& color, ccV3F_C4B_T2F_Quad* quad) {
+	const Bone* bone = slot->bone;
+	// Concatenate the bone's world transform with the node transform once, then map all four corners with it.
+	float a = transform.a * bone->m00 + transform.c * bone->m10;
+	float b = transform.b * bone->m00 + transform.d * bone->m10;
+	float c = transform.a * bone->m01 + transform.c * bone->m11;
+	float d = transform.b * bone->m01 + transform.d * bone->m11;
+	float tx = transform.a * bone->worldX + transform.c * bone->worldY + transform.tx;
+	float ty = transform.b * bone->worldX + transform.d * bone->worldY + transform.ty;
+
+	// Offsets run bl, tl, tr, br. Computing them into a flat array first keeps the loop free of stores through the
+	// interleaved quad layout, so the compiler can vectorize it.
+	const float* offset = self->offset;
+	float vertices[8];
+	for (int i = 0; i < 8; i += 2) {
+		vertices[i] = offset[i] * a + offset[i + 1] * c + tx;
+		vertices[i + 1] = offset[i] * b + offset[i + 1] * d + ty;
+	}
+	quad->bl.vertices = vertex3(vertices[VERTEX_X1], vertices[VERTEX_Y1], 0);
+	quad->tl.vertices = vertex3(vertices[VERTEX_X2], vertices[VERTEX_Y2], 0);
+	quad->tr.vertices = vertex3(vertices[VERTEX_X3], vertices[VERTEX_Y3], 0);
+	quad->br.vertices = vertex3(vertices[VERTEX_X4], vertices[VERTEX_Y4], 0);
+
+	quad->bl.colors = color;
+	quad->tl.colors = color;
+	quad->tr.colors = color;
+	quad->br.colors = color;
+
+	const AtlasRegion* region = self->region;
+	if (region->rotate) {
+		quad->tl.texCoords = tex2(region->u, region->v2);
+		quad->tr.texCoords = tex2(region->u, region->v);
+		quad->br.texCoords = tex2(region->u2, region->v);
+		quad->bl.texCoords = tex2(region->u2, region->v2);
+	} else {
+		quad->bl.texCoords = tex2(region->u, region->v2);
+		quad->tl.texCoords = tex2(region->u, region->v);
+		quad->tr.texCoords = tex2(region->u2, region->v);
+		quad->br.texCoords = tex2(region->u2, region->v2);
+	}
+}
+
 /**/
 
 CCSkeleton* CCSkeleton::createWithFile (const char* skeletonDataFile, Atlas* atlas, float scale) {
-	SkeletonJson* json = SkeletonJson_create(atlas);
-	json->scale = scale;
-	SkeletonData* skeletonData = SkeletonJson_readSkeletonDataFile(json, skeletonDataFile);
-	SkeletonJson_dispose(json);
-	CCSkeleton* node = skeletonData ? createWithData(skeletonData) : 0;
-	node->ownsSkeleton = true;
+	SkeletonData* skeletonData = CCSkeletonDataCache::readSkeletonData(skeletonDataFile, atlas, scale);
+	if (!skeletonData) return 0;
+	CCSkeleton* node = createWithData(skeletonData);
+	node->ownsSkeletonData = true;
 	return node;
 }
 
 CCSkeleton* CCSkeleton::createWithFile (const char* skeletonDataFile, const char* atlasFile, float scale) {
-	Atlas* atlas = Atlas_readAtlasFile(atlasFile);
-	if (!atlas) return 0;
-	SkeletonJson* json = SkeletonJson_create(atlas);
-	json->scale = scale;
-	SkeletonData* skeletonData = SkeletonJson_readSkeletonDataFile(json, skeletonDataFile);
-	SkeletonJson_dispose(json);
-	if (!skeletonData) {
-		Atlas_dispose(atlas);
-		return 0;
-	}
+	CCSkeletonDataCache* cache = CCSkeletonDataCache::sharedSkeletonDataCache();
+	SkeletonData* skeletonData = cache->addSkeletonData(skeletonDataFile, atlasFile, scale);
+	if (!skeletonData) return 0;
 	CCSkeleton* node = createWithData(skeletonData);
-	node->ownsSkeleton = true;
-	node->atlas = atlas;
+	cache->retainSkeletonData(skeletonData);
+	node->usesCachedData = true;
 	return node;
 }
 
@@ -149,7 +184,7 @@ CCSkeleton* CCSkeleton::createWithData (SkeletonData* skeletonData, AnimationSta
 }
 
 CCSkeleton::CCSkeleton (SkeletonData *skeletonData, AnimationStateData *stateData) :
-				ownsSkeleton(false), ownsStateData(false), atlas(0),
+				ownsSkeletonData(false), ownsStateData(false), atlas(0), usesCachedData(false), batchNode(0),
 				skeleton(0), state(0), debugSlots(false), debugBones(false) {
 	CONST_CAST(Skeleton*, skeleton) = Skeleton_create(skeletonData);
 
@@ -169,61 +204,79 @@ CCSkeleton::CCSkeleton (SkeletonData *skeletonData, AnimationStateData *stateDat
 }
 
 CCSkeleton::~CCSkeleton () {
-	if (ownsSkeleton) Skeleton_dispose(skeleton);
+	SkeletonData* skeletonData = skeleton->data;
+	if (usesCachedData) CCSkeletonDataCache::sharedSkeletonDataCache()->releaseSkeletonData(skeletonData);
+	// The Skeleton is created per instance, so it is always ours; only the SkeletonData may be shared.
+	Skeleton_dispose(skeleton);
 	if (ownsStateData) AnimationStateData_dispose(state->data);
-	if (atlas) Atlas_dispose(atlas);
 	AnimationState_dispose(state);
+	// Disposed last: the skeleton and the animation state data point into it.
+	if (ownsSkeletonData) SkeletonData_dispose(skeletonData);
+	if (atlas) Atlas_dispose(atlas);
 }
 
 void CCSkeleton::update (float deltaTime) {
+	updateSkeleton(deltaTime);
+}
+
+void CCSkeleton::updateSkeleton (float deltaTime) {
 	Skeleton_update(skeleton, deltaTime);
 	AnimationState_update(state, deltaTime * timeScale);
 	AnimationState_apply(state, skeleton);
 	Skeleton_updateWorldTransform(skeleton);
 }
 
-void CCSkeleton::draw () {
-	CC_NODE_DRAW_SETUP();
+CCSkeletonBatchNode* CCSkeleton::getBatchNode () const {
+	return batchNode;
+}
 
-	ccGLBlendFunc(blendFunc.src, blendFunc.dst);
+static void flushTextureAtlas (CCTextureAtlas* textureAtlas) {
+	if (!textureAtlas) return;
+	textureAtlas->drawQuads();
+	textureAtlas->removeAllQuads();
+}
+
+CCTextureAtlas* CCSkeleton::batchQuads (const CCAffineTransform& transform, CCTextureAtlas* textureAtlas) {
 	ccColor3B color = getColor();
 	skeleton->r = color.r / (float)255;
 	skeleton->g = color.g / (float)255;
 	skeleton->b = color.b / (float)255;
 	skeleton->a = getOpacity() / (float)255;
 
-	CCTextureAtlas* textureAtlas = 0;
 	ccV3F_C4B_T2F_Quad quad;
-	quad.tl.vertices.z = 0;
-	quad.tr.vertices.z = 0;
-	quad.bl.vertices.z = 0;
-	quad.br.vertices.z = 0;
 	for (int i = 0, n = skeleton->slotCount; i < n; i++) {
 		Slot* slot = skeleton->slots[i];
 		if (!slot->attachment || slot->attachment->type != ATTACHMENT_REGION) continue;
 		RegionAttachment* attachment = (RegionAttachment*)slot->attachment;
 		CCTextureAtlas* regionTextureAtlas = (CCTextureAtlas*)attachment->region->page->texture;
 		if (regionTextureAtlas != textureAtlas) {
-			if (textureAtlas) {
-				textureAtlas->drawQuads();
-				textureAtlas->removeAllQuads();
-			}
+			flushTextureAtlas(textureAtlas);
+			textureAtlas = regionTextureAtlas;
 		}
-		textureAtlas = regionTextureAtlas;
 		if (textureAtlas->getCapacity() == textureAtlas->getTotalQuads() &&
-			!textureAtlas->resizeCapacity(textureAtlas->getCapacity() * 2)) return;
-		RegionAttachment_updateQuad(attachment, slot, &quad);
+			!textureAtlas->resizeCapacity(textureAtlas->getCapacity() * 2)) return textureAtlas;
+		ccColor4B slotColor = {
+			(GLubyte)(skeleton->r * slot->r * 255),
+			(GLubyte)(skeleton->g * slot->g * 255),
+			(GLubyte)(skeleton->b * slot->b * 255),
+			(GLubyte)(skeleton->a * slot->a * 255)
+		};
+		RegionAttachment_computeQuad(attachment, slot, transform, slotColor, &quad);
 		textureAtlas->updateQuad(&quad, textureAtlas->getTotalQuads());
 	}
-	if (textureAtlas) {
-		textureAtlas->drawQuads();
-		textureAtlas->removeAllQuads();
-	}
+	return textureAtlas;
+}
+
+void CCSkeleton::draw () {
+	CC_NODE_DRAW_SETUP();
+
+	ccGLBlendFunc(blendFunc.src, blendFunc.dst);
+	flushTextureAtlas(batchQuads(CCAffineTransformIdentity, 0));
 
 	if (debugSlots) {
 		// Slots.
 		ccDrawColor4B(0, 0, 255, 255);
-		glLineWidth(1);
+		ccLineWidth(1);
 		CCPoint points[4];
 		ccV3F_C4B_T2F_Quad quad;
 		for (int i = 0, n = skeleton->slotCount; i < n; i++) {
@@ -240,7 +293,7 @@ void CCSkeleton::draw () {
 	}
 	if (debugBones) {
 		// Bone lengths.
-		glLineWidth(2);
+		ccLineWidth(2);
 		ccDrawColor4B(255, 0, 0, 255);
 		for (int i = 0, n = skeleton->boneCount; i < n; i++) {
 			Bone *bone = skeleton->bones[i];
@@ -304,4 +357,397 @@ void CCSkeleton::setBlendFunc (ccBlendFunc blendFunc) {
     this->blendFunc = blendFunc;
 }
 
+/**/
+
+static CCSkeletonDataCache* s_sharedSkeletonDataCache = 0;
+
+CCSkeletonDataCache* CCSkeletonDataCache::sharedSkeletonDataCache () {
+	if (!s_sharedSkeletonDataCache) s_sharedSkeletonDataCache = new CCSkeletonDataCache();
+	return s_sharedSkeletonDataCache;
+}
+
+void CCSkeletonDataCache::purgeSharedSkeletonDataCache () {
+	CC_SAFE_DELETE(s_sharedSkeletonDataCache);
+}
+
+CCSkeletonDataCache::~CCSkeletonDataCache () {
+	for (std::map<std::string, SkeletonDataEntry>::iterator it = skeletonDataEntries.begin(); it != skeletonDataEntries.end(); ++it) {
+		CCAssert(it->second.useCount == 0, "CCSkeletonDataCache: skeleton data is still used by a node");
+		SkeletonData_dispose(it->second.skeletonData);
+	}
+	for (std::map<std::string, AtlasEntry>::iterator it = atlasEntries.begin(); it != atlasEntries.end(); ++it)
+		Atlas_dispose(it->second.atlas);
+}
+
+Atlas* CCSkeletonDataCache::addAtlas (const char* atlasFile) {
+	std::string key = CCFileUtils::sharedFileUtils()->fullPathForFilename(atlasFile);
+	std::map<std::string, AtlasEntry>::iterator it = atlasEntries.find(key);
+	if (it != atlasEntries.end()) return it->second.atlas;
+
+	Atlas* atlas = Atlas_readAtlasFile(atlasFile);
+	if (!atlas) {
+		CCLOG("CCSkeletonDataCache: unable to read atlas %s", atlasFile);
+		return 0;
+	}
+	AtlasEntry entry = {atlas, 0};
+	atlasEntries[key] = entry;
+	return atlas;
+}
+
+SkeletonData* CCSkeletonDataCache::addSkeletonData (const char* skeletonDataFile, const char* atlasFile, float scale) {
+	std::string atlasKey = CCFileUtils::sharedFileUtils()->fullPathForFilename(atlasFile);
+	// The scale is baked into the data, so the same file read at another scale is a separate entry.
+	char scaleSuffix[32];
+	sprintf(scaleSuffix, "@%g|", scale);
+	std::string key = CCFileUtils::sharedFileUtils()->fullPathForFilename(skeletonDataFile) + scaleSuffix + atlasKey;
+	std::map<std::string, SkeletonDataEntry>::iterator it = skeletonDataEntries.find(key);
+	if (it != skeletonDataEntries.end()) return it->second.skeletonData;
+
+	Atlas* atlas = addAtlas(atlasFile);
+	if (!atlas) return 0;
+	SkeletonData* skeletonData = readSkeletonData(skeletonDataFile, atlas, scale);
+	if (!skeletonData) return 0;
+
+	SkeletonDataEntry entry;
+	entry.skeletonData = skeletonData;
+	entry.atlasKey = atlasKey;
+	entry.useCount = 0;
+	skeletonDataEntries[key] = entry;
+	atlasEntries[atlasKey].useCount++;
+	return skeletonData;
+}
+
+void CCSkeletonDataCache::retainSkeletonData (SkeletonData* skeletonData) {
+	for (std::map<std::string, SkeletonDataEntry>::iterator it = skeletonDataEntries.begin(); it != skeletonDataEntries.end(); ++it) {
+		if (it->second.skeletonData == skeletonData) {
+			it->second.useCount++;
+			return;
+		}
+	}
+	CCAssert(false, "CCSkeletonDataCache: skeleton data is not cached");
+}
+
+void CCSkeletonDataCache::releaseSkeletonData (SkeletonData* skeletonData) {
+	for (std::map<std::string, SkeletonDataEntry>::iterator it = skeletonDataEntries.begin(); it != skeletonDataEntries.end(); ++it) {
+		if (it->second.skeletonData == skeletonData) {
+			CCAssert(it->second.useCount > 0, "CCSkeletonDataCache: unbalanced release");
+			it->second.useCount--;
+			return;
+		}
+	}
+}
+
+void CCSkeletonDataCache::removeUnusedData () {
+	std::map<std::string, SkeletonDataEntry>::iterator it = skeletonDataEntries.begin();
+	while (it != skeletonDataEntries.end()) {
+		if (it->second.useCount == 0) {
+			SkeletonData_dispose(it->second.skeletonData);
+			atlasEntries[it->second.atlasKey].useCount--;
+			skeletonDataEntries.erase(it++);
+		} else {
+			++it;
+		}
+	}
+
+	std::map<std::string, AtlasEntry>::iterator atlasIt = atlasEntries.begin();
+	while (atlasIt != atlasEntries.end()) {
+		if (atlasIt->second.useCount == 0) {
+			Atlas_dispose(atlasIt->second.atlas);
+			atlasEntries.erase(atlasIt++);
+		} else {
+			++atlasIt;
+		}
+	}
+}
+
+SkeletonData* CCSkeletonDataCache::readSkeletonData (const char* skeletonDataFile, Atlas* atlas, float scale) {
+	int length;
+	char* data = _Util_readFile(skeletonDataFile, &length);
+	if (!data) {
+		CCLOG("CCSkeletonDataCache: unable to read skeleton file %s", skeletonDataFile);
+		return 0;
+	}
+
+	SkeletonData* skeletonData;
+	if (SkeletonBinary_isBinary((const unsigned char*)data, length)) {
+		SkeletonBinary* binary = SkeletonBinary_create(atlas);
+		binary->scale = scale;
+		skeletonData = SkeletonBinary_readSkeletonData(binary, (const unsigned char*)data, length);
+		if (!skeletonData) CCLOG("CCSkeletonDataCache: %s: %s", skeletonDataFile, binary->error);
+		SkeletonBinary_dispose(binary);
+	} else {
+		// The file data is not null terminated.
+		char* text = MALLOC(char, length + 1);
+		memcpy(text, data, length);
+		text[length] = '\0';
+		SkeletonJson* json = SkeletonJson_create(atlas);
+		json->scale = scale;
+		skeletonData = SkeletonJson_readSkeletonData(json, text);
+		if (!skeletonData) CCLOG("CCSkeletonDataCache: %s: %s", skeletonDataFile, json->error);
+		SkeletonJson_dispose(json);
+		FREE(text);
+	}
+	FREE(data);
+	return skeletonData;
+}
+
+bool CCSkeletonDataCache::convertToBinary (const char* jsonFile, const char* atlasFile, const char* binaryPath) {
+	Atlas* atlas = Atlas_readAtlasFile(atlasFile);
+	if (!atlas) {
+		CCLOG("CCSkeletonDataCache: unable to read atlas %s", atlasFile);
+		return false;
+	}
+	// Written unscaled; the scale is applied when the binary is read.
+	SkeletonData* skeletonData = readSkeletonData(jsonFile, atlas, 1);
+	bool written = skeletonData && SkeletonBinary_writeSkeletonDataFile(skeletonData, binaryPath);
+	if (skeletonData && !written) CCLOG("CCSkeletonDataCache: unable to write %s", binaryPath);
+	if (skeletonData) SkeletonData_dispose(skeletonData);
+	Atlas_dispose(atlas);
+	return written;
+}
+
+/**/
+
+/* Runs CCSkeleton::updateSkeleton over a list of skeletons, split into contiguous ranges: one per worker thread plus one
+ * for the calling thread. */
+class CCSkeletonUpdatePool {
+public:
+	CCSkeletonUpdatePool (int threadCount);
+	~CCSkeletonUpdatePool ();
+
+	int getThreadCount () const { return threadCount; }
+
+	void run (CCSkeleton** skeletons, int count, float deltaTime);
+
+private:
+	struct Worker {
+		CCSkeletonUpdatePool* pool;
+		int index;
+		pthread_t thread;
+	};
+
+	static void* workerMain (void* data);
+	void updateRange (int part);
+
+	int threadCount;
+	Worker* workers;
+	pthread_mutex_t mutex;
+	pthread_cond_t workCondition;
+	pthread_cond_t doneCondition;
+	unsigned int generation;
+	int pending;
+	bool quit;
+
+	CCSkeleton** skeletons;
+	int count;
+	float deltaTime;
+};
+
+CCSkeletonUpdatePool::CCSkeletonUpdatePool (int threadCount) :
+				threadCount(0), workers(0), generation(0), pending(0), quit(false), skeletons(0), count(0), deltaTime(0) {
+	pthread_mutex_init(&mutex, NULL);
+	pthread_cond_init(&workCondition, NULL);
+	pthread_cond_init(&doneCondition, NULL);
+
+	workers = new Worker[threadCount];
+	for (int i = 0; i < threadCount; i++) {
+		workers[i].pool = this;
+		workers[i].index = i + 1;
+		if (pthread_create(&workers[i].thread, NULL, workerMain, &workers[i]) != 0) {
+			CCLOG("CCSkeletonUpdatePool: failed to start worker thread, using %d", this->threadCount);
+			break;
+		}
+		this->threadCount++;
+	}
+}
+
+CCSkeletonUpdatePool::~CCSkeletonUpdatePool () {
+	pthread_mutex_lock(&mutex);
+	quit = true;
+	pthread_cond_broadcast(&workCondition);
+	pthread_mutex_unlock(&mutex);
+	for (int i = 0; i < threadCount; i++)
+		pthread_join(workers[i].thread, NULL);
+	delete[] workers;
+
+	pthread_cond_destroy(&doneCondition);
+	pthread_cond_destroy(&workCondition);
+	pthread_mutex_destroy(&mutex);
+}
+
+void CCSkeletonUpdatePool::run (CCSkeleton** skeletons, int count, float deltaTime) {
+	pthread_mutex_lock(&mutex);
+	this->skeletons = skeletons;
+	this->count = count;
+	this->deltaTime = deltaTime;
+	pending = threadCount;
+	generation++;
+	pthread_cond_broadcast(&workCondition);
+	pthread_mutex_unlock(&mutex);
+
+	updateRange(0);
+
+	pthread_mutex_lock(&mutex);
+	while (pending > 0)
+		pthread_cond_wait(&doneCondition, &mutex);
+	pthread_mutex_unlock(&mutex);
+}
+
+void CCSkeletonUpdatePool::updateRange (int part) {
+	int parts = threadCount + 1;
+	int start = count * part / parts;
+	int end = count * (part + 1) / parts;
+	for (int i = start; i < end; i++)
+		skeletons[i]->updateSkeleton(deltaTime);
+}
+
+void* CCSkeletonUpdatePool::workerMain (void* data) {
+	Worker* worker = (Worker*)data;
+	CCSkeletonUpdatePool* pool = worker->pool;
+	unsigned int seen = 0;
+
+	pthread_mutex_lock(&pool->mutex);
+	while (true) {
+		while (!pool->quit && pool->generation == seen)
+			pthread_cond_wait(&pool->workCondition, &pool->mutex);
+		if (pool->quit) break;
+		seen = pool->generation;
+		pthread_mutex_unlock(&pool->mutex);
+
+		pool->updateRange(worker->index);
+
+		pthread_mutex_lock(&pool->mutex);
+		if (--pool->pending == 0) pthread_cond_signal(&pool->doneCondition);
+	}
+	pthread_mutex_unlock(&pool->mutex);
+	return NULL;
+}
+
+/**/
+
+CCSkeletonBatchNode* CCSkeletonBatchNode::create () {
+	CCSkeletonBatchNode* node = new CCSkeletonBatchNode();
+	node->autorelease();
+	return node;
+}
+
+CCSkeletonBatchNode::CCSkeletonBatchNode () : updatePool(0) {
+	setShaderProgram(CCShaderCache::sharedShaderCache()->programForKey(kCCShader_PositionTextureColor));
+	scheduleUpdate();
+}
+
+CCSkeletonBatchNode::~CCSkeletonBatchNode () {
+	delete updatePool;
+}
+
+void CCSkeletonBatchNode::setThreadCount (int threadCount) {
+	if (threadCount == getThreadCount()) return;
+	delete updatePool;
+	updatePool = threadCount > 0 ? new CCSkeletonUpdatePool(threadCount) : 0;
+}
+
+int CCSkeletonBatchNode::getThreadCount () const {
+	return updatePool ? updatePool->getThreadCount() : 0;
+}
+
+void CCSkeletonBatchNode::addChild (CCNode* child) {
+	CCNode::addChild(child);
+}
+
+void CCSkeletonBatchNode::addChild (CCNode* child, int zOrder) {
+	CCNode::addChild(child, zOrder);
+}
+
+void CCSkeletonBatchNode::addChild (CCNode* child, int zOrder, int tag) {
+	CCSkeleton* skeleton = dynamic_cast<CCSkeleton*>(child);
+	CCAssert(skeleton, "CCSkeletonBatchNode only supports CCSkeleton children");
+	CCNode::addChild(child, zOrder, tag);
+	// The batch node advances its children itself.
+	skeleton->unscheduleUpdate();
+	skeleton->batchNode = this;
+}
+
+void CCSkeletonBatchNode::removeChild (CCNode* child, bool cleanup) {
+	if (!child || !m_pChildren || !m_pChildren->containsObject(child)) return;
+	CCSkeleton* skeleton = (CCSkeleton*)child;
+	skeleton->batchNode = 0;
+	// Rescheduled before removal so cleanup unschedules it again.
+	skeleton->scheduleUpdate();
+	CCNode::removeChild(child, cleanup);
+}
+
+void CCSkeletonBatchNode::removeAllChildrenWithCleanup (bool cleanup) {
+	CCObject* child;
+	CCARRAY_FOREACH(m_pChildren, child) {
+		CCSkeleton* skeleton = (CCSkeleton*)child;
+		skeleton->batchNode = 0;
+		skeleton->scheduleUpdate();
+	}
+	CCNode::removeAllChildrenWithCleanup(cleanup);
+}
+
+void CCSkeletonBatchNode::update (float deltaTime) {
+	if (!m_pChildren || m_pChildren->count() == 0) return;
+
+	updateList.clear();
+	CCObject* child;
+	CCARRAY_FOREACH(m_pChildren, child) {
+		updateList.push_back((CCSkeleton*)child);
+	}
+
+	int count = (int)updateList.size();
+	if (updatePool && count > 1) {
+		updatePool->run(&updateList[0], count, deltaTime);
+	} else {
+		for (int i = 0; i < count; i++)
+			updateList[i]->updateSkeleton(deltaTime);
+	}
+}
+
+void CCSkeletonBatchNode::visit () {
+	// Same as CCNode::visit, except that the children are drawn by draw() rather than visited.
+	if (!m_bVisible) return;
+
+	kmGLPushMatrix();
+
+	if (m_pGrid && m_pGrid->isActive()) {
+		m_pGrid->beforeDraw();
+		transformAncestors();
+	}
+
+	sortAllChildren();
+	transform();
+	draw();
+
+	if (m_pGrid && m_pGrid->isActive()) {
+		m_pGrid->afterDraw(this);
+	}
+
+	kmGLPopMatrix();
+}
+
+void CCSkeletonBatchNode::draw () {
+	if (!m_pChildren || m_pChildren->count() == 0) return;
+
+	CC_NODE_DRAW_SETUP();
+
+	CCTextureAtlas* textureAtlas = 0;
+	ccBlendFunc blendFunc = {0, 0};
+	CCObject* child;
+	CCARRAY_FOREACH(m_pChildren, child) {
+		CCSkeleton* skeleton = (CCSkeleton*)child;
+		if (!skeleton->isVisible()) continue;
+
+		ccBlendFunc skeletonBlendFunc = skeleton->getBlendFunc();
+		if (skeletonBlendFunc.src != blendFunc.src || skeletonBlendFunc.dst != blendFunc.dst) {
+			flushTextureAtlas(textureAtlas);
+			textureAtlas = 0;
+			blendFunc = skeletonBlendFunc;
+			ccGLBlendFunc(blendFunc.src, blendFunc.dst);
+		}
+		textureAtlas = skeleton->batchQuads(skeleton->nodeToParentTransform(), textureAtlas);
+	}
+	flushTextureAtlas(textureAtlas);
+}
+
 }} // namespace cocos2d { namespace extension {
@@ -28,14 +28,23 @@
 
 #include <spine/spine.h>
 #include "cocos2d.h"
+#include <map>
+#include <string>
+#include <vector>
 
 namespace cocos2d { namespace extension {
 
+class CCSkeletonBatchNode;
+
 class CCSkeleton: public cocos2d::CCNodeRGBA, public cocos2d::CCBlendProtocol {
 private:
-	bool ownsSkeleton;
+	bool ownsSkeletonData;
 	bool ownsStateData;
 	Atlas* atlas;
+	bool usesCachedData;
+	CCSkeletonBatchNode* batchNode;
+
+	friend class CCSkeletonBatchNode;
 
 public:
 	Skeleton* const skeleton;
@@ -44,7 +53,10 @@ public:
 	bool debugSlots;
 	bool debugBones;
 
+	/* The skeleton data file may be JSON or binary (see SkeletonBinary). The node owns the SkeletonData it reads, the
+	 * atlas stays the caller's. */
 	static CCSkeleton* createWithFile (const char* skeletonDataFile, Atlas* atlas, float scale = 1);
+	/* Shares the SkeletonData and Atlas through CCSkeletonDataCache, so only the first instance reads the files. */
 	static CCSkeleton* createWithFile (const char* skeletonDataFile, const char* atlasFile, float scale = 1);
 	static CCSkeleton* createWithData (SkeletonData* skeletonData, AnimationStateData* stateData = 0);
 
@@ -55,14 +67,107 @@ public:
 	virtual void draw ();
 	virtual cocos2d::CCRect boundingBox ();
 
+	/* Advances the animation and poses the bones. Touches only this instance's Skeleton and AnimationState, so
+	 * CCSkeletonBatchNode may call it for many skeletons at once from worker threads. */
+	void updateSkeleton (float deltaTime);
+
+	/* Returns the batch node drawing this skeleton, or 0 if it draws itself. */
+	CCSkeletonBatchNode* getBatchNode () const;
+
 	// CCBlendProtocol
 	CC_PROPERTY(cocos2d::ccBlendFunc, blendFunc, BlendFunc);
+
+protected:
+	/* Appends the region quads, transformed by the given transform, to the AtlasPage texture atlases. textureAtlas holds
+	 * quads not yet drawn; it is flushed whenever the page changes. Returns the atlas holding the last unflushed quads. */
+	cocos2d::CCTextureAtlas* batchQuads (const cocos2d::CCAffineTransform& transform, cocos2d::CCTextureAtlas* textureAtlas);
+};
+
+/* Process-wide cache of SkeletonData and Atlas keyed by file, so creating many instances of a character reads and parses
+ * its files once. Entries stay alive while a CCSkeleton created from them exists; removeUnusedData disposes the rest. */
+class CCSkeletonDataCache {
+public:
+	static CCSkeletonDataCache* sharedSkeletonDataCache ();
+	/* Disposes all cached data. No CCSkeleton created through the cache may be alive. */
+	static void purgeSharedSkeletonDataCache ();
+
+	virtual ~CCSkeletonDataCache ();
+
+	/* Returns the atlas for the file, reading it on first use, or 0 if it cannot be read. */
+	Atlas* addAtlas (const char* atlasFile);
+	/* Returns the skeleton data for the JSON or binary file, reading it on first use, or 0 if it cannot be read. */
+	SkeletonData* addSkeletonData (const char* skeletonDataFile, const char* atlasFile, float scale = 1);
+
+	/* Marks cached skeleton data as in use, or no longer in use, by a node. */
+	void retainSkeletonData (SkeletonData* skeletonData);
+	void releaseSkeletonData (SkeletonData* skeletonData);
+
+	/* Disposes the skeleton data no node uses, and the atlases no remaining skeleton data uses. */
+	void removeUnusedData ();
+
+	/* Reads a JSON or binary skeleton data file. Returns 0 and logs the error if it cannot be read. */
+	static SkeletonData* readSkeletonData (const char* skeletonDataFile, Atlas* atlas, float scale);
+
+	/* Converts a JSON skeleton data file to the binary format, which loads without any parsing. Returns false and logs
+	 * the error if the conversion fails. */
+	static bool convertToBinary (const char* jsonFile, const char* atlasFile, const char* binaryPath);
+
+private:
+	struct SkeletonDataEntry {
+		SkeletonData* skeletonData;
+		std::string atlasKey;
+		int useCount;
+	};
+	struct AtlasEntry {
+		Atlas* atlas;
+		int useCount;
+	};
+
+	std::map<std::string, SkeletonDataEntry> skeletonDataEntries;
+	std::map<std::string, AtlasEntry> atlasEntries;
+};
+
+class CCSkeletonUpdatePool;
+
+/* Draws its CCSkeleton children with as few draw calls as possible: consecutive skeletons sharing an atlas page and blend
+ * function go into a single draw. It also advances the animation of all children in one pass, optionally spread across
+ * worker threads. Only CCSkeleton children are allowed, and their own children are not visited. */
+class CCSkeletonBatchNode: public cocos2d::CCNode {
+public:
+	static CCSkeletonBatchNode* create ();
+
+	CCSkeletonBatchNode ();
+	virtual ~CCSkeletonBatchNode ();
+
+	/* Sets the number of worker threads used to update the children, in addition to the main thread. 0 (the default)
+	 * updates them all on the main thread. */
+	void setThreadCount (int threadCount);
+	int getThreadCount () const;
+
+	virtual void addChild (cocos2d::CCNode* child);
+	virtual void addChild (cocos2d::CCNode* child, int zOrder);
+	virtual void addChild (cocos2d::CCNode* child, int zOrder, int tag);
+	virtual void removeChild (cocos2d::CCNode* child, bool cleanup);
+	virtual void removeAllChildrenWithCleanup (bool cleanup);
+
+	virtual void update (float deltaTime);
+	virtual void visit ();
+	virtual void draw ();
+
+private:
+	CCSkeletonUpdatePool* updatePool;
+	std::vector<CCSkeleton*> updateList;
 };
 
 /**/
 
 void RegionAttachment_updateQuad (RegionAttachment* self, Slot* slot, cocos2d::ccV3F_C4B_T2F_Quad* quad);
 
+/* Like RegionAttachment_updateQuad, but concatenates the bone with the given transform in the same pass, takes the color
+ * already computed and never writes the attachment's vertices, which are shared by every skeleton using the same data. */
+void RegionAttachment_computeQuad (const RegionAttachment* self, const Slot* slot, const cocos2d::CCAffineTransform& transform,
+	const cocos2d::ccColor4B& color, cocos2d::ccV3F_C4B_T2F_Quad* quad);
+
 }} // namespace cocos2d { namespace extension {
 
 #endif /* SPINE_COCOS2DX_H_ */
@@ -37,6 +37,7 @@
 #include <spine/BoneData.h>
 #include <spine/RegionAttachment.h>
 #include <spine/Skeleton.h>
+#include <spine/SkeletonBinary.h>
 #include <spine/SkeletonData.h>
 #include <spine/SkeletonJson.h>
 #include <spine/Skin.h>
@@ -24,6 +24,7 @@ Common/b2Draw.cpp \
 Common/b2Math.cpp \
 Common/b2Settings.cpp \
 Common/b2StackAllocator.cpp \
+Common/b2ThreadPool.cpp \
 Common/b2Timer.cpp \
 Dynamics/Contacts/b2ChainAndCircleContact.cpp \
 Dynamics/Contacts/b2ChainAndPolygonContact.cpp \
@@ -0,0 +1,52 @@
+/*
+* Copyright (c) 2013 cocos2d-x.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_TASK_SCHEDULER_H
+#define B2_TASK_SCHEDULER_H
+
+#include <Box2D/Common/b2Settings.h>
+
+/// A task run for every index of a range, possibly on several threads at once.
+class b2Task
+{
+public:
+    virtual ~b2Task() {}
+
+    /// Run the task for one index.
+    /// @param index the index in the range.
+    /// @param threadIndex the thread running it, in [0, b2TaskScheduler::GetThreadCount()).
+    /// A thread runs one index at a time: data indexed by thread needs no locking.
+    virtual void Run(int32 index, int32 threadIndex) = 0;
+};
+
+/// Runs tasks on several threads. The world uses it to solve its islands
+/// in parallel, see b2World::SetTaskScheduler. Implement it to use your own
+/// job system, or use b2ThreadPool.
+class b2TaskScheduler
+{
+public:
+    virtual ~b2TaskScheduler() {}
+
+    /// The number of threads running the tasks, the calling thread included.
+    virtual int32 GetThreadCount() const = 0;
+
+    /// Run the task for every index in [0, count) and return once all are done.
+    virtual void ParallelFor(b2Task* task, int32 count) = 0;
+};
+
+#endif
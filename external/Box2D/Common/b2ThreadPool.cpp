@@ -0,0 +1,168 @@
+/*
+* Copyright (c) 2013 cocos2d-x.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <Box2D/Common/b2ThreadPool.h>
+
+b2ThreadPool::b2ThreadPool(int32 threadCount)
+{
+    pthread_mutex_init(&m_mutex, NULL);
+    pthread_cond_init(&m_workCondition, NULL);
+    pthread_cond_init(&m_doneCondition, NULL);
+
+    m_task = NULL;
+    m_taskCount = 0;
+    m_nextIndex = 0;
+    m_busyWorkers = 0;
+    m_generation = 0;
+    m_quit = false;
+
+    m_workerCount = 0;
+    m_workers = NULL;
+    if (threadCount > 1)
+    {
+        m_workers = (b2Worker*)b2Alloc((threadCount - 1) * sizeof(b2Worker));
+    }
+
+    for (int32 i = 0; i < threadCount - 1; ++i)
+    {
+        b2Worker* worker = m_workers + m_workerCount;
+        worker->pool = this;
+        // The calling thread is thread 0.
+        worker->threadIndex = m_workerCount + 1;
+        if (pthread_create(&worker->thread, NULL, WorkerMain, worker) != 0)
+        {
+            break;
+        }
+        ++m_workerCount;
+    }
+}
+
+b2ThreadPool::~b2ThreadPool()
+{
+    pthread_mutex_lock(&m_mutex);
+    m_quit = true;
+    pthread_cond_broadcast(&m_workCondition);
+    pthread_mutex_unlock(&m_mutex);
+
+    for (int32 i = 0; i < m_workerCount; ++i)
+    {
+        pthread_join(m_workers[i].thread, NULL);
+    }
+    if (m_workers)
+    {
+        b2Free(m_workers);
+    }
+
+    pthread_cond_destroy(&m_doneCondition);
+    pthread_cond_destroy(&m_workCondition);
+    pthread_mutex_destroy(&m_mutex);
+}
+
+int32 b2ThreadPool::GetThreadCount() const
+{
+    return m_workerCount + 1;
+}
+
+void b2ThreadPool::ParallelFor(b2Task* task, int32 count)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+
+    if (m_workerCount == 0 || count == 1)
+    {
+        for (int32 i = 0; i < count; ++i)
+        {
+            task->Run(i, 0);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&m_mutex);
+    m_task = task;
+    m_taskCount = count;
+    m_nextIndex = 0;
+    m_busyWorkers = m_workerCount;
+    ++m_generation;
+    pthread_cond_broadcast(&m_workCondition);
+    pthread_mutex_unlock(&m_mutex);
+
+    RunTasks(0);
+
+    // Every worker takes part in a generation before the next one starts.
+    pthread_mutex_lock(&m_mutex);
+    while (m_busyWorkers > 0)
+    {
+        pthread_cond_wait(&m_doneCondition, &m_mutex);
+    }
+    m_task = NULL;
+    pthread_mutex_unlock(&m_mutex);
+}
+
+void b2ThreadPool::RunTasks(int32 threadIndex)
+{
+    for (;;)
+    {
+        pthread_mutex_lock(&m_mutex);
+        int32 index = m_nextIndex++;
+        pthread_mutex_unlock(&m_mutex);
+
+        if (index >= m_taskCount)
+        {
+            break;
+        }
+
+        m_task->Run(index, threadIndex);
+    }
+}
+
+void* b2ThreadPool::WorkerMain(void* data)
+{
+    b2Worker* worker = (b2Worker*)data;
+    b2ThreadPool* pool = worker->pool;
+    uint32 generation = 0;
+
+    pthread_mutex_lock(&pool->m_mutex);
+    for (;;)
+    {
+        while (pool->m_quit == false && pool->m_generation == generation)
+        {
+            pthread_cond_wait(&pool->m_workCondition, &pool->m_mutex);
+        }
+
+        if (pool->m_quit)
+        {
+            break;
+        }
+
+        generation = pool->m_generation;
+        pthread_mutex_unlock(&pool->m_mutex);
+
+        pool->RunTasks(worker->threadIndex);
+
+        pthread_mutex_lock(&pool->m_mutex);
+        if (--pool->m_busyWorkers == 0)
+        {
+            pthread_cond_signal(&pool->m_doneCondition);
+        }
+    }
+    pthread_mutex_unlock(&pool->m_mutex);
+
+    return NULL;
+}
@@ -0,0 +1,66 @@
+/*
+* Copyright (c) 2013 cocos2d-x.org
+*
+* This software is provided 'as-is', without any express or implied
+* warranty.  In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef B2_THREAD_POOL_H
+#define B2_THREAD_POOL_H
+
+#include <Box2D/Common/b2TaskScheduler.h>
+#include <pthread.h>
+
+/// A task scheduler running the tasks on a fixed set of POSIX threads.
+/// The thread calling ParallelFor runs tasks too.
+class b2ThreadPool : public b2TaskScheduler
+{
+public:
+    /// @param threadCount the threads running the tasks, the calling thread included.
+    /// It is lowered if the threads can't be created.
+    explicit b2ThreadPool(int32 threadCount);
+    ~b2ThreadPool();
+
+    int32 GetThreadCount() const;
+
+    void ParallelFor(b2Task* task, int32 count);
+
+private:
+
+    struct b2Worker
+    {
+        b2ThreadPool* pool;
+        int32 threadIndex;
+        pthread_t thread;
+    };
+
+    static void* WorkerMain(void* data);
+    void RunTasks(int32 threadIndex);
+
+    b2Worker* m_workers;
+    int32 m_workerCount;
+
+    pthread_mutex_t m_mutex;
+    pthread_cond_t m_workCondition;
+    pthread_cond_t m_doneCondition;
+
+    b2Task* m_task;
+    int32 m_taskCount;
+    int32 m_nextIndex;
+    int32 m_busyWorkers;
+    uint32 m_generation;
+    bool m_quit;
+};
+
+#endif
@@ -20,6 +20,7 @@
 
 #include <Box2D/Dynamics/Contacts/b2Contact.h>
 #include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Dynamics/b2Island.h>
 #include <Box2D/Dynamics/b2Fixture.h>
 #include <Box2D/Dynamics/b2World.h>
 #include <Box2D/Common/b2StackAllocator.h>
@@ -73,8 +74,8 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
         b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
         vc->friction = contact->m_friction;
         vc->restitution = contact->m_restitution;
-        vc->indexA = bodyA->m_islandIndex;
-        vc->indexB = bodyB->m_islandIndex;
+        vc->indexA = def->island->GetIndex(bodyA);
+        vc->indexB = def->island->GetIndex(bodyB);
         vc->invMassA = bodyA->m_invMass;
         vc->invMassB = bodyB->m_invMass;
         vc->invIA = bodyA->m_invI;
@@ -85,8 +86,8 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
         vc->normalMass.SetZero();
 
         b2ContactPositionConstraint* pc = m_positionConstraints + i;
-        pc->indexA = bodyA->m_islandIndex;
-        pc->indexB = bodyB->m_islandIndex;
+        pc->indexA = vc->indexA;
+        pc->indexB = vc->indexB;
         pc->invMassA = bodyA->m_invMass;
         pc->invMassB = bodyB->m_invMass;
         pc->localCenterA = bodyA->m_sweep.localCenter;
@@ -57,6 +57,7 @@ struct b2ContactVelocityConstraint
 
 struct b2ContactSolverDef
 {
+    const b2Island* island;
     b2TimeStep step;
     b2Contact** contacts;
     int32 count;
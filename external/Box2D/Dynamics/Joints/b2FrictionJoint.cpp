@@ -18,6 +18,7 @@
 
 #include <Box2D/Dynamics/Joints/b2FrictionJoint.h>
 #include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Dynamics/b2Island.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
 
 // Point-to-point constraint
@@ -55,8 +56,8 @@ b2FrictionJoint::b2FrictionJoint(const b2FrictionJointDef* def)
 
 void b2FrictionJoint::InitVelocityConstraints(const b2SolverData& data)
 {
-    m_indexA = m_bodyA->m_islandIndex;
-    m_indexB = m_bodyB->m_islandIndex;
+    m_indexA = data.island->GetIndex(m_bodyA);
+    m_indexB = data.island->GetIndex(m_bodyB);
     m_localCenterA = m_bodyA->m_sweep.localCenter;
     m_localCenterB = m_bodyB->m_sweep.localCenter;
     m_invMassA = m_bodyA->m_invMass;
@@ -20,6 +20,7 @@
 #include <Box2D/Dynamics/Joints/b2RevoluteJoint.h>
 #include <Box2D/Dynamics/Joints/b2PrismaticJoint.h>
 #include <Box2D/Dynamics/b2Body.h>
+#include <Box2D/Dynamics/b2Island.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
 
 // Gear Joint:
@@ -130,10 +131,10 @@ b2GearJoint::b2GearJoint(const b2GearJointDef* def)
 
 void b2GearJoint::InitVelocityConstraints(const b2SolverData& data)
 {
-    m_indexA = m_bodyA->m_islandIndex;
-    m_indexB = m_bodyB->m_islandIndex;
-    m_indexC = m_bodyC->m_islandIndex;
-    m_indexD = m_bodyD->m_islandIndex;
+    m_indexA = data.island->GetIndex(m_bodyA);
+    m_indexB = data.island->GetIndex(m_bodyB);
+    m_indexC = data.island->GetIndex(m_bodyC);
+    m_indexD = data.island->GetIndex(m_bodyD);
     m_lcA = m_bodyA->m_sweep.localCenter;
     m_lcB = m_bodyB->m_sweep.localCenter;
     m_lcC = m_bodyC->m_sweep.localCenter;
@@ -156,6 +156,7 @@ b2Island::b2Island(
     m_contactCapacity = contactCapacity;
     m_jointCapacity     = jointCapacity;
     m_bodyCount = 0;
+    m_staticCount = 0;
     m_contactCount = 0;
     m_jointCount = 0;
 
@@ -163,6 +164,7 @@ b2Island::b2Island(
     m_listener = listener;
 
     m_bodies = (b2Body**)m_allocator->Allocate(bodyCapacity * sizeof(b2Body*));
+    m_staticIndices = (int32*)m_allocator->Allocate(bodyCapacity * sizeof(int32));
     m_contacts = (b2Contact**)m_allocator->Allocate(contactCapacity     * sizeof(b2Contact*));
     m_joints = (b2Joint**)m_allocator->Allocate(jointCapacity * sizeof(b2Joint*));
 
@@ -177,6 +179,7 @@ b2Island::~b2Island()
     m_allocator->Free(m_velocities);
     m_allocator->Free(m_joints);
     m_allocator->Free(m_contacts);
+    m_allocator->Free(m_staticIndices);
     m_allocator->Free(m_bodies);
 }
 
@@ -196,9 +199,13 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
         b2Vec2 v = b->m_linearVelocity;
         float32 w = b->m_angularVelocity;
 
-        // Store positions for continuous collision.
-        b->m_sweep.c0 = b->m_sweep.c;
-        b->m_sweep.a0 = b->m_sweep.a;
+        if (b->m_type != b2_staticBody)
+        {
+            // Store positions for continuous collision.
+            // Static bodies don't move, and may be shared with an island solved at the same time.
+            b->m_sweep.c0 = b->m_sweep.c;
+            b->m_sweep.a0 = b->m_sweep.a;
+        }
 
         if (b->m_type == b2_dynamicBody)
         {
@@ -227,12 +234,14 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
 
     // Solver data
     b2SolverData solverData;
+    solverData.island = this;
     solverData.step = step;
     solverData.positions = m_positions;
     solverData.velocities = m_velocities;
 
     // Initialize velocity constraints.
     b2ContactSolverDef contactSolverDef;
+    contactSolverDef.island = this;
     contactSolverDef.step = step;
     contactSolverDef.contacts = m_contacts;
     contactSolverDef.count = m_contactCount;
@@ -330,6 +339,10 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
     for (int32 i = 0; i < m_bodyCount; ++i)
     {
         b2Body* body = m_bodies[i];
+        if (body->m_type == b2_staticBody)
+        {
+            continue;
+        }
         body->m_sweep.c = m_positions[i].c;
         body->m_sweep.a = m_positions[i].a;
         body->m_linearVelocity = m_velocities[i].v;
@@ -375,7 +388,10 @@ void b2Island::Solve(b2Profile* profile, const b2TimeStep& step, const b2Vec2& g
             for (int32 i = 0; i < m_bodyCount; ++i)
             {
                 b2Body* b = m_bodies[i];
-                b->SetAwake(false);
+                if (b->GetType() != b2_staticBody)
+                {
+                    b->SetAwake(false);
+                }
             }
         }
     }
@@ -397,6 +413,7 @@ void b2Island::SolveTOI(const b2TimeStep& subStep, int32 toiIndexA, int32 toiInd
     }
 
     b2ContactSolverDef contactSolverDef;
+    contactSolverDef.island = this;
     contactSolverDef.contacts = m_contacts;
     contactSolverDef.count = m_contactCount;
     contactSolverDef.allocator = m_allocator;
@@ -31,6 +31,8 @@ struct b2ContactVelocityConstraint;
 struct b2Profile;
 
 /// This is an internal class.
+/// Islands sharing no dynamic body can be solved at the same time, with
+/// different allocators: the static bodies they share are only read.
 class b2Island
 {
 public:
@@ -41,6 +43,7 @@ public:
     void Clear()
     {
         m_bodyCount = 0;
+        m_staticCount = 0;
         m_contactCount = 0;
         m_jointCount = 0;
     }
@@ -52,11 +55,39 @@ public:
     void Add(b2Body* body)
     {
         b2Assert(m_bodyCount < m_bodyCapacity);
-        body->m_islandIndex = m_bodyCount;
+        if (body->m_type == b2_staticBody)
+        {
+            // Static bodies may be in several islands: their index is kept here.
+            m_staticIndices[m_staticCount++] = m_bodyCount;
+        }
+        else
+        {
+            body->m_islandIndex = m_bodyCount;
+        }
         m_bodies[m_bodyCount] = body;
         ++m_bodyCount;
     }
 
+    /// The index of a body of the island in the positions and velocities.
+    int32 GetIndex(const b2Body* body) const
+    {
+        if (body->m_type != b2_staticBody)
+        {
+            return body->m_islandIndex;
+        }
+
+        for (int32 i = 0; i < m_staticCount; ++i)
+        {
+            if (m_bodies[m_staticIndices[i]] == body)
+            {
+                return m_staticIndices[i];
+            }
+        }
+
+        b2Assert(false);
+        return -1;
+    }
+
     void Add(b2Contact* contact)
     {
         b2Assert(m_contactCount < m_contactCapacity);
@@ -75,6 +106,7 @@ public:
     b2ContactListener* m_listener;
 
     b2Body** m_bodies;
+    int32* m_staticIndices;
     b2Contact** m_contacts;
     b2Joint** m_joints;
 
@@ -82,6 +114,7 @@ public:
     b2Velocity* m_velocities;
 
     int32 m_bodyCount;
+    int32 m_staticCount;
     int32 m_jointCount;
     int32 m_contactCount;
 
@@ -59,9 +59,12 @@ struct b2Velocity
     float32 w;
 };
 
+class b2Island;
+
 /// Solver Data
 struct b2SolverData
 {
+    const b2Island* island;
     b2TimeStep step;
     b2Position* positions;
     b2Velocity* velocities;
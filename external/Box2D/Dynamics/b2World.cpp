@@ -61,6 +61,10 @@ b2World::b2World(const b2Vec2& gravity)
     m_contactManager.m_allocator = &m_blockAllocator;
 
     memset(&m_profile, 0, sizeof(b2Profile));
+
+    m_taskScheduler = NULL;
+    m_threadAllocators = NULL;
+    m_threadAllocatorCount = 0;
 }
 
 b2World::~b2World()
@@ -82,6 +86,8 @@ b2World::~b2World()
 
         b = bNext;
     }
+
+    SetThreadAllocatorCount(0);
 }
 
 void b2World::SetDestructionListener(b2DestructionListener* listener)
@@ -99,6 +105,40 @@ void b2World::SetContactListener(b2ContactListener* listener)
     m_contactManager.m_contactListener = listener;
 }
 
+void b2World::SetTaskScheduler(b2TaskScheduler* scheduler)
+{
+    b2Assert(IsLocked() == false);
+    m_taskScheduler = scheduler;
+}
+
+void b2World::SetThreadAllocatorCount(int32 count)
+{
+    if (count == m_threadAllocatorCount)
+    {
+        return;
+    }
+
+    for (int32 i = 0; i < m_threadAllocatorCount; ++i)
+    {
+        m_threadAllocators[i].~b2StackAllocator();
+    }
+    if (m_threadAllocators)
+    {
+        b2Free(m_threadAllocators);
+        m_threadAllocators = NULL;
+    }
+
+    m_threadAllocatorCount = count;
+    if (count > 0)
+    {
+        m_threadAllocators = (b2StackAllocator*)b2Alloc(count * sizeof(b2StackAllocator));
+        for (int32 i = 0; i < count; ++i)
+        {
+            new (m_threadAllocators + i) b2StackAllocator;
+        }
+    }
+}
+
 void b2World::SetDebugDraw(b2Draw* debugDraw)
 {
     m_debugDraw = debugDraw;
@@ -382,6 +422,113 @@ void b2World::SetAllowSleeping(bool flag)
     }
 }
 
+// A growable array living for one step.
+template <typename T>
+struct b2StepArray
+{
+    b2StepArray() : data(NULL), count(0), capacity(0) {}
+    ~b2StepArray()
+    {
+        if (data)
+        {
+            b2Free(data);
+        }
+    }
+
+    void Reserve(int32 n)
+    {
+        if (n <= capacity)
+        {
+            return;
+        }
+        capacity = b2Max(n, 2 * capacity);
+        T* old = data;
+        data = (T*)b2Alloc(capacity * sizeof(T));
+        if (old)
+        {
+            memcpy(data, old, count * sizeof(T));
+            b2Free(old);
+        }
+    }
+
+    T* data;
+    int32 count;
+    int32 capacity;
+};
+
+// The islands of a step, built on the calling thread and solved by the task scheduler.
+struct b2IslandRange
+{
+    int32 bodyStart, bodyCount;
+    int32 contactStart, contactCount;
+    int32 jointStart, jointCount;
+    b2Profile profile;
+};
+
+struct b2IslandList
+{
+    void Add(const b2Island& island)
+    {
+        ranges.Reserve(ranges.count + 1);
+        b2IslandRange* range = ranges.data + ranges.count++;
+        range->bodyStart = bodies.count;
+        range->bodyCount = island.m_bodyCount;
+        range->contactStart = contacts.count;
+        range->contactCount = island.m_contactCount;
+        range->jointStart = joints.count;
+        range->jointCount = island.m_jointCount;
+
+        Append(bodies, island.m_bodies, island.m_bodyCount);
+        Append(contacts, island.m_contacts, island.m_contactCount);
+        Append(joints, island.m_joints, island.m_jointCount);
+    }
+
+    template <typename T>
+    static void Append(b2StepArray<T*>& array, T* const* elements, int32 n)
+    {
+        array.Reserve(array.count + n);
+        memcpy(array.data + array.count, elements, n * sizeof(T*));
+        array.count += n;
+    }
+
+    b2StepArray<b2IslandRange> ranges;
+    b2StepArray<b2Body*> bodies;
+    b2StepArray<b2Contact*> contacts;
+    b2StepArray<b2Joint*> joints;
+};
+
+// Solves one island of the list, with the allocator of the thread.
+class b2IslandSolveTask : public b2Task
+{
+public:
+    void Run(int32 index, int32 threadIndex)
+    {
+        b2IslandRange* range = islands->ranges.data + index;
+        b2Island island(range->bodyCount, range->contactCount, range->jointCount, allocators + threadIndex, NULL);
+
+        for (int32 i = 0; i < range->bodyCount; ++i)
+        {
+            island.Add(islands->bodies.data[range->bodyStart + i]);
+        }
+        for (int32 i = 0; i < range->contactCount; ++i)
+        {
+            island.Add(islands->contacts.data[range->contactStart + i]);
+        }
+        for (int32 i = 0; i < range->jointCount; ++i)
+        {
+            island.Add(islands->joints.data[range->jointStart + i]);
+        }
+
+        island.Solve(&range->profile, *step, gravity, allowSleep);
+    }
+
+    b2IslandList* islands;
+    b2StackAllocator* allocators;
+    const b2TimeStep* step;
+    b2Vec2 gravity;
+    bool allowSleep;
+};
+
 // Find islands, integrate and solve constraints, solve position constraints
 void b2World::Solve(const b2TimeStep& step)
 {
@@ -389,6 +536,10 @@ void b2World::Solve(const b2TimeStep& step)
     m_profile.solveVelocity = 0.0f;
     m_profile.solvePosition = 0.0f;
 
+    // Islands don't share dynamic bodies: they can be solved in parallel once all are built.
+    bool parallel = m_taskScheduler != NULL && m_taskScheduler->GetThreadCount() > 1;
+    b2IslandList islands;
+
     // Size the island for the worst case.
     b2Island island(m_bodyCount,
                     m_contactManager.m_contactCount,
@@ -527,11 +678,18 @@ void b2World::Solve(const b2TimeStep& step)
             }
         }
 
-        b2Profile profile;
-        island.Solve(&profile, step, m_gravity, m_allowSleep);
-        m_profile.solveInit += profile.solveInit;
-        m_profile.solveVelocity += profile.solveVelocity;
-        m_profile.solvePosition += profile.solvePosition;
+        if (parallel)
+        {
+            islands.Add(island);
+        }
+        else
+        {
+            b2Profile profile;
+            island.Solve(&profile, step, m_gravity, m_allowSleep);
+            m_profile.solveInit += profile.solveInit;
+            m_profile.solveVelocity += profile.solveVelocity;
+            m_profile.solvePosition += profile.solvePosition;
+        }
 
         // Post solve cleanup.
         for (int32 i = 0; i < island.m_bodyCount; ++i)
@@ -547,6 +705,51 @@ void b2World::Solve(const b2TimeStep& step)
 
     m_stackAllocator.Free(stack);
 
+    if (parallel)
+    {
+        SetThreadAllocatorCount(m_taskScheduler->GetThreadCount());
+
+        b2IslandSolveTask task;
+        task.islands = &islands;
+        task.allocators = m_threadAllocators;
+        task.step = &step;
+        task.gravity = m_gravity;
+        task.allowSleep = m_allowSleep;
+        m_taskScheduler->ParallelFor(&task, islands.ranges.count);
+
+        // Report in the order of the islands, whatever thread solved them.
+        b2ContactListener* listener = m_contactManager.m_contactListener;
+        for (int32 i = 0; i < islands.ranges.count; ++i)
+        {
+            const b2IslandRange& range = islands.ranges.data[i];
+            m_profile.solveInit += range.profile.solveInit;
+            m_profile.solveVelocity += range.profile.solveVelocity;
+            m_profile.solvePosition += range.profile.solvePosition;
+
+            if (listener == NULL)
+            {
+                continue;
+            }
+
+            for (int32 j = 0; j < range.contactCount; ++j)
+            {
+                // The solver stored the impulses in the manifold.
+                b2Contact* c = islands.contacts.data[range.contactStart + j];
+                const b2Manifold* manifold = c->GetManifold();
+
+                b2ContactImpulse impulse;
+                impulse.count = manifold->pointCount;
+                for (int32 k = 0; k < manifold->pointCount; ++k)
+                {
+                    impulse.normalImpulses[k] = manifold->points[k].normalImpulse;
+                    impulse.tangentImpulses[k] = manifold->points[k].tangentImpulse;
+                }
+
+                listener->PostSolve(c, &impulse);
+            }
+        }
+    }
+
     {
         b2Timer timer;
         // Synchronize fixtures, check for out of range bodies.
@@ -860,7 +1063,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
         subStep.positionIterations = 20;
         subStep.velocityIterations = step.velocityIterations;
         subStep.warmStarting = false;
-        island.SolveTOI(subStep, bA->m_islandIndex, bB->m_islandIndex);
+        island.SolveTOI(subStep, island.GetIndex(bA), island.GetIndex(bB));
 
         // Reset island flags and synchronize broad-phase proxies.
         for (int32 i = 0; i < island.m_bodyCount; ++i)
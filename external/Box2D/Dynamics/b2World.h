@@ -22,6 +22,7 @@
 #include <Box2D/Common/b2Math.h>
 #include <Box2D/Common/b2BlockAllocator.h>
 #include <Box2D/Common/b2StackAllocator.h>
+#include <Box2D/Common/b2TaskScheduler.h>
 #include <Box2D/Dynamics/b2ContactManager.h>
 #include <Box2D/Dynamics/b2WorldCallbacks.h>
 #include <Box2D/Dynamics/b2TimeStep.h>
@@ -200,6 +201,14 @@ public:
     /// Get the current profile.
     const b2Profile& GetProfile() const;
 
+    /// Solve the islands on the threads of a task scheduler. The results are the same
+    /// whatever the number of threads. The contact listener PostSolve calls are made
+    /// on the calling thread once all the islands are solved, in the same order.
+    /// The scheduler is owned by you and must remain in scope. NULL to solve on the
+    /// calling thread only, the default.
+    void SetTaskScheduler(b2TaskScheduler* scheduler);
+    b2TaskScheduler* GetTaskScheduler() const;
+
     /// Dump the world into the log file.
     /// @warning this should be called outside of a time step.
     void Dump();
@@ -221,6 +230,7 @@ private:
 
     void Solve(const b2TimeStep& step);
     void SolveTOI(const b2TimeStep& step);
+    void SetThreadAllocatorCount(int32 count);
 
     void DrawJoint(b2Joint* joint);
     void DrawShape(b2Fixture* shape, const b2Transform& xf, const b2Color& color);
@@ -256,6 +266,11 @@ private:
     bool m_stepComplete;
 
     b2Profile m_profile;
+
+    b2TaskScheduler* m_taskScheduler;
+    // One per thread of the scheduler, for the islands solved in parallel.
+    b2StackAllocator* m_threadAllocators;
+    int32 m_threadAllocatorCount;
 };
 
 inline b2Body* b2World::GetBodyList()
@@ -346,4 +361,9 @@ inline const b2Profile& b2World::GetProfile() const
     return m_profile;
 }
 
+inline b2TaskScheduler* b2World::GetTaskScheduler() const
+{
+    return m_taskScheduler;
+}
+
 #endif
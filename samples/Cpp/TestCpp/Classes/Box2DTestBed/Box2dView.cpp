@@ -12,8 +12,13 @@ Settings settings;
 enum 
 {
     kTagBox2DNode,
+    kTagBenchmarkLabel,
 }; 
 
+// steps of the benchmark, and threads solving the islands
+static const int kBenchmarkSteps = 300;
+static const int kBenchmarkThreadCounts[] = { 1, 2, 4 };
+
 
 //------------------------------------------------------------------
 //
@@ -80,6 +85,11 @@ bool MenuLayer::initWithEntryID(int entryId)
     
     addChild(menu, 1);    
 
+    CCMenuItemFont *benchmark = CCMenuItemFont::create("Benchmark", this, menu_selector(MenuLayer::benchmarkCallback));
+    CCMenu *benchmarkMenu = CCMenu::create(benchmark, NULL);
+    benchmarkMenu->setPosition(ccp(VisibleRect::right().x - 80, VisibleRect::top().y - 90));
+    addChild(benchmarkMenu, 1);
+
     return true;
 }
 
@@ -119,6 +129,60 @@ void MenuLayer::backCallback(CCObject* sender)
     s->release();
 }
 
+// Steps a new instance of the test with its islands solved on 1, 2 and 4 threads,
+// and checks that the bodies end at the same place.
+void MenuLayer::benchmarkCallback(CCObject* sender)
+{
+    std::string results;
+    std::vector<b2Transform> reference;
+
+    for (unsigned int i = 0; i < sizeof(kBenchmarkThreadCounts) / sizeof(kBenchmarkThreadCounts[0]); ++i)
+    {
+        int threadCount = kBenchmarkThreadCounts[i];
+        Test* test = g_testEntries[m_entryID].createFcn();
+        b2ThreadPool* pool = threadCount > 1 ? new b2ThreadPool(threadCount) : NULL;
+        test->m_world->SetTaskScheduler(pool);
+
+        float32 solve = 0.0f;
+        b2Timer timer;
+        for (int step = 0; step < kBenchmarkSteps; ++step)
+        {
+            test->m_world->Step(1.0f / settings.hz, settings.velocityIterations, settings.positionIterations);
+            solve += test->m_world->GetProfile().solve;
+        }
+        float32 total = timer.GetMilliseconds();
+
+        std::vector<b2Transform> transforms;
+        for (b2Body* body = test->m_world->GetBodyList(); body; body = body->GetNext())
+        {
+            transforms.push_back(body->GetTransform());
+        }
+        bool identical = true;
+        if (i == 0)
+        {
+            reference = transforms;
+        }
+        else
+        {
+            identical = transforms.size() == reference.size() &&
+                (transforms.empty() || memcmp(&transforms[0], &reference[0], transforms.size() * sizeof(b2Transform)) == 0);
+        }
+
+        results += CCString::createWithFormat("%d thread(s): %.1f ms, solve %.1f ms%s\n", threadCount, total, solve,
+                                              identical ? "" : ", NOT IDENTICAL")->getCString();
+
+        delete test;
+        delete pool;
+    }
+
+    CCLog("Box2D benchmark, %s, %d steps:\n%s", g_testEntries[m_entryID].name, kBenchmarkSteps, results.c_str());
+
+    removeChildByTag(kTagBenchmarkLabel);
+    CCLabelTTF* label = CCLabelTTF::create(results.c_str(), "Arial", 16);
+    label->setPosition(ccp(VisibleRect::right().x - 120, VisibleRect::top().y - 150));
+    addChild(label, 1, kTagBenchmarkLabel);
+}
+
 void MenuLayer::registerWithTouchDispatcher()
 {
     CCDirector* pDirector = CCDirector::sharedDirector();
@@ -17,6 +17,7 @@ public:
     void restartCallback(CCObject* sender);
     void nextCallback(CCObject* sender);
     void backCallback(CCObject* sender);
+    void benchmarkCallback(CCObject* sender);
 
     virtual void registerWithTouchDispatcher();
 
@@ -51,12 +51,12 @@ ChipmunkTestLayer::ChipmunkTestLayer()
     // menu for debug layer
     CCMenuItemFont::setFontSize(18);
     CCMenuItemFont *item = CCMenuItemFont::create("Toggle debug", this, menu_selector(ChipmunkTestLayer::toggleDebugCallback));
+    CCMenuItemFont *threadItem = CCMenuItemFont::create("Toggle physics thread", this, menu_selector(ChipmunkTestLayer::toggleThreadCallback));
 
-    CCMenu *menu = CCMenu::create(item, NULL);
+    CCMenu *menu = CCMenu::create(item, threadItem, NULL);
+    menu->alignItemsVertically();
     this->addChild(menu);
     menu->setPosition(ccp(VisibleRect::right().x-100, VisibleRect::top().y-60));
-
-    scheduleUpdate();
 #else
     CCLabelTTF *pLabel = CCLabelTTF::create("Should define CC_ENABLE_CHIPMUNK_INTEGRATION=1\n to run this test case",
                                             "Arial",
@@ -77,15 +77,35 @@ void ChipmunkTestLayer::toggleDebugCallback(CCObject* pSender)
 #endif
 }
 
+void ChipmunkTestLayer::toggleThreadCallback(CCObject* pSender)
+{
+#if CC_ENABLE_CHIPMUNK_INTEGRATION
+    bool bWorkerThread = ! m_pWorldNode->isSteppingOnWorkerThread();
+    m_pWorldNode->setSteppingOnWorkerThread(bWorkerThread);
+    // the debug layer makes the frame wait for the step, see draw()
+    m_pDebugLayer->setVisible(! bWorkerThread);
+#endif
+}
+
+void ChipmunkTestLayer::draw()
+{
+    CCLayer::draw();
+#if CC_ENABLE_CHIPMUNK_INTEGRATION
+    // The debug layer, drawn after this layer, reads the space while the physics thread may step it:
+    // the step has to be finished first.
+    if (m_pDebugLayer->isVisible())
+    {
+        m_pWorldNode->waitForStep();
+    }
+#endif
+}
+
 ChipmunkTestLayer::~ChipmunkTestLayer()
 {
     // manually Free rogue shapes
     for( int i=0;i<4;i++) {
         cpShapeFree( m_pWalls[i] );
     }
-
-    cpSpaceFree( m_pSpace );
-
 }
 
 void ChipmunkTestLayer::initPhysics()
@@ -94,7 +114,11 @@ void ChipmunkTestLayer::initPhysics()
     // init chipmunk
     //cpInitChipmunk();
 
-    m_pSpace = cpSpaceNew();
+    // the world node steps the space at a fixed rate, and interpolates the sprites
+    m_pWorldNode = CCPhysicsWorldNode::create();
+    m_pWorldNode->setFixedTimeStep(1.0f / 120);
+    this->addChild(m_pWorldNode);
+    m_pSpace = m_pWorldNode->getSpace();
 
     m_pSpace->gravity = cpv(0, -100);
 
@@ -134,17 +158,6 @@ void ChipmunkTestLayer::initPhysics()
 #endif
 }
 
-void ChipmunkTestLayer::update(float delta)
-{
-    // Should use a fixed size step based on the animation interval.
-    int steps = 2;
-    float dt = CCDirector::sharedDirector()->getAnimationInterval()/(float)steps;
-
-    for(int i=0; i<steps; i++){
-        cpSpaceStep(m_pSpace, dt);
-    }
-}
-
 void ChipmunkTestLayer::createResetButton()
 {
     CCMenuItemImage *reset = CCMenuItemImage::create("Images/r1.png", "Images/r2.png", this, menu_selector(ChipmunkTestLayer::reset));
@@ -187,6 +200,9 @@ void ChipmunkTestLayer::addNewSpriteAtPosition(CCPoint pos)
         cpv( 24,-54),
     };
 
+    // the space may be stepped on the physics thread
+    m_pWorldNode->waitForStep();
+
     cpBody *body = cpBodyNew(1.0f, cpMomentForPoly(1.0f, num, verts, cpvzero));
 
     body->p = cpv(pos.x, pos.y);
@@ -201,6 +217,7 @@ void ChipmunkTestLayer::addNewSpriteAtPosition(CCPoint pos)
 
     sprite->setCPBody(body);
     sprite->setPosition(pos);
+    m_pWorldNode->addPhysicsSprite(sprite);
 #endif
 }
 
@@ -242,6 +259,7 @@ void ChipmunkTestLayer::didAccelerate(CCAcceleration* pAccelerationValue)
 
     CCPoint v = ccp( accelX, accelY);
     v = ccpMult(v, 200);
+    m_pWorldNode->waitForStep();
     m_pSpace->gravity = cpv(v.x, v.y);
 }
 
@@ -22,8 +22,9 @@ public:
     void reset(CCObject* sender);
 
     void addNewSpriteAtPosition(CCPoint p);
-    void update(float dt);
     void toggleDebugCallback(CCObject* pSender);
+    void toggleThreadCallback(CCObject* pSender);
+    virtual void draw();
     virtual void ccTouchesEnded(CCSet* touches, CCEvent* event);
     virtual void didAccelerate(CCAcceleration* pAccelerationValue);
 
@@ -32,7 +33,8 @@ private:
 #if CC_ENABLE_CHIPMUNK_INTEGRATION    
     CCPhysicsDebugNode* m_pDebugLayer; // weak ref
 #endif
-    cpSpace* m_pSpace; // strong ref
+    CCPhysicsWorldNode* m_pWorldNode; // weak ref
+    cpSpace* m_pSpace; // weak ref, owned by m_pWorldNode
     cpShape* m_pWalls[4];
 };
 
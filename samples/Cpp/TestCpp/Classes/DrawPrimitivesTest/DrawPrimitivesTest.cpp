@@ -16,11 +16,13 @@ static CCLayer* create##className() \
 
 DRAWPRIMITIVES_CREATE_FUNC(DrawPrimitivesTest);
 DRAWPRIMITIVES_CREATE_FUNC(DrawNodeTest);
+DRAWPRIMITIVES_CREATE_FUNC(DrawPrimitivesBatchTest);
 
 static NEWDRAWPRIMITIVESFUNC createFunctions[] =
 {
     createDrawPrimitivesTest,
     createDrawNodeTest,
+    createDrawPrimitivesBatchTest,
 };
 
 #define MAX_LAYER    (sizeof(createFunctions) / sizeof(createFunctions[0]))
@@ -157,7 +159,7 @@ void DrawPrimitivesTest::draw()
 	// glLineWidth > 1 and GL_LINE_SMOOTH are not compatible
 	// GL_SMOOTH_LINE_WIDTH_RANGE = (1,1) on iPhone
     //	glDisable(GL_LINE_SMOOTH);
-	glLineWidth( 5.0f );
+	ccLineWidth( 5.0f );
 	ccDrawColor4B(255,0,0,255);
     ccDrawLine( VisibleRect::leftTop(), VisibleRect::rightBottom() );
     
@@ -185,14 +187,14 @@ void DrawPrimitivesTest::draw()
 	CHECK_GL_ERROR_DEBUG();
     
 	// draw a green circle with 10 segments
-	glLineWidth(16);
+	ccLineWidth(16);
 	ccDrawColor4B(0, 255, 0, 255);
     ccDrawCircle( VisibleRect::center(), 100, 0, 10, false);
     
 	CHECK_GL_ERROR_DEBUG();
     
 	// draw a green circle with 50 segments with line to center
-	glLineWidth(2);
+	ccLineWidth(2);
 	ccDrawColor4B(0, 255, 255, 255);
     ccDrawCircle( VisibleRect::center(), 50, CC_DEGREES_TO_RADIANS(90), 50, true);
     
@@ -200,21 +202,21 @@ void DrawPrimitivesTest::draw()
     
 	// open yellow poly
 	ccDrawColor4B(255, 255, 0, 255);
-	glLineWidth(10);
+	ccLineWidth(10);
 	CCPoint vertices[] = { ccp(0,0), ccp(50,50), ccp(100,50), ccp(100,100), ccp(50,100) };
 	ccDrawPoly( vertices, 5, false);
     
 	CHECK_GL_ERROR_DEBUG();
 	
 	// filled poly
-	glLineWidth(1);
+	ccLineWidth(1);
 	CCPoint filledVertices[] = { ccp(0,120), ccp(50,120), ccp(50,170), ccp(25,200), ccp(0,170) };
 	ccDrawSolidPoly(filledVertices, 5, ccc4f(0.5f, 0.5f, 1, 1 ) );
     
     
 	// closed purble poly
 	ccDrawColor4B(255, 0, 255, 255);
-	glLineWidth(2);
+	ccLineWidth(2);
 	CCPoint vertices2[] = { ccp(30,130), ccp(30,230), ccp(50,200) };
 	ccDrawPoly( vertices2, 3, true);
     
@@ -235,7 +237,7 @@ void DrawPrimitivesTest::draw()
     ccDrawSolidPoly( vertices3, 4, ccc4f(1,1,0,1) );
     
 	// restore original values
-	glLineWidth(1);
+	ccLineWidth(1);
 	ccDrawColor4B(255,255,255,255);
 	ccPointSize(1);
     
@@ -317,6 +319,75 @@ string DrawNodeTest::subtitle()
     return "Testing DrawNode - batched draws. Concave polygons are BROKEN";
 }
 
+// DrawPrimitivesBatchTest
+DrawPrimitivesBatchTest::DrawPrimitivesBatchTest()
+{
+}
+
+void DrawPrimitivesBatchTest::draw()
+{
+    bool wasBatching = ccDrawIsBatchingEnabled();
+    ccDrawSetBatchingEnabled(true);
+
+    CCPoint center = VisibleRect::center();
+
+    // 200 rays, each one a separate ccDrawLine call
+    ccLineWidth(1);
+    for (int i = 0; i < 200; i++)
+    {
+        float angle = 2 * (float)M_PI * i / 200;
+        ccDrawColor4B(128 + i / 2, 255 - i, i, 255);
+        ccDrawLine(center, ccpAdd(center, ccp(cosf(angle) * 150, sinf(angle) * 150)));
+    }
+
+    // a grid of points
+    ccPointSize(4);
+    ccDrawColor4B(0, 255, 255, 255);
+    for (int x = 0; x < 20; x++)
+    {
+        for (int y = 0; y < 10; y++)
+        {
+            ccDrawPoint(ccpAdd(VisibleRect::leftBottom(), ccp(20 + x * 10, 20 + y * 10)));
+        }
+    }
+
+    // thick circles end up in their own line width run
+    ccLineWidth(4);
+    for (int i = 1; i <= 5; i++)
+    {
+        ccDrawColor4B(255, 255 - i * 40, 0, 255);
+        ccDrawCircle(center, 20.0f * i, 0, 30, false);
+    }
+
+    // filled polygons
+    for (int i = 0; i < 10; i++)
+    {
+        CCPoint origin = ccpAdd(VisibleRect::rightBottom(), ccp(-40 - (i % 5) * 30, 20 + (i / 5) * 30));
+        CCPoint vertices[] = { origin, ccpAdd(origin, ccp(20, 0)), ccpAdd(origin, ccp(20, 20)), ccpAdd(origin, ccp(0, 20)) };
+        ccDrawSolidPoly(vertices, 4, ccc4f(i / 10.0f, 0.5f, 1, 1));
+    }
+
+    // turning batching off flushes everything drawn above with a couple of draw calls
+    ccDrawSetBatchingEnabled(wasBatching);
+
+    // restore original values
+    ccLineWidth(1);
+    ccDrawColor4B(255,255,255,255);
+    ccPointSize(1);
+
+    CHECK_GL_ERROR_DEBUG();
+}
+
+string DrawPrimitivesBatchTest::title()
+{
+    return "batched draw primitives";
+}
+
+string DrawPrimitivesBatchTest::subtitle()
+{
+    return "ccDrawSetBatchingEnabled: ~500 primitives, 2 draw calls";
+}
+
 void DrawPrimitivesTestScene::runThisTest()
 {
     CCLayer* pLayer = nextAction();
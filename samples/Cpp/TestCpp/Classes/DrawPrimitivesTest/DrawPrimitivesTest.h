@@ -38,6 +38,16 @@ public:
     virtual std::string subtitle();
 };
 
+class DrawPrimitivesBatchTest : public BaseLayer
+{
+public:
+    DrawPrimitivesBatchTest();
+    
+    virtual std::string title();
+    virtual std::string subtitle();
+    virtual void draw();
+};
+
 class DrawPrimitivesTestScene : public TestScene
 {
 public:
@@ -1,5 +1,6 @@
 #include "EffectsTest.h"
 #include "../testResource.h"
+#include "effects/ccGridKernels.h"
 
 enum {
     kTagTextLayer = 1,
@@ -33,6 +34,7 @@ static std::string effectsList[] =
     "SplitRows",
     "SplitCols",
     "PageTurn3D",
+    "Waves3D, 2 grid threads",
 }; 
 
 
@@ -280,12 +282,23 @@ public:
     }
 };
 
+// A grid large enough for ccGridParallelFor to split its columns, run with 2 worker threads set by TextLayer::onEnter.
+class ParallelWaves3DDemo : public CCWaves3D
+{
+public:
+    static CCActionInterval* create(float t)
+    {
+        return CCWaves3D::create(t, CCSizeMake(128,96), 5, 40);
+    }
+};
+
 //------------------------------------------------------------------
 //
 // TextLayer
 //
 //------------------------------------------------------------------
-#define MAX_LAYER    22
+#define MAX_LAYER    23
+#define PARALLEL_GRID_LAYER    22
 
 CCActionInterval* createEffect(int nIndex, float t)
 {
@@ -316,6 +329,7 @@ CCActionInterval* createEffect(int nIndex, float t)
         case 19: return SplitRowsDemo::create(t);
         case 20: return SplitColsDemo::create(t);
         case 21: return PageTurn3DDemo::create(t);
+        case 22: return ParallelWaves3DDemo::create(t);
     }
 
     return NULL;
@@ -414,6 +428,14 @@ TextLayer* TextLayer::create()
 void TextLayer::onEnter()
 {
     CCLayer::onEnter();
+    // the grid workers are off by default; only the parallel demo turns them on
+    ccGridSetWorkerThreadCount(actionIdx == PARALLEL_GRID_LAYER ? 2 : 0);
+}
+
+void TextLayer::onExit()
+{
+    ccGridSetWorkerThreadCount(0);
+    CCLayer::onExit();
 }
 
 void TextLayer::newScene()
@@ -21,6 +21,7 @@ public:
     void checkAnim(float dt);
 
     virtual void onEnter();
+    virtual void onExit();
 
     void restartCallback(CCObject* pSender);
     void nextCallback(CCObject* pSender);
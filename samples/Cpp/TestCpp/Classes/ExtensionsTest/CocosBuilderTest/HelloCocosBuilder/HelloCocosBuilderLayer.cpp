@@ -46,6 +46,9 @@ void HelloCocosBuilderLayer::openTest(const char * pCCBFileName, const char * pC
 
     this->mTestTitleLabelTTF->setString(pCCBFileName);
 
+    // Opening a test again reuses the parsed files; the log shows the load and per instance times.
+    CCBFileCache::sharedFileCache()->dumpStatistics();
+
     CCScene * scene = CCScene::create();
     if(node != NULL) {
         scene->addChild(node);
@@ -20,10 +20,10 @@ public:
     virtual void draw()
     {
         ccDrawColor4B(m_TouchColor.r, m_TouchColor.g, m_TouchColor.b, 255);
-        glLineWidth(10);
+        ccLineWidth(10);
         ccDrawLine( ccp(0, m_pTouchPoint.y), ccp(getContentSize().width, m_pTouchPoint.y) );
         ccDrawLine( ccp(m_pTouchPoint.x, 0), ccp(m_pTouchPoint.x, getContentSize().height) );
-        glLineWidth(1);
+        ccLineWidth(1);
         ccPointSize(30);
         ccDrawPoint(m_pTouchPoint);
     }
@@ -22,7 +22,7 @@ CCLayer* restartCocosNodeAction();
 
 static int sceneIdx = -1; 
 
-#define MAX_LAYER    14
+#define MAX_LAYER    15
 
 CCLayer* createCocosNodeLayer(int nIndex)
 {
@@ -42,6 +42,7 @@ CCLayer* createCocosNodeLayer(int nIndex)
         case 11: return new ConvertToNode();
         case 12: return new NodeOpaqueTest();
         case 13: return new NodeNonOpaqueTest();
+        case 14: return new NodeCullingTest();
     }
 
     return NULL;
@@ -869,6 +870,56 @@ std::string NodeNonOpaqueTest::subtitle()
     return "Node rendered with GL_BLEND enabled";
 }
 
+NodeCullingTest::NodeCullingTest()
+{
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    // a world 10 screens wide scrolling back and forth: most of it is off-screen at any time
+    CCNode *world = CCNode::create();
+    addChild(world, -1);
+
+    CCSpriteBatchNode *batch = CCSpriteBatchNode::create("Images/grossini_dance_atlas.png", 500);
+    world->addChild(batch);
+    for (int i = 0; i < 500; i++)
+    {
+        CCSprite *sprite = CCSprite::createWithTexture(batch->getTexture(), CCRectMake(85 * (i % 5), 0, 85, 121));
+        sprite->setPosition(ccp(CCRANDOM_0_1() * s.width * 10, CCRANDOM_0_1() * s.height));
+        batch->addChild(sprite);
+    }
+
+    for (int i = 0; i < 100; i++)
+    {
+        CCSprite *sprite = CCSprite::create("Images/grossini.png");
+        sprite->setPosition(ccp(CCRANDOM_0_1() * s.width * 10, CCRANDOM_0_1() * s.height));
+        world->addChild(sprite);
+    }
+
+    CCActionInterval *scroll = CCMoveBy::create(10, ccp(-s.width * 9, 0));
+    world->runAction(CCRepeatForever::create(CCSequence::create(scroll, scroll->reverse(), NULL)));
+}
+
+void NodeCullingTest::onEnter()
+{
+    TestCocosNodeDemo::onEnter();
+    CCNode::setCullingEnabled(true);
+}
+
+void NodeCullingTest::onExit()
+{
+    CCNode::setCullingEnabled(false);
+    TestCocosNodeDemo::onExit();
+}
+
+std::string NodeCullingTest::title()
+{
+    return "Node Culling Test";
+}
+
+std::string NodeCullingTest::subtitle()
+{
+    return "Off-screen sprites are skipped. Stats: draws / culled";
+}
+
 void CocosNodeTestScene::runThisTest()
 {
     CCLayer* pLayer = nextCocosNodeAction();
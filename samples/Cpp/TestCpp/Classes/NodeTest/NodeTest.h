@@ -145,6 +145,16 @@ public:
     virtual std::string subtitle();
 };
 
+class NodeCullingTest : public TestCocosNodeDemo
+{
+public:
+    NodeCullingTest();
+    virtual void onEnter();
+    virtual void onExit();
+    virtual std::string title();
+    virtual std::string subtitle();
+};
+
 class CocosNodeTestScene : public TestScene
 {
 public:
@@ -0,0 +1,353 @@
+#include "PerformanceAllocTest.h"
+
+enum
+{
+    TEST_COUNT = 3,
+    kCallsPerTest = 10000,
+};
+
+static int s_nAllocCurCase = 0;
+
+static float secondsSince(struct timeval *lastUpdate)
+{
+    struct timeval now;
+
+    gettimeofday(&now, NULL);
+
+    return (now.tv_sec - lastUpdate->tv_sec) + (now.tv_usec - lastUpdate->tv_usec) / 1000000.0f;
+}
+
+////////////////////////////////////////////////////////
+//
+// AllocMenuLayer
+//
+////////////////////////////////////////////////////////
+void AllocMenuLayer::showCurrentTest()
+{
+    CCScene* pScene = NULL;
+
+    switch (m_nCurCase)
+    {
+    case 0:
+        pScene = StringFormatAllocTest::scene();
+        break;
+    case 1:
+        pScene = AutoreleasePoolAllocTest::scene();
+        break;
+    case 2:
+        pScene = SmallObjectAllocTest::scene();
+        break;
+    }
+    s_nAllocCurCase = m_nCurCase;
+
+    if (pScene)
+    {
+        CCDirector::sharedDirector()->replaceScene(pScene);
+    }
+}
+
+void AllocMenuLayer::onEnter()
+{
+    PerformBasicLayer::onEnter();
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    // Title
+    CCLabelTTF *label = CCLabelTTF::create(title().c_str(), "Arial", 40);
+    addChild(label, 1);
+    label->setPosition(ccp(s.width/2, s.height-32));
+    label->setColor(ccc3(255,255,40));
+
+    // Subtitle
+    std::string strSubTitle = subtitle();
+    if(strSubTitle.length())
+    {
+        CCLabelTTF *l = CCLabelTTF::create(strSubTitle.c_str(), "Thonburi", 16);
+        addChild(l, 1);
+        l->setPosition(ccp(s.width/2, s.height-80));
+    }
+
+    std::string results = performTests();
+    CCLabelTTF *resultsLabel = CCLabelTTF::create(results.c_str(), "Arial", 16);
+    addChild(resultsLabel, 1);
+    resultsLabel->setPosition(ccp(s.width/2, s.height/2));
+}
+
+std::string AllocMenuLayer::title()
+{
+    return "no title";
+}
+
+std::string AllocMenuLayer::subtitle()
+{
+    return "no subtitle";
+}
+
+////////////////////////////////////////////////////////
+//
+// StringFormatAllocTest
+//
+////////////////////////////////////////////////////////
+
+// what CCString::initWithFormat did before: a 100 KB heap buffer for every call
+static void legacyFormat(std::string& str, const char* format, ...)
+{
+    va_list ap;
+    va_start(ap, format);
+    char* pBuf = (char*)malloc(1024 * 100);
+    if (pBuf != NULL)
+    {
+        vsnprintf(pBuf, 1024 * 100, format, ap);
+        str = pBuf;
+        free(pBuf);
+    }
+    va_end(ap);
+}
+
+std::string StringFormatAllocTest::performTests()
+{
+    struct timeval now;
+    std::string results;
+    std::string legacy;
+    CCString str;
+    std::string longText(2000, 'x');
+    float duration;
+    unsigned int allocations;
+
+    CCLog("--------");
+    CCLog("%d calls per test", kCallsPerTest);
+
+    gettimeofday(&now, NULL);
+    for (int i = 0; i < kCallsPerTest; i++)
+    {
+        legacyFormat(legacy, "Score: %d", i);
+    }
+    duration = secondsSince(&now);
+    results += CCString::createWithFormat("short, 100 KB malloc per call: %.2f ms, %d allocations\n",
+                                          duration * 1000, kCallsPerTest)->getCString();
+
+    allocations = CCString::getFormatBufferAllocations();
+    gettimeofday(&now, NULL);
+    for (int i = 0; i < kCallsPerTest; i++)
+    {
+        str.initWithFormat("Score: %d", i);
+    }
+    duration = secondsSince(&now);
+    results += CCString::createWithFormat("short, CCString: %.2f ms, %u allocations\n",
+                                          duration * 1000, CCString::getFormatBufferAllocations() - allocations)->getCString();
+
+    gettimeofday(&now, NULL);
+    for (int i = 0; i < kCallsPerTest; i++)
+    {
+        legacyFormat(legacy, "%d: %s", i, longText.c_str());
+    }
+    duration = secondsSince(&now);
+    results += CCString::createWithFormat("2 KB, 100 KB malloc per call: %.2f ms, %d allocations\n",
+                                          duration * 1000, kCallsPerTest)->getCString();
+
+    allocations = CCString::getFormatBufferAllocations();
+    gettimeofday(&now, NULL);
+    for (int i = 0; i < kCallsPerTest; i++)
+    {
+        str.initWithFormat("%d: %s", i, longText.c_str());
+    }
+    duration = secondsSince(&now);
+    results += CCString::createWithFormat("2 KB, CCString: %.2f ms, %u allocations",
+                                          duration * 1000, CCString::getFormatBufferAllocations() - allocations)->getCString();
+
+    CCLog("%s", results.c_str());
+    return results;
+}
+
+std::string StringFormatAllocTest::title()
+{
+    return "CCString format";
+}
+
+std::string StringFormatAllocTest::subtitle()
+{
+    return "Formatting buffer allocations, std::string ones excluded";
+}
+
+CCScene* StringFormatAllocTest::scene()
+{
+    CCScene *pScene = CCScene::create();
+    StringFormatAllocTest *layer = new StringFormatAllocTest(true, TEST_COUNT, s_nAllocCurCase);
+    pScene->addChild(layer);
+    layer->release();
+
+    return pScene;
+}
+
+////////////////////////////////////////////////////////
+//
+// AutoreleasePoolAllocTest
+//
+////////////////////////////////////////////////////////
+std::string AutoreleasePoolAllocTest::performTests()
+{
+    struct timeval now;
+    std::string results;
+    CCPoolManager *manager = CCPoolManager::sharedPoolManager();
+
+    CCLog("--------");
+    CCLog("%d objects per frame", kCallsPerTest);
+
+    // what CCAutoreleasePool did before: a CCArray retaining the objects, emptied every frame
+    CCArray *legacyPool = new CCArray();
+    legacyPool->init();
+    for (int frame = 0; frame < 2; frame++)
+    {
+        gettimeofday(&now, NULL);
+        for (int i = 0; i < kCallsPerTest; i++)
+        {
+            CCObject *pObject = new CCObject();
+            legacyPool->addObject(pObject);
+            pObject->release();
+        }
+        legacyPool->removeAllObjects();
+        results += CCString::createWithFormat("CCArray pool, frame %d: %.2f ms\n", frame + 1, secondsSince(&now) * 1000)->getCString();
+    }
+    legacyPool->release();
+
+    manager->setStatisticsEnabled(true);
+    for (int frame = 0; frame < 2; frame++)
+    {
+        gettimeofday(&now, NULL);
+        manager->push();
+        for (int i = 0; i < kCallsPerTest; i++)
+        {
+            (new CCObject())->autorelease();
+        }
+        manager->pop();
+        results += CCString::createWithFormat("chunked pool, frame %d: %.2f ms\n", frame + 1, secondsSince(&now) * 1000)->getCString();
+    }
+    manager->setStatisticsEnabled(false);
+    results += "The first frame allocates the chunks, the next ones reuse them";
+
+    CCLog("%s", results.c_str());
+    return results;
+}
+
+std::string AutoreleasePoolAllocTest::title()
+{
+    return "Autorelease pool";
+}
+
+std::string AutoreleasePoolAllocTest::subtitle()
+{
+    return "Autorelease then release objects, like in a frame";
+}
+
+CCScene* AutoreleasePoolAllocTest::scene()
+{
+    CCScene *pScene = CCScene::create();
+    AutoreleasePoolAllocTest *layer = new AutoreleasePoolAllocTest(true, TEST_COUNT, s_nAllocCurCase);
+    pScene->addChild(layer);
+    layer->release();
+
+    return pScene;
+}
+
+////////////////////////////////////////////////////////
+//
+// SmallObjectAllocTest
+//
+////////////////////////////////////////////////////////
+std::string SmallObjectAllocTest::performTests()
+{
+    struct timeval now;
+    std::string results;
+    static const size_t sizes[] = { sizeof(CCCallFunc), sizeof(CCSequence), sizeof(CCString), sizeof(CCSprite) };
+    static const int sizeCount = sizeof(sizes) / sizeof(sizes[0]);
+    void* blocks[sizeCount * 100];
+
+    CCLog("--------");
+    CCLog("%d objects per test", kCallsPerTest);
+
+    // the allocations of the actions of a typical game object
+    gettimeofday(&now, NULL);
+    for (int i = 0; i < kCallsPerTest; i++)
+    {
+        CCPoolManager::sharedPoolManager()->push();
+        CCSequence::create(CCMoveBy::create(1, ccp(10, 0)),
+                           CCRotateBy::create(1, 90),
+                           CCCallFunc::create(this, callfunc_selector(SmallObjectAllocTest::onExit)),
+                           NULL);
+        CCPoolManager::sharedPoolManager()->pop();
+    }
+    results += CCString::createWithFormat("sequences of 3 actions: %.2f ms\n", secondsSince(&now) * 1000)->getCString();
+
+    gettimeofday(&now, NULL);
+    for (int i = 0; i < kCallsPerTest; i++)
+    {
+        (new CCSprite())->release();
+    }
+    results += CCString::createWithFormat("sprites: %.2f ms\n", secondsSince(&now) * 1000)->getCString();
+
+    // the allocators alone, 100 blocks of each size of the classes above alive at once
+    gettimeofday(&now, NULL);
+    for (int i = 0; i < kCallsPerTest / 100; i++)
+    {
+        for (int j = 0; j < sizeCount * 100; j++)
+        {
+            blocks[j] = malloc(sizes[j % sizeCount]);
+        }
+        for (int j = 0; j < sizeCount * 100; j++)
+        {
+            free(blocks[j]);
+        }
+    }
+    results += CCString::createWithFormat("malloc / free: %.2f ms\n", secondsSince(&now) * 1000)->getCString();
+
+    gettimeofday(&now, NULL);
+    for (int i = 0; i < kCallsPerTest / 100; i++)
+    {
+        for (int j = 0; j < sizeCount * 100; j++)
+        {
+            blocks[j] = CCPoolAllocator::allocate(sizes[j % sizeCount]);
+        }
+        for (int j = 0; j < sizeCount * 100; j++)
+        {
+            CCPoolAllocator::deallocate(blocks[j], sizes[j % sizeCount]);
+        }
+    }
+    results += CCString::createWithFormat("CCPoolAllocator: %.2f ms\n", secondsSince(&now) * 1000)->getCString();
+
+    results += CCString::createWithFormat("%u KB reserved by the pools", CCPoolAllocator::getReservedMemory() / 1024)->getCString();
+    CCPoolAllocator::dumpStatistics();
+
+    CCLog("%s", results.c_str());
+    return results;
+}
+
+std::string SmallObjectAllocTest::title()
+{
+    return "Small objects";
+}
+
+std::string SmallObjectAllocTest::subtitle()
+{
+#if CC_ENABLE_POOL_ALLOCATOR
+    return "Create then release actions and sprites";
+#else
+    return "CC_ENABLE_POOL_ALLOCATOR is 0 (the default): the objects use the system allocator";
+#endif
+}
+
+CCScene* SmallObjectAllocTest::scene()
+{
+    CCScene *pScene = CCScene::create();
+    SmallObjectAllocTest *layer = new SmallObjectAllocTest(true, TEST_COUNT, s_nAllocCurCase);
+    pScene->addChild(layer);
+    layer->release();
+
+    return pScene;
+}
+
+void runAllocTest()
+{
+    s_nAllocCurCase = 0;
+    CCScene* pScene = StringFormatAllocTest::scene();
+    CCDirector::sharedDirector()->replaceScene(pScene);
+}
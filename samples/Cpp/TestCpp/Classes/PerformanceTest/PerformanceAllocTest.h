@@ -0,0 +1,70 @@
+#ifndef __PERFORMANCE_ALLOC_TEST_H__
+#define __PERFORMANCE_ALLOC_TEST_H__
+
+#include "PerformanceTest.h"
+
+class AllocMenuLayer : public PerformBasicLayer
+{
+public:
+    AllocMenuLayer(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        :PerformBasicLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual void showCurrentTest();
+
+    virtual void onEnter();
+    virtual std::string title();
+    virtual std::string subtitle();
+    // runs the benchmark and returns the text of the results, also written to the console
+    virtual std::string performTests() = 0;
+};
+
+class StringFormatAllocTest : public AllocMenuLayer
+{
+public:
+    StringFormatAllocTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        :AllocMenuLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual std::string performTests();
+    virtual std::string title();
+    virtual std::string subtitle();
+
+    static CCScene* scene();
+};
+
+class AutoreleasePoolAllocTest : public AllocMenuLayer
+{
+public:
+    AutoreleasePoolAllocTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        :AllocMenuLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual std::string performTests();
+    virtual std::string title();
+    virtual std::string subtitle();
+
+    static CCScene* scene();
+};
+
+class SmallObjectAllocTest : public AllocMenuLayer
+{
+public:
+    SmallObjectAllocTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        :AllocMenuLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual std::string performTests();
+    virtual std::string title();
+    virtual std::string subtitle();
+
+    static CCScene* scene();
+};
+
+void runAllocTest();
+
+#endif
@@ -0,0 +1,329 @@
+#include "PerformanceDictionaryTest.h"
+#include <map>
+
+enum
+{
+    TEST_COUNT = 3,
+    kPlistLoads = 50,
+    kLookupRounds = 2000,
+};
+
+static int s_nDictionaryCurCase = 0;
+
+static const char s_pszFramesPlist[] = "animations/grossini.plist";
+static const char s_pszAnimationsPlist[] = "animations/animations.plist";
+
+static float secondsSince(struct timeval *lastUpdate)
+{
+    struct timeval now;
+
+    gettimeofday(&now, NULL);
+
+    return (now.tv_sec - lastUpdate->tv_sec) + (now.tv_usec - lastUpdate->tv_usec) / 1000000.0f;
+}
+
+// the keys of a dictionary of the plist, like the frame names of a sprite sheet
+static std::vector<std::string> plistKeys(const char* pszPlist, const char* pszDictionary)
+{
+    std::vector<std::string> keys;
+    CCDictionary* pPlist = CCDictionary::createWithContentsOfFile(pszPlist);
+    CCDictionary* pDict = (CCDictionary*)pPlist->objectForKey(pszDictionary);
+    CCDictElement* pElement = NULL;
+    CCDICT_FOREACH(pDict, pElement)
+    {
+        keys.push_back(pElement->getStrKey());
+    }
+    return keys;
+}
+
+////////////////////////////////////////////////////////
+//
+// DictionaryMenuLayer
+//
+////////////////////////////////////////////////////////
+void DictionaryMenuLayer::showCurrentTest()
+{
+    CCScene* pScene = NULL;
+
+    switch (m_nCurCase)
+    {
+    case 0:
+        pScene = PlistDictionaryTest::scene();
+        break;
+    case 1:
+        pScene = SpriteFrameDictionaryTest::scene();
+        break;
+    case 2:
+        pScene = AnimationDictionaryTest::scene();
+        break;
+    }
+    s_nDictionaryCurCase = m_nCurCase;
+
+    if (pScene)
+    {
+        CCDirector::sharedDirector()->replaceScene(pScene);
+    }
+}
+
+void DictionaryMenuLayer::onEnter()
+{
+    PerformBasicLayer::onEnter();
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    // Title
+    CCLabelTTF *label = CCLabelTTF::create(title().c_str(), "Arial", 40);
+    addChild(label, 1);
+    label->setPosition(ccp(s.width/2, s.height-32));
+    label->setColor(ccc3(255,255,40));
+
+    // Subtitle
+    std::string strSubTitle = subtitle();
+    if(strSubTitle.length())
+    {
+        CCLabelTTF *l = CCLabelTTF::create(strSubTitle.c_str(), "Thonburi", 16);
+        addChild(l, 1);
+        l->setPosition(ccp(s.width/2, s.height-80));
+    }
+
+    std::string results = performTests();
+    CCLabelTTF *resultsLabel = CCLabelTTF::create(results.c_str(), "Arial", 16);
+    addChild(resultsLabel, 1);
+    resultsLabel->setPosition(ccp(s.width/2, s.height/2));
+}
+
+std::string DictionaryMenuLayer::title()
+{
+    return "no title";
+}
+
+std::string DictionaryMenuLayer::subtitle()
+{
+    return "no subtitle";
+}
+
+////////////////////////////////////////////////////////
+//
+// PlistDictionaryTest
+//
+////////////////////////////////////////////////////////
+std::string PlistDictionaryTest::performTests()
+{
+    struct timeval now;
+    std::string results;
+    CCSpriteFrameCache *pFrameCache = CCSpriteFrameCache::sharedSpriteFrameCache();
+
+    CCLog("--------");
+    CCLog("%d loads of %s per test", kPlistLoads, s_pszFramesPlist);
+
+    // loads the texture once, outside of the measures
+    pFrameCache->addSpriteFramesWithFile(s_pszFramesPlist);
+    pFrameCache->removeSpriteFramesFromFile(s_pszFramesPlist);
+
+    gettimeofday(&now, NULL);
+    for (int i = 0; i < kPlistLoads; i++)
+    {
+        // not autoreleased, the dictionaries are freed in the loop
+        CCDictionary* pDict = CCDictionary::createWithContentsOfFileThreadSafe(s_pszFramesPlist);
+        pDict->release();
+    }
+    results += CCString::createWithFormat("CCDictionary: %.2f ms\n", secondsSince(&now) * 1000)->getCString();
+
+    gettimeofday(&now, NULL);
+    for (int i = 0; i < kPlistLoads; i++)
+    {
+        pFrameCache->addSpriteFramesWithFile(s_pszFramesPlist);
+        pFrameCache->removeSpriteFramesFromFile(s_pszFramesPlist);
+    }
+    results += CCString::createWithFormat("CCSpriteFrameCache add and remove: %.2f ms", secondsSince(&now) * 1000)->getCString();
+
+    CCLog("%s", results.c_str());
+    return results;
+}
+
+std::string PlistDictionaryTest::title()
+{
+    return "Plist loading";
+}
+
+std::string PlistDictionaryTest::subtitle()
+{
+    return "CCDictionary::createWithContentsOfFile and addSpriteFramesWithFile";
+}
+
+CCScene* PlistDictionaryTest::scene()
+{
+    CCScene *pScene = CCScene::create();
+    PlistDictionaryTest *layer = new PlistDictionaryTest(true, TEST_COUNT, s_nDictionaryCurCase);
+    pScene->addChild(layer);
+    layer->release();
+
+    return pScene;
+}
+
+////////////////////////////////////////////////////////
+//
+// SpriteFrameDictionaryTest
+//
+////////////////////////////////////////////////////////
+std::string SpriteFrameDictionaryTest::performTests()
+{
+    struct timeval now;
+    std::string results;
+    CCSpriteFrameCache *pFrameCache = CCSpriteFrameCache::sharedSpriteFrameCache();
+    std::vector<std::string> names = plistKeys(s_pszFramesPlist, "frames");
+    unsigned int nCount = names.size();
+    int nFound = 0;
+
+    CCLog("--------");
+    CCLog("%d rounds of %u frame names per test", kLookupRounds, nCount);
+
+    pFrameCache->addSpriteFramesWithFile(s_pszFramesPlist);
+
+    gettimeofday(&now, NULL);
+    for (int r = 0; r < kLookupRounds; r++)
+    {
+        for (unsigned int i = 0; i < nCount; i++)
+        {
+            nFound += pFrameCache->spriteFrameByName(names[i].c_str()) != NULL;
+        }
+    }
+    results += CCString::createWithFormat("spriteFrameByName: %.2f ms\n", secondsSince(&now) * 1000)->getCString();
+
+    // the same names in a dictionary of the test, to compare the kinds of keys
+    CCDictionary* pDict = CCDictionary::create();
+    std::map<std::string, CCObject*> map;
+    std::vector<CCDictKey> keys;
+    for (unsigned int i = 0; i < nCount; i++)
+    {
+        CCSpriteFrame* pFrame = pFrameCache->spriteFrameByName(names[i].c_str());
+        pDict->setObject(pFrame, names[i]);
+        map[names[i]] = pFrame;
+        keys.push_back(CCDictKey(names[i]));
+    }
+
+    gettimeofday(&now, NULL);
+    for (int r = 0; r < kLookupRounds; r++)
+    {
+        for (unsigned int i = 0; i < nCount; i++)
+        {
+            nFound += pDict->objectForKey(names[i]) != NULL;
+        }
+    }
+    results += CCString::createWithFormat("std::string keys: %.2f ms\n", secondsSince(&now) * 1000)->getCString();
+
+    gettimeofday(&now, NULL);
+    for (int r = 0; r < kLookupRounds; r++)
+    {
+        for (unsigned int i = 0; i < nCount; i++)
+        {
+            nFound += pDict->objectForKey(keys[i]) != NULL;
+        }
+    }
+    results += CCString::createWithFormat("CCDictKey keys: %.2f ms\n", secondsSince(&now) * 1000)->getCString();
+
+    gettimeofday(&now, NULL);
+    for (int r = 0; r < kLookupRounds; r++)
+    {
+        for (unsigned int i = 0; i < nCount; i++)
+        {
+            nFound += map.find(names[i]) != map.end();
+        }
+    }
+    results += CCString::createWithFormat("std::map: %.2f ms", secondsSince(&now) * 1000)->getCString();
+
+    pFrameCache->removeSpriteFramesFromFile(s_pszFramesPlist);
+
+    CCLog("%s", results.c_str());
+    CCLog("%d lookups found", nFound);
+    return results;
+}
+
+std::string SpriteFrameDictionaryTest::title()
+{
+    return "Sprite frame lookups";
+}
+
+std::string SpriteFrameDictionaryTest::subtitle()
+{
+    return "spriteFrameByName, and the same names in a CCDictionary";
+}
+
+CCScene* SpriteFrameDictionaryTest::scene()
+{
+    CCScene *pScene = CCScene::create();
+    SpriteFrameDictionaryTest *layer = new SpriteFrameDictionaryTest(true, TEST_COUNT, s_nDictionaryCurCase);
+    pScene->addChild(layer);
+    layer->release();
+
+    return pScene;
+}
+
+////////////////////////////////////////////////////////
+//
+// AnimationDictionaryTest
+//
+////////////////////////////////////////////////////////
+std::string AnimationDictionaryTest::performTests()
+{
+    struct timeval now;
+    std::string results;
+    CCAnimationCache *pAnimationCache = CCAnimationCache::sharedAnimationCache();
+    std::vector<std::string> names = plistKeys(s_pszAnimationsPlist, "animations");
+    unsigned int nCount = names.size();
+    int nFound = 0;
+
+    CCLog("--------");
+    CCLog("%d rounds of %u animation names per test", kLookupRounds * 10, nCount);
+
+    // the animations of the plist are made of the grossini frames
+    CCSpriteFrameCache::sharedSpriteFrameCache()->addSpriteFramesWithFile(s_pszFramesPlist);
+    pAnimationCache->addAnimationsWithFile(s_pszAnimationsPlist);
+
+    gettimeofday(&now, NULL);
+    for (int r = 0; r < kLookupRounds * 10; r++)
+    {
+        for (unsigned int i = 0; i < nCount; i++)
+        {
+            nFound += pAnimationCache->animationByName(names[i].c_str()) != NULL;
+        }
+    }
+    results += CCString::createWithFormat("animationByName: %.2f ms", secondsSince(&now) * 1000)->getCString();
+
+    for (unsigned int i = 0; i < nCount; i++)
+    {
+        pAnimationCache->removeAnimationByName(names[i].c_str());
+    }
+    CCSpriteFrameCache::sharedSpriteFrameCache()->removeSpriteFramesFromFile(s_pszFramesPlist);
+
+    CCLog("%s", results.c_str());
+    CCLog("%d lookups found", nFound);
+    return results;
+}
+
+std::string AnimationDictionaryTest::title()
+{
+    return "Animation lookups";
+}
+
+std::string AnimationDictionaryTest::subtitle()
+{
+    return "CCAnimationCache::animationByName";
+}
+
+CCScene* AnimationDictionaryTest::scene()
+{
+    CCScene *pScene = CCScene::create();
+    AnimationDictionaryTest *layer = new AnimationDictionaryTest(true, TEST_COUNT, s_nDictionaryCurCase);
+    pScene->addChild(layer);
+    layer->release();
+
+    return pScene;
+}
+
+void runDictionaryTest()
+{
+    s_nDictionaryCurCase = 0;
+    CCScene* pScene = PlistDictionaryTest::scene();
+    CCDirector::sharedDirector()->replaceScene(pScene);
+}
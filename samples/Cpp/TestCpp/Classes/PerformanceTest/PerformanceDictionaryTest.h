@@ -0,0 +1,70 @@
+#ifndef __PERFORMANCE_DICTIONARY_TEST_H__
+#define __PERFORMANCE_DICTIONARY_TEST_H__
+
+#include "PerformanceTest.h"
+
+class DictionaryMenuLayer : public PerformBasicLayer
+{
+public:
+    DictionaryMenuLayer(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        :PerformBasicLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual void showCurrentTest();
+
+    virtual void onEnter();
+    virtual std::string title();
+    virtual std::string subtitle();
+    // runs the benchmark and returns the text of the results, also written to the console
+    virtual std::string performTests() = 0;
+};
+
+class PlistDictionaryTest : public DictionaryMenuLayer
+{
+public:
+    PlistDictionaryTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        :DictionaryMenuLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual std::string performTests();
+    virtual std::string title();
+    virtual std::string subtitle();
+
+    static CCScene* scene();
+};
+
+class SpriteFrameDictionaryTest : public DictionaryMenuLayer
+{
+public:
+    SpriteFrameDictionaryTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        :DictionaryMenuLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual std::string performTests();
+    virtual std::string title();
+    virtual std::string subtitle();
+
+    static CCScene* scene();
+};
+
+class AnimationDictionaryTest : public DictionaryMenuLayer
+{
+public:
+    AnimationDictionaryTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        :DictionaryMenuLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual std::string performTests();
+    virtual std::string title();
+    virtual std::string subtitle();
+
+    static CCScene* scene();
+};
+
+void runDictionaryTest();
+
+#endif
@@ -7,7 +7,7 @@ enum {
 
     kTagBase = 20000,
 
-    TEST_COUNT = 4,
+    TEST_COUNT = 5,
 };
 
 enum {
@@ -50,6 +50,9 @@ void NodeChildrenMenuLayer::showCurrentTest()
     case 3:
         pScene = new ReorderSpriteSheet();
         break;
+    case 4:
+        pScene = new TagLookupNodeChildren();
+        break;
     }
     s_nCurCase = m_nCurCase;
 
@@ -524,6 +527,106 @@ const char*  ReorderSpriteSheet::profilerName()
     return "reorder sprites";
 }
 
+////////////////////////////////////////////////////////
+//
+// TagLookupNodeChildren
+//
+////////////////////////////////////////////////////////
+TagLookupNodeChildren::~TagLookupNodeChildren()
+{
+
+}
+
+void TagLookupNodeChildren::initWithQuantityOfNodes(unsigned int nNodes)
+{
+    // plain nodes, so only the children bookkeeping of CCNode is measured
+    scanNode = CCNode::create();
+    scanNode->setVisible(false);
+    addChild(scanNode);
+
+    indexedNode = CCNode::create();
+    indexedNode->setVisible(false);
+    indexedNode->setChildTagIndexEnabled(true);
+    addChild(indexedNode);
+
+    NodeChildrenMainScene::initWithQuantityOfNodes(nNodes);
+
+    scheduleUpdate();
+}
+
+void TagLookupNodeChildren::updateQuantityOfNodes()
+{
+    CCNode* parents[] = { scanNode, indexedNode };
+
+    for (int p = 0; p < 2; p++)
+    {
+        // increase nodes
+        for (int i = currentQuantityOfNodes; i < quantityOfNodes; i++)
+        {
+            parents[p]->addChild(CCNode::create(), (int)(CCRANDOM_MINUS1_1() * 50), kTagBase+i);
+        }
+        // decrease nodes
+        for (int i = currentQuantityOfNodes-1; i >= quantityOfNodes; i--)
+        {
+            parents[p]->removeChildByTag(kTagBase+i, true);
+        }
+        parents[p]->sortAllChildren();
+    }
+
+    currentQuantityOfNodes = quantityOfNodes;
+}
+
+void TagLookupNodeChildren::lookupAndRemove(CCNode* pParent, const char* lookupName, const char* removeName)
+{
+    // 15 percent, spread over the whole array (7919 is prime, so the tags are distinct)
+    int totalToRemove = currentQuantityOfNodes * 0.15f;
+    CCArray* children = CCArray::createWithCapacity(totalToRemove);
+
+    CC_PROFILER_START(lookupName);
+
+    for (int i = 0; i < totalToRemove; i++)
+    {
+        children->addObject(pParent->getChildByTag(kTagBase + (i * 7919) % currentQuantityOfNodes));
+    }
+
+    CC_PROFILER_STOP(lookupName);
+
+    CC_PROFILER_START(removeName);
+
+    for (int i = 0; i < totalToRemove; i++)
+    {
+        pParent->removeChild((CCNode*) children->objectAtIndex(i), false);
+    }
+
+    CC_PROFILER_STOP(removeName);
+
+    // put them back, keeping their tag and z order
+    for (int i = 0; i < totalToRemove; i++)
+    {
+        pParent->addChild((CCNode*) children->objectAtIndex(i));
+    }
+    pParent->sortAllChildren();
+}
+
+void TagLookupNodeChildren::update(float dt)
+{
+    if (currentQuantityOfNodes > 0)
+    {
+        lookupAndRemove(scanNode, "getChildByTag scan", "removeChild");
+        lookupAndRemove(indexedNode, "getChildByTag index", "removeChild + tag index");
+    }
+}
+
+std::string TagLookupNodeChildren::title()
+{
+    return "F - Tag lookup & removal";
+}
+
+std::string TagLookupNodeChildren::subtitle()
+{
+    return "Find and remove %15 of the children by tag, with and without tag index. Try 10000 nodes. See console";
+}
+
 void runNodeChildrenTest()
 {
     IterateSpriteSheet* pScene = new IterateSpriteSheetCArray();
@@ -111,6 +111,24 @@ public:
     virtual const char* profilerName();
 };
 
+class TagLookupNodeChildren : public NodeChildrenMainScene
+{
+public:
+    virtual ~TagLookupNodeChildren();
+    virtual void updateQuantityOfNodes();
+    virtual void initWithQuantityOfNodes(unsigned int nNodes);
+    virtual void update(float dt);
+
+    virtual std::string title();
+    virtual std::string subtitle();
+
+protected:
+    void lookupAndRemove(CCNode* pParent, const char* lookupName, const char* removeName);
+
+    CCNode* scanNode;
+    CCNode* indexedNode;
+};
+
 void runNodeChildrenTest();
 
 #endif // __PERFORMANCE_NODE_CHILDREN_TEST_H__
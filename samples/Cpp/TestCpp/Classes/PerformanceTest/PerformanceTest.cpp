@@ -5,11 +5,14 @@
 #include "PerformanceSpriteTest.h"
 #include "PerformanceTextureTest.h"
 #include "PerformanceTouchesTest.h"
+#include "PerformanceAllocTest.h"
+#include "PerformanceTextTest.h"
+#include "PerformanceDictionaryTest.h"
 
 enum
 {
-    MAX_COUNT = 5,
-    LINE_SPACE = 40,
+    MAX_COUNT = 8,
+    LINE_SPACE = 36,
     kItemTagBasic = 1000,
 };
 
@@ -19,7 +22,10 @@ const std::string testsName[MAX_COUNT] =
     "PerformanceParticleTest",
     "PerformanceSpriteTest",
     "PerformanceTextureTest",
-    "PerformanceTouchesTest"
+    "PerformanceTouchesTest",
+    "PerformanceAllocTest",
+    "PerformanceTextTest",
+    "PerformanceDictionaryTest"
 };
 
 ////////////////////////////////////////////////////////
@@ -70,6 +76,15 @@ void PerformanceMainLayer::menuCallback(CCObject* pSender)
     case 4:
         runTouchesTest();
         break;
+    case 5:
+        runAllocTest();
+        break;
+    case 6:
+        runTextTest();
+        break;
+    case 7:
+        runDictionaryTest();
+        break;
     default:
         break;
     }
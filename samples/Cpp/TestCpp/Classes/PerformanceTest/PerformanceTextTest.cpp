@@ -0,0 +1,378 @@
+#include "PerformanceTextTest.h"
+#include "support/ccUTF8.h"
+#include "support/image_support/ccPixelConversion.h"
+
+enum
+{
+    TEST_COUNT = 3,
+    kRunsPerTest = 20,
+    kTextSize = 256 * 1024,
+    kLabelUpdates = 50,
+};
+
+static int s_nTextCurCase = 0;
+
+static float secondsSince(struct timeval *lastUpdate)
+{
+    struct timeval now;
+
+    gettimeofday(&now, NULL);
+
+    return (now.tv_sec - lastUpdate->tv_sec) + (now.tv_usec - lastUpdate->tv_usec) / 1000000.0f;
+}
+
+// the sample texts, about kTextSize bytes of UTF-8 each
+static const int s_nTextCount = 3;
+static const char* s_pszTextNames[s_nTextCount] = { "English", "French", "Chinese" };
+static const char* s_pszTextSentences[s_nTextCount] =
+{
+    "The quick brown fox jumps over the lazy dog. ",
+    "Le c\xc5\x93ur d\xc3\xa9\xc3\xa7u mais l'\xc3\xa2me plut\xc3\xb4t na\xc3\xafve, Lou\xc3\xbfs r\xc3\xaava de crapa\xc3\xbcter en cano\xc3\xab. ",
+    "\xe6\x95\x8f\xe6\x8d\xb7\xe7\x9a\x84\xe6\xa3\x95\xe8\x89\xb2\xe7\x8b\x90\xe7\x8b\xb8\xe8\xb7\xb3\xe8\xbf\x87\xe4\xba\x86\xe9\x82\xa3\xe5\x8f\xaa\xe6\x87\x92\xe7\x8b\x97\xe3\x80\x82 ",
+};
+
+static std::string sampleText(int index)
+{
+    std::string text;
+    text.reserve(kTextSize + 256);
+    while (text.size() < kTextSize)
+    {
+        text += s_pszTextSentences[index];
+    }
+    return text;
+}
+
+// the character count of CCTextFieldTTF before cc_utf8_count_chars: every byte but 10xxxxxx
+static int countCharsByByte(const char* text)
+{
+    int n = 0;
+    for (; *text; ++text)
+    {
+        if (0x80 != (0xC0 & *text))
+        {
+            ++n;
+        }
+    }
+    return n;
+}
+
+// Text with stray continuation bytes inside and next to ASCII runs of every length. cc_utf8_count_chars must
+// skip them as the byte loop did, from every starting offset so that they fall at every place of a SIMD block.
+static bool checkStrayContinuationBytes()
+{
+    std::string text;
+    for (int run = 0; run < 40; run++)
+    {
+        text.append(run, 'a');
+        text += (run & 1) ? "\x80" : "\xbf\xbf";
+        text += "\xc3\xa9";
+        text += (run % 3) ? "\xe6\x95" : "\x8f";
+    }
+
+    bool passed = true;
+    for (int simd = 0; simd < 2; simd++)
+    {
+        ccSetCPUFeaturesMask(simd ? ~0u : 0);
+        for (size_t offset = 0; offset < 32; offset++)
+        {
+            const char* p = text.c_str() + offset;
+            if (cc_utf8_count_chars(p) != countCharsByByte(p) ||
+                cc_utf8_count_chars(p, (int)strlen(p)) != countCharsByByte(p))
+            {
+                CCLog("cc_utf8_count_chars differs from the byte loop at offset %d, SIMD %s",
+                      (int)offset, simd ? "on" : "off");
+                passed = false;
+            }
+        }
+    }
+    ccSetCPUFeaturesMask(~0u);
+    return passed;
+}
+
+////////////////////////////////////////////////////////
+//
+// TextMenuLayer
+//
+////////////////////////////////////////////////////////
+void TextMenuLayer::showCurrentTest()
+{
+    CCScene* pScene = NULL;
+
+    switch (m_nCurCase)
+    {
+    case 0:
+        pScene = UTF8ToUTF16TextTest::scene();
+        break;
+    case 1:
+        pScene = UTF16ToUTF8TextTest::scene();
+        break;
+    case 2:
+        pScene = LabelBMFontTextTest::scene();
+        break;
+    }
+    s_nTextCurCase = m_nCurCase;
+
+    if (pScene)
+    {
+        CCDirector::sharedDirector()->replaceScene(pScene);
+    }
+}
+
+void TextMenuLayer::onEnter()
+{
+    PerformBasicLayer::onEnter();
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    // Title
+    CCLabelTTF *label = CCLabelTTF::create(title().c_str(), "Arial", 40);
+    addChild(label, 1);
+    label->setPosition(ccp(s.width/2, s.height-32));
+    label->setColor(ccc3(255,255,40));
+
+    // Subtitle
+    std::string strSubTitle = subtitle();
+    if(strSubTitle.length())
+    {
+        CCLabelTTF *l = CCLabelTTF::create(strSubTitle.c_str(), "Thonburi", 16);
+        addChild(l, 1);
+        l->setPosition(ccp(s.width/2, s.height-80));
+    }
+
+    std::string results = performTests();
+    CCLabelTTF *resultsLabel = CCLabelTTF::create(results.c_str(), "Arial", 16);
+    addChild(resultsLabel, 1);
+    resultsLabel->setPosition(ccp(s.width/2, s.height/2));
+}
+
+std::string TextMenuLayer::title()
+{
+    return "no title";
+}
+
+std::string TextMenuLayer::subtitle()
+{
+    return "no subtitle";
+}
+
+////////////////////////////////////////////////////////
+//
+// UTF8ToUTF16TextTest
+//
+////////////////////////////////////////////////////////
+std::string UTF8ToUTF16TextTest::performTests()
+{
+    struct timeval now;
+    std::string results;
+    std::vector<unsigned short> utf16;
+
+    CCLog("--------");
+    CCLog("%d conversions of %d KB per test", kRunsPerTest, kTextSize / 1024);
+
+    for (int t = 0; t < s_nTextCount; t++)
+    {
+        std::string text = sampleText(t);
+        float scalar, simd, reused, length, validation;
+
+        ccSetCPUFeaturesMask(0);
+        gettimeofday(&now, NULL);
+        for (int i = 0; i < kRunsPerTest; i++)
+        {
+            delete [] cc_utf8_to_utf16(text.c_str());
+        }
+        scalar = secondsSince(&now);
+
+        ccSetCPUFeaturesMask(~0u);
+        gettimeofday(&now, NULL);
+        for (int i = 0; i < kRunsPerTest; i++)
+        {
+            delete [] cc_utf8_to_utf16(text.c_str());
+        }
+        simd = secondsSince(&now);
+
+        // a single pass, in the memory of the previous conversion
+        gettimeofday(&now, NULL);
+        for (int i = 0; i < kRunsPerTest; i++)
+        {
+            cc_utf8_to_utf16(text.c_str(), -1, utf16);
+        }
+        reused = secondsSince(&now);
+
+        gettimeofday(&now, NULL);
+        for (int i = 0; i < kRunsPerTest; i++)
+        {
+            cc_utf8_strlen(text.c_str(), -1);
+        }
+        length = secondsSince(&now);
+
+        gettimeofday(&now, NULL);
+        for (int i = 0; i < kRunsPerTest; i++)
+        {
+            cc_utf8_validate(text.c_str());
+        }
+        validation = secondsSince(&now);
+
+        results += CCString::createWithFormat("%s: scalar %.2f ms, SIMD %.2f ms, reused vector %.2f ms\n"
+                                              "length %.2f ms, validation %.2f ms\n",
+                                              s_pszTextNames[t], scalar * 1000, simd * 1000, reused * 1000,
+                                              length * 1000, validation * 1000)->getCString();
+    }
+
+    results += checkStrayContinuationBytes() ? "stray continuation bytes: passed" : "stray continuation bytes: FAILED";
+
+    CCLog("%s", results.c_str());
+    return results;
+}
+
+std::string UTF8ToUTF16TextTest::title()
+{
+    return "UTF-8 to UTF-16";
+}
+
+std::string UTF8ToUTF16TextTest::subtitle()
+{
+    return "cc_utf8_to_utf16, cc_utf8_strlen and cc_utf8_validate";
+}
+
+CCScene* UTF8ToUTF16TextTest::scene()
+{
+    CCScene *pScene = CCScene::create();
+    UTF8ToUTF16TextTest *layer = new UTF8ToUTF16TextTest(true, TEST_COUNT, s_nTextCurCase);
+    pScene->addChild(layer);
+    layer->release();
+
+    return pScene;
+}
+
+////////////////////////////////////////////////////////
+//
+// UTF16ToUTF8TextTest
+//
+////////////////////////////////////////////////////////
+std::string UTF16ToUTF8TextTest::performTests()
+{
+    struct timeval now;
+    std::string results;
+    std::vector<unsigned short> utf16;
+
+    CCLog("--------");
+    CCLog("%d conversions of %d KB of UTF-8 per test", kRunsPerTest, kTextSize / 1024);
+
+    for (int t = 0; t < s_nTextCount; t++)
+    {
+        std::string text = sampleText(t);
+        cc_utf8_to_utf16(text.c_str(), -1, utf16);
+        utf16.push_back(0);
+        float scalar, simd;
+
+        ccSetCPUFeaturesMask(0);
+        gettimeofday(&now, NULL);
+        for (int i = 0; i < kRunsPerTest; i++)
+        {
+            delete [] cc_utf16_to_utf8(&utf16[0], -1, NULL, NULL);
+        }
+        scalar = secondsSince(&now);
+
+        ccSetCPUFeaturesMask(~0u);
+        gettimeofday(&now, NULL);
+        for (int i = 0; i < kRunsPerTest; i++)
+        {
+            delete [] cc_utf16_to_utf8(&utf16[0], -1, NULL, NULL);
+        }
+        simd = secondsSince(&now);
+
+        results += CCString::createWithFormat("%s: scalar %.2f ms, SIMD %.2f ms\n",
+                                              s_pszTextNames[t], scalar * 1000, simd * 1000)->getCString();
+    }
+
+    CCLog("%s", results.c_str());
+    return results;
+}
+
+std::string UTF16ToUTF8TextTest::title()
+{
+    return "UTF-16 to UTF-8";
+}
+
+std::string UTF16ToUTF8TextTest::subtitle()
+{
+    return "cc_utf16_to_utf8";
+}
+
+CCScene* UTF16ToUTF8TextTest::scene()
+{
+    CCScene *pScene = CCScene::create();
+    UTF16ToUTF8TextTest *layer = new UTF16ToUTF8TextTest(true, TEST_COUNT, s_nTextCurCase);
+    pScene->addChild(layer);
+    layer->release();
+
+    return pScene;
+}
+
+////////////////////////////////////////////////////////
+//
+// LabelBMFontTextTest
+//
+////////////////////////////////////////////////////////
+std::string LabelBMFontTextTest::performTests()
+{
+    struct timeval now;
+    std::string results;
+    std::string text;
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    while (text.size() < 2000)
+    {
+        text += s_pszTextSentences[0];
+    }
+
+    CCLog("--------");
+    CCLog("%d updates of a %d characters label per test", kLabelUpdates, (int)text.size());
+
+    CCLabelBMFont *label = CCLabelBMFont::create("", "fonts/markerFelt.fnt");
+    gettimeofday(&now, NULL);
+    for (int i = 0; i < kLabelUpdates; i++)
+    {
+        label->setString(text.c_str());
+    }
+    results += CCString::createWithFormat("one line: %.2f ms\n", secondsSince(&now) * 1000)->getCString();
+
+    // line breaks convert the string again and search it at every line
+    label = CCLabelBMFont::create("", "fonts/markerFelt.fnt", s.width / 1.5f);
+    gettimeofday(&now, NULL);
+    for (int i = 0; i < kLabelUpdates; i++)
+    {
+        label->setString(text.c_str());
+    }
+    results += CCString::createWithFormat("wrapped: %.2f ms", secondsSince(&now) * 1000)->getCString();
+
+    CCLog("%s", results.c_str());
+    return results;
+}
+
+std::string LabelBMFontTextTest::title()
+{
+    return "CCLabelBMFont";
+}
+
+std::string LabelBMFontTextTest::subtitle()
+{
+    return "setString with a long text, not displayed";
+}
+
+CCScene* LabelBMFontTextTest::scene()
+{
+    CCScene *pScene = CCScene::create();
+    LabelBMFontTextTest *layer = new LabelBMFontTextTest(true, TEST_COUNT, s_nTextCurCase);
+    pScene->addChild(layer);
+    layer->release();
+
+    return pScene;
+}
+
+void runTextTest()
+{
+    s_nTextCurCase = 0;
+    CCScene* pScene = UTF8ToUTF16TextTest::scene();
+    CCDirector::sharedDirector()->replaceScene(pScene);
+}
@@ -0,0 +1,70 @@
+#ifndef __PERFORMANCE_TEXT_TEST_H__
+#define __PERFORMANCE_TEXT_TEST_H__
+
+#include "PerformanceTest.h"
+
+class TextMenuLayer : public PerformBasicLayer
+{
+public:
+    TextMenuLayer(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        :PerformBasicLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual void showCurrentTest();
+
+    virtual void onEnter();
+    virtual std::string title();
+    virtual std::string subtitle();
+    // runs the benchmark and returns the text of the results, also written to the console
+    virtual std::string performTests() = 0;
+};
+
+class UTF8ToUTF16TextTest : public TextMenuLayer
+{
+public:
+    UTF8ToUTF16TextTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        :TextMenuLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual std::string performTests();
+    virtual std::string title();
+    virtual std::string subtitle();
+
+    static CCScene* scene();
+};
+
+class UTF16ToUTF8TextTest : public TextMenuLayer
+{
+public:
+    UTF16ToUTF8TextTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        :TextMenuLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual std::string performTests();
+    virtual std::string title();
+    virtual std::string subtitle();
+
+    static CCScene* scene();
+};
+
+class LabelBMFontTextTest : public TextMenuLayer
+{
+public:
+    LabelBMFontTextTest(bool bControlMenuVisible, int nMaxCases = 0, int nCurCase = 0)
+        :TextMenuLayer(bControlMenuVisible, nMaxCases, nCurCase)
+    {
+    }
+
+    virtual std::string performTests();
+    virtual std::string title();
+    virtual std::string subtitle();
+
+    static CCScene* scene();
+};
+
+void runTextTest();
+
+#endif
@@ -13,6 +13,7 @@ TESTLAYER_CREATE_FUNC(RenderTextureZbuffer);
 TESTLAYER_CREATE_FUNC(RenderTextureTestDepthStencil);
 TESTLAYER_CREATE_FUNC(RenderTextureTargetNode);
 TESTLAYER_CREATE_FUNC(SpriteRenderTextureBug);
+TESTLAYER_CREATE_FUNC(RenderCacheNodeTest);
 
 static NEWTESTFUNC createFunctions[] = {
     CF(RenderTextureSave),
@@ -21,6 +22,7 @@ static NEWTESTFUNC createFunctions[] = {
     CF(RenderTextureTestDepthStencil),
     CF(RenderTextureTargetNode),
     CF(SpriteRenderTextureBug),
+    CF(RenderCacheNodeTest),
 };
 
 #define MAX_LAYER   (sizeof(createFunctions)/sizeof(createFunctions[0]))
@@ -151,8 +153,9 @@ RenderTextureSave::RenderTextureSave()
     // Save Image menu
     CCMenuItemFont::setFontSize(16);
     CCMenuItem *item1 = CCMenuItemFont::create("Save Image", this, menu_selector(RenderTextureSave::saveImage));
-    CCMenuItem *item2 = CCMenuItemFont::create("Clear", this, menu_selector(RenderTextureSave::clearImage));
-    CCMenu *menu = CCMenu::create(item1, item2, NULL);
+    CCMenuItem *item2 = CCMenuItemFont::create("Save Image Async", this, menu_selector(RenderTextureSave::saveImageAsync));
+    CCMenuItem *item3 = CCMenuItemFont::create("Clear", this, menu_selector(RenderTextureSave::clearImage));
+    CCMenu *menu = CCMenu::create(item1, item2, item3, NULL);
     this->addChild(menu);
     menu->alignItemsVertically();
     menu->setPosition(ccp(VisibleRect::rightTop().x - 80, VisibleRect::rightTop().y - 30));
@@ -204,6 +207,50 @@ void RenderTextureSave::saveImage(cocos2d::CCObject *pSender)
     counter++;
 }
 
+void RenderTextureSave::saveImageAsync(cocos2d::CCObject *pSender)
+{
+    static int counter = 0;
+
+    char png[32];
+    sprintf(png, "image-async-%d.png", counter);
+
+    // the pixels are read back on a later frame and encoded on a worker thread,
+    // so saving does not stall the frame
+    m_pTarget->saveToFileAsync(png, kCCImageFormatPNG, this, callfuncO_selector(RenderTextureSave::imageSaved));
+    m_pTarget->readImageAsync(this, callfuncO_selector(RenderTextureSave::imageRead));
+
+    counter++;
+}
+
+void RenderTextureSave::imageSaved(CCObject *pPath)
+{
+    CCString *path = (CCString*)pPath;
+    CCLog("Image %s %s", path ? path->getCString() : "", path ? "saved" : "could not be saved");
+}
+
+void RenderTextureSave::imageRead(CCObject *pImage)
+{
+    static int counter = 0;
+
+    if (! pImage)
+    {
+        return;
+    }
+
+    char key[32];
+    sprintf(key, "image-async-%d", counter);
+    CCTexture2D *tex = CCTextureCache::sharedTextureCache()->addUIImage((CCImage*)pImage, key);
+
+    CCSprite *sprite = CCSprite::createWithTexture(tex);
+
+    sprite->setScale(0.3f);
+    addChild(sprite);
+    sprite->setPosition(ccp(VisibleRect::right().x - 40, 40));
+    sprite->setRotation(counter * 3);
+
+    counter++;
+}
+
 RenderTextureSave::~RenderTextureSave()
 {
     m_pBrush->release();
@@ -727,3 +774,81 @@ std::string SpriteRenderTextureBug::subtitle()
 {
     return "Touch the screen. Sprite should appear on under the touch";
 }
+
+// RenderCacheNodeTest
+
+RenderCacheNodeTest::RenderCacheNodeTest()
+{
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    // a panel of 100 sprites and 10 labels, drawn with one draw call while nothing changes
+    m_pCache = CCRenderCacheNode::create(CCSizeMake(300, 200));
+    m_pCache->setAnchorPoint(ccp(0.5f, 0.5f));
+    m_pCache->setPosition(ccp(s.width / 2, s.height / 2));
+    addChild(m_pCache);
+
+    CCLayerColor *background = CCLayerColor::create(ccc4(40, 40, 80, 255), 300, 200);
+    m_pCache->addChild(background, -1);
+
+    for (int i = 0; i < 100; i++)
+    {
+        CCSprite *sprite = CCSprite::create("Images/grossini.png");
+        sprite->setScale(0.2f);
+        sprite->setPosition(ccp(15 + (i % 10) * 30, 20 + (i / 10) * 18));
+        m_pCache->addChild(sprite);
+    }
+    for (int i = 0; i < 10; i++)
+    {
+        char text[16];
+        sprintf(text, "item %d", i);
+        CCLabelTTF *label = CCLabelTTF::create(text, "Arial", 10);
+        label->setPosition(ccp(15 + i * 30, 190));
+        m_pCache->addChild(label);
+    }
+
+    // changing a child renders the panel again
+    m_pTinted = (CCSprite*)m_pCache->getChildren()->objectAtIndex(50);
+    schedule(schedule_selector(RenderCacheNodeTest::tint), 1.0f);
+
+    // moving the cache node itself doesn't
+    m_pCache->runAction(CCRepeatForever::create(CCSequence::create(CCMoveBy::create(2, ccp(0, 40)), CCMoveBy::create(2, ccp(0, -40)), NULL)));
+
+    m_pRenders = CCLabelTTF::create("", "Arial", 16);
+    m_pRenders->setPosition(ccp(s.width / 2, 50));
+    addChild(m_pRenders);
+
+    CCMenuItemFont::setFontSize(16);
+    CCMenuItemFont *item = CCMenuItemFont::create("Cache On/Off", this, menu_selector(RenderCacheNodeTest::toggleCache));
+    CCMenu *menu = CCMenu::create(item, NULL);
+    addChild(menu);
+    menu->setPosition(ccp(s.width - 80, 80));
+
+    scheduleUpdate();
+}
+
+void RenderCacheNodeTest::toggleCache(CCObject* sender)
+{
+    m_pCache->setCacheEnabled(!m_pCache->isCacheEnabled());
+}
+
+void RenderCacheNodeTest::tint(float dt)
+{
+    m_pTinted->setColor(ccc3(CCRANDOM_0_1() * 255, CCRANDOM_0_1() * 255, CCRANDOM_0_1() * 255));
+}
+
+void RenderCacheNodeTest::update(float dt)
+{
+    char text[64];
+    sprintf(text, "cache %s, rendered %u times", m_pCache->isCacheEnabled() ? "on" : "off", m_pCache->getCacheRenderCount());
+    m_pRenders->setString(text);
+}
+
+std::string RenderCacheNodeTest::title()
+{
+    return "CCRenderCacheNode";
+}
+
+std::string RenderCacheNodeTest::subtitle()
+{
+    return "The panel is rendered again once per second";
+}
@@ -26,6 +26,9 @@ public:
     virtual void ccTouchesMoved(CCSet* touches, CCEvent* event);
     void clearImage(CCObject *pSender);
     void saveImage(CCObject *pSender);
+    void saveImageAsync(CCObject *pSender);
+    void imageSaved(CCObject *pPath);
+    void imageRead(CCObject *pImage);
 
 private:
     CCRenderTexture *m_pTarget;
@@ -96,6 +99,24 @@ public:
     void touched(CCObject* sender);
 };
 
+class RenderCacheNodeTest : public RenderTextureTest
+{
+public:
+    RenderCacheNodeTest();
+
+    virtual void update(float dt);
+    virtual std::string title();
+    virtual std::string subtitle();
+
+    void toggleCache(CCObject* sender);
+    void tint(float dt);
+
+private:
+    CCRenderCacheNode *m_pCache;
+    CCSprite *m_pTinted;
+    CCLabelTTF *m_pRenders;
+};
+
 class SpriteRenderTextureBug : public RenderTextureTest
 {
 public:
@@ -201,6 +201,8 @@ void ShaderNode::loadShaderVertex(const char *vert, const char *frag)
 
     shader->addAttribute("aVertex", kCCVertexAttrib_Position);
     shader->link();
+    // keep the binary of the program for the next run
+    CCShaderCache::sharedShaderCache()->saveProgramBinaryCache();
 
     shader->updateUniforms();
 
@@ -798,6 +800,8 @@ string ShaderFail::subtitle()
 ///---------------------------------------
 void ShaderTestScene::runThisTest()
 {
+    CCShaderCache::sharedShaderCache()->dumpProgramBinaryCacheInfo();
+
     sceneIdx = -1;
     addChild(nextAction());
 
@@ -24,6 +24,7 @@
  ******************************************************************************/
 
 #include "SpineTest.h"
+#include <spine/extension.h>
 #include <iostream>
 #include <fstream>
 #include <string.h>
@@ -64,6 +65,16 @@ bool SpineTestLayer::init () {
 	skeletonNode->setPosition(ccp(windowSize.width / 2, 20));
 	addChild(skeletonNode);
 
+	crowdNode = 0;
+	CCMenuItemFont* crowdItem = CCMenuItemFont::create("Toggle crowd", this, menu_selector(SpineTestLayer::toggleCrowd));
+	crowdItem->setFontSizeObj(20);
+	CCMenuItemFont* corruptItem = CCMenuItemFont::create("Check corrupt binary", this, menu_selector(SpineTestLayer::checkCorruptBinary));
+	corruptItem->setFontSizeObj(20);
+	CCMenu* menu = CCMenu::create(crowdItem, corruptItem, NULL);
+	menu->alignItemsVertically();
+	menu->setPosition(ccp(windowSize.width - 100, windowSize.height - 70));
+	addChild(menu, 1);
+
 	scheduleUpdate();
 
 	return true;
@@ -76,3 +87,90 @@ void SpineTestLayer::update (float deltaTime) {
         if (skeletonNode->state->time > 1) AnimationState_setAnimationByName(skeletonNode->state, "walk", true);
     }
 }
+
+void SpineTestLayer::toggleCrowd (CCObject* sender) {
+	if (crowdNode) {
+		crowdNode->removeFromParent();
+		crowdNode = 0;
+		return;
+	}
+
+	// The crowd loads the binary form of the skeleton, converted once into the writable path. Through
+	// CCSkeletonDataCache only the first of the 200 instances reads the file.
+	std::string skeletonFile = CCFileUtils::sharedFileUtils()->getWritablePath() + "spineboy.skel";
+	if (!CCFileUtils::sharedFileUtils()->isFileExist(skeletonFile) &&
+		!CCSkeletonDataCache::convertToBinary("spine/spineboy.json", "spine/spineboy.atlas", skeletonFile.c_str()))
+		skeletonFile = "spine/spineboy.json";
+
+	// 200 walking skeletons drawn by one batch node and updated on two worker threads plus the main thread.
+	crowdNode = CCSkeletonBatchNode::create();
+	crowdNode->setThreadCount(2);
+	CCSize windowSize = CCDirector::sharedDirector()->getWinSize();
+	for (int i = 0; i < 200; i++) {
+		CCSkeleton* skeleton = CCSkeleton::createWithFile(skeletonFile.c_str(), "spine/spineboy.atlas", 0.25f);
+		AnimationState_setAnimationByName(skeleton->state, "walk", true);
+		skeleton->timeScale = 0.3f + CCRANDOM_0_1() * 0.4f;
+		skeleton->setPosition(ccp(CCRANDOM_0_1() * windowSize.width, 40 + CCRANDOM_0_1() * (windowSize.height - 120)));
+		crowdNode->addChild(skeleton, (int)-skeleton->getPositionY());
+	}
+	addChild(crowdNode, -1);
+}
+
+// Reads damaged copies of the binary skeleton: every truncation of it, and a varint decoding to -1 written over each of
+// its bytes. None may crash, and all the truncated copies must be rejected.
+void SpineTestLayer::checkCorruptBinary (CCObject* sender) {
+	Atlas* atlas = Atlas_readAtlasFile("spine/spineboy.atlas");
+	SkeletonJson* json = SkeletonJson_create(atlas);
+	SkeletonData* skeletonData = SkeletonJson_readSkeletonDataFile(json, "spine/spineboy.json");
+	SkeletonJson_dispose(json);
+	int length;
+	unsigned char* binary = SkeletonBinary_writeSkeletonData(skeletonData, &length);
+	SkeletonData_dispose(skeletonData);
+
+	SkeletonBinary* reader = SkeletonBinary_create(atlas);
+	int truncatedAccepted = 0;
+	for (int i = 0; i < length; i++) {
+		skeletonData = SkeletonBinary_readSkeletonData(reader, binary, i);
+		if (skeletonData) {
+			truncatedAccepted++;
+			SkeletonData_dispose(skeletonData);
+		}
+	}
+
+	static const unsigned char minusOne[] = {0xFF, 0xFF, 0xFF, 0xFF, 0x0F};
+	unsigned char* copy = new unsigned char[length];
+	int negativeRejected = 0;
+	for (int i = 5; i + (int)sizeof(minusOne) <= length; i++) {
+		memcpy(copy, binary, length);
+		memcpy(copy + i, minusOne, sizeof(minusOne));
+		skeletonData = SkeletonBinary_readSkeletonData(reader, copy, length);
+		if (skeletonData)
+			SkeletonData_dispose(skeletonData);
+		else
+			negativeRejected++;
+	}
+
+	// A bone, then a slot whose bone index is -1, no skins and no animations.
+	static const unsigned char slotOfBoneMinusOne[] = {
+		'S', 'P', 'N', 'B', 1,
+		1, 2, 'b', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		1, 2, 's', 0xFF, 0xFF, 0xFF, 0xFF, 0x0F, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+		0, 0,
+		0
+	};
+	skeletonData = SkeletonBinary_readSkeletonData(reader, slotOfBoneMinusOne, sizeof(slotOfBoneMinusOne));
+	bool slotRejected = skeletonData == 0;
+	if (skeletonData) SkeletonData_dispose(skeletonData);
+
+	delete [] copy;
+	FREE(binary);
+	SkeletonBinary_dispose(reader);
+	Atlas_dispose(atlas);
+
+	bool passed = truncatedAccepted == 0 && slotRejected;
+	CCLog("SpineTest: %d bytes, %d truncated copies accepted, %d of %d negative varints rejected, slot of bone -1 %s: %s",
+		length, truncatedAccepted, negativeRejected, length - 9, slotRejected ? "rejected" : "accepted",
+		passed ? "passed" : "FAILED");
+	CCMenuItemFont* item = (CCMenuItemFont*)sender;
+	item->setString(passed ? "Corrupt binary: passed" : "Corrupt binary: FAILED");
+}
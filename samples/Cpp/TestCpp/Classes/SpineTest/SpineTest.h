@@ -39,12 +39,16 @@ public:
 class SpineTestLayer: public cocos2d::CCLayer {
 private:
 	cocos2d::extension::CCSkeleton* skeletonNode;
+	cocos2d::extension::CCSkeletonBatchNode* crowdNode;
 
 public:
 
 	virtual bool init ();
 	virtual void update (float deltaTime);
 
+	void toggleCrowd (cocos2d::CCObject* sender);
+	void checkCorruptBinary (cocos2d::CCObject* sender);
+
 	CREATE_FUNC (SpineTestLayer);
 };
 
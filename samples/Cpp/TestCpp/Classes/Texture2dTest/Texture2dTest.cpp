@@ -1,6 +1,7 @@
 // local import
 #include "Texture2dTest.h"
 #include "../testResource.h"
+#include "support/image_support/ccPixelConversion.h"
 
 enum {
     kTagLabel = 1,
@@ -36,6 +37,7 @@ TEXTURE2D_CREATE_FUNC(TexturePVRRGBA4444);
 TEXTURE2D_CREATE_FUNC(TexturePVRRGBA4444v3);
 TEXTURE2D_CREATE_FUNC(TexturePVRRGBA4444GZ);
 TEXTURE2D_CREATE_FUNC(TexturePVRRGBA4444CCZ);
+TEXTURE2D_CREATE_FUNC(TexturePVRRGBA4444LZ4CCZ);
 TEXTURE2D_CREATE_FUNC(TexturePVRRGBA5551);
 TEXTURE2D_CREATE_FUNC(TexturePVRRGBA5551v3);
 TEXTURE2D_CREATE_FUNC(TexturePVRRGB565);
@@ -65,6 +67,9 @@ TESTLAYER_CREATE_FUNC(TextureSizeTest);
 TESTLAYER_CREATE_FUNC(TextureCache1);
 TESTLAYER_CREATE_FUNC(TextureDrawAtPoint);
 TESTLAYER_CREATE_FUNC(TextureDrawInRect);
+TESTLAYER_CREATE_FUNC(TexturePixelConversion);
+TESTLAYER_CREATE_FUNC(TextureCacheBudget);
+TESTLAYER_CREATE_FUNC(TextureDynamicAtlas);
 
 static NEWTEXTURE2DTESTFUNC createFunctions[] =
 {
@@ -89,6 +94,7 @@ static NEWTEXTURE2DTESTFUNC createFunctions[] =
     createTexturePVRRGBA4444v3,
     createTexturePVRRGBA4444GZ,
     createTexturePVRRGBA4444CCZ,
+    createTexturePVRRGBA4444LZ4CCZ,
     createTexturePVRRGBA5551,
     createTexturePVRRGBA5551v3,
     createTexturePVRRGB565,
@@ -118,6 +124,9 @@ static NEWTEXTURE2DTESTFUNC createFunctions[] =
     createTextureCache1,
     createTextureDrawAtPoint,
     createTextureDrawInRect,
+    createTexturePixelConversion,
+    createTextureCacheBudget,
+    createTextureDynamicAtlas,
 };
 
 static unsigned int TEST_CASE_COUNT = sizeof(createFunctions) / sizeof(createFunctions[0]);
@@ -722,6 +731,34 @@ std::string TexturePVRRGBA4444CCZ::subtitle()
     return "This is a ccz PVR image";
 }
 
+//------------------------------------------------------------------
+//
+// TexturePVRRGBA4444LZ4CCZ
+// Generated from test_image_rgba4444.pvr.ccz with
+// tools/ccz-converter/ccz_converter.py -c lz4 -s 8
+//
+//------------------------------------------------------------------
+void TexturePVRRGBA4444LZ4CCZ::onEnter()
+{
+    TextureDemo::onEnter();
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    CCSprite *img = CCSprite::create("Images/test_image_rgba4444_lz4.pvr.ccz");
+    img->setPosition(ccp( s.width/2.0f, s.height/2.0f));
+    addChild(img);    
+    CCTextureCache::sharedTextureCache()->dumpCachedTextureInfo();
+}
+
+std::string TexturePVRRGBA4444LZ4CCZ::title()
+{
+    return "PVR + RGBA 4444 + LZ4 CCZ Test";
+}
+
+std::string TexturePVRRGBA4444LZ4CCZ::subtitle()
+{
+    return "LZ4 chunks inflated in parallel";
+}
+
 //------------------------------------------------------------------
 //
 // TexturePVRRGB565
@@ -1872,6 +1909,265 @@ std::string TextureDrawInRect::subtitle()
     return "draws 2 textures using drawInRect";
 }
 
+//------------------------------------------------------------------
+//
+// TexturePixelConversion
+//
+//------------------------------------------------------------------
+typedef void (*PixelConversionFunc)(const unsigned char *rgba, const unsigned char *rgb, unsigned char *out, unsigned int width, unsigned int height, bool dither);
+
+static void convertTo565(const unsigned char *rgba, const unsigned char *, unsigned char *out, unsigned int w, unsigned int h, bool dither)
+{ ccConvertRGBA8888ToRGB565(rgba, (unsigned short*)out, w, h, dither); }
+static void convertTo4444(const unsigned char *rgba, const unsigned char *, unsigned char *out, unsigned int w, unsigned int h, bool dither)
+{ ccConvertRGBA8888ToRGBA4444(rgba, (unsigned short*)out, w, h, dither); }
+static void convertTo5A1(const unsigned char *rgba, const unsigned char *, unsigned char *out, unsigned int w, unsigned int h, bool dither)
+{ ccConvertRGBA8888ToRGB5A1(rgba, (unsigned short*)out, w, h, dither); }
+static void convertRGBTo565(const unsigned char *, const unsigned char *rgb, unsigned char *out, unsigned int w, unsigned int h, bool dither)
+{ ccConvertRGB888ToRGB565(rgb, (unsigned short*)out, w, h, dither); }
+static void convertTo888(const unsigned char *rgba, const unsigned char *, unsigned char *out, unsigned int w, unsigned int h, bool)
+{ ccConvertRGBA8888ToRGB888(rgba, out, w * h); }
+static void convertToA8(const unsigned char *rgba, const unsigned char *, unsigned char *out, unsigned int w, unsigned int h, bool)
+{ ccConvertRGBA8888ToA8(rgba, out, w * h); }
+static void convertToI8(const unsigned char *rgba, const unsigned char *, unsigned char *out, unsigned int w, unsigned int h, bool)
+{ ccConvertRGBA8888ToI8(rgba, out, w * h); }
+static void convertToAI88(const unsigned char *rgba, const unsigned char *, unsigned char *out, unsigned int w, unsigned int h, bool)
+{ ccConvertRGBA8888ToAI88(rgba, out, w * h); }
+static void premultiply(const unsigned char *rgba, const unsigned char *, unsigned char *out, unsigned int w, unsigned int h, bool)
+{ memcpy(out, rgba, w * h * 4); ccPremultiplyAlphaRGBA8888(out, w * h); }
+
+static float secondsSince(struct timeval *start)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (now.tv_sec - start->tv_sec) + (now.tv_usec - start->tv_usec) / 1000000.0f;
+}
+
+static const struct
+{
+    const char *name;
+    PixelConversionFunc func;
+    unsigned int bytesPerPixel;
+} s_pixelConversions[] = {
+    { "RGBA8888 -> RGB565", convertTo565, 2 },
+    { "RGBA8888 -> RGBA4444", convertTo4444, 2 },
+    { "RGBA8888 -> RGB5A1", convertTo5A1, 2 },
+    { "RGB888 -> RGB565", convertRGBTo565, 2 },
+    { "RGBA8888 -> RGB888", convertTo888, 3 },
+    { "RGBA8888 -> A8", convertToA8, 1 },
+    { "RGBA8888 -> I8", convertToI8, 1 },
+    { "RGBA8888 -> AI88", convertToAI88, 2 },
+    { "premultiply RGBA8888", premultiply, 4 },
+};
+
+void TexturePixelConversion::onEnter()
+{
+    TextureDemo::onEnter();
+
+    // odd sizes exercise the scalar tails, 1024x1024 is also used for the timings
+    static const unsigned int sizes[][2] = { { 1, 1 }, { 7, 3 }, { 33, 9 }, { 257, 5 }, { 1024, 1024 } };
+    const unsigned int maxPixels = 1024 * 1024;
+
+    unsigned char *rgba = new unsigned char[maxPixels * 4];
+    unsigned char *rgb = new unsigned char[maxPixels * 3];
+    unsigned char *scalarOut = new unsigned char[maxPixels * 4];
+    unsigned char *simdOut = new unsigned char[maxPixels * 4];
+    for (unsigned int i = 0; i < maxPixels * 4; ++i)
+    {
+        rgba[i] = (unsigned char)(rand() & 0xff);
+    }
+    for (unsigned int i = 0; i < maxPixels * 3; ++i)
+    {
+        rgb[i] = (unsigned char)(rand() & 0xff);
+    }
+
+    std::string result;
+    char line[128];
+    unsigned int features = ccGetCPUFeatures();
+    sprintf(line, "CPU:%s%s%s%s\n", features & kCCCPUFeature_SSE2 ? " SSE2" : "", features & kCCCPUFeature_SSSE3 ? " SSSE3" : "",
+            features & kCCCPUFeature_NEON ? " NEON" : "", features ? "" : " scalar only");
+    result += line;
+    result += ccCheckPixelConversion() ? "ccCheckPixelConversion: passed\n" : "ccCheckPixelConversion: FAILED\n";
+
+    for (unsigned int c = 0; c < sizeof(s_pixelConversions) / sizeof(s_pixelConversions[0]); ++c)
+    {
+        bool identical = true;
+        float scalarTime = 0, simdTime = 0;
+        for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+        {
+            unsigned int w = sizes[s][0], h = sizes[s][1];
+            for (int dither = 0; dither < 2; ++dither)
+            {
+                struct timeval now;
+
+                ccSetCPUFeaturesMask(0);
+                gettimeofday(&now, NULL);
+                s_pixelConversions[c].func(rgba, rgb, scalarOut, w, h, dither != 0);
+                float scalar = secondsSince(&now);
+
+                ccSetCPUFeaturesMask(~0u);
+                gettimeofday(&now, NULL);
+                s_pixelConversions[c].func(rgba, rgb, simdOut, w, h, dither != 0);
+                float simd = secondsSince(&now);
+
+                identical = identical && memcmp(scalarOut, simdOut, w * h * s_pixelConversions[c].bytesPerPixel) == 0;
+                if (w * h == maxPixels && ! dither)
+                {
+                    scalarTime = scalar;
+                    simdTime = simd;
+                }
+            }
+        }
+        sprintf(line, "%s: %s, %.2f ms -> %.2f ms\n", s_pixelConversions[c].name, identical ? "identical" : "MISMATCH",
+                scalarTime * 1000, simdTime * 1000);
+        CCLog("%s", line);
+        result += line;
+    }
+
+    delete [] rgba;
+    delete [] rgb;
+    delete [] scalarOut;
+    delete [] simdOut;
+
+    CCLabelTTF *label = CCLabelTTF::create(result.c_str(), "Arial", 14);
+    label->setPosition(VisibleRect::center());
+    addChild(label);
+}
+
+std::string TexturePixelConversion::title()
+{
+    return "Pixel format conversion";
+}
+
+std::string TexturePixelConversion::subtitle()
+{
+    return "SIMD kernels must match the scalar ones byte for byte";
+}
+
+//------------------------------------------------------------------
+//
+// TextureCacheBudget
+//
+//------------------------------------------------------------------
+void TextureCacheBudget::onEnter()
+{
+    TextureDemo::onEnter();
+    m_uEvictions = 0;
+
+    CCTextureCache *cache = CCTextureCache::sharedTextureCache();
+    cache->setDelegate(this);
+    cache->setTextureMemoryBudget(cache->getTextureMemoryUsed() + 2 * 1024 * 1024);
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    // the background is used by a sprite and pinned: neither can be evicted
+    CCSprite *background = CCSprite::create("Images/background3.png");
+    background->setPosition(ccp(s.width/2, s.height/2));
+    addChild(background, -1);
+
+    // 1024x1024 RGBA8888 textures take 4 MB each: every new one evicts the previous unpinned one
+    cache->addImage("Images/PlanetCute-1024x1024.png");
+    cache->setTexturePinned(cache->addImage("Images/landscape-1024x1024.png"), true);
+    cache->addImage("Images/texture1024x1024.png");
+    cache->addImage("Images/fire.png");
+
+    CCString *info = CCString::createWithFormat("%u evictions\n%u KB used, budget %u KB\nlandscape pinned: %s",
+        m_uEvictions, cache->getTextureMemoryUsed() / 1024, cache->getTextureMemoryBudget() / 1024,
+        cache->textureForKey("Images/landscape-1024x1024.png") ? "still cached" : "evicted");
+    CCLabelTTF *label = CCLabelTTF::create(info->getCString(), "Arial", 18);
+    label->setPosition(ccp(s.width/2, s.height/2));
+    addChild(label);
+
+    cache->dumpCachedTextureInfo();
+}
+
+TextureCacheBudget::~TextureCacheBudget()
+{
+    CCTextureCache *cache = CCTextureCache::sharedTextureCache();
+    cache->setDelegate(NULL);
+    cache->setTextureMemoryBudget(0);
+    cache->setTexturePinned(cache->textureForKey("Images/landscape-1024x1024.png"), false);
+}
+
+void TextureCacheBudget::textureCacheWillEvictTexture(CCTextureCache* cache, CCTexture2D* texture, const char* key)
+{
+    CCLog("evicted %s: %u KB", key, CCTextureCache::textureMemorySize(texture) / 1024);
+    ++m_uEvictions;
+}
+
+std::string TextureCacheBudget::title()
+{
+    return "CCTextureCache memory budget";
+}
+
+std::string TextureCacheBudget::subtitle()
+{
+    return "Unused textures are evicted, least recently used first";
+}
+
+//------------------------------------------------------------------
+//
+// TextureDynamicAtlas
+//
+//------------------------------------------------------------------
+void TextureDynamicAtlas::onEnter()
+{
+    TextureDemo::onEnter();
+
+    CCSize s = CCDirector::sharedDirector()->getWinSize();
+
+    CCDynamicAtlas *atlas = CCDynamicAtlas::create(512, 512);
+    char name[64];
+    for (int i = 1; i <= 14; i++)
+    {
+        sprintf(name, "Images/grossini_dance_%02d.png", i);
+        atlas->addImage(name);
+    }
+    atlas->addImage("Images/grossinis_sister1.png");
+    atlas->addImage("Images/grossinis_sister2.png");
+
+    // the removed images leave holes that repack() reclaims
+    for (int i = 1; i <= 14; i += 2)
+    {
+        sprintf(name, "Images/grossini_dance_%02d.png", i);
+        atlas->removeImageForKey(CCFileUtils::sharedFileUtils()->fullPathForFilename(name).c_str());
+    }
+    float before = atlas->getOccupancy();
+    atlas->repack();
+
+    // every image is in the same page: a single batch node draws them all
+    CCSpriteBatchNode *batch = CCSpriteBatchNode::createWithTexture(atlas->getPage(0));
+    addChild(batch);
+    for (int i = 2; i <= 14; i += 2)
+    {
+        sprintf(name, "Images/grossini_dance_%02d.png", i);
+        CCSprite *sprite = CCSprite::createWithSpriteFrame(atlas->addImage(name));
+        sprite->setPosition(ccp(s.width * i / 16, s.height / 2));
+        batch->addChild(sprite);
+    }
+    CCSprite *sister1 = CCSprite::createWithSpriteFrame(atlas->addImage("Images/grossinis_sister1.png"));
+    sister1->setPosition(ccp(s.width / 4, s.height / 4));
+    batch->addChild(sister1);
+    CCSprite *sister2 = CCSprite::createWithSpriteFrame(atlas->addImage("Images/grossinis_sister2.png"));
+    sister2->setPosition(ccp(s.width * 3 / 4, s.height / 4));
+    batch->addChild(sister2);
+
+    CCString *info = CCString::createWithFormat("%u images in %u page(s), occupancy %.0f%% -> %.0f%% after repack",
+        atlas->getImageCount(), atlas->getPageCount(), before * 100, atlas->getOccupancy() * 100);
+    CCLabelTTF *label = CCLabelTTF::create(info->getCString(), "Arial", 16);
+    label->setPosition(ccp(s.width/2, s.height * 3 / 4));
+    addChild(label);
+}
+
+std::string TextureDynamicAtlas::title()
+{
+    return "CCDynamicAtlas";
+}
+
+std::string TextureDynamicAtlas::subtitle()
+{
+    return "Loose images packed at runtime, drawn by one batch node";
+}
+
 //------------------------------------------------------------------
 //
 // TextureTestScene
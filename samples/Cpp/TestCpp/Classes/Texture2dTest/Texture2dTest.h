@@ -119,6 +119,14 @@ public:
     virtual void onEnter();
 };
 
+class TexturePVRRGBA4444LZ4CCZ : public TextureDemo
+{
+public:
+    virtual std::string title();
+    virtual std::string subtitle();
+    virtual void onEnter();
+};
+
 class TexturePVRRGBA5551 : public TextureDemo
 {
 public:
@@ -413,6 +421,34 @@ private:
     CCTexture2D* m_pTex1, *m_pTex2;
 };
 
+class TexturePixelConversion : public TextureDemo
+{
+public:
+    virtual std::string title();
+    virtual std::string subtitle();
+    virtual void onEnter();
+};
+
+class TextureCacheBudget : public TextureDemo, public CCTextureCacheDelegate
+{
+public:
+    virtual ~TextureCacheBudget();
+    virtual std::string title();
+    virtual std::string subtitle();
+    virtual void onEnter();
+    virtual void textureCacheWillEvictTexture(CCTextureCache* cache, CCTexture2D* texture, const char* key);
+private:
+    unsigned int m_uEvictions;
+};
+
+class TextureDynamicAtlas : public TextureDemo
+{
+public:
+    virtual std::string title();
+    virtual std::string subtitle();
+    virtual void onEnter();
+};
+
 class TextureTestScene : public TestScene
 {
 public:
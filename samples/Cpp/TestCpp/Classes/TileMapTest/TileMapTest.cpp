@@ -657,14 +657,14 @@ void TMXOrthoObjectsTest::draw()
         key = "height";
         int height = ((CCString*)dict->objectForKey(key))->intValue();//dynamic_cast<NSNumber*>(dict->objectForKey("height"))->getNumber();
         
-        glLineWidth(3);
+        ccLineWidth(3);
         
         ccDrawLine( ccp((float)x, (float)y), ccp((float)(x+width), (float)y) );
         ccDrawLine( ccp((float)(x+width), (float)y), ccp((float)(x+width), (float)(y+height)) );
         ccDrawLine( ccp((float)(x+width), (float)(y+height)), ccp((float)x, (float)(y+height)) );
         ccDrawLine( ccp((float)x, (float)(y+height)), ccp((float)x, (float)y) );
         
-        glLineWidth(1);
+        ccLineWidth(1);
     }
 }
 
@@ -734,14 +734,14 @@ void TMXIsoObjectsTest::draw()
         key = "height";
         int height = ((CCString*)dict->objectForKey(key))->intValue();//dynamic_cast<NSNumber*>(dict->objectForKey("height"))->getNumber();
         
-        glLineWidth(3);
+        ccLineWidth(3);
         
         ccDrawLine( ccp(x,y), ccp(x+width,y) );
         ccDrawLine( ccp(x+width,y), ccp(x+width,y+height) );
         ccDrawLine( ccp(x+width,y+height), ccp(x,y+height) );
         ccDrawLine( ccp(x,y+height), ccp(x,y) );
         
-        glLineWidth(1);
+        ccLineWidth(1);
     }
 }
 
@@ -1573,14 +1573,14 @@ void TMXGIDObjectsTest::draw()
         key = "height";
         int height = ((CCString*)dict->objectForKey(key))->intValue();
 
-        glLineWidth(3);
+        ccLineWidth(3);
 
         ccDrawLine(ccp(x, y), ccp(x + width, y));
         ccDrawLine(ccp(x + width, y), ccp(x + width, y + height));
         ccDrawLine(ccp(x + width,y + height), ccp(x,y + height));
         ccDrawLine(ccp(x,y + height), ccp(x,y));
 
-        glLineWidth(1);
+        ccLineWidth(1);
     }
 }
 
@@ -100,32 +100,36 @@ int CCLuaEngine::executeNodeEvent(CCNode* pNode, int nAction)
     int nHandler = pNode->getScriptHandler();
     if (!nHandler) return 0;
     
+    const char* pszEventName = NULL;
     switch (nAction)
     {
         case kCCNodeOnEnter:
-            m_stack->pushString("enter");
+            pszEventName = "enter";
             break;
             
         case kCCNodeOnExit:
-            m_stack->pushString("exit");
+            pszEventName = "exit";
             break;
             
         case kCCNodeOnEnterTransitionDidFinish:
-            m_stack->pushString("enterTransitionFinish");
+            pszEventName = "enterTransitionFinish";
             break;
             
         case kCCNodeOnExitTransitionDidStart:
-            m_stack->pushString("exitTransitionStart");
+            pszEventName = "exitTransitionStart";
             break;
             
         case kCCNodeOnCleanup:
-            m_stack->pushString("cleanup");
+            pszEventName = "cleanup";
             break;
             
         default:
             return 0;
     }
-    int ret = m_stack->executeFunctionByHandler(nHandler, 1);
+    
+    if (!m_stack->pushFunctionByHandler(nHandler)) return 0;
+    m_stack->pushString(pszEventName);
+    int ret = m_stack->executeFunction(1);
     m_stack->clean();
     return ret;
 }
@@ -135,9 +139,10 @@ int CCLuaEngine::executeMenuItemEvent(CCMenuItem* pMenuItem)
     int nHandler = pMenuItem->getScriptTapHandler();
     if (!nHandler) return 0;
     
+    if (!m_stack->pushFunctionByHandler(nHandler)) return 0;
     m_stack->pushInt(pMenuItem->getTag());
     m_stack->pushCCObject(pMenuItem, "CCMenuItem");
-    int ret = m_stack->executeFunctionByHandler(nHandler, 2);
+    int ret = m_stack->executeFunction(2);
     m_stack->clean();
     return ret;
 }
@@ -147,8 +152,9 @@ int CCLuaEngine::executeNotificationEvent(CCNotificationCenter* pNotificationCen
     int nHandler = pNotificationCenter->getScriptHandler();
     if (!nHandler) return 0;
     
+    if (!m_stack->pushFunctionByHandler(nHandler)) return 0;
     m_stack->pushString(pszName);
-    int ret = m_stack->executeFunctionByHandler(nHandler, 1);
+    int ret = m_stack->executeFunction(1);
     m_stack->clean();
     return ret;
 }
@@ -158,11 +164,12 @@ int CCLuaEngine::executeCallFuncActionEvent(CCCallFunc* pAction, CCObject* pTarg
     int nHandler = pAction->getScriptHandler();
     if (!nHandler) return 0;
     
+    if (!m_stack->pushFunctionByHandler(nHandler)) return 0;
     if (pTarget)
     {
         m_stack->pushCCObject(pTarget, "CCNode");
     }
-    int ret = m_stack->executeFunctionByHandler(nHandler, pTarget ? 1 : 0);
+    int ret = m_stack->executeFunction(pTarget ? 1 : 0);
     m_stack->clean();
     return ret;
 }
@@ -170,8 +177,9 @@ int CCLuaEngine::executeCallFuncActionEvent(CCCallFunc* pAction, CCObject* pTarg
 int CCLuaEngine::executeSchedule(int nHandler, float dt, CCNode* pNode/* = NULL*/)
 {
     if (!nHandler) return 0;
+    if (!m_stack->pushFunctionByHandler(nHandler)) return 0;
     m_stack->pushFloat(dt);
-    int ret = m_stack->executeFunctionByHandler(nHandler, 1);
+    int ret = m_stack->executeFunction(1);
     m_stack->clean();
     return ret;
 }
@@ -183,32 +191,36 @@ int CCLuaEngine::executeLayerTouchEvent(CCLayer* pLayer, int eventType, CCTouch
     int nHandler = pScriptHandlerEntry->getHandler();
     if (!nHandler) return 0;
     
+    const char* pszEventName = NULL;
     switch (eventType)
     {
         case CCTOUCHBEGAN:
-            m_stack->pushString("began");
+            pszEventName = "began";
             break;
             
         case CCTOUCHMOVED:
-            m_stack->pushString("moved");
+            pszEventName = "moved";
             break;
             
         case CCTOUCHENDED:
-            m_stack->pushString("ended");
+            pszEventName = "ended";
             break;
             
         case CCTOUCHCANCELLED:
-            m_stack->pushString("cancelled");
+            pszEventName = "cancelled";
             break;
             
         default:
             return 0;
     }
     
+    if (!m_stack->pushFunctionByHandler(nHandler)) return 0;
+    m_stack->pushString(pszEventName);
+    
     const CCPoint pt = CCDirector::sharedDirector()->convertToGL(pTouch->getLocationInView());
     m_stack->pushFloat(pt.x);
     m_stack->pushFloat(pt.y);
-    int ret = m_stack->executeFunctionByHandler(nHandler, 3);
+    int ret = m_stack->executeFunction(3);
     m_stack->clean();
     return ret;
 }
@@ -220,31 +232,35 @@ int CCLuaEngine::executeLayerTouchesEvent(CCLayer* pLayer, int eventType, CCSet
     int nHandler = pScriptHandlerEntry->getHandler();
     if (!nHandler) return 0;
     
+    const char* pszEventName = NULL;
     switch (eventType)
     {
         case CCTOUCHBEGAN:
-            m_stack->pushString("began");
+            pszEventName = "began";
             break;
             
         case CCTOUCHMOVED:
-            m_stack->pushString("moved");
+            pszEventName = "moved";
             break;
             
         case CCTOUCHENDED:
-            m_stack->pushString("ended");
+            pszEventName = "ended";
             break;
             
         case CCTOUCHCANCELLED:
-            m_stack->pushString("cancelled");
+            pszEventName = "cancelled";
             break;
             
         default:
             return 0;
     }
+    
+    if (!m_stack->pushFunctionByHandler(nHandler)) return 0;
+    m_stack->pushString(pszEventName);
 
     CCDirector* pDirector = CCDirector::sharedDirector();
     lua_State *L = m_stack->getLuaState();
-    lua_newtable(L);
+    lua_createtable(L, pTouches->count() * 3, 0);
     int i = 1;
     for (CCSetIterator it = pTouches->begin(); it != pTouches->end(); ++it)
     {
@@ -257,7 +273,7 @@ int CCLuaEngine::executeLayerTouchesEvent(CCLayer* pLayer, int eventType, CCSet
         lua_pushinteger(L, pTouch->getID());
         lua_rawseti(L, -2, i++);
     }
-    int ret = m_stack->executeFunctionByHandler(nHandler, 2);
+    int ret = m_stack->executeFunction(2);
     m_stack->clean();
     return ret;
 }
@@ -270,20 +286,24 @@ int CCLuaEngine::executeLayerKeypadEvent(CCLayer* pLayer, int eventType)
     int nHandler = pScriptHandlerEntry->getHandler();
     if (!nHandler) return 0;
     
+    const char* pszEventName = NULL;
     switch (eventType)
     {
         case kTypeBackClicked:
-            m_stack->pushString("backClicked");
+            pszEventName = "backClicked";
             break;
             
         case kTypeMenuClicked:
-            m_stack->pushString("menuClicked");
+            pszEventName = "menuClicked";
             break;
             
         default:
             return 0;
     }
-    int ret = m_stack->executeFunctionByHandler(nHandler, 1);
+    
+    if (!m_stack->pushFunctionByHandler(nHandler)) return 0;
+    m_stack->pushString(pszEventName);
+    int ret = m_stack->executeFunction(1);
     m_stack->clean();
     return ret;
 }
@@ -296,23 +316,25 @@ int CCLuaEngine::executeAccelerometerEvent(CCLayer* pLayer, CCAcceleration* pAcc
     int nHandler = pScriptHandlerEntry->getHandler();
     if (!nHandler) return 0;
     
+    if (!m_stack->pushFunctionByHandler(nHandler)) return 0;
     m_stack->pushFloat(pAccelerationValue->x);
     m_stack->pushFloat(pAccelerationValue->y);
     m_stack->pushFloat(pAccelerationValue->z);
     m_stack->pushFloat(pAccelerationValue->timestamp);
-    int ret = m_stack->executeFunctionByHandler(nHandler, 4);
+    int ret = m_stack->executeFunction(4);
     m_stack->clean();
     return ret;
 }
 
 int CCLuaEngine::executeEvent(int nHandler, const char* pEventName, CCObject* pEventSource /* = NULL*/, const char* pEventSourceClassName /* = NULL*/)
 {
+    if (!m_stack->pushFunctionByHandler(nHandler)) return 0;
     m_stack->pushString(pEventName);
     if (pEventSource)
     {
         m_stack->pushCCObject(pEventSource, pEventSourceClassName ? pEventSourceClassName : "CCObject");
     }
-    int ret = m_stack->executeFunctionByHandler(nHandler, pEventSource ? 2 : 1);
+    int ret = m_stack->executeFunction(pEventSource ? 2 : 1);
     m_stack->clean();
     return ret;
 }
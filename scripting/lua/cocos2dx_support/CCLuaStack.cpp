@@ -34,6 +34,7 @@ extern "C" {
 
 #include "LuaCocos2d.h"
 #include "Cocos2dxLuaLoader.h"
+#include <string.h>
 
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS || CC_TARGET_PLATFORM == CC_PLATFORM_MAC)
 #include "platform/ios/CCLuaObjcBridge.h"
@@ -121,6 +122,9 @@ bool CCLuaStack::init(void)
     
     // add cocos2dx loader
     addLuaLoader(cocos2dx_lua_loader);
+    
+    cacheFunctionMapping();
+    createObjectCache();
 
     return true;
 }
@@ -128,9 +132,50 @@ bool CCLuaStack::init(void)
 bool CCLuaStack::initWithLuaState(lua_State *L)
 {
     m_state = L;
+    cacheFunctionMapping();
+    createObjectCache();
     return true;
 }
 
+CCLuaStack::~CCLuaStack(void)
+{
+    if (m_state)
+    {
+        luaL_unref(m_state, LUA_REGISTRYINDEX, m_functionMappingRef);
+        luaL_unref(m_state, LUA_REGISTRYINDEX, m_objectCacheRef);
+        luaL_unref(m_state, LUA_REGISTRYINDEX, m_objectTypeCacheRef);
+    }
+}
+
+void CCLuaStack::cacheFunctionMapping(void)
+{
+    lua_pushstring(m_state, TOLUA_REFID_FUNCTION_MAPPING);
+    lua_rawget(m_state, LUA_REGISTRYINDEX);                             /* L: refid_fun */
+    if (lua_istable(m_state, -1))
+    {
+        m_functionMappingRef = luaL_ref(m_state, LUA_REGISTRYINDEX);    /* L: - */
+    }
+    else
+    {
+        // toluafix_open() has not been called on this state yet, try again later
+        lua_pop(m_state, 1);                                            /* L: - */
+    }
+}
+
+void CCLuaStack::createObjectCache(void)
+{
+    // weak values: the cache doesn't keep the userdata alive, the same as the ubox of tolua
+    lua_newtable(m_state);                                              /* L: objects */
+    lua_createtable(m_state, 0, 1);                                     /* L: objects mt */
+    lua_pushliteral(m_state, "v");                                      /* L: objects mt "v" */
+    lua_setfield(m_state, -2, "__mode");                                /* L: objects mt */
+    lua_setmetatable(m_state, -2);                                      /* L: objects */
+    m_objectCacheRef = luaL_ref(m_state, LUA_REGISTRYINDEX);            /* L: - */
+
+    lua_newtable(m_state);                                              /* L: types */
+    m_objectTypeCacheRef = luaL_ref(m_state, LUA_REGISTRYINDEX);        /* L: - */
+}
+
 void CCLuaStack::addSearchPath(const char* path)
 {
     lua_getglobal(m_state, "package");                                  /* L: package */
@@ -170,6 +215,17 @@ void CCLuaStack::addLuaLoader(lua_CFunction func)
 void CCLuaStack::removeScriptObjectByCCObject(CCObject* pObj)
 {
     toluafix_remove_ccobject_by_refid(m_state, pObj->m_nLuaID);
+
+    // the address may be reused by another object
+    lua_rawgeti(m_state, LUA_REGISTRYINDEX, m_objectCacheRef);          /* L: objects */
+    lua_pushlightuserdata(m_state, pObj);
+    lua_pushnil(m_state);
+    lua_rawset(m_state, -3);                                            /* objects[ptr] = nil, L: objects */
+    lua_rawgeti(m_state, LUA_REGISTRYINDEX, m_objectTypeCacheRef);      /* L: objects types */
+    lua_pushlightuserdata(m_state, pObj);
+    lua_pushnil(m_state);
+    lua_rawset(m_state, -3);                                            /* types[ptr] = nil, L: objects types */
+    lua_pop(m_state, 2);                                                /* L: - */
 }
 
 void CCLuaStack::removeScriptHandler(int nHandler)
@@ -257,7 +313,46 @@ void CCLuaStack::pushNil(void)
 
 void CCLuaStack::pushCCObject(CCObject* objectValue, const char* typeName)
 {
+    // An object already pushed with this type name has its userdata in the cache. tolua would look up the metatable,
+    // the ubox and the super classes, all by string, to find the same userdata.
+    if (objectValue->m_nLuaID != 0)
+    {
+        lua_rawgeti(m_state, LUA_REGISTRYINDEX, m_objectTypeCacheRef);  /* L: types */
+        lua_pushlightuserdata(m_state, objectValue);
+        lua_rawget(m_state, -2);                                        /* L: types type */
+        const char* cachedTypeName = lua_tostring(m_state, -1);
+        bool bSameType = cachedTypeName && strcmp(cachedTypeName, typeName) == 0;
+        lua_pop(m_state, 2);                                            /* L: - */
+        if (bSameType)
+        {
+            lua_rawgeti(m_state, LUA_REGISTRYINDEX, m_objectCacheRef);  /* L: objects */
+            lua_pushlightuserdata(m_state, objectValue);
+            lua_rawget(m_state, -2);                                    /* L: objects ud */
+            lua_remove(m_state, -2);                                    /* L: ud */
+            if (lua_isuserdata(m_state, -1))
+            {
+                return;
+            }
+            // collected by Lua since
+            lua_pop(m_state, 1);                                        /* L: - */
+        }
+    }
+
+    int top = lua_gettop(m_state);
     toluafix_pushusertype_ccobject(m_state, objectValue->m_uID, &objectValue->m_nLuaID, objectValue, typeName);
+    // nothing is pushed for an unknown type
+    if (lua_gettop(m_state) == top + 1 && lua_isuserdata(m_state, -1))
+    {
+        lua_rawgeti(m_state, LUA_REGISTRYINDEX, m_objectCacheRef);      /* L: ud objects */
+        lua_pushlightuserdata(m_state, objectValue);
+        lua_pushvalue(m_state, -3);
+        lua_rawset(m_state, -3);                                        /* objects[ptr] = ud, L: ud objects */
+        lua_rawgeti(m_state, LUA_REGISTRYINDEX, m_objectTypeCacheRef);  /* L: ud objects types */
+        lua_pushlightuserdata(m_state, objectValue);
+        lua_pushstring(m_state, typeName);
+        lua_rawset(m_state, -3);                                        /* types[ptr] = type, L: ud objects types */
+        lua_pop(m_state, 2);                                            /* L: ud */
+    }
 }
 
 void CCLuaStack::pushCCLuaValue(const CCLuaValue& value)
@@ -277,7 +372,8 @@ void CCLuaStack::pushCCLuaValue(const CCLuaValue& value)
     }
     else if (type == CCLuaValueTypeString)
     {
-        return pushString(value.stringValue().c_str());
+        const std::string& stringValue = value.stringValue();
+        return pushString(stringValue.c_str(), stringValue.length());
     }
     else if (type == CCLuaValueTypeDict)
     {
@@ -295,7 +391,7 @@ void CCLuaStack::pushCCLuaValue(const CCLuaValue& value)
 
 void CCLuaStack::pushCCLuaValueDict(const CCLuaValueDict& dict)
 {
-    lua_newtable(m_state);                                              /* L: table */
+    lua_createtable(m_state, 0, (int)dict.size());                      /* L: table */
     for (CCLuaValueDictIterator it = dict.begin(); it != dict.end(); ++it)
     {
         lua_pushstring(m_state, it->first.c_str());                     /* L: table key */
@@ -306,7 +402,7 @@ void CCLuaStack::pushCCLuaValueDict(const CCLuaValueDict& dict)
 
 void CCLuaStack::pushCCLuaValueArray(const CCLuaValueArray& array)
 {
-    lua_newtable(m_state);                                              /* L: table */
+    lua_createtable(m_state, (int)array.size(), 0);                     /* L: table */
     int index = 1;
     for (CCLuaValueArrayIterator it = array.begin(); it != array.end(); ++it)
     {
@@ -318,7 +414,21 @@ void CCLuaStack::pushCCLuaValueArray(const CCLuaValueArray& array)
 
 bool CCLuaStack::pushFunctionByHandler(int nHandler)
 {
-    toluafix_get_function_by_refid(m_state, nHandler);                  /* L: ... func */
+    if (m_functionMappingRef == LUA_NOREF)
+    {
+        cacheFunctionMapping();
+    }
+    
+    if (m_functionMappingRef != LUA_NOREF)
+    {
+        lua_rawgeti(m_state, LUA_REGISTRYINDEX, m_functionMappingRef);  /* L: ... refid_fun */
+        lua_rawgeti(m_state, -1, nHandler);                             /* L: ... refid_fun func */
+        lua_remove(m_state, -2);                                        /* L: ... func */
+    }
+    else
+    {
+        toluafix_get_function_by_refid(m_state, nHandler);              /* L: ... func */
+    }
     if (!lua_isfunction(m_state, -1))
     {
         CCLOG("[LUA ERROR] function refid '%d' does not reference a Lua function", nHandler);
@@ -27,6 +27,7 @@
 
 extern "C" {
 #include "lua.h"
+#include "lauxlib.h"
 }
 
 #include "ccTypes.h"
@@ -100,11 +101,23 @@ public:
     virtual void pushString(const char* stringValue);
     virtual void pushString(const char* stringValue, int length);
     virtual void pushNil(void);
+    /**
+     @brief Push the userdata of a CCObject as typeName.
+     @brief An object pushed again with the same type name, like the sender of a menu callback, reuses its
+            cached userdata: no tolua registry lookups or allocations.
+     */
     virtual void pushCCObject(CCObject* objectValue, const char* typeName);
     virtual void pushCCLuaValue(const CCLuaValue& value);
     virtual void pushCCLuaValueDict(const CCLuaValueDict& dict);
     virtual void pushCCLuaValueArray(const CCLuaValueArray& array);    
     virtual bool pushFunctionByHandler(int nHandler);
+    
+    /**
+     @brief Call the function pushed with pushFunctionByHandler() followed by numArgs arguments.
+     @brief Hot callbacks (scheduler, touches, actions) push the function first and then their
+            arguments as primitives, so no CCLuaValue boxing or stack reordering is needed.
+     @return The integer value returned from the script function.
+     */
     virtual int executeFunction(int numArgs);
     
     virtual int executeFunctionByHandler(int nHandler, int numArgs);
@@ -114,14 +127,26 @@ protected:
     CCLuaStack(void)
     : m_state(NULL)
     , m_callFromLua(0)
+    , m_functionMappingRef(LUA_NOREF)
+    , m_objectCacheRef(LUA_NOREF)
+    , m_objectTypeCacheRef(LUA_NOREF)
     {
     }
+    virtual ~CCLuaStack(void);
     
     bool init(void);
     bool initWithLuaState(lua_State *L);
     
+    // keep a registry reference to the refid -> function table, so handlers are found without a string lookup
+    void cacheFunctionMapping(void);
+    // create the tables of pushCCObject(): object -> userdata, weak, and object -> type name
+    void createObjectCache(void);
+    
     lua_State *m_state;
     int m_callFromLua;
+    int m_functionMappingRef;
+    int m_objectCacheRef;
+    int m_objectTypeCacheRef;
 };
 
 NS_CC_END
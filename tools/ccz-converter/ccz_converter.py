@@ -0,0 +1,269 @@
+#!/usr/bin/python
+# ccz_converter.py
+# Compress files (usually .pvr textures) into CCZ files using zlib, LZ4 or Zstandard
+# Copyright (c) 2013 cocos2d-x.org
+#
+# By default the payload is split into independently compressed chunks
+# (CCZ version 3), which ZipUtils::ccInflateCCZFile inflates on several
+# threads. Use --chunk-size 0 for a classic single block file, readable by
+# older cocos2d-x versions when it is compressed with zlib.
+#
+# Existing unencrypted .ccz files are accepted as input and recompressed.
+
+from __future__ import print_function
+
+import os
+import sys
+import struct
+import zlib
+import optparse
+
+try:
+    import lz4.block as lz4block
+except ImportError:
+    lz4block = None
+
+try:
+    import zstandard
+except ImportError:
+    zstandard = None
+
+# CCZHeader::compression_type, see ZipUtils.h
+CCZ_COMPRESSION_ZLIB = 0
+CCZ_COMPRESSION_NONE = 3
+CCZ_COMPRESSION_LZ4  = 4
+CCZ_COMPRESSION_ZSTD = 5
+
+CCZ_VERSION_CHUNKED = 3
+
+COMPRESSIONS = {
+    'zlib': CCZ_COMPRESSION_ZLIB,
+    'none': CCZ_COMPRESSION_NONE,
+    'lz4':  CCZ_COMPRESSION_LZ4,
+    'zstd': CCZ_COMPRESSION_ZSTD,
+}
+
+
+class ConverterError(Exception):
+    pass
+
+#
+# lz4 block format
+#
+
+LZ4_MIN_MATCH = 4
+LZ4_LAST_LITERALS = 5       # the last 5 bytes are always literals
+LZ4_MATCH_LIMIT = 12        # no match starts in the last 12 bytes
+LZ4_MAX_DISTANCE = 65535
+
+
+def _lz4_length(out, length):
+    while length >= 255:
+        out.append(255)
+        length -= 255
+    out.append(length)
+
+
+def _lz4_sequence(out, literals, distance, matchLength):
+    literalLength = len(literals)
+    token = min(literalLength, 15) << 4
+    if matchLength:
+        token |= min(matchLength - LZ4_MIN_MATCH, 15)
+    out.append(token)
+    if literalLength >= 15:
+        _lz4_length(out, literalLength - 15)
+    out += literals
+    if matchLength:
+        out += struct.pack('<H', distance)
+        if matchLength - LZ4_MIN_MATCH >= 15:
+            _lz4_length(out, matchLength - LZ4_MIN_MATCH - 15)
+
+
+def lz4_compress(data):
+    """greedy lz4 block compressor; slow but only needs python"""
+    if lz4block is not None:
+        return lz4block.compress(bytes(data), mode='high_compression', store_size=False)
+
+    data = bytes(data)
+    size = len(data)
+    out = bytearray()
+    table = {}
+    anchor = 0
+    pos = 0
+    matchStop = size - LZ4_LAST_LITERALS
+    while pos < size - LZ4_MATCH_LIMIT:
+        key = data[pos:pos + 4]
+        ref = table.get(key)
+        table[key] = pos
+        if ref is None or pos - ref > LZ4_MAX_DISTANCE:
+            pos += 1
+            continue
+
+        # extend the match 64 bytes at a time, then byte per byte
+        end = pos + 4
+        src = ref + 4
+        while end + 64 <= matchStop and data[end:end + 64] == data[src:src + 64]:
+            end += 64
+            src += 64
+        while end < matchStop and data[end] == data[src]:
+            end += 1
+            src += 1
+
+        _lz4_sequence(out, data[anchor:pos], pos - ref, end - pos)
+        pos = anchor = end
+    _lz4_sequence(out, data[anchor:], 0, 0)
+    return bytes(out)
+
+
+def lz4_decompress(data, size):
+    data = bytearray(data)
+    out = bytearray()
+    pos = 0
+    while pos < len(data):
+        token = data[pos]
+        pos += 1
+        length = token >> 4
+        if length == 15:
+            while True:
+                s = data[pos]
+                pos += 1
+                length += s
+                if s != 255:
+                    break
+        out += data[pos:pos + length]
+        pos += length
+        if pos >= len(data):
+            break
+        distance = data[pos] | (data[pos + 1] << 8)
+        pos += 2
+        length = token & 15
+        if length == 15:
+            while True:
+                s = data[pos]
+                pos += 1
+                length += s
+                if s != 255:
+                    break
+        length += LZ4_MIN_MATCH
+        start = len(out) - distance
+        if distance <= 0 or start < 0:
+            raise ConverterError('corrupted lz4 block')
+        for i in range(length):
+            out.append(out[start + i])
+    if len(out) != size:
+        raise ConverterError('corrupted lz4 block')
+    return bytes(out)
+
+#
+# ccz
+#
+
+def compress_block(data, compression, level):
+    if compression == CCZ_COMPRESSION_ZLIB:
+        return zlib.compress(bytes(data), level)
+    if compression == CCZ_COMPRESSION_NONE:
+        return bytes(data)
+    if compression == CCZ_COMPRESSION_LZ4:
+        return lz4_compress(data)
+    if zstandard is None:
+        raise ConverterError('zstd needs the python zstandard module')
+    return zstandard.ZstdCompressor(level=level).compress(bytes(data))
+
+
+def decompress_block(data, compression, size):
+    if compression == CCZ_COMPRESSION_ZLIB:
+        return zlib.decompress(data)
+    if compression == CCZ_COMPRESSION_NONE:
+        return data
+    if compression == CCZ_COMPRESSION_LZ4:
+        return lz4_decompress(data, size)
+    if compression == CCZ_COMPRESSION_ZSTD and zstandard is not None:
+        return zstandard.ZstdDecompressor().decompress(data, max_output_size=size)
+    raise ConverterError('unsupported ccz compression %d' % compression)
+
+
+def write_ccz(path, data, compression, chunkSize, level):
+    if chunkSize:
+        chunks = [compress_block(data[i:i + chunkSize], compression, level)
+                  for i in range(0, len(data), chunkSize)]
+        payload = struct.pack('>II', chunkSize, len(chunks))
+        payload += b''.join(struct.pack('>I', len(c)) for c in chunks)
+        payload += b''.join(chunks)
+        version = CCZ_VERSION_CHUNKED
+    else:
+        payload = compress_block(data, compression, level)
+        version = 2
+    with open(path, 'wb') as f:
+        f.write(b'CCZ!' + struct.pack('>HHII', compression, version, 0, len(data)))
+        f.write(payload)
+    return 16 + len(payload)
+
+
+def read_ccz(data):
+    """returns the uncompressed content of an unencrypted ccz file"""
+    if data[:4] == b'CCZp':
+        raise ConverterError('encrypted ccz files are not supported')
+    compression, version, reserved, size = struct.unpack('>HHII', data[4:16])
+    payload = data[16:]
+    if version != CCZ_VERSION_CHUNKED:
+        return decompress_block(payload, compression, size)
+    chunkSize, count = struct.unpack('>II', payload[:8])
+    sizes = struct.unpack('>%dI' % count, payload[8:8 + count * 4])
+    out = []
+    pos = 8 + count * 4
+    for i, length in enumerate(sizes):
+        out.append(decompress_block(payload[pos:pos + length], compression, min(chunkSize, size - i * chunkSize)))
+        pos += length
+    return b''.join(out)
+
+
+def convert(src, dst, compression, chunkSize, level, verbose):
+    with open(src, 'rb') as f:
+        data = f.read()
+    if data[:4] in (b'CCZ!', b'CCZp'):
+        data = read_ccz(data)
+    written = write_ccz(dst, data, compression, chunkSize, level)
+    with open(dst, 'rb') as f:
+        if read_ccz(f.read()) != data:
+            raise ConverterError('%s does not decompress to its source' % dst)
+    if verbose:
+        print('%s -> %s (%d -> %d bytes%s)' % (src, dst, len(data), written,
+              ', %d KB chunks' % (chunkSize // 1024) if chunkSize else ''))
+
+
+def output_name(src, outdir):
+    base = src if src.endswith('.ccz') else src + '.ccz'
+    if outdir:
+        base = os.path.join(outdir, os.path.basename(base))
+    return base
+
+
+def main():
+    parser = optparse.OptionParser(usage='%prog [options] file [file ...]')
+    parser.add_option('-c', '--compression', dest='compression', default='lz4', choices=sorted(COMPRESSIONS.keys()),
+                      help='zlib, lz4, zstd or none. default: lz4')
+    parser.add_option('-s', '--chunk-size', dest='chunkSize', type='int', default=256,
+                      help='size in KB of the independently compressed chunks, 0 for a single block. default: 256')
+    parser.add_option('-l', '--level', dest='level', type='int', default=9,
+                      help='zlib or zstd compression level. default: 9')
+    parser.add_option('-o', '--output-dir', dest='outdir', default=None,
+                      help='directory for the ccz files. default: next to the source, replacing .ccz inputs')
+    parser.add_option('-q', '--quiet', dest='verbose', action='store_false', default=True)
+    options, args = parser.parse_args()
+    if not args:
+        parser.error('no input file')
+    if options.chunkSize < 0:
+        parser.error('negative chunk size')
+
+    try:
+        for src in args:
+            convert(src, output_name(src, options.outdir), COMPRESSIONS[options.compression],
+                    options.chunkSize * 1024, options.level, options.verbose)
+    except (ConverterError, IOError, zlib.error, struct.error) as e:
+        print('error: %s' % e, file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
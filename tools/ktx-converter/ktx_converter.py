@@ -0,0 +1,516 @@
+#!/usr/bin/python
+# ktx_converter.py
+# Convert png images to KTX textures compressed with ETC1, ETC2 or S3TC
+# Copyright (c) 2013 cocos2d-x.org
+#
+# The output files are named after the variants CCTextureCache looks for when
+# setUseCompressedTextureVariants(true) is enabled:
+#
+#     image.png -> image.etc1.ktx, image.etc2.ktx, image.s3tc.ktx
+#
+# The encoders favour simplicity over quality: use a dedicated encoder
+# (etcpack, etc2comp, nvcompress...) for shipping assets when quality matters,
+# and this script for prototypes and for machines without those tools.
+
+from __future__ import print_function
+
+import os
+import sys
+import struct
+import zlib
+import optparse
+
+# GL enums written in the KTX header
+GL_RGB                          = 0x1907
+GL_RGBA                         = 0x1908
+GL_ETC1_RGB8_OES                = 0x8D64
+GL_COMPRESSED_RGB8_ETC2         = 0x9274
+GL_COMPRESSED_RGBA8_ETC2_EAC    = 0x9278
+GL_COMPRESSED_RGB_S3TC_DXT1     = 0x83F0
+GL_COMPRESSED_RGBA_S3TC_DXT5    = 0x83F3
+
+KTX_IDENTIFIER = b'\xABKTX 11\xBB\r\n\x1A\n'
+KTX_PREMULTIPLIED_KEY = b'cocos2d.premultipliedAlpha'
+
+
+class ConverterError(Exception):
+    pass
+
+#
+# png reading
+#
+
+def _paeth(a, b, c):
+    p = a + b - c
+    pa = abs(p - a)
+    pb = abs(p - b)
+    pc = abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    if pb <= pc:
+        return b
+    return c
+
+
+def read_png(path):
+    """returns (width, height, rgba bytearray) for an 8 or 16 bit, non interlaced png"""
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        raise ConverterError('%s is not a png file' % path)
+
+    pos = 8
+    idat = []
+    palette = None
+    trns = None
+    width = height = depth = colorType = interlace = None
+    while pos < len(data):
+        length, = struct.unpack('>I', data[pos:pos + 4])
+        chunk = data[pos + 4:pos + 8]
+        body = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if chunk == b'IHDR':
+            width, height, depth, colorType, _, _, interlace = struct.unpack('>IIBBBBB', body)
+        elif chunk == b'PLTE':
+            palette = bytearray(body)
+        elif chunk == b'tRNS':
+            trns = bytearray(body)
+        elif chunk == b'IDAT':
+            idat.append(body)
+        elif chunk == b'IEND':
+            break
+
+    if width is None:
+        raise ConverterError('%s has no IHDR chunk' % path)
+    if interlace != 0:
+        raise ConverterError('%s: interlaced png files are not supported' % path)
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}.get(colorType)
+    if channels is None:
+        raise ConverterError('%s: unknown png color type %d' % (path, colorType))
+    if depth not in (8, 16) or (colorType == 3 and depth != 8):
+        raise ConverterError('%s: only 8 and 16 bit png files are supported' % path)
+
+    raw = bytearray(zlib.decompress(b''.join(idat)))
+    bpp = channels * depth // 8
+    stride = width * bpp
+    pixels = bytearray(stride * height)
+    prev = bytearray(stride)
+    src = 0
+    for y in range(height):
+        ftype = raw[src]
+        line = raw[src + 1:src + 1 + stride]
+        src += 1 + stride
+        if ftype == 1:
+            for i in range(bpp, stride):
+                line[i] = (line[i] + line[i - bpp]) & 0xff
+        elif ftype == 2:
+            for i in range(stride):
+                line[i] = (line[i] + prev[i]) & 0xff
+        elif ftype == 3:
+            for i in range(stride):
+                left = line[i - bpp] if i >= bpp else 0
+                line[i] = (line[i] + ((left + prev[i]) >> 1)) & 0xff
+        elif ftype == 4:
+            for i in range(stride):
+                left = line[i - bpp] if i >= bpp else 0
+                upleft = prev[i - bpp] if i >= bpp else 0
+                line[i] = (line[i] + _paeth(left, prev[i], upleft)) & 0xff
+        elif ftype != 0:
+            raise ConverterError('%s: bad png filter %d' % (path, ftype))
+        pixels[y * stride:(y + 1) * stride] = line
+        prev = line
+
+    if depth == 16:
+        pixels = pixels[0::2]
+
+    count = width * height
+    rgba = bytearray(count * 4)
+    if colorType == 6:
+        rgba[:] = pixels
+    elif colorType == 2:
+        rgba[0::4] = pixels[0::3]
+        rgba[1::4] = pixels[1::3]
+        rgba[2::4] = pixels[2::3]
+        rgba[3::4] = b'\xff' * count
+    elif colorType == 0:
+        rgba[0::4] = pixels
+        rgba[1::4] = pixels
+        rgba[2::4] = pixels
+        rgba[3::4] = b'\xff' * count
+    elif colorType == 4:
+        rgba[0::4] = pixels[0::2]
+        rgba[1::4] = pixels[0::2]
+        rgba[2::4] = pixels[0::2]
+        rgba[3::4] = pixels[1::2]
+    else:
+        if palette is None:
+            raise ConverterError('%s: palette png without PLTE chunk' % path)
+        for i in range(count):
+            index = pixels[i]
+            rgba[i * 4:i * 4 + 3] = palette[index * 3:index * 3 + 3]
+            rgba[i * 4 + 3] = trns[index] if trns is not None and index < len(trns) else 255
+    return width, height, rgba
+
+
+def has_alpha(rgba):
+    return any(a != 255 for a in rgba[3::4])
+
+
+def premultiply(rgba):
+    for i in range(0, len(rgba), 4):
+        a = rgba[i + 3]
+        if a != 255:
+            rgba[i] = (rgba[i] * a + 127) // 255
+            rgba[i + 1] = (rgba[i + 1] * a + 127) // 255
+            rgba[i + 2] = (rgba[i + 2] * a + 127) // 255
+
+
+def downsample(width, height, rgba):
+    """box filters the image to the next mipmap level"""
+    w = max(width // 2, 1)
+    h = max(height // 2, 1)
+    out = bytearray(w * h * 4)
+    for y in range(h):
+        y0 = min(y * 2, height - 1)
+        y1 = min(y * 2 + 1, height - 1)
+        for x in range(w):
+            x0 = min(x * 2, width - 1)
+            x1 = min(x * 2 + 1, width - 1)
+            a = (y0 * width + x0) * 4
+            b = (y0 * width + x1) * 4
+            c = (y1 * width + x0) * 4
+            d = (y1 * width + x1) * 4
+            o = (y * w + x) * 4
+            for k in range(4):
+                out[o + k] = (rgba[a + k] + rgba[b + k] + rgba[c + k] + rgba[d + k] + 2) >> 2
+    return w, h, out
+
+
+def blocks(width, height, rgba):
+    """yields the 16 rgba tuples of each 4x4 block, row major, edges clamped"""
+    for by in range(0, height, 4):
+        for bx in range(0, width, 4):
+            block = []
+            for y in range(4):
+                sy = min(by + y, height - 1)
+                for x in range(4):
+                    sx = min(bx + x, width - 1)
+                    i = (sy * width + sx) * 4
+                    block.append((rgba[i], rgba[i + 1], rgba[i + 2], rgba[i + 3]))
+            yield block
+
+#
+# ETC1 (also a valid ETC2 RGB8 block)
+#
+
+ETC1_MODIFIERS = [
+    (2, 8), (5, 17), (9, 29), (13, 42), (18, 60), (24, 80), (33, 106), (47, 183),
+]
+
+
+def _clamp(v):
+    return 0 if v < 0 else (255 if v > 255 else v)
+
+
+def _etc1_subblock_error(pixels, base, table):
+    """returns (error, indices) of the best modifier for every pixel"""
+    small, large = ETC1_MODIFIERS[table]
+    candidates = []
+    # index order of the spec: 0 -> +small, 1 -> +large, 2 -> -small, 3 -> -large
+    for m in (small, large, -small, -large):
+        candidates.append((_clamp(base[0] + m), _clamp(base[1] + m), _clamp(base[2] + m)))
+    total = 0
+    indices = []
+    for p in pixels:
+        best = None
+        bestIndex = 0
+        for i, c in enumerate(candidates):
+            dr = p[0] - c[0]
+            dg = p[1] - c[1]
+            db = p[2] - c[2]
+            e = dr * dr + dg * dg + db * db
+            if best is None or e < best:
+                best = e
+                bestIndex = i
+        total += best
+        indices.append(bestIndex)
+    return total, indices
+
+
+def _etc1_best_table(pixels, base):
+    best = None
+    for table in range(8):
+        error, indices = _etc1_subblock_error(pixels, base, table)
+        if best is None or error < best[0]:
+            best = (error, table, indices)
+    return best
+
+
+def _average(pixels):
+    n = len(pixels)
+    return [sum(p[k] for p in pixels) / float(n) for k in range(3)]
+
+
+def encode_etc1_block(block):
+    best = None
+    for flip in (0, 1):
+        # positions are (x, y); block is row major
+        if flip:
+            subs = [[(x, y) for x in range(4) for y in (0, 1)],
+                    [(x, y) for x in range(4) for y in (2, 3)]]
+        else:
+            subs = [[(x, y) for x in (0, 1) for y in range(4)],
+                    [(x, y) for x in (2, 3) for y in range(4)]]
+        pixels = [[block[y * 4 + x] for (x, y) in s] for s in subs]
+        avg = [_average(p) for p in pixels]
+
+        modes = []
+        # differential mode: 5 bit colors, second one within [-4, 3] of the first
+        c1 = [int(round(v * 31 / 255.0)) for v in avg[0]]
+        c2 = [int(round(v * 31 / 255.0)) for v in avg[1]]
+        if all(-4 <= c2[k] - c1[k] <= 3 for k in range(3)):
+            bases = [[(c << 3) | (c >> 2) for c in c1], [(c << 3) | (c >> 2) for c in c2]]
+            modes.append((1, c1, c2, bases))
+        # individual mode: two 4 bit colors
+        i1 = [int(round(v * 15 / 255.0)) for v in avg[0]]
+        i2 = [int(round(v * 15 / 255.0)) for v in avg[1]]
+        modes.append((0, i1, i2, [[c * 17 for c in i1], [c * 17 for c in i2]]))
+
+        for diff, q1, q2, bases in modes:
+            r1 = _etc1_best_table(pixels[0], bases[0])
+            r2 = _etc1_best_table(pixels[1], bases[1])
+            error = r1[0] + r2[0]
+            if best is None or error < best[0]:
+                best = (error, flip, diff, q1, q2, r1, r2, subs)
+
+    _, flip, diff, q1, q2, r1, r2, subs = best
+    if diff:
+        hi = 0
+        for k in range(3):
+            d = (q2[k] - q1[k]) & 7
+            hi |= ((q1[k] << 3) | d) << (24 - k * 8)
+    else:
+        hi = 0
+        for k in range(3):
+            hi |= ((q1[k] << 4) | q2[k]) << (24 - k * 8)
+    hi |= (r1[1] << 5) | (r2[1] << 2) | (diff << 1) | flip
+
+    msb = 0
+    lsb = 0
+    for sub, result in ((subs[0], r1), (subs[1], r2)):
+        for (x, y), index in zip(sub, result[2]):
+            bit = x * 4 + y
+            msb |= (index >> 1) << bit
+            lsb |= (index & 1) << bit
+    lo = (msb << 16) | lsb
+    return struct.pack('>II', hi, lo)
+
+#
+# EAC alpha, used by ETC2 RGBA8
+#
+
+EAC_MODIFIERS = [
+    (-3, -6, -9, -15, 2, 5, 8, 14),
+    (-3, -7, -10, -13, 2, 6, 9, 12),
+    (-2, -5, -8, -13, 1, 4, 7, 12),
+    (-2, -4, -6, -13, 1, 3, 5, 12),
+    (-3, -6, -8, -12, 2, 5, 7, 11),
+    (-3, -7, -9, -11, 2, 6, 8, 10),
+    (-4, -7, -8, -11, 3, 6, 7, 10),
+    (-3, -5, -8, -11, 2, 4, 7, 10),
+    (-2, -6, -8, -10, 1, 5, 7, 9),
+    (-2, -5, -8, -10, 1, 4, 7, 9),
+    (-2, -4, -8, -10, 1, 3, 7, 9),
+    (-2, -5, -7, -10, 1, 4, 6, 9),
+    (-3, -4, -7, -10, 2, 3, 6, 9),
+    (-1, -2, -3, -10, 0, 1, 2, 9),
+    (-4, -6, -8, -9, 3, 5, 7, 8),
+    (-3, -5, -7, -9, 2, 4, 6, 8),
+]
+
+
+def encode_eac_block(block):
+    alphas = [p[3] for p in block]
+    lo = min(alphas)
+    hi = max(alphas)
+    best = None
+    if lo == hi:
+        # table 13 has a zero modifier at index 4
+        best = (0, lo, 1, 13, [4] * 16)
+    else:
+        center = (lo + hi + 1) // 2
+        for table, mods in enumerate(EAC_MODIFIERS):
+            span = mods[7] - mods[3]
+            guess = max(1, min(15, int(round((hi - lo) / float(span)))))
+            for mul in set((max(1, guess - 1), guess, min(15, guess + 1))):
+                for base in (center - 1, center, center + 1):
+                    base = _clamp(base)
+                    values = [_clamp(base + m * mul) for m in mods]
+                    error = 0
+                    indices = []
+                    for a in alphas:
+                        e, i = min(((a - v) * (a - v), i) for i, v in enumerate(values))
+                        error += e
+                        indices.append(i)
+                    if best is None or error < best[0]:
+                        best = (error, base, mul, table, indices)
+    _, base, mul, table, indices = best
+    bits = 0
+    # pixels are stored column major, first pixel in the most significant bits
+    for x in range(4):
+        for y in range(4):
+            bits = (bits << 3) | indices[y * 4 + x]
+    return struct.pack('>BB', base, (mul << 4) | table) + struct.pack('>Q', bits)[2:]
+
+#
+# S3TC
+#
+
+def _to565(c):
+    return ((c[0] * 31 + 127) // 255 << 11) | ((c[1] * 63 + 127) // 255 << 5) | ((c[2] * 31 + 127) // 255)
+
+
+def _from565(v):
+    r = (v >> 11) & 31
+    g = (v >> 5) & 63
+    b = v & 31
+    return ((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2))
+
+
+def encode_dxt1_block(block):
+    lo = tuple(min(p[k] for p in block) for k in range(3))
+    hi = tuple(max(p[k] for p in block) for k in range(3))
+    c0 = _to565(hi)
+    c1 = _to565(lo)
+    if c0 < c1:
+        c0, c1 = c1, c0
+    if c0 == c1:
+        return struct.pack('<HHI', c0, c1, 0)
+
+    e0 = _from565(c0)
+    e1 = _from565(c1)
+    palette = [e0, e1,
+               tuple((2 * e0[k] + e1[k]) // 3 for k in range(3)),
+               tuple((e0[k] + 2 * e1[k]) // 3 for k in range(3))]
+    bits = 0
+    for i, p in enumerate(block):
+        _, index = min(((p[0] - c[0]) ** 2 + (p[1] - c[1]) ** 2 + (p[2] - c[2]) ** 2, j)
+                       for j, c in enumerate(palette))
+        bits |= index << (i * 2)
+    return struct.pack('<HHI', c0, c1, bits)
+
+
+def encode_dxt5_block(block):
+    alphas = [p[3] for p in block]
+    a0 = max(alphas)
+    a1 = min(alphas)
+    bits = 0
+    if a0 != a1:
+        palette = [a0, a1] + [((7 - i) * a0 + i * a1) // 7 for i in range(1, 7)]
+        for i, a in enumerate(alphas):
+            _, index = min((abs(a - v), j) for j, v in enumerate(palette))
+            bits |= index << (i * 3)
+    return struct.pack('<BB', a0, a1) + struct.pack('<Q', bits)[:6] + encode_dxt1_block(block)
+
+#
+# KTX writing
+#
+
+# name -> (internal format, base internal format, encoder) for opaque and translucent images
+FORMATS = {
+    'etc1': ((GL_ETC1_RGB8_OES, GL_RGB, [encode_etc1_block]),
+             None),
+    'etc2': ((GL_COMPRESSED_RGB8_ETC2, GL_RGB, [encode_etc1_block]),
+             (GL_COMPRESSED_RGBA8_ETC2_EAC, GL_RGBA, [encode_eac_block, encode_etc1_block])),
+    's3tc': ((GL_COMPRESSED_RGB_S3TC_DXT1, GL_RGB, [encode_dxt1_block]),
+             (GL_COMPRESSED_RGBA_S3TC_DXT5, GL_RGBA, [encode_dxt5_block])),
+}
+
+
+def encode_level(width, height, rgba, encoders):
+    out = []
+    for block in blocks(width, height, rgba):
+        for encode in encoders:
+            out.append(encode(block))
+    return b''.join(out)
+
+
+def write_ktx(path, width, height, internalFormat, baseFormat, levels, premultiplied):
+    keyValues = b''
+    if premultiplied:
+        pair = KTX_PREMULTIPLIED_KEY + b'\0' + b'true\0'
+        pair += b'\0' * ((4 - len(pair) % 4) % 4)
+        keyValues = struct.pack('<I', len(KTX_PREMULTIPLIED_KEY) + 6) + pair
+
+    with open(path, 'wb') as f:
+        f.write(KTX_IDENTIFIER)
+        # endianness, glType, glTypeSize, glFormat, glInternalFormat, glBaseInternalFormat,
+        # width, height, depth, array elements, faces, mipmap levels, key/value bytes
+        f.write(struct.pack('<13I', 0x04030201, 0, 1, 0, internalFormat, baseFormat,
+                            width, height, 0, 0, 1, len(levels), len(keyValues)))
+        f.write(keyValues)
+        for level in levels:
+            f.write(struct.pack('<I', len(level)))
+            f.write(level)
+            f.write(b'\0' * ((4 - len(level) % 4) % 4))
+
+
+def convert(src, dst, formatName, mipmaps, premultiplied, verbose):
+    width, height, rgba = read_png(src)
+    alpha = has_alpha(rgba)
+    opaque, translucent = FORMATS[formatName]
+    if alpha and translucent is None:
+        print('warning: %s has an alpha channel, %s drops it' % (src, formatName), file=sys.stderr)
+    internalFormat, baseFormat, encoders = translucent if alpha and translucent else opaque
+    premultiplied = premultiplied and alpha and baseFormat == GL_RGBA
+    if premultiplied:
+        premultiply(rgba)
+
+    levels = [encode_level(width, height, rgba, encoders)]
+    w, h = width, height
+    while mipmaps and (w > 1 or h > 1):
+        w, h, rgba = downsample(w, h, rgba)
+        levels.append(encode_level(w, h, rgba, encoders))
+
+    write_ktx(dst, width, height, internalFormat, baseFormat, levels, premultiplied)
+    if verbose:
+        print('%s -> %s (%dx%d, 0x%04X, %d level%s%s)' % (src, dst, width, height, internalFormat,
+              len(levels), 's' if len(levels) > 1 else '', ', premultiplied' if premultiplied else ''))
+
+
+def output_name(src, formatName, outdir):
+    base = os.path.splitext(src)[0] + '.' + formatName + '.ktx'
+    if outdir:
+        base = os.path.join(outdir, os.path.basename(base))
+    return base
+
+
+def main():
+    parser = optparse.OptionParser(usage='%prog [options] image.png [image.png ...]')
+    parser.add_option('-f', '--format', dest='formats', action='append', choices=sorted(FORMATS.keys()),
+                      help='etc1, etc2 or s3tc; may be repeated. default: all of them')
+    parser.add_option('-m', '--mipmaps', dest='mipmaps', action='store_true', default=False,
+                      help='generate the whole mipmap chain')
+    parser.add_option('-p', '--premultiply', dest='premultiply', action='store_true', default=False,
+                      help='premultiply translucent images and tag the file as premultiplied')
+    parser.add_option('-o', '--output-dir', dest='outdir', default=None,
+                      help='directory for the ktx files. default: next to the png')
+    parser.add_option('-q', '--quiet', dest='verbose', action='store_false', default=True)
+    options, args = parser.parse_args()
+    if not args:
+        parser.error('no input file')
+
+    formats = options.formats or ['etc1', 'etc2', 's3tc']
+    try:
+        for src in args:
+            for formatName in formats:
+                convert(src, output_name(src, formatName, options.outdir), formatName,
+                        options.mipmaps, options.premultiply, options.verbose)
+    except (ConverterError, IOError, zlib.error) as e:
+        print('error: %s' % e, file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())